@@ -0,0 +1,133 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "busload.h"
+
+#include <string.h>
+
+void knx_busload_init(knx_busload* load, uint64_t bucket_width) {
+	memset(load, 0, sizeof(knx_busload));
+	load->bucket_width = bucket_width > 0 ? bucket_width : 1;
+}
+
+// Move the line's window forward to the given epoch, clearing every bucket that has been skipped.
+inline static
+void knx_busload_advance(knx_busload_line* line, uint64_t epoch) {
+	if (epoch <= line->epoch)
+		return;
+
+	if (epoch - line->epoch >= KNX_BUSLOAD_BUCKETS) {
+		memset(line->bits, 0, sizeof(line->bits));
+		memset(line->telegrams, 0, sizeof(line->telegrams));
+	} else {
+		for (uint64_t e = line->epoch + 1; e <= epoch; e++) {
+			line->bits[e % KNX_BUSLOAD_BUCKETS] = 0;
+			line->telegrams[e % KNX_BUSLOAD_BUCKETS] = 0;
+		}
+	}
+
+	line->epoch = epoch;
+}
+
+void knx_busload_update(knx_busload* load, uint64_t now, const knx_ldata* ldata) {
+	knx_busload_line* line = load->lines + (ldata->source >> 8);
+	uint64_t epoch = now / load->bucket_width;
+
+	knx_busload_advance(line, epoch);
+
+	// Late telegrams still count, as long as their bucket is part of the window
+	if (line->epoch - epoch < KNX_BUSLOAD_BUCKETS) {
+		line->bits[epoch % KNX_BUSLOAD_BUCKETS] += knx_busload_bits(ldata);
+		line->telegrams[epoch % KNX_BUSLOAD_BUCKETS]++;
+	}
+}
+
+inline static
+void knx_busload_sum(
+	const knx_busload*      load,
+	const knx_busload_line* line,
+	uint64_t                now,
+	uint64_t*               bits,
+	uint64_t*               telegrams
+) {
+	uint64_t epoch = now / load->bucket_width;
+
+	*bits = 0;
+	*telegrams = 0;
+
+	if (epoch < line->epoch || epoch - line->epoch >= KNX_BUSLOAD_BUCKETS)
+		return;
+
+	// Only the buckets which are still part of the window at `now`
+	for (uint64_t e = line->epoch; e + KNX_BUSLOAD_BUCKETS > epoch; e--) {
+		*bits += line->bits[e % KNX_BUSLOAD_BUCKETS];
+		*telegrams += line->telegrams[e % KNX_BUSLOAD_BUCKETS];
+
+		if (e == 0)
+			break;
+	}
+}
+
+// Duration of the sliding window in seconds, the newest bucket is only partially elapsed.
+inline static
+double knx_busload_window(const knx_busload* load, uint64_t now) {
+	uint64_t epoch = now / load->bucket_width;
+	uint64_t full = epoch < KNX_BUSLOAD_BUCKETS - 1 ? epoch : KNX_BUSLOAD_BUCKETS - 1;
+
+	return (full * load->bucket_width + now % load->bucket_width + 1) / 1e9;
+}
+
+float knx_busload_utilisation(const knx_busload* load, uint64_t now, knx_addr line, float* rate) {
+	uint64_t bits, telegrams;
+	knx_busload_sum(load, load->lines + (line >> 8), now, &bits, &telegrams);
+
+	double window = knx_busload_window(load, now);
+
+	if (rate)
+		*rate = telegrams / window;
+
+	return 100.0 * bits / (window * KNX_BUSLOAD_BIT_RATE);
+}
+
+size_t knx_busload_snapshot_all(
+	const knx_busload*    load,
+	uint64_t              now,
+	knx_busload_snapshot* snapshots,
+	size_t                max
+) {
+	double window = knx_busload_window(load, now);
+	size_t count = 0;
+
+	for (size_t i = 0; i < KNX_BUSLOAD_LINES && count < max; i++) {
+		uint64_t bits, telegrams;
+		knx_busload_sum(load, load->lines + i, now, &bits, &telegrams);
+
+		if (telegrams == 0)
+			continue;
+
+		snapshots[count].line = i << 8;
+		snapshots[count].utilisation = 100.0 * bits / (window * KNX_BUSLOAD_BIT_RATE);
+		snapshots[count].rate = telegrams / window;
+		count++;
+	}
+
+	return count;
+}
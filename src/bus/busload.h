@@ -0,0 +1,176 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_BUS_BUSLOAD_H_
+#define KNXPROTO_BUS_BUSLOAD_H_
+
+#include "../proto/ldata.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * TP1 bit rate in bits per second
+ */
+#define KNX_BUSLOAD_BIT_RATE 9600
+
+/**
+ * Bit times per character: start bit, 8 data bits, parity bit, stop bit and 2 bits pause
+ */
+#define KNX_BUSLOAD_CHAR_BITS 13
+
+/**
+ * Bit times the bus has to be idle before a frame may be sent
+ */
+#define KNX_BUSLOAD_IDLE_BITS 50
+
+/**
+ * Bit times consumed by the acknowledgement: 15 bits pause and 11 bits for the character
+ */
+#define KNX_BUSLOAD_ACK_BITS 26
+
+/**
+ * Number of buckets the sliding window consists of
+ */
+#define KNX_BUSLOAD_BUCKETS 16
+
+/**
+ * Number of lines that can be told apart (16 areas with 16 lines each)
+ */
+#define KNX_BUSLOAD_LINES 256
+
+/**
+ * Load of a single line
+ */
+typedef struct {
+	/**
+	 * Number of the newest bucket
+	 */
+	uint64_t epoch;
+
+	/**
+	 * Bit times per bucket
+	 */
+	uint32_t bits[KNX_BUSLOAD_BUCKETS];
+
+	/**
+	 * Telegrams per bucket
+	 */
+	uint32_t telegrams[KNX_BUSLOAD_BUCKETS];
+} knx_busload_line;
+
+/**
+ * Bus Load Monitor
+ *
+ * Accumulates the estimated TP1 bit time of every telegram on the line of its source address.
+ * The table is statically sized, updating it never allocates.
+ */
+typedef struct {
+	/**
+	 * Bucket width in nanoseconds
+	 */
+	uint64_t bucket_width;
+
+	/**
+	 * Lines indexed by the upper 8 bits of an individual address
+	 */
+	knx_busload_line lines[KNX_BUSLOAD_LINES];
+} knx_busload;
+
+/**
+ * Line utilisation snapshot
+ */
+typedef struct {
+	/**
+	 * Area and line in the form of an individual address with device `0`
+	 */
+	knx_addr line;
+
+	/**
+	 * Percentage of the bus time occupied by telegrams
+	 */
+	float utilisation;
+
+	/**
+	 * Telegrams per second
+	 */
+	float rate;
+} knx_busload_snapshot;
+
+/**
+ * Estimated number of TP1 bit times a telegram occupies the bus, including the idle time in
+ * front of it and its acknowledgement.
+ */
+inline static
+uint32_t knx_busload_bits(const knx_ldata* ldata) {
+	// Standard TP1 frames lack control field 2 but carry a checksum, hence the size matches
+	return
+		KNX_BUSLOAD_IDLE_BITS +
+		KNX_BUSLOAD_CHAR_BITS * knx_ldata_size(ldata) +
+		KNX_BUSLOAD_ACK_BITS;
+}
+
+/**
+ * Initialize the monitor.
+ *
+ * \param load         Bus load monitor
+ * \param bucket_width Width of a bucket in nanoseconds, the sliding window spans
+ *                     `KNX_BUSLOAD_BUCKETS` buckets
+ */
+void knx_busload_init(knx_busload* load, uint64_t bucket_width);
+
+/**
+ * Account for a telegram.
+ *
+ * \param load  Bus load monitor
+ * \param now   Current time in nanoseconds (monotonic)
+ * \param ldata Observed telegram
+ */
+void knx_busload_update(knx_busload* load, uint64_t now, const knx_ldata* ldata);
+
+/**
+ * Calculate the utilisation of a line.
+ *
+ * \param load Bus load monitor
+ * \param now  Current time in nanoseconds
+ * \param line Any individual address on the line in question
+ * \param rate Telegrams per second will be stored here (may be `NULL`)
+ * \returns Utilisation in percent
+ */
+float knx_busload_utilisation(const knx_busload* load, uint64_t now, knx_addr line, float* rate);
+
+/**
+ * Take a snapshot of every line which has seen traffic within the sliding window.
+ *
+ * \param load      Bus load monitor
+ * \param now       Current time in nanoseconds
+ * \param snapshots Output array
+ * \param max       Maximum number of elements in `snapshots`
+ * \returns Number of snapshots written
+ */
+size_t knx_busload_snapshot_all(
+	const knx_busload*    load,
+	uint64_t              now,
+	knx_busload_snapshot* snapshots,
+	size_t                max
+);
+
+#endif
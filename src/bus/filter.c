@@ -0,0 +1,172 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "filter.h"
+
+#include <math.h>
+#include <string.h>
+
+bool knx_filter_init(knx_filter* filter, const knx_filter_profile* profile) {
+	return knx_filter_init_with(filter, profile, NULL);
+}
+
+bool knx_filter_init_with(
+	knx_filter*               filter,
+	const knx_filter_profile* profile,
+	const knx_allocator*      allocator
+) {
+	filter->states =
+		knx_allocator_alloc(allocator, sizeof(knx_filter_state) * KNX_GROUP_INDEX_SIZE);
+
+	if (!filter->states)
+		return false;
+
+	filter->allocator = allocator;
+
+	memset(filter->states, 0, sizeof(knx_filter_state) * KNX_GROUP_INDEX_SIZE);
+	memset(filter->profiles, 0, sizeof(filter->profiles));
+
+	if (profile)
+		filter->profiles[0] = *profile;
+
+	filter->forwarded = 0;
+	filter->dropped = 0;
+
+	return true;
+}
+
+void knx_filter_destroy(knx_filter* filter) {
+	knx_allocator_free(filter->allocator, filter->states);
+	filter->states = NULL;
+}
+
+void knx_filter_configure(knx_filter* filter, knx_addr group, uint8_t profile) {
+	if (group >= KNX_GROUP_INDEX_SIZE)
+		return;
+
+	knx_filter_state* state = filter->states + group;
+
+	state->profile = profile;
+	state->valid = false;
+}
+
+// Decision based on timing alone: 1 = forward, 0 = drop, -1 = depends on the value
+inline static
+int knx_filter_timing(const knx_filter_state* state, const knx_filter_profile* profile, uint64_t now) {
+	if (!state->valid)
+		return 1;
+
+	uint64_t elapsed = now > state->time ? now - state->time : 0;
+
+	if (elapsed < profile->min_interval)
+		return 0;
+
+	if (profile->max_interval > 0 && elapsed >= profile->max_interval)
+		return 1;
+
+	return -1;
+}
+
+inline static
+bool knx_filter_finish(knx_filter* filter, knx_filter_state* state, uint64_t now, bool forward) {
+	if (forward) {
+		state->time = now;
+		state->valid = true;
+		filter->forwarded++;
+	} else {
+		filter->dropped++;
+	}
+
+	return forward;
+}
+
+inline static
+bool knx_filter_significant(const knx_filter_profile* profile, double last, double value) {
+	if (isnan(last) || isnan(value))
+		return isnan(last) != isnan(value);
+
+	double delta = fabs(value - last);
+
+	if (delta == 0)
+		return false;
+
+	if (profile->absolute <= 0 && profile->relative <= 0)
+		return true;
+
+	return (profile->absolute > 0 && delta >= profile->absolute)
+	    || (profile->relative > 0 && delta >= profile->relative * fabs(last));
+}
+
+bool knx_filter_update(knx_filter* filter, uint64_t now, knx_addr group, double value) {
+	if (group >= KNX_GROUP_INDEX_SIZE) {
+		filter->forwarded++;
+		return true;
+	}
+
+	knx_filter_state* state = filter->states + group;
+	int timing = knx_filter_timing(state, filter->profiles + state->profile, now);
+
+	bool forward = timing > 0 || (timing < 0 &&
+		knx_filter_significant(filter->profiles + state->profile, state->last.value, value));
+
+	if (forward)
+		state->last.value = value;
+
+	return knx_filter_finish(filter, state, now, forward);
+}
+
+inline static
+bool knx_filter_numeric(const knx_group_value* value, double* number) {
+	if (!knx_dpt_value_number(value->descriptor->type, &value->value, number))
+		return false;
+
+	*number = *number * value->descriptor->multiplier / value->descriptor->divisor;
+	return true;
+}
+
+bool knx_filter_group_value(knx_filter* filter, uint64_t now, const knx_group_value* value) {
+	double number;
+
+	if (knx_filter_numeric(value, &number))
+		return knx_filter_update(filter, now, value->group, number);
+
+	if (value->group >= KNX_GROUP_INDEX_SIZE) {
+		filter->forwarded++;
+		return true;
+	}
+
+	knx_filter_state* state = filter->states + value->group;
+	int timing = knx_filter_timing(state, filter->profiles + state->profile, now);
+
+	// Compare the wire representation, it covers every field and contains no padding
+	uint8_t apdu[KNX_FILTER_APDU_SIZE];
+	size_t length = knx_dpt_size(value->descriptor->type);
+
+	memset(apdu, 0, sizeof(apdu));
+	knx_dpt_to_apdu(apdu, value->descriptor->type, &value->value);
+
+	bool forward = timing > 0 || (timing < 0 && memcmp(apdu, state->last.apdu, length) != 0);
+
+	if (forward)
+		memcpy(state->last.apdu, apdu, length);
+
+	return knx_filter_finish(filter, state, now, forward);
+}
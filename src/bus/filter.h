@@ -0,0 +1,196 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_BUS_FILTER_H_
+#define KNXPROTO_BUS_FILTER_H_
+
+#include "../proto/groupindex.h"
+#include "../util/allocator.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Number of filter profiles
+ */
+#define KNX_FILTER_PROFILES 256
+
+/**
+ * Largest APDU of a non-numeric value, which is a string
+ */
+#define KNX_FILTER_APDU_SIZE KNX_DPT_STRING_SIZE
+
+/**
+ * Filter Profile
+ *
+ * An update is significant if it differs from the last forwarded value by at least one of the
+ * deadbands. If both deadbands are disabled, every change is significant.
+ */
+typedef struct {
+	/**
+	 * Minimum absolute change, 0 disables the absolute deadband
+	 */
+	double absolute;
+
+	/**
+	 * Minimum change relative to the last forwarded value (e.g. 0.05 for 5 %), 0 disables the
+	 * relative deadband
+	 */
+	double relative;
+
+	/**
+	 * Updates arriving sooner than this many nanoseconds after the last forwarded one are dropped,
+	 * even if they are significant
+	 */
+	uint64_t min_interval;
+
+	/**
+	 * Forward an update regardless of its value if the last forwarded one is older than this many
+	 * nanoseconds, 0 disables the heartbeat
+	 */
+	uint64_t max_interval;
+} knx_filter_profile;
+
+/**
+ * Filter State of a Group Address
+ */
+typedef struct {
+	union {
+		/**
+		 * Last forwarded numeric value
+		 */
+		double value;
+
+		/**
+		 * APDU of the last forwarded non-numeric value
+		 */
+		uint8_t apdu[KNX_FILTER_APDU_SIZE];
+	} last;
+
+	/**
+	 * Time at which the last value has been forwarded
+	 */
+	uint64_t time;
+
+	/**
+	 * Index of the profile in use
+	 */
+	uint8_t profile;
+
+	/**
+	 * A value has been forwarded
+	 */
+	bool valid;
+} knx_filter_state;
+
+/**
+ * Deadband Filter
+ *
+ * Drops group value updates which are not significant compared to the last forwarded value. The
+ * state of each group address is stored in a flat array indexed by the address.
+ */
+typedef struct {
+	/**
+	 * Profiles, all group addresses use profile 0 initially
+	 */
+	knx_filter_profile profiles[KNX_FILTER_PROFILES];
+
+	/**
+	 * State indexed by group address
+	 */
+	knx_filter_state* states;
+
+	/**
+	 * Allocator `states` has been obtained from
+	 */
+	const knx_allocator* allocator;
+
+	/**
+	 * Number of updates that have been forwarded
+	 */
+	uint64_t forwarded;
+
+	/**
+	 * Number of updates that have been dropped
+	 */
+	uint64_t dropped;
+} knx_filter;
+
+/**
+ * Initialize the filter.
+ *
+ * \param filter  Output filter
+ * \param profile Profile 0, `NULL` means only changed values are forwarded
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_filter_init(knx_filter* filter, const knx_filter_profile* profile);
+
+/**
+ * Initialize the filter using the given allocator for its state.
+ *
+ * \see knx_filter_init
+ * \param allocator Allocator (may be `NULL`), must outlive the filter
+ */
+bool knx_filter_init_with(
+	knx_filter*               filter,
+	const knx_filter_profile* profile,
+	const knx_allocator*      allocator
+);
+
+/**
+ * Free the filter state.
+ */
+void knx_filter_destroy(knx_filter* filter);
+
+/**
+ * Let a group address use the given profile. Its state is reset, so the next update is
+ * forwarded.
+ *
+ * \param filter  Filter
+ * \param group   Group address
+ * \param profile Index into `filter->profiles`
+ */
+void knx_filter_configure(knx_filter* filter, knx_addr group, uint8_t profile);
+
+/**
+ * Check whether a numeric update is significant. If it is, it becomes the new reference value.
+ *
+ * \param filter Filter
+ * \param now    Current time in nanoseconds
+ * \param group  Group address
+ * \param value  Numeric value
+ * \returns `true` if the update shall be forwarded, `false` if it shall be dropped
+ */
+bool knx_filter_update(knx_filter* filter, uint64_t now, knx_addr group, double value);
+
+/**
+ * Check whether a decoded group value is significant. Numbers are scaled according to their
+ * sub-type and subject to the deadbands, other values are forwarded only if they have changed.
+ *
+ * \param filter Filter
+ * \param now    Current time in nanoseconds
+ * \param value  Decoded group value
+ * \returns `true` if the update shall be forwarded, `false` if it shall be dropped
+ */
+bool knx_filter_group_value(knx_filter* filter, uint64_t now, const knx_group_value* value);
+
+#endif
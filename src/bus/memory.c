@@ -0,0 +1,279 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "memory.h"
+
+#include <string.h>
+
+// Forward frames to the user's send function
+static
+void knx_memory_send(const knx_ldata* ldata, void* user, void* data) {
+	const knx_memory* memory = data;
+	memory->send(ldata, user, memory->data);
+}
+
+// Close the connection and report the outcome, so the handler may reuse the slot
+static
+void knx_memory_finish(knx_memory* memory, uint32_t index, bool success) {
+	const knx_memory_job* job = memory->jobs + index;
+	void* user = job->user;
+	size_t transferred = job->offset;
+
+	knx_transport_disconnect(&memory->transport, index);
+	memory->done(index, success, transferred, user, memory->data);
+}
+
+// Request the next chunk
+static
+void knx_memory_request(knx_memory* memory, uint32_t index) {
+	knx_memory_job* job = memory->jobs + index;
+
+	size_t remaining = job->length - job->offset;
+	uint8_t count = remaining < job->chunk ? remaining : job->chunk;
+	uint16_t address = job->address + job->offset;
+
+	job->request[0] = count;
+	job->request[1] = address >> 8 & 0xFF;
+	job->request[2] = address & 0xFF;
+	job->requested = count;
+	job->answered = false;
+
+	bool sent;
+
+	if (job->operation == KNX_MEMORY_READ) {
+		sent = knx_transport_send_data(&memory->transport, index, KNX_APCI_MEMORYREAD,
+		                               job->request, 3, memory->now);
+	} else {
+		memcpy(job->request + 3, job->buffer.write + job->offset, count);
+		sent = knx_transport_send_data(&memory->transport, index, KNX_APCI_MEMORYWRITE,
+		                               job->request, 3 + count, memory->now);
+	}
+
+	if (!sent)
+		knx_memory_finish(memory, index, false);
+}
+
+static
+void knx_memory_advance(knx_memory* memory, uint32_t index) {
+	const knx_memory_job* job = memory->jobs + index;
+
+	if (job->offset == job->length)
+		knx_memory_finish(memory, index, true);
+	else
+		knx_memory_request(memory, index);
+}
+
+// Copy the answer to the pending read request into the caller buffer
+static
+void knx_memory_response(knx_memory* memory, uint32_t index, const knx_tpdu* tpdu) {
+	knx_memory_job* job = memory->jobs + index;
+
+	if (job->operation != KNX_MEMORY_READ || job->answered ||
+	    tpdu->info.data.apci != KNX_APCI_MEMORYRESPONSE || tpdu->info.data.length < 3)
+		return;
+
+	const uint8_t* payload = tpdu->info.data.payload;
+	uint8_t count = payload[0] & 63;
+	uint16_t address = payload[1] << 8 | payload[2];
+
+	// Answers to other requests are ignored
+	if (address != (uint16_t) (job->address + job->offset))
+		return;
+
+	// A device answers with no data if the memory is protected
+	if (count == 0 || count > job->requested || tpdu->info.data.length < 3 + (size_t) count) {
+		knx_memory_finish(memory, index, false);
+		return;
+	}
+
+	memcpy(job->buffer.read + job->offset, payload + 3, count);
+	job->offset += count;
+	job->answered = true;
+
+	// The acknowledgement of the request may still be outstanding
+	if (knx_transport_state_of(&memory->transport, index) == KNX_TRANSPORT_OPEN_IDLE)
+		knx_memory_advance(memory, index);
+}
+
+static
+void knx_memory_handle(
+	uint32_t            index,
+	knx_transport_event event,
+	const knx_tpdu*     tpdu,
+	void*               user,
+	void*               data
+) {
+	knx_memory* memory = data;
+	knx_memory_job* job = memory->jobs + index;
+
+	switch (event) {
+		case KNX_TRANSPORT_CONFIRMED:
+			if (job->operation == KNX_MEMORY_WRITE) {
+				job->offset += job->requested;
+				knx_memory_advance(memory, index);
+			} else if (job->answered) {
+				knx_memory_advance(memory, index);
+			}
+
+			break;
+
+		case KNX_TRANSPORT_DATA:
+			knx_memory_response(memory, index, tpdu);
+			break;
+
+		case KNX_TRANSPORT_DISCONNECTED:
+		case KNX_TRANSPORT_FAILED:
+			knx_memory_finish(memory, index, false);
+			break;
+	}
+}
+
+bool knx_memory_init(
+	knx_memory*        memory,
+	size_t             capacity,
+	knx_transport_send send,
+	knx_memory_done    done,
+	void*              data
+) {
+	return knx_memory_init_with(memory, capacity, send, done, data, NULL);
+}
+
+bool knx_memory_init_with(
+	knx_memory*          memory,
+	size_t               capacity,
+	knx_transport_send   send,
+	knx_memory_done      done,
+	void*                data,
+	const knx_allocator* allocator
+) {
+	if (!knx_transport_init_with(&memory->transport, capacity, knx_memory_send, knx_memory_handle,
+	                             memory, allocator))
+		return false;
+
+	memory->jobs = knx_allocator_alloc(allocator, sizeof(knx_memory_job) * capacity);
+
+	if (!memory->jobs) {
+		knx_transport_destroy(&memory->transport);
+		return false;
+	}
+
+	memory->send = send;
+	memory->done = done;
+	memory->data = data;
+	memory->now = 0;
+
+	return true;
+}
+
+void knx_memory_destroy(knx_memory* memory) {
+	knx_allocator_free(memory->transport.allocator, memory->jobs);
+	memory->jobs = NULL;
+
+	knx_transport_destroy(&memory->transport);
+}
+
+static
+uint32_t knx_memory_start(
+	knx_memory*          memory,
+	knx_memory_operation operation,
+	knx_addr             local,
+	knx_addr             device,
+	uint16_t             address,
+	size_t               length,
+	size_t               apdu_length,
+	void*                user,
+	uint64_t             now
+) {
+	// A request carries the address, count and APCI besides the data
+	if (length == 0 || address + length > UINT16_MAX + 1 || apdu_length < 4)
+		return KNX_TRANSPORT_NONE;
+
+	memory->now = now;
+
+	uint32_t index = knx_transport_connect(&memory->transport, local, device, user, now);
+	if (index == KNX_TRANSPORT_NONE)
+		return KNX_TRANSPORT_NONE;
+
+	knx_memory_job* job = memory->jobs + index;
+
+	job->operation = operation;
+	job->address = address;
+	job->length = length;
+	job->offset = 0;
+	job->chunk = apdu_length - 3 < KNX_MEMORY_MAX_CHUNK ? apdu_length - 3 : KNX_MEMORY_MAX_CHUNK;
+	job->user = user;
+
+	return index;
+}
+
+uint32_t knx_memory_read(
+	knx_memory* memory,
+	knx_addr    local,
+	knx_addr    device,
+	uint16_t    address,
+	uint8_t*    buffer,
+	size_t      length,
+	size_t      apdu_length,
+	void*       user,
+	uint64_t    now
+) {
+	uint32_t index = knx_memory_start(memory, KNX_MEMORY_READ, local, device, address, length,
+	                                  apdu_length, user, now);
+
+	if (index != KNX_TRANSPORT_NONE) {
+		memory->jobs[index].buffer.read = buffer;
+		knx_memory_request(memory, index);
+	}
+
+	return index;
+}
+
+uint32_t knx_memory_write(
+	knx_memory*    memory,
+	knx_addr       local,
+	knx_addr       device,
+	uint16_t       address,
+	const uint8_t* buffer,
+	size_t         length,
+	size_t         apdu_length,
+	void*          user,
+	uint64_t       now
+) {
+	uint32_t index = knx_memory_start(memory, KNX_MEMORY_WRITE, local, device, address, length,
+	                                  apdu_length, user, now);
+
+	if (index != KNX_TRANSPORT_NONE) {
+		memory->jobs[index].buffer.write = buffer;
+		knx_memory_request(memory, index);
+	}
+
+	return index;
+}
+
+bool knx_memory_receive(knx_memory* memory, const knx_ldata* ldata, uint64_t now) {
+	memory->now = now;
+	return knx_transport_receive(&memory->transport, ldata, now);
+}
+
+uint64_t knx_memory_poll(knx_memory* memory, uint64_t now) {
+	memory->now = now;
+	return knx_transport_poll(&memory->transport, now);
+}
@@ -0,0 +1,265 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_BUS_MEMORY_H_
+#define KNXPROTO_BUS_MEMORY_H_
+
+#include "transport.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Maximum number of bytes a single memory request can transfer
+ */
+#define KNX_MEMORY_MAX_CHUNK 63
+
+/**
+ * Maximum APDU length of devices which only support standard frames
+ */
+#define KNX_MEMORY_STANDARD_APDU (KNX_LDATA_STANDARD_TPDU_SIZE - 1)
+
+/**
+ * Maximum APDU length of devices which support extended frames
+ */
+#define KNX_MEMORY_EXTENDED_APDU (KNX_LDATA_EXTENDED_TPDU_SIZE - 1)
+
+/**
+ * Report the end of a job.
+ *
+ * \param job         Job
+ * \param success     `true` if the whole range has been transferred
+ * \param transferred Number of bytes that have been transferred
+ * \param user        User pointer given when the job was started
+ * \param data        User data given to `knx_memory_init`
+ */
+typedef void (* knx_memory_done)(
+	uint32_t job,
+	bool     success,
+	size_t   transferred,
+	void*    user,
+	void*    data
+);
+
+/**
+ * Memory Operation
+ */
+typedef enum {
+	KNX_MEMORY_READ  = 0,
+	KNX_MEMORY_WRITE = 1
+} knx_memory_operation;
+
+/**
+ * Memory Job
+ */
+typedef struct {
+	/**
+	 * Operation
+	 */
+	knx_memory_operation operation;
+
+	/**
+	 * Caller buffer: destination of reads, source of writes
+	 */
+	union {
+		uint8_t* read;
+		const uint8_t* write;
+	} buffer;
+
+	/**
+	 * Device memory address of the first byte
+	 */
+	uint16_t address;
+
+	/**
+	 * Number of bytes to transfer
+	 */
+	size_t length;
+
+	/**
+	 * Number of bytes transferred so far
+	 */
+	size_t offset;
+
+	/**
+	 * Maximum number of bytes per request
+	 */
+	uint8_t chunk;
+
+	/**
+	 * Number of bytes in the pending request
+	 */
+	uint8_t requested;
+
+	/**
+	 * Has the pending read request been answered?
+	 */
+	bool answered;
+
+	/**
+	 * User pointer
+	 */
+	void* user;
+
+	/**
+	 * Pending request APDU
+	 */
+	uint8_t request[3 + KNX_MEMORY_MAX_CHUNK];
+} knx_memory_job;
+
+/**
+ * Memory Access Engine
+ *
+ * Reads and writes device memory in chunks as large as the device permits. Each job uses its
+ * own transport connection and issues the next request as soon as the previous one completed,
+ * so jobs for different devices proceed in parallel.
+ */
+typedef struct {
+	/**
+	 * Transport layer carrying the requests
+	 */
+	knx_transport transport;
+
+	/**
+	 * Jobs, indexed like the connections of `transport`
+	 */
+	knx_memory_job* jobs;
+
+	/**
+	 * Send function
+	 */
+	knx_transport_send send;
+
+	/**
+	 * Completion handler
+	 */
+	knx_memory_done done;
+
+	/**
+	 * User data passed to `send` and `done`
+	 */
+	void* data;
+
+	/**
+	 * Time given to the most recent call
+	 */
+	uint64_t now;
+} knx_memory;
+
+/**
+ * Initialize the engine.
+ *
+ * \param memory   Output engine
+ * \param capacity Maximum number of concurrent jobs
+ * \param send     Send function, receives the user pointer of the job
+ * \param done     Completion handler, may start new jobs
+ * \param data     User data passed to `send` and `done`
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_memory_init(
+	knx_memory*        memory,
+	size_t             capacity,
+	knx_transport_send send,
+	knx_memory_done    done,
+	void*              data
+);
+
+/**
+ * Initialize the engine using the given allocator for its connection and job tables.
+ *
+ * \see knx_memory_init
+ * \param allocator Allocator (may be `NULL`), must outlive the engine
+ */
+bool knx_memory_init_with(
+	knx_memory*          memory,
+	size_t               capacity,
+	knx_transport_send   send,
+	knx_memory_done      done,
+	void*                data,
+	const knx_allocator* allocator
+);
+
+/**
+ * Free the engine. Running jobs are dropped without notifying the devices.
+ */
+void knx_memory_destroy(knx_memory* memory);
+
+/**
+ * Read a range of device memory.
+ *
+ * \param memory      Engine
+ * \param local       Local individual address (0 lets the tunnel fill it in)
+ * \param device      Individual address of the device
+ * \param address     Device memory address of the first byte
+ * \param buffer      Output buffer, must stay valid until the job is done
+ * \param length      Number of bytes to read
+ * \param apdu_length Maximum APDU length of the device, see `KNX_MEMORY_STANDARD_APDU` and
+ *                    `KNX_MEMORY_EXTENDED_APDU`
+ * \param user        User pointer handed to `send` and `done`
+ * \param now         Current time in nanoseconds (monotonic)
+ * \returns Job or `KNX_TRANSPORT_NONE` on failure, e.g. if a job for `device` is running
+ */
+uint32_t knx_memory_read(
+	knx_memory* memory,
+	knx_addr    local,
+	knx_addr    device,
+	uint16_t    address,
+	uint8_t*    buffer,
+	size_t      length,
+	size_t      apdu_length,
+	void*       user,
+	uint64_t    now
+);
+
+/**
+ * Write a range of device memory.
+ *
+ * \see knx_memory_read
+ * \param buffer Input data, must stay valid until the job is done
+ */
+uint32_t knx_memory_write(
+	knx_memory*    memory,
+	knx_addr       local,
+	knx_addr       device,
+	uint16_t       address,
+	const uint8_t* buffer,
+	size_t         length,
+	size_t         apdu_length,
+	void*          user,
+	uint64_t       now
+);
+
+/**
+ * Process an incoming frame.
+ *
+ * \see knx_transport_receive
+ */
+bool knx_memory_receive(knx_memory* memory, const knx_ldata* ldata, uint64_t now);
+
+/**
+ * Drive timeouts.
+ *
+ * \see knx_transport_poll
+ */
+uint64_t knx_memory_poll(knx_memory* memory, uint64_t now);
+
+#endif
@@ -0,0 +1,208 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "shaper.h"
+
+// Rank of each priority, from highest to lowest: system, urgent, normal, low
+static
+const uint8_t knx_shaper_ranks[4] = {
+	[KNX_LDATA_PRIO_SYSTEM] = 0,
+	[KNX_LDATA_PRIO_URGENT] = 1,
+	[KNX_LDATA_PRIO_NORMAL] = 2,
+	[KNX_LDATA_PRIO_LOW]    = 3
+};
+
+bool knx_shaper_init(
+	knx_shaper*     shaper,
+	size_t          capacity,
+	double          rate,
+	double          burst,
+	knx_shaper_send send,
+	void*           data
+) {
+	return knx_shaper_init_with(shaper, capacity, rate, burst, send, data, NULL);
+}
+
+bool knx_shaper_init_with(
+	knx_shaper*          shaper,
+	size_t               capacity,
+	double               rate,
+	double               burst,
+	knx_shaper_send      send,
+	void*                data,
+	const knx_allocator* allocator
+) {
+	if (capacity == 0 || capacity >= KNX_SHAPER_NONE || rate <= 0 || burst < 1)
+		return false;
+
+	shaper->entries = knx_allocator_alloc(allocator, sizeof(knx_shaper_entry) * capacity);
+	if (!shaper->entries)
+		return false;
+
+	shaper->allocator = allocator;
+
+	shaper->send = send;
+	shaper->data = data;
+	shaper->rate = rate;
+	shaper->burst = burst;
+	shaper->capacity = capacity;
+	shaper->queued = 0;
+
+	// Chain all entries into the free list
+	for (size_t i = 0; i < capacity; i++)
+		shaper->entries[i].next = i + 1 < capacity ? i + 1 : KNX_SHAPER_NONE;
+
+	shaper->free = 0;
+
+	for (size_t i = 0; i < 4; i++) {
+		shaper->active[i].head = shaper->active[i].tail = KNX_SHAPER_NONE;
+
+		for (size_t j = 0; j < KNX_SHAPER_BUCKETS; j++) {
+			knx_shaper_queue* queue = &shaper->queues[i][j];
+			queue->head = queue->tail = queue->next = KNX_SHAPER_NONE;
+		}
+	}
+
+	// Every bucket starts out full
+	for (size_t i = 0; i < KNX_SHAPER_BUCKETS; i++) {
+		shaper->buckets[i].tokens = burst;
+		shaper->buckets[i].updated = 0;
+	}
+
+	return true;
+}
+
+void knx_shaper_destroy(knx_shaper* shaper) {
+	knx_allocator_free(shaper->allocator, shaper->entries);
+	shaper->entries = NULL;
+	shaper->capacity = 0;
+	shaper->queued = 0;
+}
+
+bool knx_shaper_submit(knx_shaper* shaper, const knx_ldata* ldata, void* user) {
+	if (shaper->free == KNX_SHAPER_NONE)
+		return false;
+
+	uint32_t index = shaper->free;
+	knx_shaper_entry* entry = shaper->entries + index;
+
+	shaper->free = entry->next;
+
+	entry->ldata = ldata;
+	entry->user = user;
+	entry->next = KNX_SHAPER_NONE;
+
+	// Append to the queue of its priority and bucket
+	uint8_t rank = knx_shaper_ranks[ldata->control1.priority & 3];
+	uint32_t bucket = knx_shaper_bucket_of(ldata);
+	knx_shaper_queue* queue = &shaper->queues[rank][bucket];
+
+	if (queue->tail == KNX_SHAPER_NONE) {
+		queue->head = index;
+
+		// The bucket has something to send now
+		if (shaper->active[rank].tail == KNX_SHAPER_NONE)
+			shaper->active[rank].head = bucket;
+		else
+			shaper->queues[rank][shaper->active[rank].tail].next = bucket;
+
+		shaper->active[rank].tail = bucket;
+	} else {
+		shaper->entries[queue->tail].next = index;
+	}
+
+	queue->tail = index;
+	shaper->queued++;
+
+	return true;
+}
+
+inline static
+void knx_shaper_refill(const knx_shaper* shaper, knx_shaper_bucket* bucket, uint64_t now) {
+	if (now <= bucket->updated)
+		return;
+
+	bucket->tokens += (now - bucket->updated) * shaper->rate / 1e9;
+	bucket->updated = now;
+
+	if (bucket->tokens > shaper->burst)
+		bucket->tokens = shaper->burst;
+}
+
+uint64_t knx_shaper_poll(knx_shaper* shaper, uint64_t now) {
+	uint64_t deadline = UINT64_MAX;
+
+	for (size_t rank = 0; rank < 4; rank++) {
+		uint32_t previous = KNX_SHAPER_NONE;
+		uint32_t index = shaper->active[rank].head;
+
+		while (index != KNX_SHAPER_NONE) {
+			knx_shaper_queue* queue = &shaper->queues[rank][index];
+			knx_shaper_bucket* bucket = shaper->buckets + index;
+			uint32_t next = queue->next;
+
+			knx_shaper_refill(shaper, bucket, now);
+
+			// Release from the front of the queue while tokens last
+			while (queue->head != KNX_SHAPER_NONE && bucket->tokens >= 1) {
+				uint32_t head = queue->head;
+				knx_shaper_entry* entry = shaper->entries + head;
+
+				bucket->tokens -= 1;
+
+				queue->head = entry->next;
+				if (queue->head == KNX_SHAPER_NONE)
+					queue->tail = KNX_SHAPER_NONE;
+
+				entry->next = shaper->free;
+				shaper->free = head;
+				shaper->queued--;
+
+				shaper->send(entry->ldata, entry->user, shaper->data);
+			}
+
+			if (queue->head != KNX_SHAPER_NONE) {
+				// Blocked, the rest of this queue has to wait for the same bucket
+				uint64_t wait = (1 - bucket->tokens) * 1e9 / shaper->rate + 1;
+
+				if (now + wait < deadline)
+					deadline = now + wait;
+
+				previous = index;
+			} else {
+				// Drained, remove the bucket from the active list
+				if (previous == KNX_SHAPER_NONE)
+					shaper->active[rank].head = next;
+				else
+					shaper->queues[rank][previous].next = next;
+
+				if (shaper->active[rank].tail == index)
+					shaper->active[rank].tail = previous;
+
+				queue->next = KNX_SHAPER_NONE;
+			}
+
+			index = next;
+		}
+	}
+
+	return deadline;
+}
@@ -0,0 +1,255 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_BUS_SHAPER_H_
+#define KNXPROTO_BUS_SHAPER_H_
+
+#include "../proto/ldata.h"
+#include "../util/allocator.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Number of token buckets: one per line and one for group telegrams
+ */
+#define KNX_SHAPER_BUCKETS 257
+
+/**
+ * Bucket shared by all group telegrams, since they have to pass the backbone
+ */
+#define KNX_SHAPER_BACKBONE 256
+
+/**
+ * Telegrams per second a TP1 line or KNX/IP router can absorb safely
+ */
+#define KNX_SHAPER_DEFAULT_RATE 50
+
+/**
+ * Marks the end of a queue
+ */
+#define KNX_SHAPER_NONE UINT32_MAX
+
+/**
+ * Send a telegram which has been released by the shaper.
+ *
+ * \note This must not call `knx_shaper_submit` or `knx_shaper_poll`.
+ * \param ldata Telegram that has been submitted
+ * \param user  User pointer that has been submitted alongside the telegram
+ * \param data  User data given to `knx_shaper_init`
+ */
+typedef void (* knx_shaper_send)(const knx_ldata* ldata, void* user, void* data);
+
+/**
+ * Token Bucket
+ */
+typedef struct {
+	/**
+	 * Available tokens
+	 */
+	double tokens;
+
+	/**
+	 * Time of the last refill in nanoseconds
+	 */
+	uint64_t updated;
+} knx_shaper_bucket;
+
+/**
+ * Queued Telegram
+ */
+typedef struct {
+	/**
+	 * Telegram, must stay valid until it has been sent
+	 */
+	const knx_ldata* ldata;
+
+	/**
+	 * User pointer
+	 */
+	void* user;
+
+	/**
+	 * Next entry in the same queue
+	 */
+	uint32_t next;
+} knx_shaper_entry;
+
+/**
+ * Queued telegrams of one priority drawing from the same token bucket
+ */
+typedef struct {
+	/**
+	 * First and last entry
+	 */
+	uint32_t head, tail;
+
+	/**
+	 * Next bucket with telegrams of the same priority
+	 */
+	uint32_t next;
+} knx_shaper_queue;
+
+/**
+ * Traffic Shaper
+ *
+ * Queues outgoing telegrams by priority and releases them as fast as the token bucket of their
+ * destination line permits. Each line has its own queue per priority, so a poll only visits the
+ * first telegram of a blocked line. The entries are allocated once during initialization.
+ */
+typedef struct {
+	/**
+	 * Send function
+	 */
+	knx_shaper_send send;
+
+	/**
+	 * User data passed to `send`
+	 */
+	void* data;
+
+	/**
+	 * Tokens per second
+	 */
+	double rate;
+
+	/**
+	 * Maximum number of tokens per bucket
+	 */
+	double burst;
+
+	/**
+	 * Queue entries
+	 */
+	knx_shaper_entry* entries;
+
+	/**
+	 * Number of elements in `entries`
+	 */
+	size_t capacity;
+
+	/**
+	 * Allocator `entries` has been obtained from
+	 */
+	const knx_allocator* allocator;
+
+	/**
+	 * Number of queued telegrams
+	 */
+	size_t queued;
+
+	/**
+	 * Unused entries
+	 */
+	uint32_t free;
+
+	/**
+	 * Queue of each bucket, ordered from highest to lowest priority
+	 */
+	knx_shaper_queue queues[4][KNX_SHAPER_BUCKETS];
+
+	/**
+	 * Buckets with queued telegrams, in the order their queues became non-empty
+	 */
+	struct {
+		uint32_t head, tail;
+	} active[4];
+
+	/**
+	 * Token buckets
+	 */
+	knx_shaper_bucket buckets[KNX_SHAPER_BUCKETS];
+} knx_shaper;
+
+/**
+ * Token bucket a telegram draws from.
+ */
+inline static
+uint32_t knx_shaper_bucket_of(const knx_ldata* ldata) {
+	if (ldata->control2.address_type == KNX_LDATA_ADDR_GROUP)
+		return KNX_SHAPER_BACKBONE;
+	else
+		return ldata->destination >> 8;
+}
+
+/**
+ * Initialize the shaper.
+ *
+ * \param shaper   Output shaper
+ * \param capacity Maximum number of queued telegrams
+ * \param rate     Telegrams per second per bucket
+ * \param burst    Number of telegrams a bucket may release at once
+ * \param send     Send function
+ * \param data     User data passed to `send`
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_shaper_init(
+	knx_shaper*     shaper,
+	size_t          capacity,
+	double          rate,
+	double          burst,
+	knx_shaper_send send,
+	void*           data
+);
+
+/**
+ * Initialize the shaper using the given allocator for its queue.
+ *
+ * \see knx_shaper_init
+ * \param allocator Allocator (may be `NULL`), must outlive the shaper
+ */
+bool knx_shaper_init_with(
+	knx_shaper*          shaper,
+	size_t               capacity,
+	double               rate,
+	double               burst,
+	knx_shaper_send      send,
+	void*                data,
+	const knx_allocator* allocator
+);
+
+/**
+ * Free the queue. Telegrams which are still queued are dropped.
+ */
+void knx_shaper_destroy(knx_shaper* shaper);
+
+/**
+ * Queue a telegram. It is sent during the next `knx_shaper_poll`.
+ *
+ * \param shaper Traffic shaper
+ * \param ldata  Telegram, must stay valid until it has been sent
+ * \param user   User pointer handed to the send function
+ * \returns `true` if the telegram has been queued, `false` if the queue is full
+ */
+bool knx_shaper_submit(knx_shaper* shaper, const knx_ldata* ldata, void* user);
+
+/**
+ * Send every queued telegram whose bucket has a token to spare, highest priority first.
+ *
+ * \param shaper Traffic shaper
+ * \param now    Current time in nanoseconds (monotonic)
+ * \returns Time at which the shaper should be polled again or `UINT64_MAX` if nothing is queued;
+ *          arm the event loop's timer with it
+ */
+uint64_t knx_shaper_poll(knx_shaper* shaper, uint64_t now);
+
+#endif
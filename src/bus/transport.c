@@ -0,0 +1,358 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "transport.h"
+
+// Hand a frame for the connection's remote device to the send function
+static
+void knx_transport_emit(
+	const knx_transport*            transport,
+	const knx_transport_connection* connection,
+	const knx_tpdu*                 tpdu
+) {
+	knx_ldata ldata = {
+		.control1 = {KNX_LDATA_PRIO_LOW, true, false, false, false},
+		.control2 = {KNX_LDATA_ADDR_INDIVIDUAL, 6},
+		.source = connection->local,
+		.destination = connection->remote,
+		.tpdu = *tpdu
+	};
+
+	transport->send(&ldata, connection->user, transport->data);
+}
+
+static
+void knx_transport_emit_control(
+	const knx_transport*            transport,
+	const knx_transport_connection* connection,
+	knx_tpci                        tpci,
+	knx_tpci_control                control,
+	uint8_t                         seq_number
+) {
+	knx_tpdu tpdu = {
+		.tpci = tpci,
+		.seq_number = seq_number,
+		.info = {.control = control}
+	};
+
+	knx_transport_emit(transport, connection, &tpdu);
+}
+
+// Close the connection, then report the event, so the handler may reuse the slot
+static
+void knx_transport_close(knx_transport* transport, uint32_t index, knx_transport_event event) {
+	knx_transport_connection* connection = transport->connections + index;
+	void* user = connection->user;
+
+	connection->state = KNX_TRANSPORT_CLOSED;
+	transport->active--;
+
+	transport->handler(index, event, NULL, user, transport->data);
+}
+
+// Give up on the connection and let the remote device know
+static
+void knx_transport_fail(knx_transport* transport, uint32_t index) {
+	knx_transport_emit_control(transport, transport->connections + index,
+	                           KNX_TPCI_UNNUMBERED_CONTROL, KNX_TPCI_CONTROL_DISCONNECTED, 0);
+	knx_transport_close(transport, index, KNX_TRANSPORT_FAILED);
+}
+
+// Repeat the pending data frame or fail once all repetitions are used up
+static
+void knx_transport_repeat(knx_transport* transport, uint32_t index, uint64_t now) {
+	knx_transport_connection* connection = transport->connections + index;
+
+	if (connection->repetitions >= KNX_TRANSPORT_MAX_REPETITIONS) {
+		knx_transport_fail(transport, index);
+		return;
+	}
+
+	connection->repetitions++;
+	connection->ack_deadline = now + KNX_TRANSPORT_ACK_TIMEOUT;
+	connection->idle_deadline = now + KNX_TRANSPORT_CONNECTION_TIMEOUT;
+
+	knx_transport_emit(transport, connection, &connection->pending);
+}
+
+bool knx_transport_init(
+	knx_transport*        transport,
+	size_t                capacity,
+	knx_transport_send    send,
+	knx_transport_handler handler,
+	void*                 data
+) {
+	return knx_transport_init_with(transport, capacity, send, handler, data, NULL);
+}
+
+bool knx_transport_init_with(
+	knx_transport*        transport,
+	size_t                capacity,
+	knx_transport_send    send,
+	knx_transport_handler handler,
+	void*                 data,
+	const knx_allocator*  allocator
+) {
+	if (capacity == 0 || capacity >= KNX_TRANSPORT_NONE)
+		return false;
+
+	transport->connections =
+		knx_allocator_alloc(allocator, sizeof(knx_transport_connection) * capacity);
+
+	if (!transport->connections)
+		return false;
+
+	transport->allocator = allocator;
+
+	for (size_t i = 0; i < capacity; i++)
+		transport->connections[i].state = KNX_TRANSPORT_CLOSED;
+
+	transport->send = send;
+	transport->handler = handler;
+	transport->data = data;
+	transport->capacity = capacity;
+	transport->active = 0;
+
+	return true;
+}
+
+void knx_transport_destroy(knx_transport* transport) {
+	knx_allocator_free(transport->allocator, transport->connections);
+	transport->connections = NULL;
+	transport->capacity = 0;
+	transport->active = 0;
+}
+
+uint32_t knx_transport_connect(
+	knx_transport* transport,
+	knx_addr       local,
+	knx_addr       remote,
+	void*          user,
+	uint64_t       now
+) {
+	uint32_t slot = KNX_TRANSPORT_NONE;
+
+	for (size_t i = 0; i < transport->capacity; i++) {
+		const knx_transport_connection* connection = transport->connections + i;
+
+		if (connection->state == KNX_TRANSPORT_CLOSED) {
+			if (slot == KNX_TRANSPORT_NONE)
+				slot = i;
+		} else if (connection->remote == remote && connection->local == local) {
+			return KNX_TRANSPORT_NONE;
+		}
+	}
+
+	if (slot == KNX_TRANSPORT_NONE)
+		return KNX_TRANSPORT_NONE;
+
+	knx_transport_connection* connection = transport->connections + slot;
+
+	connection->state = KNX_TRANSPORT_OPEN_IDLE;
+	connection->local = local;
+	connection->remote = remote;
+	connection->user = user;
+	connection->seq_send = 0;
+	connection->seq_recv = 0;
+	connection->repetitions = 0;
+	connection->idle_deadline = now + KNX_TRANSPORT_CONNECTION_TIMEOUT;
+
+	transport->active++;
+
+	knx_transport_emit_control(transport, connection, KNX_TPCI_UNNUMBERED_CONTROL,
+	                           KNX_TPCI_CONTROL_CONNECTED, 0);
+
+	return slot;
+}
+
+void knx_transport_disconnect(knx_transport* transport, uint32_t index) {
+	if (knx_transport_state_of(transport, index) == KNX_TRANSPORT_CLOSED)
+		return;
+
+	knx_transport_connection* connection = transport->connections + index;
+
+	knx_transport_emit_control(transport, connection, KNX_TPCI_UNNUMBERED_CONTROL,
+	                           KNX_TPCI_CONTROL_DISCONNECTED, 0);
+
+	connection->state = KNX_TRANSPORT_CLOSED;
+	transport->active--;
+}
+
+bool knx_transport_send_data(
+	knx_transport* transport,
+	uint32_t       index,
+	knx_apci       apci,
+	const uint8_t* payload,
+	size_t         length,
+	uint64_t       now
+) {
+	// The first payload byte carries part of the APCI
+	if (knx_transport_state_of(transport, index) != KNX_TRANSPORT_OPEN_IDLE ||
+	    length == 0 || length >= KNX_LDATA_EXTENDED_TPDU_SIZE)
+		return false;
+
+	knx_transport_connection* connection = transport->connections + index;
+
+	connection->pending.tpci = KNX_TPCI_NUMBERED_DATA;
+	connection->pending.seq_number = connection->seq_send;
+	connection->pending.info.data.apci = apci;
+	connection->pending.info.data.payload = payload;
+	connection->pending.info.data.length = length;
+
+	connection->state = KNX_TRANSPORT_OPEN_WAIT;
+	connection->repetitions = 0;
+	connection->ack_deadline = now + KNX_TRANSPORT_ACK_TIMEOUT;
+	connection->idle_deadline = now + KNX_TRANSPORT_CONNECTION_TIMEOUT;
+
+	knx_transport_emit(transport, connection, &connection->pending);
+
+	return true;
+}
+
+// Acknowledge the data frame and deliver it unless it is a repetition
+static
+void knx_transport_receive_data(knx_transport* transport, uint32_t index, const knx_tpdu* tpdu) {
+	knx_transport_connection* connection = transport->connections + index;
+	uint8_t seq_number = tpdu->seq_number & 15;
+
+	if (seq_number == connection->seq_recv) {
+		knx_transport_emit_control(transport, connection, KNX_TPCI_NUMBERED_CONTROL,
+		                           KNX_TPCI_CONTROL_ACK, seq_number);
+
+		connection->seq_recv = (connection->seq_recv + 1) & 15;
+		transport->handler(index, KNX_TRANSPORT_DATA, tpdu, connection->user, transport->data);
+	} else if (seq_number == ((connection->seq_recv - 1) & 15)) {
+		// Our acknowledgement got lost
+		knx_transport_emit_control(transport, connection, KNX_TPCI_NUMBERED_CONTROL,
+		                           KNX_TPCI_CONTROL_ACK, seq_number);
+	} else {
+		knx_transport_emit_control(transport, connection, KNX_TPCI_NUMBERED_CONTROL,
+		                           KNX_TPCI_CONTROL_ERROR, seq_number);
+	}
+}
+
+// Complete or repeat the pending data frame
+static
+void knx_transport_receive_control(
+	knx_transport*  transport,
+	uint32_t        index,
+	const knx_tpdu* tpdu,
+	uint64_t        now
+) {
+	knx_transport_connection* connection = transport->connections + index;
+
+	// Stray acknowledgements are ignored
+	if (connection->state != KNX_TRANSPORT_OPEN_WAIT ||
+	    (tpdu->seq_number & 15) != connection->seq_send)
+		return;
+
+	switch (tpdu->info.control) {
+		case KNX_TPCI_CONTROL_ACK:
+			connection->seq_send = (connection->seq_send + 1) & 15;
+			connection->state = KNX_TRANSPORT_OPEN_IDLE;
+
+			transport->handler(index, KNX_TRANSPORT_CONFIRMED, NULL, connection->user,
+			                   transport->data);
+			break;
+
+		case KNX_TPCI_CONTROL_ERROR:
+			knx_transport_repeat(transport, index, now);
+			break;
+
+		default:
+			break;
+	}
+}
+
+bool knx_transport_receive(knx_transport* transport, const knx_ldata* ldata, uint64_t now) {
+	if (ldata->control2.address_type != KNX_LDATA_ADDR_INDIVIDUAL ||
+	    ldata->tpdu.tpci == KNX_TPCI_UNNUMBERED_DATA)
+		return false;
+
+	// Find the connection to the sender, a local address of 0 matches any destination
+	uint32_t index = KNX_TRANSPORT_NONE;
+
+	for (size_t i = 0; i < transport->capacity; i++) {
+		const knx_transport_connection* connection = transport->connections + i;
+
+		if (connection->state != KNX_TRANSPORT_CLOSED && connection->remote == ldata->source &&
+		    (connection->local == 0 || connection->local == ldata->destination)) {
+			index = i;
+			break;
+		}
+	}
+
+	if (index == KNX_TRANSPORT_NONE)
+		return false;
+
+	transport->connections[index].idle_deadline = now + KNX_TRANSPORT_CONNECTION_TIMEOUT;
+
+	switch (ldata->tpdu.tpci) {
+		case KNX_TPCI_UNNUMBERED_CONTROL:
+			// A new T_Connect from the remote device supersedes this connection
+			if (ldata->tpdu.info.control == KNX_TPCI_CONTROL_CONNECTED)
+				knx_transport_emit_control(transport, transport->connections + index,
+				                           KNX_TPCI_UNNUMBERED_CONTROL,
+				                           KNX_TPCI_CONTROL_DISCONNECTED, 0);
+
+			knx_transport_close(transport, index, KNX_TRANSPORT_DISCONNECTED);
+			break;
+
+		case KNX_TPCI_NUMBERED_CONTROL:
+			knx_transport_receive_control(transport, index, &ldata->tpdu, now);
+			break;
+
+		case KNX_TPCI_NUMBERED_DATA:
+			knx_transport_receive_data(transport, index, &ldata->tpdu);
+			break;
+
+		default:
+			break;
+	}
+
+	return true;
+}
+
+uint64_t knx_transport_poll(knx_transport* transport, uint64_t now) {
+	uint64_t deadline = UINT64_MAX;
+
+	for (size_t i = 0; i < transport->capacity; i++) {
+		knx_transport_connection* connection = transport->connections + i;
+
+		if (connection->state == KNX_TRANSPORT_OPEN_WAIT && now >= connection->ack_deadline)
+			knx_transport_repeat(transport, i, now);
+
+		if (connection->state != KNX_TRANSPORT_CLOSED && now >= connection->idle_deadline)
+			knx_transport_fail(transport, i);
+
+		// The handler may have reopened the slot
+		if (connection->state == KNX_TRANSPORT_CLOSED)
+			continue;
+
+		if (connection->idle_deadline < deadline)
+			deadline = connection->idle_deadline;
+
+		if (connection->state == KNX_TRANSPORT_OPEN_WAIT && connection->ack_deadline < deadline)
+			deadline = connection->ack_deadline;
+	}
+
+	return deadline;
+}
@@ -0,0 +1,324 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_BUS_TRANSPORT_H_
+#define KNXPROTO_BUS_TRANSPORT_H_
+
+#include "../proto/ldata.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Time to wait for the acknowledgement of a data frame in nanoseconds
+ */
+#define KNX_TRANSPORT_ACK_TIMEOUT 3000000000ull
+
+/**
+ * Time after which an idle connection is closed in nanoseconds
+ */
+#define KNX_TRANSPORT_CONNECTION_TIMEOUT 6000000000ull
+
+/**
+ * Number of times an unacknowledged data frame is repeated
+ */
+#define KNX_TRANSPORT_MAX_REPETITIONS 3
+
+/**
+ * Marks an invalid connection
+ */
+#define KNX_TRANSPORT_NONE UINT32_MAX
+
+/**
+ * Connection State
+ */
+typedef enum {
+	KNX_TRANSPORT_CLOSED    = 0,
+	KNX_TRANSPORT_OPEN_IDLE = 1,
+	KNX_TRANSPORT_OPEN_WAIT = 2
+} knx_transport_state;
+
+/**
+ * Event reported to the handler
+ */
+typedef enum {
+	/**
+	 * A data frame has been received, `tpdu` holds it
+	 */
+	KNX_TRANSPORT_DATA         = 0,
+
+	/**
+	 * The data frame given to `knx_transport_send_data` has been acknowledged
+	 */
+	KNX_TRANSPORT_CONFIRMED    = 1,
+
+	/**
+	 * The remote device closed the connection
+	 */
+	KNX_TRANSPORT_DISCONNECTED = 2,
+
+	/**
+	 * The connection timed out or a data frame was not acknowledged after all repetitions
+	 */
+	KNX_TRANSPORT_FAILED       = 3
+} knx_transport_event;
+
+/**
+ * Send a frame generated by the transport layer.
+ *
+ * \note This must not call any other `knx_transport_*` function.
+ * \param ldata Frame, only valid during the call
+ * \param user  User pointer of the connection
+ * \param data  User data given to `knx_transport_init`
+ */
+typedef void (* knx_transport_send)(const knx_ldata* ldata, void* user, void* data);
+
+/**
+ * Handle a transport layer event. The handler may open, use and close connections.
+ *
+ * \param connection Connection
+ * \param event      Event
+ * \param tpdu       Received frame (only `KNX_TRANSPORT_DATA`), only valid during the call
+ * \param user       User pointer of the connection
+ * \param data       User data given to `knx_transport_init`
+ */
+typedef void (* knx_transport_handler)(
+	uint32_t            connection,
+	knx_transport_event event,
+	const knx_tpdu*     tpdu,
+	void*               user,
+	void*               data
+);
+
+/**
+ * Point-to-point Connection
+ */
+typedef struct {
+	/**
+	 * Connection state
+	 */
+	knx_transport_state state;
+
+	/**
+	 * Local individual address (0 lets the tunnel fill it in)
+	 */
+	knx_addr local;
+
+	/**
+	 * Remote individual address
+	 */
+	knx_addr remote;
+
+	/**
+	 * User pointer
+	 */
+	void* user;
+
+	/**
+	 * Sequence number of the next data frame to send
+	 */
+	uint8_t seq_send;
+
+	/**
+	 * Sequence number of the next data frame expected from the remote device
+	 */
+	uint8_t seq_recv;
+
+	/**
+	 * Number of times the pending data frame has been repeated
+	 */
+	uint8_t repetitions;
+
+	/**
+	 * Time at which the pending data frame is repeated
+	 */
+	uint64_t ack_deadline;
+
+	/**
+	 * Time at which the connection times out
+	 */
+	uint64_t idle_deadline;
+
+	/**
+	 * Data frame awaiting acknowledgement (only `KNX_TRANSPORT_OPEN_WAIT`)
+	 */
+	knx_tpdu pending;
+} knx_transport_connection;
+
+/**
+ * Transport Layer
+ *
+ * Manages connection-oriented communication with many devices at once. Each connection sends
+ * one data frame at a time and waits for its acknowledgement, but connections do not block each
+ * other. The connection table is allocated once during initialization.
+ */
+typedef struct {
+	/**
+	 * Send function
+	 */
+	knx_transport_send send;
+
+	/**
+	 * Event handler
+	 */
+	knx_transport_handler handler;
+
+	/**
+	 * User data passed to `send` and `handler`
+	 */
+	void* data;
+
+	/**
+	 * Connection table
+	 */
+	knx_transport_connection* connections;
+
+	/**
+	 * Number of elements in `connections`
+	 */
+	size_t capacity;
+
+	/**
+	 * Allocator `connections` has been obtained from
+	 */
+	const knx_allocator* allocator;
+
+	/**
+	 * Number of open connections
+	 */
+	size_t active;
+} knx_transport;
+
+/**
+ * Initialize the transport layer.
+ *
+ * \param transport Output transport layer
+ * \param capacity  Maximum number of concurrent connections
+ * \param send      Send function
+ * \param handler   Event handler
+ * \param data      User data passed to `send` and `handler`
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_transport_init(
+	knx_transport*        transport,
+	size_t                capacity,
+	knx_transport_send    send,
+	knx_transport_handler handler,
+	void*                 data
+);
+
+/**
+ * Initialize the transport layer using the given allocator for its connection table.
+ *
+ * \see knx_transport_init
+ * \param allocator Allocator (may be `NULL`), must outlive the transport layer
+ */
+bool knx_transport_init_with(
+	knx_transport*        transport,
+	size_t                capacity,
+	knx_transport_send    send,
+	knx_transport_handler handler,
+	void*                 data,
+	const knx_allocator*  allocator
+);
+
+/**
+ * Free the connection table. Open connections are dropped without notifying the remote devices.
+ */
+void knx_transport_destroy(knx_transport* transport);
+
+/**
+ * State of a connection.
+ */
+inline static
+knx_transport_state knx_transport_state_of(const knx_transport* transport, uint32_t connection) {
+	if (connection >= transport->capacity)
+		return KNX_TRANSPORT_CLOSED;
+
+	return transport->connections[connection].state;
+}
+
+/**
+ * Open a connection by sending T_Connect. The connection is usable right away.
+ *
+ * \param transport Transport layer
+ * \param local     Local individual address (0 lets the tunnel fill it in)
+ * \param remote    Remote individual address
+ * \param user      User pointer handed to `send` and `handler`
+ * \param now       Current time in nanoseconds (monotonic)
+ * \returns Connection or `KNX_TRANSPORT_NONE` if the table is full or `remote` is connected
+ */
+uint32_t knx_transport_connect(
+	knx_transport* transport,
+	knx_addr       local,
+	knx_addr       remote,
+	void*          user,
+	uint64_t       now
+);
+
+/**
+ * Close a connection by sending T_Disconnect. The handler is not invoked.
+ */
+void knx_transport_disconnect(knx_transport* transport, uint32_t connection);
+
+/**
+ * Send a data frame (T_Data_Connected). `KNX_TRANSPORT_CONFIRMED` is reported once the remote
+ * device acknowledged it.
+ *
+ * \param transport  Transport layer
+ * \param connection Connection, must be in state `KNX_TRANSPORT_OPEN_IDLE`
+ * \param apci       Application protocol control information
+ * \param payload    APDU, must stay valid until the frame is confirmed or the connection closed
+ * \param length     Number of bytes in `payload`
+ * \param now        Current time in nanoseconds (monotonic)
+ * \returns `true` if the frame has been sent, otherwise `false`
+ */
+bool knx_transport_send_data(
+	knx_transport* transport,
+	uint32_t       connection,
+	knx_apci       apci,
+	const uint8_t* payload,
+	size_t         length,
+	uint64_t       now
+);
+
+/**
+ * Process an incoming frame.
+ *
+ * \param transport Transport layer
+ * \param ldata     Received frame
+ * \param now       Current time in nanoseconds (monotonic)
+ * \returns `true` if the frame belongs to an open connection, otherwise `false`
+ */
+bool knx_transport_receive(knx_transport* transport, const knx_ldata* ldata, uint64_t now);
+
+/**
+ * Repeat unacknowledged data frames and close connections which timed out.
+ *
+ * \param transport Transport layer
+ * \param now       Current time in nanoseconds (monotonic)
+ * \returns Time at which the transport layer should be polled again or `UINT64_MAX` if no
+ *          connection is open; arm the event loop's timer with it
+ */
+uint64_t knx_transport_poll(knx_transport* transport, uint64_t now);
+
+#endif
@@ -0,0 +1,577 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "capture.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// pcapng block types
+#define KNX_CAPTURE_SHB 0x0A0D0D0A
+#define KNX_CAPTURE_IDB 0x00000001
+#define KNX_CAPTURE_EPB 0x00000006
+
+// pcapng byte order magic
+#define KNX_CAPTURE_BYTE_ORDER 0x1A2B3C4D
+
+// Classic pcap magic numbers for microsecond and nanosecond resolution
+#define KNX_CAPTURE_PCAP_USEC 0xA1B2C3D4
+#define KNX_CAPTURE_PCAP_NSEC 0xA1B23C4D
+
+// Size of the classic pcap file header
+#define KNX_CAPTURE_PCAP_HEADER_SIZE 24
+
+// Link layer types
+#define KNX_CAPTURE_LINK_ETHERNET  1
+#define KNX_CAPTURE_LINK_RAW       101
+#define KNX_CAPTURE_LINK_LINUX_SLL 113
+#define KNX_CAPTURE_LINK_IPV4      228
+
+// Size of the IPv4 and UDP headers the writer puts in front of each frame
+#define KNX_CAPTURE_PSEUDO_SIZE 28
+
+// Enhanced packet block overhead excluding the packet data
+#define KNX_CAPTURE_EPB_SIZE 32
+
+// Writer
+
+inline static
+void knx_capture_put16(uint8_t* buffer, uint16_t value) {
+	memcpy(buffer, &value, 2);
+}
+
+inline static
+void knx_capture_put32(uint8_t* buffer, uint32_t value) {
+	memcpy(buffer, &value, 4);
+}
+
+bool knx_capture_writer_open(knx_capture_writer* writer, const char* path) {
+	writer->file = fopen(path, "wb");
+	if (!writer->file)
+		return false;
+
+	// Section header block with unspecified section length
+	uint8_t header[60] = {0};
+	knx_capture_put32(header, KNX_CAPTURE_SHB);
+	knx_capture_put32(header + 4, 28);
+	knx_capture_put32(header + 8, KNX_CAPTURE_BYTE_ORDER);
+	knx_capture_put16(header + 12, 1);
+	knx_capture_put16(header + 14, 0);
+	memset(header + 16, 0xFF, 8);
+	knx_capture_put32(header + 24, 28);
+
+	// Interface description block for raw IPv4 with nanosecond timestamps (if_tsresol = 9)
+	uint8_t* idb = header + 28;
+	knx_capture_put32(idb, KNX_CAPTURE_IDB);
+	knx_capture_put32(idb + 4, 32);
+	knx_capture_put16(idb + 8, KNX_CAPTURE_LINK_IPV4);
+	knx_capture_put16(idb + 10, 0);
+	knx_capture_put32(idb + 12, 0);
+	knx_capture_put16(idb + 16, 9);
+	knx_capture_put16(idb + 18, 1);
+	idb[20] = 9;
+	knx_capture_put32(idb + 24, 0);
+	knx_capture_put32(idb + 28, 32);
+
+	if (fwrite(header, sizeof(header), 1, writer->file) != 1) {
+		fclose(writer->file);
+		return false;
+	}
+
+	return true;
+}
+
+bool knx_capture_write(
+	knx_capture_writer*  writer,
+	uint64_t             timestamp,
+	const knx_host_info* source,
+	const knx_host_info* destination,
+	const uint8_t*       frame,
+	size_t               length
+) {
+	if (length > UINT16_MAX - KNX_CAPTURE_PSEUDO_SIZE)
+		return false;
+
+	size_t captured = KNX_CAPTURE_PSEUDO_SIZE + length;
+	size_t padding = (4 - captured % 4) % 4;
+	uint32_t block_length = KNX_CAPTURE_EPB_SIZE + captured + padding;
+
+	uint8_t header[28 + KNX_CAPTURE_PSEUDO_SIZE];
+
+	// Enhanced packet block
+	knx_capture_put32(header, KNX_CAPTURE_EPB);
+	knx_capture_put32(header + 4, block_length);
+	knx_capture_put32(header + 8, 0);
+	knx_capture_put32(header + 12, timestamp >> 32);
+	knx_capture_put32(header + 16, timestamp & 0xFFFFFFFF);
+	knx_capture_put32(header + 20, captured);
+	knx_capture_put32(header + 24, captured);
+
+	// IPv4 header
+	uint8_t* ip = header + 28;
+	ip[0] = 0x45;
+	ip[1] = 0;
+	ip[2] = captured >> 8 & 0xFF;
+	ip[3] = captured & 0xFF;
+	ip[4] = 0;
+	ip[5] = 0;
+	ip[6] = 0x40;
+	ip[7] = 0;
+	ip[8] = 64;
+	ip[9] = 17;
+	ip[10] = 0;
+	ip[11] = 0;
+	memcpy(ip + 12, &source->address, 4);
+	memcpy(ip + 16, &destination->address, 4);
+
+	uint32_t checksum = 0;
+	for (size_t i = 0; i < 20; i += 2)
+		checksum += ip[i] << 8 | ip[i + 1];
+
+	checksum = (checksum & 0xFFFF) + (checksum >> 16);
+	checksum = ~((checksum & 0xFFFF) + (checksum >> 16));
+
+	ip[10] = checksum >> 8 & 0xFF;
+	ip[11] = checksum & 0xFF;
+
+	// UDP header without checksum
+	uint8_t* udp = ip + 20;
+	memcpy(udp, &source->port, 2);
+	memcpy(udp + 2, &destination->port, 2);
+	udp[4] = (length + 8) >> 8 & 0xFF;
+	udp[5] = (length + 8) & 0xFF;
+	udp[6] = 0;
+	udp[7] = 0;
+
+	uint8_t trailer[8] = {0};
+	knx_capture_put32(trailer + padding, block_length);
+
+	return
+		fwrite(header, sizeof(header), 1, writer->file) == 1 &&
+		fwrite(frame, 1, length, writer->file) == length &&
+		fwrite(trailer, padding + 4, 1, writer->file) == 1;
+}
+
+bool knx_capture_writer_close(knx_capture_writer* writer) {
+	return fclose(writer->file) == 0;
+}
+
+// Reader
+
+inline static
+uint16_t knx_capture_get16(const knx_capture_reader* reader, const uint8_t* buffer) {
+	uint16_t value;
+	memcpy(&value, buffer, 2);
+
+	return reader->swapped ? __builtin_bswap16(value) : value;
+}
+
+inline static
+uint32_t knx_capture_get32(const knx_capture_reader* reader, const uint8_t* buffer) {
+	uint32_t value;
+	memcpy(&value, buffer, 4);
+
+	return reader->swapped ? __builtin_bswap32(value) : value;
+}
+
+// Convert a timestamp of the given pcapng resolution to nanoseconds. The resolution must have
+// passed knx_capture_resolution_valid.
+inline static
+uint64_t knx_capture_nanoseconds(uint64_t timestamp, uint8_t resolution) {
+	if (resolution & 128) {
+		unsigned shift = resolution & 127;
+
+		if (shift == 0)
+			return timestamp * 1000000000;
+
+		// Keep the intermediate product of the fraction within 64 bits
+		unsigned fraction_shift = shift > 30 ? 30 : shift;
+		uint64_t fraction = (timestamp & ((((uint64_t) 1) << shift) - 1)) >> (shift - fraction_shift);
+
+		return (timestamp >> shift) * 1000000000 + ((fraction * 1000000000) >> fraction_shift);
+	}
+
+	uint64_t scale = 1;
+
+	if (resolution <= 9) {
+		for (unsigned i = resolution; i < 9; i++)
+			scale *= 10;
+
+		return timestamp * scale;
+	} else {
+		for (unsigned i = 9; i < resolution; i++)
+			scale *= 10;
+
+		return timestamp / scale;
+	}
+}
+
+// Locate the UDP payload within a link layer packet.
+static
+bool knx_capture_decode(
+	uint16_t           link_type,
+	const uint8_t*     packet,
+	size_t             length,
+	knx_capture_frame* frame
+) {
+	switch (link_type) {
+		case KNX_CAPTURE_LINK_ETHERNET: {
+			if (length < 14)
+				return false;
+
+			size_t header_length = 14;
+			uint16_t ether_type = packet[12] << 8 | packet[13];
+
+			// Skip a VLAN tag
+			if (ether_type == 0x8100) {
+				if (length < 18)
+					return false;
+
+				header_length = 18;
+				ether_type = packet[16] << 8 | packet[17];
+			}
+
+			if (ether_type != 0x0800)
+				return false;
+
+			packet += header_length;
+			length -= header_length;
+			break;
+		}
+
+		case KNX_CAPTURE_LINK_LINUX_SLL:
+			if (length < 16 || (packet[14] << 8 | packet[15]) != 0x0800)
+				return false;
+
+			packet += 16;
+			length -= 16;
+			break;
+
+		case KNX_CAPTURE_LINK_RAW:
+		case KNX_CAPTURE_LINK_IPV4:
+			break;
+
+		default:
+			return false;
+	}
+
+	// IPv4
+	if (length < 20 || packet[0] >> 4 != 4)
+		return false;
+
+	size_t ip_header_length = (packet[0] & 15) * 4;
+	size_t ip_length = packet[2] << 8 | packet[3];
+
+	// Ignore anything but unfragmented UDP packets
+	if (ip_header_length < 20 || ip_length < ip_header_length + 8 || packet[9] != 17 ||
+	    (packet[6] & 0x3F) != 0 || packet[7] != 0)
+		return false;
+
+	if (ip_length < length)
+		length = ip_length;
+
+	if (length < ip_header_length + 8)
+		return false;
+
+	const uint8_t* udp = packet + ip_header_length;
+	size_t udp_length = udp[4] << 8 | udp[5];
+
+	if (udp_length < 8)
+		return false;
+
+	frame->source.protocol = KNX_PROTO_UDP;
+	memcpy(&frame->source.address, packet + 12, 4);
+	memcpy(&frame->source.port, udp, 2);
+
+	frame->destination.protocol = KNX_PROTO_UDP;
+	memcpy(&frame->destination.address, packet + 16, 4);
+	memcpy(&frame->destination.port, udp + 2, 2);
+
+	frame->data = udp + 8;
+	frame->length = length - ip_header_length - 8;
+
+	if (udp_length - 8 < frame->length)
+		frame->length = udp_length - 8;
+
+	return true;
+}
+
+void knx_capture_rewind(knx_capture_reader* reader) {
+	if (reader->ng) {
+		reader->offset = 0;
+		reader->num_interfaces = 0;
+	} else {
+		reader->offset = KNX_CAPTURE_PCAP_HEADER_SIZE;
+	}
+}
+
+bool knx_capture_reader_open(knx_capture_reader* reader, const char* path) {
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size < KNX_CAPTURE_PCAP_HEADER_SIZE) {
+		close(fd);
+		return false;
+	}
+
+	void* base = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (base == MAP_FAILED)
+		return false;
+
+	reader->base = base;
+	reader->size = info.st_size;
+	reader->swapped = false;
+
+	uint32_t magic;
+	memcpy(&magic, reader->base, 4);
+
+	if (magic == KNX_CAPTURE_SHB) {
+		reader->ng = true;
+	} else {
+		reader->ng = false;
+		reader->num_interfaces = 1;
+
+		switch (magic) {
+			case __builtin_bswap32(KNX_CAPTURE_PCAP_USEC):
+				reader->swapped = true;
+				// fallthrough
+
+			case KNX_CAPTURE_PCAP_USEC:
+				reader->interfaces[0].resolution = 6;
+				break;
+
+			case __builtin_bswap32(KNX_CAPTURE_PCAP_NSEC):
+				reader->swapped = true;
+				// fallthrough
+
+			case KNX_CAPTURE_PCAP_NSEC:
+				reader->interfaces[0].resolution = 9;
+				break;
+
+			default:
+				knx_capture_reader_close(reader);
+				return false;
+		}
+
+		reader->interfaces[0].link_type = knx_capture_get32(reader, reader->base + 20);
+	}
+
+	knx_capture_rewind(reader);
+	return true;
+}
+
+void knx_capture_reader_close(knx_capture_reader* reader) {
+	if (reader->base) {
+		munmap((void*) reader->base, reader->size);
+		reader->base = NULL;
+	}
+}
+
+static
+bool knx_capture_next_pcap(knx_capture_reader* reader, knx_capture_frame* frame) {
+	while (reader->offset + 16 <= reader->size) {
+		const uint8_t* record = reader->base + reader->offset;
+
+		uint32_t seconds = knx_capture_get32(reader, record);
+		uint32_t fraction = knx_capture_get32(reader, record + 4);
+		uint32_t captured = knx_capture_get32(reader, record + 8);
+
+		if (captured > reader->size - reader->offset - 16)
+			return false;
+
+		reader->offset += 16 + captured;
+
+		if (knx_capture_decode(reader->interfaces[0].link_type, record + 16, captured, frame)) {
+			frame->timestamp =
+				(uint64_t) seconds * 1000000000 +
+				knx_capture_nanoseconds(fraction, reader->interfaces[0].resolution);
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Larger resolutions would overflow the conversion factor.
+inline static
+bool knx_capture_resolution_valid(uint8_t resolution) {
+	return resolution & 128 ? (resolution & 127) < 64 : resolution <= 19;
+}
+
+static
+bool knx_capture_add_interface(knx_capture_reader* reader, const uint8_t* block, size_t length) {
+	if (reader->num_interfaces >= KNX_CAPTURE_MAX_INTERFACES || length < 20)
+		return true;
+
+	knx_capture_interface* interface = reader->interfaces + reader->num_interfaces++;
+
+	interface->link_type = knx_capture_get16(reader, block + 8);
+	interface->resolution = 6;
+
+	// Look for the timestamp resolution among the options
+	for (size_t offset = 16; offset + 4 <= length - 4;) {
+		uint16_t code = knx_capture_get16(reader, block + offset);
+		uint16_t option_length = knx_capture_get16(reader, block + offset + 2);
+
+		if (code == 0 || offset + 4 + option_length > length - 4)
+			break;
+
+		if (code == 9 && option_length >= 1) {
+			interface->resolution = block[offset + 4];
+
+			if (!knx_capture_resolution_valid(interface->resolution))
+				return false;
+		}
+
+		offset += 4 + ((option_length + 3) & ~3);
+	}
+
+	return true;
+}
+
+static
+bool knx_capture_next_pcapng(knx_capture_reader* reader, knx_capture_frame* frame) {
+	while (reader->offset + 12 <= reader->size) {
+		const uint8_t* block = reader->base + reader->offset;
+
+		uint32_t type;
+		memcpy(&type, block, 4);
+
+		// A new section might switch the byte order
+		if (type == KNX_CAPTURE_SHB) {
+			uint32_t byte_order;
+			memcpy(&byte_order, block + 8, 4);
+
+			if (byte_order == KNX_CAPTURE_BYTE_ORDER)
+				reader->swapped = false;
+			else if (byte_order == __builtin_bswap32(KNX_CAPTURE_BYTE_ORDER))
+				reader->swapped = true;
+			else
+				return false;
+
+			reader->num_interfaces = 0;
+		} else if (reader->swapped) {
+			type = __builtin_bswap32(type);
+		}
+
+		uint32_t length = knx_capture_get32(reader, block + 4);
+
+		if (length < 12 || length % 4 != 0 || length > reader->size - reader->offset)
+			return false;
+
+		reader->offset += length;
+
+		switch (type) {
+			case KNX_CAPTURE_IDB:
+				if (!knx_capture_add_interface(reader, block, length))
+					return false;
+
+				break;
+
+			case KNX_CAPTURE_EPB: {
+				if (length < KNX_CAPTURE_EPB_SIZE)
+					return false;
+
+				uint32_t interface = knx_capture_get32(reader, block + 8);
+				uint32_t captured = knx_capture_get32(reader, block + 20);
+
+				if (interface >= reader->num_interfaces || captured > length - KNX_CAPTURE_EPB_SIZE)
+					break;
+
+				const knx_capture_interface* info = reader->interfaces + interface;
+
+				if (knx_capture_decode(info->link_type, block + 28, captured, frame)) {
+					uint64_t timestamp =
+						(uint64_t) knx_capture_get32(reader, block + 12) << 32 |
+						knx_capture_get32(reader, block + 16);
+
+					frame->timestamp = knx_capture_nanoseconds(timestamp, info->resolution);
+					return true;
+				}
+
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+
+	return false;
+}
+
+bool knx_capture_next(knx_capture_reader* reader, knx_capture_frame* frame) {
+	if (reader->ng)
+		return knx_capture_next_pcapng(reader, frame);
+	else
+		return knx_capture_next_pcap(reader, frame);
+}
+
+size_t knx_capture_replay(
+	knx_capture_reader*     reader,
+	knx_capture_replay_mode mode,
+	knx_capture_handler     handler,
+	void*                   data
+) {
+	knx_capture_frame frame;
+	size_t replayed = 0;
+
+	struct timespec start;
+	uint64_t first_timestamp = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	while (knx_capture_next(reader, &frame)) {
+		if (mode == KNX_CAPTURE_REPLAY_REALTIME) {
+			if (replayed == 0) {
+				first_timestamp = frame.timestamp;
+			} else if (frame.timestamp > first_timestamp) {
+				// Sleep until the frame is due, relative to the start of the replay
+				uint64_t delay = frame.timestamp - first_timestamp;
+				uint64_t nanoseconds = start.tv_nsec + delay % 1000000000;
+
+				struct timespec due = {
+					start.tv_sec + delay / 1000000000 + nanoseconds / 1000000000,
+					nanoseconds % 1000000000
+				};
+
+				while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL) == EINTR);
+			}
+		}
+
+		replayed++;
+
+		if (!handler(&frame, data))
+			break;
+	}
+
+	return replayed;
+}
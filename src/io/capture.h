@@ -0,0 +1,241 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_IO_CAPTURE_H_
+#define KNXPROTO_IO_CAPTURE_H_
+
+#include "../proto/hostinfo.h"
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Maximum number of interfaces per pcapng section the reader keeps track of
+ */
+#define KNX_CAPTURE_MAX_INTERFACES 8
+
+/**
+ * Capture Writer
+ *
+ * Writes KNXnet/IP frames into a pcapng file. Each frame is wrapped in IPv4 and UDP headers, so
+ * the capture can be inspected with the usual tools.
+ */
+typedef struct {
+	/**
+	 * Output file
+	 */
+	FILE* file;
+} knx_capture_writer;
+
+/**
+ * Captured Frame
+ */
+typedef struct {
+	/**
+	 * Capture time in nanoseconds since the epoch
+	 */
+	uint64_t timestamp;
+
+	/**
+	 * Sender
+	 */
+	knx_host_info source;
+
+	/**
+	 * Receiver
+	 */
+	knx_host_info destination;
+
+	/**
+	 * KNXnet/IP frame, points into the mapped capture file
+	 */
+	const uint8_t* data;
+
+	/**
+	 * Number of bytes in `data`
+	 */
+	size_t length;
+} knx_capture_frame;
+
+/**
+ * Interface within a capture
+ */
+typedef struct {
+	/**
+	 * Link layer type
+	 */
+	uint16_t link_type;
+
+	/**
+	 * Timestamp resolution as specified by pcapng's `if_tsresol` option
+	 */
+	uint8_t resolution;
+} knx_capture_interface;
+
+/**
+ * Capture Reader
+ *
+ * Maps a pcap or pcapng file and extracts the UDP payloads of all IPv4 packets without copying
+ * them. Supported link types are Ethernet, Linux cooked capture and raw IPv4.
+ */
+typedef struct {
+	/**
+	 * Mapped capture file
+	 */
+	const uint8_t* base;
+
+	/**
+	 * Size of the capture file
+	 */
+	size_t size;
+
+	/**
+	 * Offset of the next block or record
+	 */
+	size_t offset;
+
+	/**
+	 * Is it a pcapng file?
+	 */
+	bool ng;
+
+	/**
+	 * Is the current section in the opposite byte order?
+	 */
+	bool swapped;
+
+	/**
+	 * Number of interfaces in the current section
+	 */
+	size_t num_interfaces;
+
+	/**
+	 * Interfaces in the current section (the classic format only has one)
+	 */
+	knx_capture_interface interfaces[KNX_CAPTURE_MAX_INTERFACES];
+} knx_capture_reader;
+
+/**
+ * Replay speed
+ */
+typedef enum {
+	/**
+	 * Preserve the gaps between frames
+	 */
+	KNX_CAPTURE_REPLAY_REALTIME,
+
+	/**
+	 * Deliver frames as fast as possible
+	 */
+	KNX_CAPTURE_REPLAY_FAST
+} knx_capture_replay_mode;
+
+/**
+ * Replay handler
+ *
+ * \param frame Captured frame, only valid as long as the reader is open
+ * \param data  User data
+ * \returns `false` to stop the replay
+ */
+typedef bool (* knx_capture_handler)(const knx_capture_frame* frame, void* data);
+
+/**
+ * Create a capture file.
+ *
+ * \param writer Output writer
+ * \param path   Path to the capture file, it will be truncated
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_capture_writer_open(knx_capture_writer* writer, const char* path);
+
+/**
+ * Write a KNXnet/IP frame.
+ *
+ * \param writer      Capture writer
+ * \param timestamp   Capture time in nanoseconds since the epoch
+ * \param source      Sender of the frame
+ * \param destination Receiver of the frame
+ * \param frame       Raw KNXnet/IP frame
+ * \param length      Number of bytes in `frame`
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_capture_write(
+	knx_capture_writer*  writer,
+	uint64_t             timestamp,
+	const knx_host_info* source,
+	const knx_host_info* destination,
+	const uint8_t*       frame,
+	size_t               length
+);
+
+/**
+ * Flush and close the capture file.
+ */
+bool knx_capture_writer_close(knx_capture_writer* writer);
+
+/**
+ * Map a pcap or pcapng file.
+ *
+ * \param reader Output reader
+ * \param path   Path to the capture file
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_capture_reader_open(knx_capture_reader* reader, const char* path);
+
+/**
+ * Retrieve the next UDP payload. Packets which are not UDP over IPv4 are skipped.
+ *
+ * \param reader Capture reader
+ * \param frame  Output frame, its data can be handed to `knx_parse` directly
+ * \returns `true` if a frame has been found, `false` at the end of the capture or on error
+ */
+bool knx_capture_next(knx_capture_reader* reader, knx_capture_frame* frame);
+
+/**
+ * Start over at the beginning of the capture.
+ */
+void knx_capture_rewind(knx_capture_reader* reader);
+
+/**
+ * Unmap the capture file.
+ */
+void knx_capture_reader_close(knx_capture_reader* reader);
+
+/**
+ * Feed every remaining frame of the capture to a handler.
+ *
+ * \param reader  Capture reader
+ * \param mode    Replay speed
+ * \param handler Handler invoked for each frame
+ * \param data    User data passed to `handler`
+ * \returns Number of replayed frames
+ */
+size_t knx_capture_replay(
+	knx_capture_reader*     reader,
+	knx_capture_replay_mode mode,
+	knx_capture_handler     handler,
+	void*                   data
+);
+
+#endif
@@ -0,0 +1,774 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "log.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Identifies a segment: "KNXL"
+#define KNX_LOG_MAGIC 0x4B4E584C
+
+#define KNX_LOG_VERSION 1
+
+// Segment file names consist of a 16 digit hexadecimal sequence number and this suffix
+#define KNX_LOG_SUFFIX ".knxlog"
+
+// Number of distinct destination addresses
+#define KNX_LOG_ADDRESSES 65536
+
+typedef struct {
+	uint64_t timestamp;
+	uint64_t offset;
+} knx_log_time_entry;
+
+typedef struct {
+	uint16_t group;
+	uint16_t reserved;
+	uint32_t count;
+	uint64_t postings;
+} knx_log_group_entry;
+
+typedef struct {
+	const uint32_t* position;
+	const uint32_t* end;
+} knx_log_cursor;
+
+typedef char knx_log_header_size_check[sizeof(knx_log_header) == 64 ? 1 : -1];
+
+inline static
+uint64_t knx_log_align(uint64_t offset) {
+	return (offset + 7) & ~((uint64_t) 7);
+}
+
+inline static
+void knx_log_record_unpack(const uint8_t* record, uint16_t* length, uint64_t* timestamp) {
+	memcpy(length, record, 2);
+	memcpy(timestamp, record + 2, 8);
+}
+
+inline static
+bool knx_log_frame_group(const uint8_t* frame, size_t length, knx_addr* group) {
+	knx_cemi cemi;
+
+	if (!knx_cemi_parse(frame, length, &cemi) ||
+	    cemi.payload.ldata.control2.address_type != KNX_LDATA_ADDR_GROUP)
+		return false;
+
+	*group = cemi.payload.ldata.destination;
+	return true;
+}
+
+bool knx_log_segment_create(knx_log_segment* segment, int dir_fd, const char* path, size_t capacity) {
+	// Postings refer to records using 32-bit offsets
+	if (capacity < sizeof(knx_log_header) + KNX_LOG_RECORD_HEADER_SIZE || capacity > UINT32_MAX)
+		return false;
+
+	int fd = openat(dir_fd, path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+	if (fd < 0)
+		return false;
+
+	if (ftruncate(fd, capacity) != 0) {
+		close(fd);
+		return false;
+	}
+
+	void* base = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (base == MAP_FAILED) {
+		close(fd);
+		return false;
+	}
+
+	segment->fd = fd;
+	segment->base = base;
+	segment->header = base;
+
+	memset(segment->header, 0, sizeof(knx_log_header));
+	segment->header->magic = KNX_LOG_MAGIC;
+	segment->header->version = KNX_LOG_VERSION;
+	segment->header->capacity = capacity;
+	segment->header->data_end = sizeof(knx_log_header);
+
+	return true;
+}
+
+bool knx_log_segment_append(
+	knx_log_segment* segment,
+	uint64_t         timestamp,
+	const uint8_t*   cemi,
+	size_t           length
+) {
+	knx_log_header* header = segment->header;
+
+	if (length == 0 || length > UINT16_MAX ||
+	    (header->records > 0 && timestamp < header->last_timestamp) ||
+	    header->data_end + KNX_LOG_RECORD_HEADER_SIZE + length > header->capacity)
+		return false;
+
+	uint8_t* record = segment->base + header->data_end;
+	uint16_t record_length = length;
+
+	memcpy(record, &record_length, 2);
+	memcpy(record + 2, &timestamp, 8);
+	memcpy(record + KNX_LOG_RECORD_HEADER_SIZE, cemi, length);
+
+	if (header->records == 0)
+		header->first_timestamp = timestamp;
+
+	header->last_timestamp = timestamp;
+	header->records++;
+
+	// Advance the end marker last, so a crashed writer process leaves a readable segment behind
+	header->data_end += KNX_LOG_RECORD_HEADER_SIZE + length;
+
+	return true;
+}
+
+bool knx_log_segment_seal(knx_log_segment* segment) {
+	return knx_log_segment_seal_with(segment, NULL);
+}
+
+bool knx_log_segment_seal_with(knx_log_segment* segment, const knx_allocator* allocator) {
+	knx_log_header* header = segment->header;
+	uint8_t* index = NULL;
+	bool success = false;
+
+	uint32_t* counts = knx_allocator_alloc(allocator, sizeof(uint32_t) * KNX_LOG_ADDRESSES);
+	if (!counts)
+		goto unmap;
+
+	memset(counts, 0, sizeof(uint32_t) * KNX_LOG_ADDRESSES);
+
+	// Count the postings of each group
+	size_t group_entries = 0, num_postings = 0;
+
+	for (uint64_t offset = sizeof(knx_log_header); offset < header->data_end;) {
+		uint16_t length;
+		uint64_t timestamp;
+		knx_addr group;
+
+		knx_log_record_unpack(segment->base + offset, &length, &timestamp);
+
+		if (knx_log_frame_group(segment->base + offset + KNX_LOG_RECORD_HEADER_SIZE, length, &group)) {
+			if (counts[group]++ == 0)
+				group_entries++;
+
+			num_postings++;
+		}
+
+		offset += KNX_LOG_RECORD_HEADER_SIZE + length;
+	}
+
+	size_t time_entries = (header->records + KNX_LOG_TIME_INTERVAL - 1) / KNX_LOG_TIME_INTERVAL;
+	size_t index_size =
+		time_entries * sizeof(knx_log_time_entry) +
+		group_entries * sizeof(knx_log_group_entry) +
+		num_postings * sizeof(uint32_t);
+
+	uint64_t index_offset = knx_log_align(header->data_end);
+
+	index = knx_allocator_alloc(allocator, index_size + 1);
+	if (!index)
+		goto unmap;
+
+	knx_log_time_entry* times = (knx_log_time_entry*) index;
+	knx_log_group_entry* groups = (knx_log_group_entry*) (times + time_entries);
+	uint32_t* postings = (uint32_t*) (groups + group_entries);
+
+	uint64_t postings_offset =
+		index_offset +
+		time_entries * sizeof(knx_log_time_entry) +
+		group_entries * sizeof(knx_log_group_entry);
+
+	// Lay out the group index in ascending address order, `counts` becomes the fill cursor
+	size_t group_index = 0, posting_index = 0;
+
+	for (size_t group = 0; group < KNX_LOG_ADDRESSES; group++) {
+		if (counts[group] == 0)
+			continue;
+
+		groups[group_index].group = group;
+		groups[group_index].reserved = 0;
+		groups[group_index].count = counts[group];
+		groups[group_index].postings = postings_offset + posting_index * sizeof(uint32_t);
+
+		posting_index += counts[group];
+		counts[group] = posting_index - counts[group];
+		group_index++;
+	}
+
+	// Fill time index and postings
+	uint64_t record_index = 0;
+
+	for (uint64_t offset = sizeof(knx_log_header); offset < header->data_end; record_index++) {
+		uint16_t length;
+		uint64_t timestamp;
+		knx_addr group;
+
+		knx_log_record_unpack(segment->base + offset, &length, &timestamp);
+
+		if (record_index % KNX_LOG_TIME_INTERVAL == 0) {
+			times[record_index / KNX_LOG_TIME_INTERVAL].timestamp = timestamp;
+			times[record_index / KNX_LOG_TIME_INTERVAL].offset = offset;
+		}
+
+		if (knx_log_frame_group(segment->base + offset + KNX_LOG_RECORD_HEADER_SIZE, length, &group))
+			postings[counts[group]++] = offset;
+
+		offset += KNX_LOG_RECORD_HEADER_SIZE + length;
+	}
+
+	if (ftruncate(segment->fd, index_offset + index_size) != 0 ||
+	    pwrite(segment->fd, index, index_size, index_offset) != (ssize_t) index_size)
+		goto unmap;
+
+	header->index_offset = index_offset;
+	header->time_entries = time_entries;
+	header->group_entries = group_entries;
+	header->sealed = 1;
+
+	success = true;
+
+	// A segment which could not be sealed remains readable, it just lacks the indexes
+	unmap:
+	knx_allocator_free(allocator, counts);
+	knx_allocator_free(allocator, index);
+
+	munmap(segment->base, header->capacity);
+	close(segment->fd);
+
+	segment->fd = -1;
+	segment->base = NULL;
+	segment->header = NULL;
+
+	return success;
+}
+
+inline static
+bool knx_log_group_wanted(const knx_log_query* query, const uint8_t* frame, size_t length) {
+	if (!query->groups)
+		return true;
+
+	knx_addr group;
+	if (!knx_log_frame_group(frame, length, &group))
+		return false;
+
+	for (size_t i = 0; i < query->num_groups; i++) {
+		if (query->groups[i] == group)
+			return true;
+	}
+
+	return false;
+}
+
+// Decode the record at `offset` and hand it to the visitor if it matches the time range.
+// Returns `-1` if the record is beyond the time range, `0` if it was skipped and `1` if visited.
+inline static
+int knx_log_visit(
+	const uint8_t*       window,
+	uint64_t             window_offset,
+	uint64_t             window_end,
+	uint64_t             offset,
+	const knx_log_query* query,
+	knx_log_visitor      visitor,
+	void*                data,
+	bool*                stopped
+) {
+	if (offset + KNX_LOG_RECORD_HEADER_SIZE > window_end)
+		return -1;
+
+	const uint8_t* record = window + (offset - window_offset);
+	uint16_t length;
+	uint64_t timestamp;
+
+	knx_log_record_unpack(record, &length, &timestamp);
+
+	if (offset + KNX_LOG_RECORD_HEADER_SIZE + length > window_end || timestamp > query->to)
+		return -1;
+
+	knx_cemi frame;
+
+	if (timestamp < query->from ||
+	    !knx_cemi_parse(record + KNX_LOG_RECORD_HEADER_SIZE, length, &frame))
+		return 0;
+
+	if (!visitor(timestamp, &frame, data))
+		*stopped = true;
+
+	return 1;
+}
+
+static
+ssize_t knx_log_segment_query_internal(
+	int                  fd,
+	const knx_log_query* query,
+	knx_log_visitor      visitor,
+	void*                data,
+	const knx_allocator* allocator,
+	bool*                stopped
+) {
+	knx_log_header header;
+
+	if (pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+	    header.magic != KNX_LOG_MAGIC || header.version != KNX_LOG_VERSION)
+		return -1;
+
+	// Nothing to see here
+	if (header.records == 0 || query->to < header.first_timestamp ||
+	    query->from > header.last_timestamp)
+		return 0;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || header.data_end > (uint64_t) info.st_size)
+		return -1;
+
+	uint64_t page_mask = ~((uint64_t) sysconf(_SC_PAGESIZE) - 1);
+
+	uint64_t lo = sizeof(knx_log_header), hi = header.data_end;
+
+	const knx_log_time_entry* times = NULL;
+	const knx_log_group_entry* groups = NULL;
+
+	uint8_t* index_map = MAP_FAILED;
+	uint64_t index_map_offset = 0;
+	size_t index_map_size = 0;
+
+	if (header.sealed) {
+		uint64_t groups_end =
+			header.index_offset +
+			header.time_entries * sizeof(knx_log_time_entry) +
+			header.group_entries * sizeof(knx_log_group_entry);
+
+		if (header.index_offset > (uint64_t) info.st_size || groups_end > (uint64_t) info.st_size)
+			return -1;
+
+		index_map_offset = header.index_offset & page_mask;
+		index_map_size = info.st_size - index_map_offset;
+		index_map = mmap(NULL, index_map_size, PROT_READ, MAP_SHARED, fd, index_map_offset);
+
+		if (index_map == MAP_FAILED)
+			return -1;
+
+		times = (const knx_log_time_entry*) (index_map + (header.index_offset - index_map_offset));
+		groups = (const knx_log_group_entry*) (times + header.time_entries);
+
+		// Start at the last sample before the lower bound
+		size_t a = 0, b = header.time_entries;
+		while (a < b) {
+			size_t m = a + (b - a) / 2;
+
+			if (times[m].timestamp < query->from)
+				a = m + 1;
+			else
+				b = m;
+		}
+
+		if (a > 0)
+			lo = times[a - 1].offset;
+
+		// Stop at the first sample beyond the upper bound
+		b = header.time_entries;
+		while (a < b) {
+			size_t m = a + (b - a) / 2;
+
+			if (times[m].timestamp <= query->to)
+				a = m + 1;
+			else
+				b = m;
+		}
+
+		if (a < header.time_entries)
+			hi = times[a].offset;
+	}
+
+	// A corrupt time index must not map anything outside the records
+	if (lo < sizeof(knx_log_header) || hi > header.data_end || lo >= hi) {
+		if (index_map != MAP_FAILED)
+			munmap(index_map, index_map_size);
+
+		return -1;
+	}
+
+	// Map the records which may fall into the time range
+	uint64_t window_offset = lo & page_mask;
+	uint8_t* window = mmap(NULL, hi - window_offset, PROT_READ, MAP_SHARED, fd, window_offset);
+
+	if (window == MAP_FAILED) {
+		if (index_map != MAP_FAILED)
+			munmap(index_map, index_map_size);
+
+		return -1;
+	}
+
+	ssize_t visited = 0;
+
+	if (header.sealed && query->groups) {
+		// Small queries keep their cursors on the stack
+		knx_log_cursor local_cursors[KNX_LOG_QUERY_GROUPS];
+		knx_log_cursor* cursors = local_cursors;
+
+		if (query->num_groups > KNX_LOG_QUERY_GROUPS)
+			cursors = knx_allocator_alloc(allocator, sizeof(knx_log_cursor) * query->num_groups);
+
+		if (!cursors) {
+			visited = -1;
+			goto unmap;
+		}
+
+		size_t num_cursors = 0;
+
+		for (size_t i = 0; i < query->num_groups; i++) {
+			// Look up the group's postings
+			size_t a = 0, b = header.group_entries;
+			while (a < b) {
+				size_t m = a + (b - a) / 2;
+
+				if (groups[m].group < query->groups[i])
+					a = m + 1;
+				else
+					b = m;
+			}
+
+			if (a == header.group_entries || groups[a].group != query->groups[i] ||
+			    groups[a].postings < header.index_offset ||
+			    groups[a].postings + groups[a].count * sizeof(uint32_t) > (uint64_t) info.st_size)
+				continue;
+
+			const uint32_t* postings =
+				(const uint32_t*) (index_map + (groups[a].postings - index_map_offset));
+
+			// Skip postings in front of the window
+			size_t c = 0, d = groups[a].count;
+			while (c < d) {
+				size_t m = c + (d - c) / 2;
+
+				if (postings[m] < lo)
+					c = m + 1;
+				else
+					d = m;
+			}
+
+			cursors[num_cursors].position = postings + c;
+			cursors[num_cursors].end = postings + groups[a].count;
+			num_cursors++;
+		}
+
+		// Merge the postings of all groups in record order
+		while (!*stopped) {
+			uint64_t offset = UINT64_MAX;
+
+			for (size_t i = 0; i < num_cursors; i++) {
+				if (cursors[i].position < cursors[i].end && *cursors[i].position < offset)
+					offset = *cursors[i].position;
+			}
+
+			if (offset >= hi)
+				break;
+
+			// Advance every cursor pointing at this record, the query might contain duplicates
+			for (size_t i = 0; i < num_cursors; i++) {
+				if (cursors[i].position < cursors[i].end && *cursors[i].position == offset)
+					cursors[i].position++;
+			}
+
+			int result =
+				knx_log_visit(window, window_offset, hi, offset, query, visitor, data, stopped);
+
+			if (result < 0)
+				break;
+
+			visited += result;
+		}
+
+		if (cursors != local_cursors)
+			knx_allocator_free(allocator, cursors);
+	} else {
+		for (uint64_t offset = lo; offset < hi && !*stopped;) {
+			uint16_t length;
+			uint64_t timestamp;
+
+			if (offset + KNX_LOG_RECORD_HEADER_SIZE > hi)
+				break;
+
+			knx_log_record_unpack(window + (offset - window_offset), &length, &timestamp);
+
+			const uint8_t* frame =
+				window + (offset - window_offset) + KNX_LOG_RECORD_HEADER_SIZE;
+
+			if (offset + KNX_LOG_RECORD_HEADER_SIZE + length <= hi &&
+			    knx_log_group_wanted(query, frame, length)) {
+				int result =
+					knx_log_visit(window, window_offset, hi, offset, query, visitor, data, stopped);
+
+				if (result < 0)
+					break;
+
+				visited += result;
+			}
+
+			offset += KNX_LOG_RECORD_HEADER_SIZE + length;
+		}
+	}
+
+	unmap:
+	munmap(window, hi - window_offset);
+
+	if (index_map != MAP_FAILED)
+		munmap(index_map, index_map_size);
+
+	return visited;
+}
+
+ssize_t knx_log_segment_query(
+	int                  fd,
+	const knx_log_query* query,
+	knx_log_visitor      visitor,
+	void*                data
+) {
+	return knx_log_segment_query_with(fd, query, visitor, data, NULL);
+}
+
+ssize_t knx_log_segment_query_with(
+	int                  fd,
+	const knx_log_query* query,
+	knx_log_visitor      visitor,
+	void*                data,
+	const knx_allocator* allocator
+) {
+	if (query->num_groups > SIZE_MAX / sizeof(knx_log_cursor))
+		return -1;
+
+	bool stopped = false;
+	return knx_log_segment_query_internal(fd, query, visitor, data, allocator, &stopped);
+}
+
+inline static
+bool knx_log_segment_name_parse(const char* name, uint64_t* sequence) {
+	size_t length = strlen(name);
+	size_t suffix_length = strlen(KNX_LOG_SUFFIX);
+
+	if (length != 16 + suffix_length || strcmp(name + 16, KNX_LOG_SUFFIX) != 0)
+		return false;
+
+	return sscanf(name, "%16" SCNx64, sequence) == 1;
+}
+
+// Layout of the records returned by getdents64
+typedef struct {
+	uint64_t ino;
+	int64_t off;
+	unsigned short reclen;
+	unsigned char type;
+	char name[];
+} knx_log_dirent;
+
+/**
+ * Determine the lowest and highest segment sequence number not below `minimum` in the directory.
+ * `readdir` and
+ * `scandir` obtain their buffers from the heap, therefore the entries are read directly
+ * into a buffer on the stack.
+ *
+ * \returns `1` if segments exist, `0` if there are none and `-1` on error
+ */
+static
+int knx_log_segment_range(int dir_fd, uint64_t minimum, uint64_t* first, uint64_t* last) {
+	if (lseek(dir_fd, 0, SEEK_SET) != 0)
+		return -1;
+
+	char buffer[4096] __attribute__((aligned(8)));
+	int found = 0;
+
+	for (;;) {
+		long length = syscall(SYS_getdents64, dir_fd, buffer, sizeof(buffer));
+
+		if (length < 0)
+			return -1;
+		else if (length == 0)
+			return found;
+
+		for (long offset = 0; offset < length;) {
+			const knx_log_dirent* entry = (const knx_log_dirent*) (buffer + offset);
+			uint64_t sequence;
+
+			if (knx_log_segment_name_parse(entry->name, &sequence) && sequence >= minimum) {
+				if (!found || sequence < *first)
+					*first = sequence;
+
+				if (!found || sequence > *last)
+					*last = sequence;
+
+				found = 1;
+			}
+
+			offset += entry->reclen;
+		}
+	}
+}
+
+inline static
+bool knx_log_segment_next(knx_log* log) {
+	char name[32];
+	snprintf(name, sizeof(name), "%016" PRIx64 KNX_LOG_SUFFIX, log->sequence++);
+
+	return knx_log_segment_create(&log->current, log->dir_fd, name, log->segment_size);
+}
+
+bool knx_log_open(knx_log* log, const char* directory, size_t segment_size) {
+	return knx_log_open_with(log, directory, segment_size, NULL);
+}
+
+bool knx_log_open_with(
+	knx_log*             log,
+	const char*          directory,
+	size_t               segment_size,
+	const knx_allocator* allocator
+) {
+	log->allocator = allocator;
+	log->dir_fd = open(directory, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (log->dir_fd < 0)
+		return false;
+
+	// Continue after the latest segment
+	uint64_t first, last;
+	int found = knx_log_segment_range(log->dir_fd, 0, &first, &last);
+
+	if (found < 0) {
+		close(log->dir_fd);
+		return false;
+	}
+
+	log->sequence = found ? last + 1 : 0;
+	log->segment_size = segment_size;
+	log->current.header = NULL;
+
+	if (!knx_log_segment_next(log)) {
+		close(log->dir_fd);
+		return false;
+	}
+
+	return true;
+}
+
+bool knx_log_append(knx_log* log, uint64_t timestamp, const uint8_t* cemi, size_t length) {
+	if (log->current.header) {
+		if (knx_log_segment_append(&log->current, timestamp, cemi, length))
+			return true;
+
+		// Only roll over when the segment is actually full
+		const knx_log_header* header = log->current.header;
+
+		if (header->records == 0 || timestamp < header->last_timestamp || length > UINT16_MAX)
+			return false;
+
+		knx_log_segment_seal_with(&log->current, log->allocator);
+	}
+
+	return
+		knx_log_segment_next(log) &&
+		knx_log_segment_append(&log->current, timestamp, cemi, length);
+}
+
+bool knx_log_close(knx_log* log) {
+	bool success = true;
+
+	if (log->current.header)
+		success = knx_log_segment_seal_with(&log->current, log->allocator);
+
+	close(log->dir_fd);
+	return success;
+}
+
+ssize_t knx_log_query_directory(
+	const char*          directory,
+	const knx_log_query* query,
+	knx_log_visitor      visitor,
+	void*                data
+) {
+	return knx_log_query_directory_with(directory, query, visitor, data, NULL);
+}
+
+ssize_t knx_log_query_directory_with(
+	const char*          directory,
+	const knx_log_query* query,
+	knx_log_visitor      visitor,
+	void*                data,
+	const knx_allocator* allocator
+) {
+	if (query->num_groups > SIZE_MAX / sizeof(knx_log_cursor))
+		return -1;
+
+	int dir_fd = open(directory, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (dir_fd < 0)
+		return -1;
+
+	uint64_t first, last;
+	int found = knx_log_segment_range(dir_fd, 0, &first, &last);
+
+	ssize_t visited = 0;
+	bool stopped = false;
+
+	// Segments are created with consecutive sequence numbers, so probing the range visits them
+	// in order without having to sort the directory entries
+	uint64_t sequence = first;
+
+	while (found > 0 && !stopped) {
+		char name[32];
+		snprintf(name, sizeof(name), "%016" PRIx64 KNX_LOG_SUFFIX, sequence);
+
+		int fd = openat(dir_fd, name, O_RDONLY | O_CLOEXEC);
+
+		if (fd >= 0) {
+			ssize_t result =
+				knx_log_segment_query_internal(fd, query, visitor, data, allocator, &stopped);
+
+			if (result > 0)
+				visited += result;
+
+			close(fd);
+		} else if (sequence < last) {
+			// Skip over gaps left by removed segments
+			uint64_t gap_last;
+			found = knx_log_segment_range(dir_fd, sequence + 1, &sequence, &gap_last);
+			continue;
+		}
+
+		if (sequence == last)
+			break;
+
+		sequence++;
+	}
+
+	if (found < 0) {
+		close(dir_fd);
+		return -1;
+	}
+
+	close(dir_fd);
+
+	return visited;
+}
@@ -0,0 +1,341 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_IO_LOG_H_
+#define KNXPROTO_IO_LOG_H_
+
+#include "../proto/cemi.h"
+#include "../util/address.h"
+#include "../util/allocator.h"
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Every n-th record of a segment gets an entry in the sparse time index.
+ */
+#define KNX_LOG_TIME_INTERVAL 64
+
+/**
+ * Size of the header which precedes each record (length and timestamp)
+ */
+#define KNX_LOG_RECORD_HEADER_SIZE 10
+
+/**
+ * Queries for up to this many group addresses are answered without allocating memory.
+ */
+#define KNX_LOG_QUERY_GROUPS 16
+
+/**
+ * Segment Header
+ *
+ * Segment layout:
+ *
+ *   +----------+------------------------+------------+-------------+----------+
+ *   | Header   | Records                | Time index | Group index | Postings |
+ *   +----------+------------------------+------------+-------------+----------+
+ *
+ * Each record consists of a 16-bit length, a 64-bit timestamp in nanoseconds and the raw CEMI
+ * frame. Indexes are only present once the segment has been sealed. All integers are stored in
+ * host byte order.
+ */
+typedef struct {
+	/**
+	 * Identifies a segment
+	 */
+	uint32_t magic;
+
+	/**
+	 * Format version
+	 */
+	uint16_t version;
+
+	/**
+	 * Have the indexes been written?
+	 */
+	uint16_t sealed;
+
+	/**
+	 * Offset at which no more records can be appended
+	 */
+	uint64_t capacity;
+
+	/**
+	 * Offset behind the last record
+	 */
+	uint64_t data_end;
+
+	/**
+	 * Number of records
+	 */
+	uint64_t records;
+
+	/**
+	 * Timestamp of the first record
+	 */
+	uint64_t first_timestamp;
+
+	/**
+	 * Timestamp of the last record
+	 */
+	uint64_t last_timestamp;
+
+	/**
+	 * Offset of the time index, the group index and the postings follow it
+	 */
+	uint64_t index_offset;
+
+	/**
+	 * Number of time index entries
+	 */
+	uint32_t time_entries;
+
+	/**
+	 * Number of group index entries
+	 */
+	uint32_t group_entries;
+} knx_log_header;
+
+/**
+ * Segment Writer
+ */
+typedef struct {
+	/**
+	 * Segment file descriptor
+	 */
+	int fd;
+
+	/**
+	 * Mapping of the entire segment
+	 */
+	uint8_t* base;
+
+	/**
+	 * Points to the beginning of `base`
+	 */
+	knx_log_header* header;
+} knx_log_segment;
+
+/**
+ * Telegram Log
+ *
+ * Manages a directory of segments and rolls over to a new segment once the current one is full.
+ */
+typedef struct {
+	/**
+	 * Directory file descriptor
+	 */
+	int dir_fd;
+
+	/**
+	 * Capacity of newly created segments in bytes
+	 */
+	size_t segment_size;
+
+	/**
+	 * Sequence number of the current segment
+	 */
+	uint64_t sequence;
+
+	/**
+	 * Segment records are appended to
+	 */
+	knx_log_segment current;
+
+	/**
+	 * Allocator for the temporary buffers needed to seal a segment
+	 */
+	const knx_allocator* allocator;
+} knx_log;
+
+/**
+ * Query
+ */
+typedef struct {
+	/**
+	 * Lower time bound (inclusive)
+	 */
+	uint64_t from;
+
+	/**
+	 * Upper time bound (inclusive)
+	 */
+	uint64_t to;
+
+	/**
+	 * Group addresses to look for (`NULL` means all frames)
+	 */
+	const knx_addr* groups;
+
+	/**
+	 * Number of elements in `groups`
+	 */
+	size_t num_groups;
+} knx_log_query;
+
+/**
+ * Query visitor
+ *
+ * \param timestamp Time of the record in nanoseconds
+ * \param frame     Decoded frame, its pointers are only valid during the invocation
+ * \param data      User data
+ * \returns `false` to stop the query
+ */
+typedef bool (* knx_log_visitor)(uint64_t timestamp, const knx_cemi* frame, void* data);
+
+/**
+ * Create a new segment.
+ *
+ * \param segment  Output segment
+ * \param dir_fd   Directory in which the segment is created (may be `AT_FDCWD`)
+ * \param path     Path of the segment file, must not exist
+ * \param capacity Maximum segment size in bytes excluding the indexes
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_log_segment_create(knx_log_segment* segment, int dir_fd, const char* path, size_t capacity);
+
+/**
+ * Append a record to a segment.
+ *
+ * \param segment   Segment
+ * \param timestamp Time in nanoseconds, must not be smaller than the previous timestamp
+ * \param cemi      Raw CEMI frame
+ * \param length    Number of bytes in `cemi`
+ * \returns `true` on success, `false` if the segment is full or the timestamp is out of order
+ */
+bool knx_log_segment_append(
+	knx_log_segment* segment,
+	uint64_t         timestamp,
+	const uint8_t*   cemi,
+	size_t           length
+);
+
+/**
+ * Write the indexes, unmap and close the segment.
+ */
+bool knx_log_segment_seal(knx_log_segment* segment);
+
+/**
+ * Seal the segment using the given allocator for the temporary buffers. They take 256 KiB plus
+ * the size of the indexes and are released before returning.
+ *
+ * \see knx_log_segment_seal
+ * \param allocator Allocator (may be `NULL`)
+ */
+bool knx_log_segment_seal_with(knx_log_segment* segment, const knx_allocator* allocator);
+
+/**
+ * Find the frames within a segment that match the query. Only the pages holding the relevant
+ * records are mapped.
+ *
+ * \param fd      Segment file descriptor
+ * \param query   Query
+ * \param visitor Function to be invoked for each matching frame
+ * \param data    User data passed to `visitor`
+ * \returns Number of visited frames or `-1` on error
+ */
+ssize_t knx_log_segment_query(
+	int                  fd,
+	const knx_log_query* query,
+	knx_log_visitor      visitor,
+	void*                data
+);
+
+/**
+ * Find the frames within a segment that match the query. Queries with more than
+ * `KNX_LOG_QUERY_GROUPS` groups obtain their cursors from the given allocator.
+ *
+ * \see knx_log_segment_query
+ * \param allocator Allocator (may be `NULL`)
+ */
+ssize_t knx_log_segment_query_with(
+	int                  fd,
+	const knx_log_query* query,
+	knx_log_visitor      visitor,
+	void*                data,
+	const knx_allocator* allocator
+);
+
+/**
+ * Open a log directory for appending. A new segment is created for this purpose.
+ *
+ * \param log          Output log
+ * \param directory    Log directory, must exist
+ * \param segment_size Capacity of each segment in bytes
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_log_open(knx_log* log, const char* directory, size_t segment_size);
+
+/**
+ * Open a log directory for appending. Segments are sealed using the given allocator.
+ *
+ * \see knx_log_open
+ * \param allocator Allocator (may be `NULL`), must outlive the log
+ */
+bool knx_log_open_with(
+	knx_log*             log,
+	const char*          directory,
+	size_t               segment_size,
+	const knx_allocator* allocator
+);
+
+/**
+ * Append a record to the log.
+ *
+ * \see knx_log_segment_append
+ */
+bool knx_log_append(knx_log* log, uint64_t timestamp, const uint8_t* cemi, size_t length);
+
+/**
+ * Seal the current segment and close the log.
+ */
+bool knx_log_close(knx_log* log);
+
+/**
+ * Query every segment in the given log directory. Segments whose time range does not intersect
+ * with the query are skipped without mapping them.
+ *
+ * \see knx_log_segment_query
+ */
+ssize_t knx_log_query_directory(
+	const char*          directory,
+	const knx_log_query* query,
+	knx_log_visitor      visitor,
+	void*                data
+);
+
+/**
+ * Query every segment in the given log directory using the given allocator.
+ *
+ * \see knx_log_query_directory
+ * \see knx_log_segment_query_with
+ */
+ssize_t knx_log_query_directory_with(
+	const char*          directory,
+	const knx_log_query* query,
+	knx_log_visitor      visitor,
+	void*                data,
+	const knx_allocator* allocator
+);
+
+#endif
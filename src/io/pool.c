@@ -0,0 +1,222 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "pool.h"
+#include "../util/alloc.h"
+
+
+// Buffers start on cache line boundaries
+#define KNX_POOL_ALIGNMENT 64
+
+#define KNX_POOL_INDEX_MASK 0xFFFFFFFFull
+
+inline static
+uint64_t knx_pool_head(uint64_t old_head, uint32_t top) {
+	return ((old_head >> 32) + 1) << 32 | top;
+}
+
+inline static
+void knx_pool_push(knx_pool* pool, knx_pool_buffer* buffer) {
+	uint32_t top = buffer - pool->buffers + 1;
+	uint64_t head = __atomic_load_n(&pool->free_head, __ATOMIC_RELAXED);
+
+	do {
+		__atomic_store_n(&buffer->next, (uint32_t) (head & KNX_POOL_INDEX_MASK), __ATOMIC_RELAXED);
+	} while (!__atomic_compare_exchange_n(&pool->free_head, &head, knx_pool_head(head, top), true,
+	                                      __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+inline static
+knx_pool_buffer* knx_pool_pop(knx_pool* pool) {
+	uint64_t head = __atomic_load_n(&pool->free_head, __ATOMIC_ACQUIRE);
+	uint32_t top;
+
+	// The tag in the upper half prevents ABA when a buffer is popped and pushed concurrently
+	do {
+		top = head & KNX_POOL_INDEX_MASK;
+		if (top == 0)
+			return NULL;
+
+		uint32_t next = __atomic_load_n(&pool->buffers[top - 1].next, __ATOMIC_RELAXED);
+
+		if (__atomic_compare_exchange_n(&pool->free_head, &head, knx_pool_head(head, next), true,
+		                                __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+			break;
+	} while (true);
+
+	return pool->buffers + top - 1;
+}
+
+bool knx_pool_init(knx_pool* pool, size_t capacity, size_t buffer_size) {
+	return knx_pool_init_with(pool, capacity, buffer_size, NULL);
+}
+
+bool knx_pool_init_with(
+	knx_pool*            pool,
+	size_t               capacity,
+	size_t               buffer_size,
+	const knx_allocator* allocator
+) {
+	if (capacity == 0 || capacity >= KNX_POOL_INDEX_MASK || buffer_size == 0)
+		return false;
+
+	buffer_size = (buffer_size + KNX_POOL_ALIGNMENT - 1) & ~((size_t) KNX_POOL_ALIGNMENT - 1);
+
+	pool->buffers = knx_allocator_alloc(allocator, sizeof(knx_pool_buffer) * capacity);
+	if (!pool->buffers)
+		return false;
+
+	// Allocators only guarantee their own alignment, so their block is padded to a cache line
+	if (allocator) {
+		pool->block = knx_allocator_alloc(allocator, capacity * buffer_size + KNX_POOL_ALIGNMENT);
+		pool->storage = (uint8_t*) (((uintptr_t) pool->block + KNX_POOL_ALIGNMENT - 1) &
+		                            ~((uintptr_t) KNX_POOL_ALIGNMENT - 1));
+	} else {
+		pool->block = pool->storage = knx_alloc_aligned(KNX_POOL_ALIGNMENT, capacity * buffer_size);
+	}
+
+	if (!pool->block) {
+		knx_allocator_free(allocator, pool->buffers);
+		return false;
+	}
+
+	pool->allocator = allocator;
+
+	pool->buffer_size = buffer_size;
+	pool->capacity = capacity;
+	pool->free_head = 0;
+	pool->in_use = pool->peak = 0;
+	pool->acquired = pool->exhausted = 0;
+
+	for (size_t i = capacity; i > 0; i--) {
+		knx_pool_buffer* buffer = pool->buffers + i - 1;
+
+		buffer->pool = pool;
+		buffer->data = pool->storage + (i - 1) * buffer_size;
+		buffer->length = 0;
+		buffer->refs = 0;
+
+		knx_pool_push(pool, buffer);
+	}
+
+	return true;
+}
+
+void knx_pool_destroy(knx_pool* pool) {
+	if (pool->allocator)
+		knx_allocator_free(pool->allocator, pool->block);
+	else
+		knx_free(pool->block);
+
+	knx_allocator_free(pool->allocator, pool->buffers);
+
+	pool->block = NULL;
+	pool->storage = NULL;
+	pool->buffers = NULL;
+	pool->capacity = 0;
+}
+
+knx_pool_buffer* knx_pool_acquire(knx_pool* pool) {
+	knx_pool_buffer* buffer = knx_pool_pop(pool);
+
+	if (!buffer) {
+		__atomic_add_fetch(&pool->exhausted, 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
+
+	buffer->length = 0;
+	__atomic_store_n(&buffer->refs, 1, __ATOMIC_RELAXED);
+
+	__atomic_add_fetch(&pool->acquired, 1, __ATOMIC_RELAXED);
+	size_t in_use = __atomic_add_fetch(&pool->in_use, 1, __ATOMIC_RELAXED);
+
+	size_t peak = __atomic_load_n(&pool->peak, __ATOMIC_RELAXED);
+	while (in_use > peak &&
+	       !__atomic_compare_exchange_n(&pool->peak, &peak, in_use, true,
+	                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+	return buffer;
+}
+
+void knx_pool_release(knx_pool_buffer* buffer) {
+	// Writes by other holders must be visible before the buffer is reused
+	if (__atomic_sub_fetch(&buffer->refs, 1, __ATOMIC_ACQ_REL) != 0)
+		return;
+
+	knx_pool* pool = buffer->pool;
+
+	__atomic_sub_fetch(&pool->in_use, 1, __ATOMIC_RELAXED);
+	knx_pool_push(pool, buffer);
+}
+
+ssize_t knx_pool_receive(
+	knx_pool_buffer* buffer,
+	int              fd,
+	int              flags,
+	struct sockaddr* address,
+	socklen_t*       address_length
+) {
+	ssize_t received = recvfrom(fd, buffer->data, buffer->pool->buffer_size, flags,
+	                            address, address_length);
+
+	buffer->length = received > 0 ? (size_t) received : 0;
+	return received;
+}
+
+bool knx_pool_parse(knx_pool_buffer* buffer, knx_pool_packet* output) {
+	// Parts which cannot be borrowed (e.g. description response services) are placed behind the
+	// frame, so the packet remains valid as long as the buffer is
+	knx_arena tail;
+	knx_arena_init_buffer(&tail, buffer->data + buffer->length,
+	                      buffer->pool->buffer_size - buffer->length);
+
+	knx_allocator allocator = knx_arena_allocator(&tail);
+
+	if (knx_parse_with(buffer->data, buffer->length, &output->packet, &allocator) < 0)
+		return false;
+
+	if (output->packet.service == KNX_DESCRIPTION_RESPONSE)
+		output->packet.payload.description_res.allocator = &knx_allocator_none;
+
+	knx_pool_retain(buffer);
+	output->buffer = buffer;
+
+	return true;
+}
+
+bool knx_pool_parse_cemi(knx_pool_buffer* buffer, size_t offset, knx_pool_cemi* output) {
+	if (offset > buffer->length ||
+	    !knx_cemi_parse(buffer->data + offset, buffer->length - offset, &output->frame))
+		return false;
+
+	knx_pool_retain(buffer);
+	output->buffer = buffer;
+
+	return true;
+}
+
+void knx_pool_stats_get(const knx_pool* pool, knx_pool_stats* stats) {
+	stats->capacity = pool->capacity;
+	stats->in_use = __atomic_load_n(&pool->in_use, __ATOMIC_RELAXED);
+	stats->peak = __atomic_load_n(&pool->peak, __ATOMIC_RELAXED);
+	stats->acquired = __atomic_load_n(&pool->acquired, __ATOMIC_RELAXED);
+	stats->exhausted = __atomic_load_n(&pool->exhausted, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,305 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_IO_POOL_H_
+#define KNXPROTO_IO_POOL_H_
+
+#include "../proto/proto.h"
+#include "../proto/cemi.h"
+#include "../util/allocator.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Pooled Frame Buffer
+ *
+ * Frames are received into and generated in `data`. Parsed structures borrow from `data`, hence
+ * every stage that holds on to them keeps a reference instead of copying the frame.
+ */
+typedef struct {
+	/**
+	 * Pool the buffer belongs to
+	 */
+	struct knx_pool* pool;
+
+	/**
+	 * Storage of `pool->buffer_size` bytes
+	 */
+	uint8_t* data;
+
+	/**
+	 * Number of bytes in use
+	 */
+	size_t length;
+
+	/**
+	 * Reference count
+	 */
+	uint32_t refs;
+
+	/**
+	 * Index + 1 of the next free buffer, `0` terminates the free list
+	 */
+	uint32_t next;
+} knx_pool_buffer;
+
+/**
+ * Pool Statistics
+ */
+typedef struct {
+	/**
+	 * Number of buffers
+	 */
+	size_t capacity;
+
+	/**
+	 * Number of buffers in use
+	 */
+	size_t in_use;
+
+	/**
+	 * Highest number of buffers that were in use at the same time
+	 */
+	size_t peak;
+
+	/**
+	 * Number of successful acquisitions
+	 */
+	uint64_t acquired;
+
+	/**
+	 * Number of acquisitions that failed because every buffer was in use
+	 */
+	uint64_t exhausted;
+} knx_pool_stats;
+
+/**
+ * Frame Buffer Pool
+ *
+ * All buffers are allocated when the pool is created. Acquiring and releasing buffers is
+ * lock-free and may happen on any thread.
+ */
+typedef struct knx_pool {
+	/**
+	 * Size of each buffer in bytes
+	 */
+	size_t buffer_size;
+
+	/**
+	 * Number of buffers
+	 */
+	size_t capacity;
+
+	/**
+	 * Buffer descriptors
+	 */
+	knx_pool_buffer* buffers;
+
+	/**
+	 * Backing storage of all buffers
+	 */
+	uint8_t* storage;
+
+	/**
+	 * Block holding `storage`, it is padded to align the buffers
+	 */
+	void* block;
+
+	/**
+	 * Allocator `buffers` and `block` have been obtained from
+	 */
+	const knx_allocator* allocator;
+
+	/**
+	 * Free list head: modification tag in the upper, buffer index + 1 in the lower 32 bits
+	 */
+	uint64_t free_head;
+
+	/**
+	 * Metrics
+	 */
+	size_t in_use, peak;
+	uint64_t acquired, exhausted;
+} knx_pool;
+
+/**
+ * Parsed KNXnet/IP Packet which keeps its buffer alive
+ */
+typedef struct {
+	/**
+	 * Buffer the packet borrows from
+	 */
+	knx_pool_buffer* buffer;
+
+	/**
+	 * Packet
+	 */
+	knx_packet packet;
+} knx_pool_packet;
+
+/**
+ * Parsed CEMI Frame which keeps its buffer alive
+ */
+typedef struct {
+	/**
+	 * Buffer the frame borrows from
+	 */
+	knx_pool_buffer* buffer;
+
+	/**
+	 * Frame
+	 */
+	knx_cemi frame;
+} knx_pool_cemi;
+
+/**
+ * Allocate the pool and all of its buffers.
+ *
+ * \param pool        Output pool
+ * \param capacity    Number of buffers
+ * \param buffer_size Size of each buffer in bytes
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_pool_init(knx_pool* pool, size_t capacity, size_t buffer_size);
+
+/**
+ * Allocate the pool and all of its buffers using the given allocator.
+ *
+ * \see knx_pool_init
+ * \param allocator Allocator (may be `NULL`), must outlive the pool
+ */
+bool knx_pool_init_with(
+	knx_pool*            pool,
+	size_t               capacity,
+	size_t               buffer_size,
+	const knx_allocator* allocator
+);
+
+/**
+ * Free the pool. No buffer may be in use.
+ */
+void knx_pool_destroy(knx_pool* pool);
+
+/**
+ * Take a buffer from the pool. Its reference count is 1 and its length 0.
+ *
+ * \returns Buffer or `NULL` if the pool is exhausted
+ */
+knx_pool_buffer* knx_pool_acquire(knx_pool* pool);
+
+/**
+ * Add a reference to the buffer.
+ */
+inline static
+void knx_pool_retain(knx_pool_buffer* buffer) {
+	__atomic_add_fetch(&buffer->refs, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * Drop a reference to the buffer. The buffer returns to its pool once the last reference has been
+ * dropped.
+ */
+void knx_pool_release(knx_pool_buffer* buffer);
+
+/**
+ * Receive a datagram directly into a buffer. The datagram is truncated if it exceeds the buffer.
+ *
+ * \param buffer         Buffer, its length is set to the number of received bytes
+ * \param fd             Socket
+ * \param flags          Flags passed to `recvfrom`
+ * \param address        Output sender address (may be `NULL`)
+ * \param address_length Size of `address`, updated with the actual size (may be `NULL`)
+ * \returns Number of received bytes or -1 (see `errno`)
+ */
+ssize_t knx_pool_receive(
+	knx_pool_buffer* buffer,
+	int              fd,
+	int              flags,
+	struct sockaddr* address,
+	socklen_t*       address_length
+);
+
+/**
+ * Parse the KNXnet/IP packet contained in the buffer in place. On success the packet holds its own
+ * reference to the buffer. Nothing is allocated; the services of a description response are stored
+ * in the unused part of the buffer.
+ *
+ * \param buffer Buffer
+ * \param output Output packet
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_pool_parse(knx_pool_buffer* buffer, knx_pool_packet* output);
+
+/**
+ * Parse the CEMI frame contained in the buffer at the given offset in place. On success the frame
+ * holds its own reference to the buffer.
+ *
+ * \param buffer Buffer
+ * \param offset Offset of the CEMI frame
+ * \param output Output frame
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_pool_parse_cemi(knx_pool_buffer* buffer, size_t offset, knx_pool_cemi* output);
+
+/**
+ * Hand another reference to the packet to a different stage.
+ */
+inline static
+void knx_pool_packet_retain(knx_pool_packet* packet) {
+	knx_pool_retain(packet->buffer);
+}
+
+/**
+ * Drop the packet's reference to its buffer. Its pointers must not be used afterwards.
+ */
+inline static
+void knx_pool_packet_release(knx_pool_packet* packet) {
+	knx_pool_release(packet->buffer);
+	packet->buffer = NULL;
+}
+
+/**
+ * Hand another reference to the frame to a different stage.
+ */
+inline static
+void knx_pool_cemi_retain(knx_pool_cemi* frame) {
+	knx_pool_retain(frame->buffer);
+}
+
+/**
+ * Drop the frame's reference to its buffer. Its pointers must not be used afterwards.
+ */
+inline static
+void knx_pool_cemi_release(knx_pool_cemi* frame) {
+	knx_pool_release(frame->buffer);
+	frame->buffer = NULL;
+}
+
+/**
+ * Snapshot of the pool metrics.
+ */
+void knx_pool_stats_get(const knx_pool* pool, knx_pool_stats* stats);
+
+#endif
@@ -0,0 +1,231 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "ring.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Identifies a ring: "KNXR"
+#define KNX_RING_MAGIC 0x4B4E5852
+
+// Both structures are mapped into foreign processes, their layout must not depend on the
+// compiler's mood.
+typedef char knx_ring_record_size_check[sizeof(knx_ring_record) == KNX_RING_RECORD_SIZE ? 1 : -1];
+typedef char knx_ring_header_size_check[sizeof(knx_ring_header) == KNX_RING_RECORD_SIZE ? 1 : -1];
+
+inline static
+uint64_t knx_ring_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+bool knx_ring_create(knx_ring* ring, const char* name, size_t capacity) {
+	if (capacity == 0 || capacity > (SIZE_MAX / KNX_RING_RECORD_SIZE) / 2)
+		return false;
+
+	// Round up to the next power of two, so the index can be masked
+	size_t real_capacity = 1;
+	while (real_capacity < capacity)
+		real_capacity <<= 1;
+
+	int fd = memfd_create(name, MFD_CLOEXEC);
+	if (fd < 0)
+		return false;
+
+	size_t map_size = sizeof(knx_ring_header) + real_capacity * sizeof(knx_ring_record);
+
+	if (ftruncate(fd, map_size) != 0) {
+		close(fd);
+		return false;
+	}
+
+	void* base = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (base == MAP_FAILED) {
+		close(fd);
+		return false;
+	}
+
+	ring->fd = fd;
+	ring->map_size = map_size;
+	ring->header = base;
+	ring->records = (knx_ring_record*) (ring->header + 1);
+
+	// The file is zero-filled, hence every record starts out with an invalid sequence number
+	ring->header->record_size = KNX_RING_RECORD_SIZE;
+	ring->header->capacity = real_capacity;
+	ring->header->head = 0;
+	__atomic_store_n(&ring->header->magic, KNX_RING_MAGIC, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+bool knx_ring_attach(knx_ring* ring, int fd) {
+	struct stat info;
+
+	if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(knx_ring_header)) {
+		close(fd);
+		return false;
+	}
+
+	size_t map_size = info.st_size;
+
+	void* base = mmap(NULL, map_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (base == MAP_FAILED) {
+		close(fd);
+		return false;
+	}
+
+	knx_ring_header* header = base;
+
+	// Verify that the producer's view matches ours
+	if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != KNX_RING_MAGIC ||
+	    header->record_size != KNX_RING_RECORD_SIZE ||
+	    header->capacity == 0 ||
+	    (header->capacity & (header->capacity - 1)) != 0 ||
+	    header->capacity > (map_size - sizeof(knx_ring_header)) / sizeof(knx_ring_record)) {
+		munmap(base, map_size);
+		close(fd);
+		return false;
+	}
+
+	ring->fd = fd;
+	ring->map_size = map_size;
+	ring->header = header;
+	ring->records = (knx_ring_record*) (header + 1);
+
+	return true;
+}
+
+void knx_ring_destroy(knx_ring* ring) {
+	if (ring->header) {
+		munmap(ring->header, ring->map_size);
+		ring->header = NULL;
+		ring->records = NULL;
+	}
+
+	if (ring->fd >= 0) {
+		close(ring->fd);
+		ring->fd = -1;
+	}
+}
+
+// Publishing follows the sequence lock pattern: invalidate the record, fill it in, validate it
+// with its new sequence number and finally advance the head.
+
+inline static
+knx_ring_record* knx_ring_begin(knx_ring* ring, uint64_t index) {
+	knx_ring_record* record = ring->records + (index & (ring->header->capacity - 1));
+
+	__atomic_store_n(&record->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	return record;
+}
+
+inline static
+void knx_ring_commit(knx_ring* ring, knx_ring_record* record, uint64_t index) {
+	__atomic_store_n(&record->seq, index + 1, __ATOMIC_RELEASE);
+	__atomic_store_n(&ring->header->head, index + 1, __ATOMIC_RELEASE);
+}
+
+bool knx_ring_publish(
+	knx_ring*          ring,
+	knx_ring_direction direction,
+	const uint8_t*     cemi,
+	size_t             length
+) {
+	if (length > KNX_RING_FRAME_SIZE)
+		return false;
+
+	uint64_t index = ring->header->head;
+	knx_ring_record* record = knx_ring_begin(ring, index);
+
+	record->timestamp = knx_ring_now();
+	record->direction = direction;
+	record->length = length;
+	memcpy(record->data, cemi, length);
+
+	knx_ring_commit(ring, record, index);
+
+	return true;
+}
+
+bool knx_ring_publish_cemi(knx_ring* ring, knx_ring_direction direction, const knx_cemi* cemi) {
+	size_t length = knx_cemi_size(cemi);
+
+	if (length == 0 || length > KNX_RING_FRAME_SIZE)
+		return false;
+
+	// Generate before claiming a record, a failure must not invalidate one readers may still use
+	uint8_t frame[KNX_RING_FRAME_SIZE];
+
+	if (!knx_cemi_generate(frame, cemi))
+		return false;
+
+	return knx_ring_publish(ring, direction, frame, length);
+}
+
+void knx_ring_reader_init(knx_ring_reader* reader, const knx_ring* ring) {
+	reader->ring = ring;
+	reader->position = __atomic_load_n(&ring->header->head, __ATOMIC_ACQUIRE);
+	reader->lost = 0;
+}
+
+const knx_ring_record* knx_ring_read(knx_ring_reader* reader) {
+	const knx_ring_header* header = reader->ring->header;
+	uint64_t capacity = header->capacity;
+
+	for (;;) {
+		uint64_t head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+
+		if (reader->position == head)
+			return NULL;
+
+		// The producer has lapped us, skip what has been overwritten
+		if (head - reader->position > capacity) {
+			reader->lost += head - reader->position - capacity;
+			reader->position = head - capacity;
+		}
+
+		const knx_ring_record* record =
+			reader->ring->records + (reader->position & (capacity - 1));
+
+		uint64_t seq = __atomic_load_n(&record->seq, __ATOMIC_ACQUIRE);
+		reader->position++;
+
+		if (seq == reader->position)
+			return record;
+
+		// Record is being rewritten right now
+		reader->lost++;
+	}
+}
+
+bool knx_ring_reader_valid(const knx_ring_reader* reader, const knx_ring_record* record) {
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return __atomic_load_n(&record->seq, __ATOMIC_RELAXED) == reader->position;
+}
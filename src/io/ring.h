@@ -0,0 +1,246 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_IO_RING_H_
+#define KNXPROTO_IO_RING_H_
+
+#include "../proto/cemi.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Size of a single ring record in bytes
+ */
+#define KNX_RING_RECORD_SIZE 64
+
+/**
+ * Maximum number of raw CEMI bytes a ring record can hold
+ */
+#define KNX_RING_FRAME_SIZE (KNX_RING_RECORD_SIZE - 18)
+
+/**
+ * Direction of a telegram relative to the publishing process
+ */
+typedef enum {
+	KNX_RING_RECEIVED = 0,
+	KNX_RING_SENT     = 1
+} knx_ring_direction;
+
+/**
+ * Ring Record
+ */
+typedef struct {
+	/**
+	 * Publication index + 1, `0` while the record is being written
+	 */
+	uint64_t seq;
+
+	/**
+	 * Time of publication in nanoseconds since the epoch
+	 */
+	uint64_t timestamp;
+
+	/**
+	 * Direction of the telegram
+	 * \see knx_ring_direction
+	 */
+	uint8_t direction;
+
+	/**
+	 * Number of bytes in `data`
+	 */
+	uint8_t length;
+
+	/**
+	 * Raw CEMI frame
+	 */
+	uint8_t data[KNX_RING_FRAME_SIZE];
+} knx_ring_record;
+
+/**
+ * Ring Header
+ * \note Located at the start of the shared memory region.
+ */
+typedef struct {
+	/**
+	 * Identifies a valid ring
+	 */
+	uint32_t magic;
+
+	/**
+	 * Record size the producer has been built with
+	 */
+	uint32_t record_size;
+
+	/**
+	 * Number of records (power of two)
+	 */
+	uint64_t capacity;
+
+	/**
+	 * Number of records published so far
+	 */
+	uint64_t head;
+
+	/**
+	 * Pad the header to a full record, so records stay cache line aligned
+	 */
+	uint8_t reserved[KNX_RING_RECORD_SIZE - 24];
+} knx_ring_header;
+
+/**
+ * Shared Telegram Ring
+ *
+ * A single producer publishes every CEMI frame into a memfd-backed ring of fixed-size records.
+ * Any number of consumers map the same file descriptor read-only and follow the producer with
+ * their own `knx_ring_reader`. Slow consumers are overrun and skip ahead instead of stalling the
+ * producer.
+ */
+typedef struct {
+	/**
+	 * Backing file descriptor; hand this to consumers (e.g. via `SCM_RIGHTS`)
+	 */
+	int fd;
+
+	/**
+	 * Size of the mapping in bytes
+	 */
+	size_t map_size;
+
+	/**
+	 * Shared header
+	 */
+	knx_ring_header* header;
+
+	/**
+	 * Record array
+	 */
+	knx_ring_record* records;
+} knx_ring;
+
+/**
+ * Ring Reader
+ */
+typedef struct {
+	/**
+	 * Ring to read from
+	 */
+	const knx_ring* ring;
+
+	/**
+	 * Index of the next record to be read
+	 */
+	uint64_t position;
+
+	/**
+	 * Number of records that have been overwritten before they could be read
+	 */
+	uint64_t lost;
+} knx_ring_reader;
+
+/**
+ * Create a new ring as its producer.
+ *
+ * \param ring     Output ring
+ * \param name     Name of the memfd (only used for debugging purposes)
+ * \param capacity Number of records, will be rounded up to the next power of two
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_ring_create(knx_ring* ring, const char* name, size_t capacity);
+
+/**
+ * Attach to an existing ring as a consumer. The ring is mapped read-only.
+ *
+ * \param ring Output ring
+ * \param fd   File descriptor obtained from the producer, ownership is transferred to `ring`
+ *             (it is closed if attaching fails)
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_ring_attach(knx_ring* ring, int fd);
+
+/**
+ * Unmap the ring and close its file descriptor.
+ */
+void knx_ring_destroy(knx_ring* ring);
+
+/**
+ * Publish a raw CEMI frame.
+ *
+ * \param ring      Producer ring
+ * \param direction Direction of the telegram
+ * \param cemi      Raw CEMI frame
+ * \param length    Number of bytes in `cemi`
+ * \returns `true` if the frame has been published, `false` if it does not fit into a record
+ */
+bool knx_ring_publish(
+	knx_ring*          ring,
+	knx_ring_direction direction,
+	const uint8_t*     cemi,
+	size_t             length
+);
+
+/**
+ * Generate a CEMI frame directly into the next record and publish it.
+ *
+ * \param ring      Producer ring
+ * \param direction Direction of the telegram
+ * \param cemi      Source frame
+ * \returns `true` if the frame has been published, otherwise `false`
+ */
+bool knx_ring_publish_cemi(knx_ring* ring, knx_ring_direction direction, const knx_cemi* cemi);
+
+/**
+ * Start reading at the current head of the ring, i.e. only records published from now on will
+ * be seen.
+ */
+void knx_ring_reader_init(knx_ring_reader* reader, const knx_ring* ring);
+
+/**
+ * Retrieve the next record.
+ *
+ * \note The record lives in shared memory and may be overwritten by the producer at any time.
+ *       Check `knx_ring_reader_valid` after you are done with it.
+ * \param reader Reader
+ * \returns Pointer to the record or `NULL` if no new record is available
+ */
+const knx_ring_record* knx_ring_read(knx_ring_reader* reader);
+
+/**
+ * Check whether the record last returned by `knx_ring_read` is still intact, i.e. everything
+ * that has been derived from it is trustworthy.
+ */
+bool knx_ring_reader_valid(const knx_ring_reader* reader, const knx_ring_record* record);
+
+/**
+ * Parse the CEMI frame contained in a record. The resulting frame refers to the record's data.
+ *
+ * \param record Ring record
+ * \param frame  Output frame
+ * \returns `true` if parsing was successful, otherwise `false`
+ */
+inline static
+bool knx_ring_record_parse(const knx_ring_record* record, knx_cemi* frame) {
+	return knx_cemi_parse(record->data, record->length, frame);
+}
+
+#endif
@@ -0,0 +1,716 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "series.h"
+
+#include <math.h>
+#include <string.h>
+
+// Initial size of a bit stream in bytes
+#define KNX_SERIES_INITIAL_BYTES 16
+
+// Marks the XOR window of a block as unset
+#define KNX_SERIES_NO_WINDOW 0xFF
+
+typedef struct {
+	const uint8_t* data;
+	size_t position;
+} knx_series_reader;
+
+typedef struct {
+	const knx_series_block* block;
+	bool boolean;
+
+	knx_series_reader times;
+	knx_series_reader values;
+
+	uint32_t index;
+	uint64_t time;
+	int64_t delta;
+
+	uint64_t value;
+	uint8_t leading, trailing;
+	uint32_t run;
+} knx_series_cursor;
+
+inline static
+uint64_t knx_series_double_bits(double value) {
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+inline static
+double knx_series_bits_double(uint64_t bits) {
+	double value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static
+bool knx_series_bits_reserve(
+	const knx_allocator* allocator,
+	knx_series_bits*     bits,
+	size_t               count
+) {
+	size_t required = (bits->bits + count + 7) / 8;
+
+	if (required <= bits->capacity)
+		return true;
+
+	size_t capacity = bits->capacity > 0 ? bits->capacity : KNX_SERIES_INITIAL_BYTES;
+	while (capacity < required)
+		capacity *= 2;
+
+	uint8_t* data = knx_allocator_resize(allocator, bits->data, bits->capacity, capacity);
+	if (!data)
+		return false;
+
+	memset(data + bits->capacity, 0, capacity - bits->capacity);
+
+	bits->data = data;
+	bits->capacity = capacity;
+
+	return true;
+}
+
+// Space must have been reserved
+static
+void knx_series_bits_write(knx_series_bits* bits, uint64_t value, unsigned int count) {
+	while (count > 0) {
+		unsigned int room = 8 - (bits->bits & 7);
+		unsigned int take = count < room ? count : room;
+
+		uint8_t chunk = (value >> (count - take)) & ((1u << take) - 1);
+		bits->data[bits->bits >> 3] |= chunk << (room - take);
+
+		bits->bits += take;
+		count -= take;
+	}
+}
+
+static
+void knx_series_bits_shrink(const knx_allocator* allocator, knx_series_bits* bits) {
+	size_t size = (bits->bits + 7) / 8;
+
+	// Other allocators keep the block when shrinking, so the unused tail would not be returned
+	if (allocator && allocator != &knx_allocator_default)
+		return;
+
+	if (size == 0 || size == bits->capacity)
+		return;
+
+	uint8_t* data = knx_allocator_resize(allocator, bits->data, bits->capacity, size);
+	if (data) {
+		bits->data = data;
+		bits->capacity = size;
+	}
+}
+
+static
+uint64_t knx_series_read(knx_series_reader* reader, unsigned int count) {
+	uint64_t value = 0;
+
+	while (count > 0) {
+		unsigned int room = 8 - (reader->position & 7);
+		unsigned int take = count < room ? count : room;
+
+		uint8_t byte = reader->data[reader->position >> 3];
+		value = (value << take) | ((byte >> (room - take)) & ((1u << take) - 1));
+
+		reader->position += take;
+		count -= take;
+	}
+
+	return value;
+}
+
+// Variable-length integer: groups of 7 bits, each preceded by a continuation bit
+inline static
+unsigned int knx_series_varint_size(uint32_t value) {
+	unsigned int size = 8;
+
+	while (value >= 0x80) {
+		value >>= 7;
+		size += 8;
+	}
+
+	return size;
+}
+
+static
+void knx_series_varint_write(knx_series_bits* bits, uint32_t value) {
+	while (value >= 0x80) {
+		knx_series_bits_write(bits, 0x80 | (value & 0x7F), 8);
+		value >>= 7;
+	}
+
+	knx_series_bits_write(bits, value, 8);
+}
+
+static
+uint32_t knx_series_varint_read(knx_series_reader* reader) {
+	uint32_t value = 0;
+	unsigned int shift = 0;
+	uint64_t group;
+
+	do {
+		group = knx_series_read(reader, 8);
+		value |= (uint32_t) (group & 0x7F) << shift;
+		shift += 7;
+	} while (group & 0x80);
+
+	return value;
+}
+
+static
+bool knx_series_write_time(
+	const knx_allocator* allocator,
+	knx_series_block*    block,
+	uint64_t             time
+) {
+	int64_t delta = (int64_t) (time - block->last_time);
+	int64_t dod = delta - block->delta;
+
+	if (!knx_series_bits_reserve(allocator, &block->times, 68))
+		return false;
+
+	if (dod == 0) {
+		knx_series_bits_write(&block->times, 0, 1);
+	} else if (dod >= -63 && dod <= 64) {
+		knx_series_bits_write(&block->times, 2, 2);
+		knx_series_bits_write(&block->times, dod + 63, 7);
+	} else if (dod >= -255 && dod <= 256) {
+		knx_series_bits_write(&block->times, 6, 3);
+		knx_series_bits_write(&block->times, dod + 255, 9);
+	} else if (dod >= -2047 && dod <= 2048) {
+		knx_series_bits_write(&block->times, 14, 4);
+		knx_series_bits_write(&block->times, dod + 2047, 12);
+	} else {
+		knx_series_bits_write(&block->times, 15, 4);
+		knx_series_bits_write(&block->times, (uint64_t) dod, 64);
+	}
+
+	block->delta = delta;
+	block->last_time = time;
+
+	return true;
+}
+
+static
+int64_t knx_series_read_dod(knx_series_reader* reader) {
+	if (knx_series_read(reader, 1) == 0)
+		return 0;
+
+	if (knx_series_read(reader, 1) == 0)
+		return (int64_t) knx_series_read(reader, 7) - 63;
+
+	if (knx_series_read(reader, 1) == 0)
+		return (int64_t) knx_series_read(reader, 9) - 255;
+
+	if (knx_series_read(reader, 1) == 0)
+		return (int64_t) knx_series_read(reader, 12) - 2047;
+
+	return (int64_t) knx_series_read(reader, 64);
+}
+
+static
+bool knx_series_write_xor(
+	const knx_allocator* allocator,
+	knx_series_block*    block,
+	uint64_t             bits
+) {
+	if (!knx_series_bits_reserve(allocator, &block->values, 77))
+		return false;
+
+	uint64_t diff = bits ^ block->value;
+
+	if (diff == 0) {
+		knx_series_bits_write(&block->values, 0, 1);
+		return true;
+	}
+
+	unsigned int leading = __builtin_clzll(diff);
+	unsigned int trailing = __builtin_ctzll(diff);
+
+	if (leading > 31)
+		leading = 31;
+
+	if (block->leading != KNX_SERIES_NO_WINDOW &&
+	    leading >= block->leading && trailing >= block->trailing) {
+		// Meaningful bits fit into the previous window
+		knx_series_bits_write(&block->values, 2, 2);
+		knx_series_bits_write(&block->values, diff >> block->trailing,
+		                      64 - block->leading - block->trailing);
+	} else {
+		unsigned int length = 64 - leading - trailing;
+
+		knx_series_bits_write(&block->values, 3, 2);
+		knx_series_bits_write(&block->values, leading, 5);
+		knx_series_bits_write(&block->values, length - 1, 6);
+		knx_series_bits_write(&block->values, diff >> trailing, length);
+
+		block->leading = leading;
+		block->trailing = trailing;
+	}
+
+	return true;
+}
+
+static
+bool knx_series_write_bool(
+	const knx_allocator* allocator,
+	knx_series_block*    block,
+	uint64_t             bits
+) {
+	if (bits == block->value) {
+		block->run++;
+		return true;
+	}
+
+	// Runs alternate between both values, hence only their lengths are written
+	if (!knx_series_bits_reserve(allocator, &block->values, knx_series_varint_size(block->run)))
+		return false;
+
+	knx_series_varint_write(&block->values, block->run);
+	block->run = 1;
+
+	return true;
+}
+
+static
+knx_series_block* knx_series_block_new(
+	const knx_allocator* allocator,
+	bool                 boolean,
+	uint64_t             time,
+	double               value
+) {
+	knx_series_block* block = knx_allocator_alloc(allocator, sizeof(knx_series_block));
+	if (!block)
+		return NULL;
+
+	memset(block, 0, sizeof(knx_series_block));
+
+	block->first_time = block->last_time = time;
+	block->count = 1;
+	block->min = block->max = block->sum = value;
+	block->value = knx_series_double_bits(value);
+	block->leading = block->trailing = KNX_SERIES_NO_WINDOW;
+
+	// The first value is stored in full
+	bool written;
+	if (boolean) {
+		written = knx_series_bits_reserve(allocator, &block->values, 1);
+		if (written)
+			knx_series_bits_write(&block->values, value != 0, 1);
+
+		block->value = knx_series_double_bits(value != 0);
+		block->run = 1;
+	} else {
+		written = knx_series_bits_reserve(allocator, &block->values, 64);
+		if (written)
+			knx_series_bits_write(&block->values, block->value, 64);
+	}
+
+	if (!written) {
+		knx_allocator_free(allocator, block);
+		return NULL;
+	}
+
+	return block;
+}
+
+static
+void knx_series_block_seal(const knx_allocator* allocator, knx_series_block* block) {
+	knx_series_bits_shrink(allocator, &block->times);
+	knx_series_bits_shrink(allocator, &block->values);
+}
+
+static
+void knx_series_block_free(const knx_allocator* allocator, knx_series_block* block) {
+	if (block->times.data)
+		knx_allocator_free(allocator, block->times.data);
+
+	if (block->values.data)
+		knx_allocator_free(allocator, block->values.data);
+
+	knx_allocator_free(allocator, block);
+}
+
+inline static
+bool knx_series_numeric(knx_dpt type) {
+	knx_dpt_value zero;
+	double number;
+
+	memset(&zero, 0, sizeof(zero));
+	return knx_dpt_value_number(type, &zero, &number);
+}
+
+void knx_series_init(knx_series* series, uint64_t resolution) {
+	knx_series_init_with(series, resolution, NULL);
+}
+
+void knx_series_init_with(knx_series* series, uint64_t resolution, const knx_allocator* allocator) {
+	memset(series, 0, sizeof(knx_series));
+	series->resolution = resolution > 0 ? resolution : 1;
+	series->allocator = allocator;
+}
+
+void knx_series_destroy(knx_series* series) {
+	for (size_t i = 0; i < KNX_GROUP_INDEX_SIZE; i++) {
+		knx_series_column* column = series->columns[i];
+		if (!column)
+			continue;
+
+		knx_series_block* block = column->head;
+		while (block) {
+			knx_series_block* next = block->next;
+			knx_series_block_free(series->allocator, block);
+			block = next;
+		}
+
+		knx_allocator_free(series->allocator, column);
+		series->columns[i] = NULL;
+	}
+}
+
+bool knx_series_append(
+	knx_series* series,
+	knx_addr    group,
+	knx_dpt     type,
+	uint64_t    timestamp,
+	double      value
+) {
+	if (group >= KNX_GROUP_INDEX_SIZE || !knx_series_numeric(type) || isnan(value))
+		return false;
+
+	knx_series_column* column = series->columns[group];
+	if (!column) {
+		column = knx_allocator_alloc(series->allocator, sizeof(knx_series_column));
+		if (!column)
+			return false;
+
+		column->type = type;
+		column->head = column->tail = NULL;
+		column->count = 0;
+
+		series->columns[group] = column;
+	} else if (column->type != type) {
+		return false;
+	}
+
+	uint64_t time = timestamp / series->resolution;
+	bool boolean = type == KNX_DPT_BOOL;
+	knx_series_block* block = column->tail;
+
+	if (block && time < block->last_time)
+		return false;
+
+	if (!block || block->count >= KNX_SERIES_BLOCK_SAMPLES) {
+		knx_series_block* fresh = knx_series_block_new(series->allocator, boolean, time, value);
+		if (!fresh)
+			return false;
+
+		if (block) {
+			knx_series_block_seal(series->allocator, block);
+			block->next = fresh;
+		} else {
+			column->head = fresh;
+		}
+
+		column->tail = fresh;
+		column->count++;
+
+		return true;
+	}
+
+	uint64_t bits = knx_series_double_bits(boolean ? value != 0 : value);
+
+	// Both streams must be able to take the sample before either is modified
+	const knx_allocator* allocator = series->allocator;
+
+	if (!knx_series_bits_reserve(allocator, &block->times, 68) ||
+	    !(boolean ? knx_series_bits_reserve(allocator, &block->values,
+	                                        knx_series_varint_size(block->run))
+	              : knx_series_bits_reserve(allocator, &block->values, 77)))
+		return false;
+
+	knx_series_write_time(allocator, block, time);
+
+	if (boolean)
+		knx_series_write_bool(allocator, block, bits);
+	else
+		knx_series_write_xor(allocator, block, bits);
+
+	if (boolean)
+		value = value != 0;
+
+	block->value = bits;
+	block->count++;
+
+	if (value < block->min)
+		block->min = value;
+
+	if (value > block->max)
+		block->max = value;
+
+	block->sum += value;
+	column->count++;
+
+	return true;
+}
+
+bool knx_series_append_ldata(
+	knx_series*      series,
+	uint64_t         timestamp,
+	const knx_ldata* ldata,
+	knx_dpt          type
+) {
+	if (ldata->control2.address_type != KNX_LDATA_ADDR_GROUP ||
+	    ldata->tpdu.tpci != KNX_TPCI_UNNUMBERED_DATA)
+		return false;
+
+	knx_apci apci = ldata->tpdu.info.data.apci;
+	if (apci != KNX_APCI_GROUPVALUEWRITE && apci != KNX_APCI_GROUPVALUERESPONSE)
+		return false;
+
+	knx_dpt_value value;
+	double number;
+
+	if (!knx_dpt_from_apdu(ldata->tpdu.info.data.payload, ldata->tpdu.info.data.length,
+	                       type, &value) ||
+	    !knx_dpt_value_number(type, &value, &number))
+		return false;
+
+	return knx_series_append(series, ldata->destination, type, timestamp, number);
+}
+
+static
+void knx_series_cursor_init(
+	knx_series_cursor*      cursor,
+	const knx_series_block* block,
+	bool                    boolean
+) {
+	cursor->block = block;
+	cursor->boolean = boolean;
+
+	cursor->times.data = block->times.data;
+	cursor->times.position = 0;
+	cursor->values.data = block->values.data;
+	cursor->values.position = 0;
+
+	cursor->index = 0;
+	cursor->time = block->first_time;
+	cursor->delta = 0;
+
+	cursor->leading = cursor->trailing = 0;
+	cursor->run = 0;
+}
+
+// Decodes the next sample, there must be one
+static
+double knx_series_cursor_next(knx_series_cursor* cursor) {
+	const knx_series_block* block = cursor->block;
+
+	if (cursor->index > 0) {
+		cursor->delta += knx_series_read_dod(&cursor->times);
+		cursor->time += cursor->delta;
+	}
+
+	if (cursor->boolean) {
+		if (cursor->index == 0) {
+			cursor->value = knx_series_read(&cursor->values, 1);
+		} else if (cursor->run == 0) {
+			cursor->value ^= 1;
+		}
+
+		if (cursor->run == 0) {
+			// The last run has not been written yet
+			cursor->run = cursor->values.position < block->values.bits
+				? knx_series_varint_read(&cursor->values)
+				: block->run;
+		}
+
+		cursor->run--;
+		cursor->index++;
+
+		return cursor->value;
+	}
+
+	if (cursor->index == 0) {
+		cursor->value = knx_series_read(&cursor->values, 64);
+	} else if (knx_series_read(&cursor->values, 1) == 1) {
+		if (knx_series_read(&cursor->values, 1) == 1) {
+			cursor->leading = knx_series_read(&cursor->values, 5);
+			unsigned int length = knx_series_read(&cursor->values, 6) + 1;
+			cursor->trailing = 64 - cursor->leading - length;
+		}
+
+		unsigned int length = 64 - cursor->leading - cursor->trailing;
+		cursor->value ^= knx_series_read(&cursor->values, length) << cursor->trailing;
+	}
+
+	cursor->index++;
+
+	return knx_series_bits_double(cursor->value);
+}
+
+size_t knx_series_scan(
+	const knx_series*  series,
+	knx_addr           group,
+	uint64_t           from,
+	uint64_t           to,
+	knx_series_visitor visitor,
+	void*              data
+) {
+	if (group >= KNX_GROUP_INDEX_SIZE || !series->columns[group] || from > to)
+		return 0;
+
+	const knx_series_column* column = series->columns[group];
+	uint64_t resolution = series->resolution;
+	size_t visited = 0;
+
+	for (const knx_series_block* block = column->head; block; block = block->next) {
+		if (block->last_time * resolution < from)
+			continue;
+
+		if (block->first_time * resolution > to)
+			break;
+
+		knx_series_cursor cursor;
+		knx_series_cursor_init(&cursor, block, column->type == KNX_DPT_BOOL);
+
+		while (cursor.index < block->count) {
+			double value = knx_series_cursor_next(&cursor);
+			uint64_t timestamp = cursor.time * resolution;
+
+			if (timestamp < from)
+				continue;
+
+			if (timestamp > to)
+				return visited;
+
+			visited++;
+
+			if (!visitor(timestamp, value, data))
+				return visited;
+		}
+	}
+
+	return visited;
+}
+
+inline static
+void knx_series_aggregate_add(knx_series_aggregate* aggregate, double value) {
+	if (aggregate->count == 0 || value < aggregate->min)
+		aggregate->min = value;
+
+	if (aggregate->count == 0 || value > aggregate->max)
+		aggregate->max = value;
+
+	aggregate->sum += value;
+	aggregate->last = value;
+	aggregate->count++;
+}
+
+void knx_series_downsample(
+	const knx_series*     series,
+	knx_addr              group,
+	uint64_t              from,
+	uint64_t              interval,
+	knx_series_aggregate* aggregates,
+	size_t                count
+) {
+	for (size_t i = 0; i < count; i++) {
+		aggregates[i].start = from + i * interval;
+		aggregates[i].count = 0;
+		aggregates[i].min = aggregates[i].max = aggregates[i].last = NAN;
+		aggregates[i].sum = 0;
+	}
+
+	if (group >= KNX_GROUP_INDEX_SIZE || !series->columns[group] || interval == 0 || count == 0)
+		return;
+
+	const knx_series_column* column = series->columns[group];
+	uint64_t resolution = series->resolution;
+	uint64_t end = from + count * interval;
+
+	for (const knx_series_block* block = column->head; block; block = block->next) {
+		uint64_t first = block->first_time * resolution;
+		uint64_t last = block->last_time * resolution;
+
+		if (last < from)
+			continue;
+
+		if (first >= end)
+			break;
+
+		if (first >= from && last < end &&
+		    (first - from) / interval == (last - from) / interval) {
+			knx_series_aggregate* aggregate = aggregates + (first - from) / interval;
+
+			if (aggregate->count == 0 || block->min < aggregate->min)
+				aggregate->min = block->min;
+
+			if (aggregate->count == 0 || block->max > aggregate->max)
+				aggregate->max = block->max;
+
+			aggregate->sum += block->sum;
+			aggregate->last = knx_series_bits_double(block->value);
+			aggregate->count += block->count;
+
+			continue;
+		}
+
+		knx_series_cursor cursor;
+		knx_series_cursor_init(&cursor, block, column->type == KNX_DPT_BOOL);
+
+		while (cursor.index < block->count) {
+			double value = knx_series_cursor_next(&cursor);
+			uint64_t timestamp = cursor.time * resolution;
+
+			if (timestamp < from)
+				continue;
+
+			if (timestamp >= end)
+				return;
+
+			knx_series_aggregate_add(aggregates + (timestamp - from) / interval, value);
+		}
+	}
+}
+
+size_t knx_series_memory(const knx_series* series) {
+	size_t memory = 0;
+
+	for (size_t i = 0; i < KNX_GROUP_INDEX_SIZE; i++) {
+		const knx_series_column* column = series->columns[i];
+		if (!column)
+			continue;
+
+		memory += sizeof(knx_series_column);
+
+		for (const knx_series_block* block = column->head; block; block = block->next)
+			memory += sizeof(knx_series_block) + block->times.capacity + block->values.capacity;
+	}
+
+	return memory;
+}
@@ -0,0 +1,296 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_IO_SERIES_H_
+#define KNXPROTO_IO_SERIES_H_
+
+#include "../proto/data.h"
+#include "../proto/ldata.h"
+#include "../proto/groupindex.h"
+#include "../util/allocator.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Maximum number of samples per block
+ */
+#define KNX_SERIES_BLOCK_SAMPLES 1024
+
+/**
+ * Growable Bit Stream
+ */
+typedef struct {
+	/**
+	 * Bytes, bits are filled from the most significant one
+	 */
+	uint8_t* data;
+
+	/**
+	 * Number of bits written
+	 */
+	size_t bits;
+
+	/**
+	 * Number of bytes allocated
+	 */
+	size_t capacity;
+} knx_series_bits;
+
+/**
+ * Block of Samples
+ *
+ * Timestamps and values are stored in separate bit streams. Timestamps are encoded as
+ * delta-of-delta, floating-point values as XOR with their predecessor and booleans as runs.
+ */
+typedef struct knx_series_block {
+	/**
+	 * Next (newer) block
+	 */
+	struct knx_series_block* next;
+
+	/**
+	 * Timestamp of the first and last sample in units of the series resolution
+	 */
+	uint64_t first_time, last_time;
+
+	/**
+	 * Number of samples
+	 */
+	uint32_t count;
+
+	/**
+	 * Aggregates over all samples
+	 */
+	double min, max, sum;
+
+	/**
+	 * Encoded timestamps
+	 */
+	knx_series_bits times;
+
+	/**
+	 * Encoded values
+	 */
+	knx_series_bits values;
+
+	/**
+	 * Encoder state: previous timestamp delta
+	 */
+	int64_t delta;
+
+	/**
+	 * Encoder state: bits of the previous value
+	 */
+	uint64_t value;
+
+	/**
+	 * Encoder state: leading and trailing zeros of the previous XOR
+	 */
+	uint8_t leading, trailing;
+
+	/**
+	 * Encoder state: length of the current boolean run (it has not been written yet)
+	 */
+	uint32_t run;
+} knx_series_block;
+
+/**
+ * Samples of a Group Address
+ */
+typedef struct {
+	/**
+	 * Datapoint type of the values
+	 */
+	knx_dpt type;
+
+	/**
+	 * Oldest and newest block
+	 */
+	knx_series_block* head, * tail;
+
+	/**
+	 * Number of samples
+	 */
+	uint64_t count;
+} knx_series_column;
+
+/**
+ * Time Series Store
+ *
+ * Keeps decoded numeric group values in compressed, append-only columns per group address.
+ */
+typedef struct {
+	/**
+	 * Timestamp resolution in nanoseconds, timestamps are truncated to a multiple of it
+	 */
+	uint64_t resolution;
+
+	/**
+	 * Allocator columns and blocks are obtained from
+	 */
+	const knx_allocator* allocator;
+
+	/**
+	 * Columns indexed by group address, allocated on the first append
+	 */
+	knx_series_column* columns[KNX_GROUP_INDEX_SIZE];
+} knx_series;
+
+/**
+ * Scan visitor
+ *
+ * \param timestamp Time of the sample in nanoseconds
+ * \param value     Value
+ * \param data      User data
+ * \returns `false` to stop the scan
+ */
+typedef bool (* knx_series_visitor)(uint64_t timestamp, double value, void* data);
+
+/**
+ * Aggregate over an interval
+ */
+typedef struct {
+	/**
+	 * Start of the interval in nanoseconds
+	 */
+	uint64_t start;
+
+	/**
+	 * Number of samples in the interval
+	 */
+	uint64_t count;
+
+	/**
+	 * Smallest, largest and last value (only meaningful if `count` is not 0)
+	 */
+	double min, max, last;
+
+	/**
+	 * Sum of the values
+	 */
+	double sum;
+} knx_series_aggregate;
+
+/**
+ * Initialize the store.
+ *
+ * \param series     Output store
+ * \param resolution Timestamp resolution in nanoseconds (e.g. 1000000 for milliseconds)
+ */
+void knx_series_init(knx_series* series, uint64_t resolution);
+
+/**
+ * Initialize the store using the given allocator for its samples. Sealed blocks are only trimmed
+ * by the default allocator.
+ *
+ * \see knx_series_init
+ * \param allocator Allocator (may be `NULL`), must outlive the store
+ */
+void knx_series_init_with(knx_series* series, uint64_t resolution, const knx_allocator* allocator);
+
+/**
+ * Free all samples.
+ */
+void knx_series_destroy(knx_series* series);
+
+/**
+ * Append a sample. Samples of a group address must be appended in chronological order.
+ *
+ * \param series    Store
+ * \param group     Group address
+ * \param type      Datapoint type, must not change between samples of the same group address
+ * \param timestamp Time in nanoseconds
+ * \param value     Value
+ * \returns `true` on success, `false` if the sample is out of order, the type differs or memory
+ *          is exhausted
+ */
+bool knx_series_append(
+	knx_series* series,
+	knx_addr    group,
+	knx_dpt     type,
+	uint64_t    timestamp,
+	double      value
+);
+
+/**
+ * Decode a GroupValueWrite or GroupValueResponse and append its value.
+ *
+ * \param series    Store
+ * \param timestamp Time in nanoseconds
+ * \param ldata     L_Data frame
+ * \param type      Datapoint type of the destination group, must be numeric
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_series_append_ldata(
+	knx_series*      series,
+	uint64_t         timestamp,
+	const knx_ldata* ldata,
+	knx_dpt          type
+);
+
+/**
+ * Visit the samples of a group address within a time range in chronological order.
+ *
+ * \param series  Store
+ * \param group   Group address
+ * \param from    Lower time bound in nanoseconds (inclusive)
+ * \param to      Upper time bound in nanoseconds (inclusive)
+ * \param visitor Function to be invoked for each sample
+ * \param data    User data passed to `visitor`
+ * \returns Number of visited samples
+ */
+size_t knx_series_scan(
+	const knx_series*  series,
+	knx_addr           group,
+	uint64_t           from,
+	uint64_t           to,
+	knx_series_visitor visitor,
+	void*              data
+);
+
+/**
+ * Aggregate the samples of a group address into intervals of equal length. Blocks which fall
+ * into a single interval entirely are aggregated without decoding them.
+ *
+ * \param series     Store
+ * \param group      Group address
+ * \param from       Start of the first interval in nanoseconds
+ * \param interval   Length of each interval in nanoseconds
+ * \param aggregates Output aggregates
+ * \param count      Number of intervals
+ */
+void knx_series_downsample(
+	const knx_series*     series,
+	knx_addr              group,
+	uint64_t              from,
+	uint64_t              interval,
+	knx_series_aggregate* aggregates,
+	size_t                count
+);
+
+/**
+ * Number of bytes used to store the samples.
+ */
+size_t knx_series_memory(const knx_series* series);
+
+#endif
@@ -20,278 +20,297 @@
  */
 
 #include "data.h"
+#include "dptcodec.h"
 
-#include <math.h>
-#include <string.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#include <immintrin.h>
 
-inline static
-bool knx_dpt_bool_parse(const uint8_t* apdu, size_t length, knx_bool* value) {
-	if (length != 1)
-		return false;
+	#define KNX_DPT_FLOAT16_SIMD
+#endif
 
-	*value = *apdu & 1;
+// Lookup table installed by `knx_dpt_use_float16_table`
+static
+const knx_float16* knx_dpt_float16_table = NULL;
 
-	return true;
+void knx_dpt_use_float16_table(const knx_float16* table) {
+	__atomic_store_n(&knx_dpt_float16_table, table, __ATOMIC_RELEASE);
 }
 
 inline static
-bool knx_dpt_cvalue_parse(const uint8_t* apdu, size_t length, knx_cvalue* value) {
-	if (length != 1)
+bool knx_dpt_float16_parse(const uint8_t* apdu, size_t length, knx_float16* value) {
+	const knx_float16* table = __atomic_load_n(&knx_dpt_float16_table, __ATOMIC_ACQUIRE);
+
+	if (!table)
+		return knx_dpt_decode_float16(apdu, length, value);
+
+	if (length != KNX_DPT_FLOAT16_SIZE)
 		return false;
 
-	value->control = *apdu >> 1 & 1;
-	value->value = *apdu & 1;
+	*value = table[apdu[1] << 8 | apdu[2]];
 
 	return true;
 }
 
-inline static
-bool knx_dpt_cstep_parse(const uint8_t* apdu, size_t length, knx_cstep* value) {
-	if (length != 1)
-		return false;
+#ifdef KNX_DPT_FLOAT16_SIMD
 
-	value->control = *apdu >> 3 & 1;
-	value->step = *apdu & 7;
+// Both vector paths compute m * 2^e exactly and then perform the same double precision scaling
+// and rounding as `knx_dpt_float16_decode`, hence their results are bit-identical.
 
-	return true;
-}
+__attribute__((target("avx2")))
+static
+size_t knx_dpt_float16_decode_avx2(const uint8_t* raw, size_t count, knx_float16* values) {
+	const __m128i swap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+	const __m256d scale = _mm256_set1_pd(0.01);
 
-inline static
-bool knx_dpt_float16_parse(const uint8_t* apdu, size_t length, knx_float16* value) {
-	if (length != 3)
-		return false;
+	size_t i = 0;
 
-	// Mantissa
-	int16_t m = (apdu[1] & 7) << 8 | apdu[2];
+	for (; i + 8 <= count; i += 8) {
+		// Eight big-endian values
+		__m128i words = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (raw + 2 * i)), swap);
+		__m256i v = _mm256_cvtepu16_epi32(words);
 
-	// Signed?
-	if (apdu[1] & 128)
-		m -= 2048;
+		__m256i m = _mm256_sub_epi32(
+			_mm256_and_si256(v, _mm256_set1_epi32(0x7FF)),
+			_mm256_and_si256(_mm256_srli_epi32(v, 4), _mm256_set1_epi32(0x800))
+		);
+		__m256i e = _mm256_and_si256(_mm256_srli_epi32(v, 11), _mm256_set1_epi32(15));
+		__m256i x = _mm256_sllv_epi32(m, e);
 
-	// Exponent
-	uint16_t e = apdu[1] >> 3 & 15;
+		__m128 lo = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(x)), scale));
+		__m128 hi = _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(x, 1)), scale));
 
-	*value = 0.01 * ((float) m) * exp2f(e);
+		_mm_storeu_ps(values + i, lo);
+		_mm_storeu_ps(values + i + 4, hi);
+	}
 
-	return true;
+	return i;
 }
 
-inline static
-bool knx_dpt_timeofday_parse(const uint8_t* apdu, size_t length, knx_timeofday* value) {
-	if (length != 4)
-		return false;
+__attribute__((target("sse4.1")))
+static
+size_t knx_dpt_float16_decode_sse4(const uint8_t* raw, size_t count, knx_float16* values) {
+	const __m128i swap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128d scale = _mm_set1_pd(0.01);
 
-	value->day = apdu[1] >> 5 & 7;
-	value->hour = (apdu[1] & 31) % 24;
-	value->minute = (apdu[2] & 63) % 60;
-	value->second = (apdu[3] & 63) % 60;
+	size_t i = 0;
 
-	return true;
+	for (; i + 4 <= count; i += 4) {
+		// Four big-endian values
+		__m128i words = _mm_shuffle_epi8(_mm_loadl_epi64((const __m128i*) (raw + 2 * i)), swap);
+		__m128i v = _mm_cvtepu16_epi32(words);
+
+		__m128i m = _mm_sub_epi32(
+			_mm_and_si128(v, _mm_set1_epi32(0x7FF)),
+			_mm_and_si128(_mm_srli_epi32(v, 4), _mm_set1_epi32(0x800))
+		);
+
+		// Build 2^e by placing the biased exponent into the float's exponent field
+		__m128i e = _mm_and_si128(_mm_srli_epi32(v, 11), _mm_set1_epi32(15));
+		__m128 p = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(e, _mm_set1_epi32(127)), 23));
+		__m128 x = _mm_mul_ps(_mm_cvtepi32_ps(m), p);
+
+		__m128 lo = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(x), scale));
+		__m128 hi = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)), scale));
+
+		_mm_storeu_ps(values + i, _mm_movelh_ps(lo, hi));
+	}
+
+	return i;
 }
 
-inline static
-bool knx_dpt_date_parse(const uint8_t* apdu, size_t length, knx_date* value) {
-	if (length != 4)
-		return false;
+#endif
 
-	// At least the KNX guys are not retarded
-	value->day = (apdu[1] & 31) % 32;
-	value->month = (apdu[2] & 15) % 13;
-	value->year = (apdu[3] & 127) % 100;
+void knx_dpt_float16_decode_batch(const uint8_t* raw, size_t count, knx_float16* values) {
+	size_t i = 0;
 
-	return true;
+#ifdef KNX_DPT_FLOAT16_SIMD
+	if (__builtin_cpu_supports("avx2"))
+		i = knx_dpt_float16_decode_avx2(raw, count, values);
+	else if (__builtin_cpu_supports("sse4.1"))
+		i = knx_dpt_float16_decode_sse4(raw, count, values);
+#endif
+
+	// Scalar fallback and remainder
+	for (; i < count; i++)
+		values[i] = knx_dpt_float16_decode(raw[2 * i], raw[2 * i + 1]);
 }
 
-#define knx_dpt_as_is_parse(type) {           \
-	if (length < sizeof(type) + 1)            \
-		return false;                         \
-	memcpy(result, apdu + 1, sizeof(type));   \
+bool knx_dpt_value_number(knx_dpt type, const knx_dpt_value* value, double* number) {
+	switch (type) {
+		case KNX_DPT_BOOL:       *number = value->bool_value; return true;
+		case KNX_DPT_CHAR:       *number = (uint8_t) value->char_value; return true;
+		case KNX_DPT_UNSIGNED8:  *number = value->unsigned8; return true;
+		case KNX_DPT_SIGNED8:    *number = value->signed8; return true;
+		case KNX_DPT_UNSIGNED16: *number = value->unsigned16; return true;
+		case KNX_DPT_SIGNED16:   *number = value->signed16; return true;
+		case KNX_DPT_FLOAT16:    *number = value->float16; return true;
+		case KNX_DPT_UNSIGNED32: *number = value->unsigned32; return true;
+		case KNX_DPT_SIGNED32:   *number = value->signed32; return true;
+		case KNX_DPT_FLOAT32:    *number = value->float32; return true;
+		case KNX_DPT_ENUM8:      *number = value->enum8; return true;
+		case KNX_DPT_SIGNED64:   *number = value->signed64; return true;
+
+		default:
+			return false;
+	}
 }
 
 bool knx_dpt_from_apdu(const uint8_t* apdu, size_t length, knx_dpt type, void* result) {
 	switch (type) {
 		case KNX_DPT_BOOL:
-			return knx_dpt_bool_parse(apdu, length, result);
+			return knx_dpt_decode_bool(apdu, length, result);
 
 		case KNX_DPT_CVALUE:
-			return knx_dpt_cvalue_parse(apdu, length, result);
+			return knx_dpt_decode_cvalue(apdu, length, result);
 
 		case KNX_DPT_CSTEP:
-			return knx_dpt_cstep_parse(apdu, length, result);
+			return knx_dpt_decode_cstep(apdu, length, result);
 
 		case KNX_DPT_CHAR:
-			knx_dpt_as_is_parse(knx_char);
-			return true;
+			return knx_dpt_decode_char(apdu, length, result);
 
 		case KNX_DPT_UNSIGNED8:
-			knx_dpt_as_is_parse(knx_unsigned8);
-			return true;
+			return knx_dpt_decode_unsigned8(apdu, length, result);
 
 		case KNX_DPT_SIGNED8:
-			knx_dpt_as_is_parse(knx_signed8);
-			return true;
+			return knx_dpt_decode_signed8(apdu, length, result);
 
 		case KNX_DPT_UNSIGNED16:
-			knx_dpt_as_is_parse(knx_unsigned16);
-			return true;
+			return knx_dpt_decode_unsigned16(apdu, length, result);
 
 		case KNX_DPT_SIGNED16:
-			knx_dpt_as_is_parse(knx_signed16);
-			return true;
+			return knx_dpt_decode_signed16(apdu, length, result);
 
 		case KNX_DPT_FLOAT16:
 			return knx_dpt_float16_parse(apdu, length, result);
 
 		case KNX_DPT_TIMEOFDAY:
-			return knx_dpt_timeofday_parse(apdu, length, result);
+			return knx_dpt_decode_timeofday(apdu, length, result);
 
 		case KNX_DPT_DATE:
-			return knx_dpt_date_parse(apdu, length, result);
+			return knx_dpt_decode_date(apdu, length, result);
 
 		case KNX_DPT_UNSIGNED32:
-			knx_dpt_as_is_parse(knx_unsigned32);
-			return true;
+			return knx_dpt_decode_unsigned32(apdu, length, result);
 
 		case KNX_DPT_SIGNED32:
-			knx_dpt_as_is_parse(knx_signed32);
-			return true;
+			return knx_dpt_decode_signed32(apdu, length, result);
 
 		case KNX_DPT_FLOAT32:
-			knx_dpt_as_is_parse(knx_float32);
-			return true;
-
-		default:
-			return false;
-	}
-}
-
-inline static
-void knx_dpt_generate_bool(uint8_t* apdu, const bool* value) {
-	apdu[0] &= ~63;
-	apdu[0] |= *value & 1;
-}
-
-inline static
-void knx_dpt_generate_cvalue(uint8_t* apdu, const knx_cvalue* value) {
-	apdu[0] &= ~63;
-	apdu[0] |= (value->control & 1) << 1 | (value->value & 1);
-}
+			return knx_dpt_decode_float32(apdu, length, result);
 
-inline static
-void knx_dpt_generate_cstep(uint8_t* apdu, const knx_cstep* value) {
-	apdu[0] &= ~63;
-	apdu[0] |= (value->control & 1) << 3 | (value->step & 7);
-}
+		case KNX_DPT_STRING:
+			return knx_dpt_decode_string(apdu, length, result);
 
-inline static
-void knx_dpt_generate_timeofday(uint8_t* apdu, const knx_timeofday* value) {
-	apdu[0] &= ~63;
-	apdu[1] = (value->day & 7) >> 5 | (value->hour % 24);
-	apdu[2] = value->minute % 60;
-	apdu[3] = value->second % 60;
-}
+		case KNX_DPT_DATETIME:
+			return knx_dpt_decode_datetime(apdu, length, result);
 
-inline static
-void knx_dpt_generate_date(uint8_t* apdu, const knx_date* value) {
-	apdu[0] &= ~63;
-	apdu[1] = value->day % 32;
-	apdu[2] = value->month % 13;
-	apdu[3] = value->year % 100;
-}
-
-inline static
-void knx_dpt_generate_float16(uint8_t* apdu, const knx_float16* value) {
-	apdu[0] &= ~63;
+		case KNX_DPT_ENUM8:
+			return knx_dpt_decode_enum8(apdu, length, result);
 
-	float target = *value * 100;
+		case KNX_DPT_SIGNED64:
+			return knx_dpt_decode_signed64(apdu, length, result);
 
-	if (target > 67076096.0f)
-		target = 67076096.0f;
-	else if (target < -67108864.0f)
-		target = -67108864.0f;
+		case KNX_DPT_RGB:
+			return knx_dpt_decode_rgb(apdu, length, result);
 
-	uint8_t e = 0;
+		case KNX_DPT_RGBW:
+			return knx_dpt_decode_rgbw(apdu, length, result);
 
-	// This isn't particularly efficient, but
-	// has yielded the best results so far.
-	while (target < -2048 || target > 2047) {
-		target /= 2;
-		e++;
+		default:
+			return false;
 	}
-
-	int16_t m = target;
-
-	if (m < 0)
-		m = ~(~m + 1);
-
-	apdu[1] = (m < 0) << 7
-	        | (e & 15) << 3
-	        | (m >> 8 & 7);
-	apdu[2] = m & 255;
 }
 
+void knx_dpt_float16_encode_batch(const knx_float16* values, size_t count, uint8_t* raw) {
+	for (size_t i = 0; i < count; i++) {
+		uint16_t encoded = knx_dpt_float16_encode(values[i]);
 
-#define knx_dpt_generate_as_is(type) {      \
-	apdu[0] &= ~63;                         \
-	memcpy(apdu + 1, source, sizeof(type)); \
+		raw[2 * i] = encoded >> 8;
+		raw[2 * i + 1] = encoded & 255;
+	}
 }
 
 void knx_dpt_to_apdu(uint8_t* apdu, knx_dpt type, const void* source) {
 	switch (type) {
 		case KNX_DPT_BOOL:
-			knx_dpt_generate_bool(apdu, source);
+			knx_dpt_encode_bool(apdu, *(const knx_bool*) source);
 			break;
 
 		case KNX_DPT_CVALUE:
-			knx_dpt_generate_cvalue(apdu, source);
+			knx_dpt_encode_cvalue(apdu, *(const knx_cvalue*) source);
 			break;
 
 		case KNX_DPT_CSTEP:
-			knx_dpt_generate_cstep(apdu, source);
+			knx_dpt_encode_cstep(apdu, *(const knx_cstep*) source);
 			break;
 
 		case KNX_DPT_CHAR:
-			knx_dpt_generate_as_is(knx_char);
+			knx_dpt_encode_char(apdu, *(const knx_char*) source);
 			break;
 
 		case KNX_DPT_UNSIGNED8:
-			knx_dpt_generate_as_is(knx_unsigned8);
+			knx_dpt_encode_unsigned8(apdu, *(const knx_unsigned8*) source);
 			break;
 
 		case KNX_DPT_SIGNED8:
-			knx_dpt_generate_as_is(knx_signed8);
+			knx_dpt_encode_signed8(apdu, *(const knx_signed8*) source);
 			break;
 
 		case KNX_DPT_UNSIGNED16:
-			knx_dpt_generate_as_is(knx_unsigned16);
+			knx_dpt_encode_unsigned16(apdu, *(const knx_unsigned16*) source);
 			break;
 
 		case KNX_DPT_SIGNED16:
-			knx_dpt_generate_as_is(knx_signed16);
+			knx_dpt_encode_signed16(apdu, *(const knx_signed16*) source);
 			break;
 
 		case KNX_DPT_FLOAT16:
-			knx_dpt_generate_float16(apdu, source);
+			knx_dpt_encode_float16(apdu, *(const knx_float16*) source);
 			break;
 
 		case KNX_DPT_TIMEOFDAY:
-			knx_dpt_generate_timeofday(apdu, source);
+			knx_dpt_encode_timeofday(apdu, *(const knx_timeofday*) source);
 			break;
 
 		case KNX_DPT_DATE:
-			knx_dpt_generate_date(apdu, source);
+			knx_dpt_encode_date(apdu, *(const knx_date*) source);
 			break;
 
 		case KNX_DPT_UNSIGNED32:
-			knx_dpt_generate_as_is(knx_unsigned32);
+			knx_dpt_encode_unsigned32(apdu, *(const knx_unsigned32*) source);
 			break;
 
 		case KNX_DPT_SIGNED32:
-			knx_dpt_generate_as_is(knx_signed32);
+			knx_dpt_encode_signed32(apdu, *(const knx_signed32*) source);
 			break;
 
 		case KNX_DPT_FLOAT32:
-			knx_dpt_generate_as_is(knx_float32);
+			knx_dpt_encode_float32(apdu, *(const knx_float32*) source);
+			break;
+
+		case KNX_DPT_STRING:
+			knx_dpt_encode_string(apdu, *(const knx_string*) source);
+			break;
+
+		case KNX_DPT_DATETIME:
+			knx_dpt_encode_datetime(apdu, *(const knx_datetime*) source);
+			break;
+
+		case KNX_DPT_ENUM8:
+			knx_dpt_encode_enum8(apdu, *(const knx_enum8*) source);
+			break;
+
+		case KNX_DPT_SIGNED64:
+			knx_dpt_encode_signed64(apdu, *(const knx_signed64*) source);
+			break;
+
+		case KNX_DPT_RGB:
+			knx_dpt_encode_rgb(apdu, *(const knx_rgb*) source);
+			break;
+
+		case KNX_DPT_RGBW:
+			knx_dpt_encode_rgbw(apdu, *(const knx_rgbw*) source);
 			break;
 
 		default:
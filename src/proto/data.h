@@ -113,6 +113,42 @@ typedef enum {
 	 * \see knx_float32
 	 */
 	KNX_DPT_FLOAT32,
+
+	/**
+	 * DPT 16.xxx
+	 * \see knx_string
+	 */
+	KNX_DPT_STRING,
+
+	/**
+	 * DPT 19.xxx
+	 * \see knx_datetime
+	 */
+	KNX_DPT_DATETIME,
+
+	/**
+	 * DPT 20.xxx
+	 * \see knx_enum8
+	 */
+	KNX_DPT_ENUM8,
+
+	/**
+	 * DPT 29.xxx
+	 * \see knx_signed64
+	 */
+	KNX_DPT_SIGNED64,
+
+	/**
+	 * DPT 232.xxx
+	 * \see knx_rgb
+	 */
+	KNX_DPT_RGB,
+
+	/**
+	 * DPT 251.xxx
+	 * \see knx_rgbw
+	 */
+	KNX_DPT_RGBW,
 } knx_dpt;
 
 /**
@@ -224,15 +260,195 @@ typedef int32_t knx_signed32;
 typedef float knx_float32;
 
 /**
- * Interpret APDU in the given way to produce an instance of a C type.
+ * Maximum number of characters in a DPT 16.xxx string
+ */
+#define KNX_STRING_LENGTH 14
+
+/**
+ * DPT 16.xxx
+ * \see KNX_DPT_STRING
+ */
+typedef struct {
+	/**
+	 * Characters, always terminated by a null character
+	 */
+	char value[KNX_STRING_LENGTH + 1];
+} knx_string;
+
+/**
+ * DPT 19.xxx
+ * \see KNX_DPT_DATETIME
+ */
+typedef struct {
+	/**
+	 * Year (1900 to 2155)
+	 */
+	uint16_t year;
+
+	/**
+	 * Month (1 to 12)
+	 */
+	uint8_t month;
+
+	/**
+	 * Day of the month (1 to 31)
+	 */
+	uint8_t day;
+
+	/**
+	 * Day of the week
+	 */
+	knx_dayofweek dayofweek;
+
+	/**
+	 * Hour (0 to 24), minute and second
+	 */
+	uint8_t hour, minute, second;
+
+	/**
+	 * Device reports a fault
+	 */
+	bool fault;
+
+	/**
+	 * Date is a working day, only meaningful if `no_working_day` is not set
+	 */
+	bool working_day;
+
+	/**
+	 * Fields which carry no valid information
+	 */
+	bool no_working_day, no_year, no_date, no_dayofweek, no_time;
+
+	/**
+	 * Summer time is in effect
+	 */
+	bool summer_time;
+
+	/**
+	 * Clock is synchronized to an external time source
+	 */
+	bool external_sync;
+
+	/**
+	 * Synchronisation source is reliable
+	 */
+	bool reliable_sync;
+} knx_datetime;
+
+/**
+ * DPT 20.xxx
+ * \see KNX_DPT_ENUM8
+ */
+typedef uint8_t knx_enum8;
+
+/**
+ * DPT 29.xxx
+ * \see KNX_DPT_SIGNED64
+ */
+typedef int64_t knx_signed64;
+
+/**
+ * DPT 232.xxx
+ * \see KNX_DPT_RGB
+ */
+typedef struct {
+	uint8_t red, green, blue;
+} knx_rgb;
+
+/**
+ * DPT 251.xxx
+ * \see KNX_DPT_RGBW
+ */
+typedef struct {
+	uint8_t red, green, blue, white;
+
+	/**
+	 * Which of the colour components are valid
+	 */
+	bool red_valid, green_valid, blue_valid, white_valid;
+} knx_rgbw;
+
+/**
+ * Storage for an instance of any datapoint type
+ */
+typedef union {
+	knx_bool       bool_value;
+	knx_cvalue     cvalue;
+	knx_cstep      cstep;
+	knx_char       char_value;
+	knx_unsigned8  unsigned8;
+	knx_signed8    signed8;
+	knx_unsigned16 unsigned16;
+	knx_signed16   signed16;
+	knx_float16    float16;
+	knx_timeofday  timeofday;
+	knx_date       date;
+	knx_unsigned32 unsigned32;
+	knx_signed32   signed32;
+	knx_float32    float32;
+	knx_string     string;
+	knx_datetime   datetime;
+	knx_enum8      enum8;
+	knx_signed64   signed64;
+	knx_rgb        rgb;
+	knx_rgbw       rgbw;
+} knx_dpt_value;
+
+/**
+ * Convert a numeric datapoint value to a number.
+ *
+ * \param type   Datapoint type of `value`
+ * \param value  Value
+ * \param number Output number
+ * \returns `true` on success, `false` if the type is not numeric
+ */
+bool knx_dpt_value_number(knx_dpt type, const knx_dpt_value* value, double* number);
+
+/**
+ * Interpret APDU in the given way to produce an instance of a C type. Multi-byte values
+ * (DPT 7, 8, 9, 12, 13, 14 and 29) are read in big-endian byte order, as they are transmitted.
  */
 bool knx_dpt_from_apdu(const uint8_t* apdu, size_t length, knx_dpt type, void* result);
 
 /**
- * Generate the APDU representation of the given type.
+ * Generate the APDU representation of the given type. Multi-byte values are written in big-endian
+ * byte order.
  */
 void knx_dpt_to_apdu(uint8_t* apdu, knx_dpt type, const void* value);
 
+/**
+ * Decode many DPT 9.xxx values at once. The results are identical to those of
+ * `knx_dpt_from_apdu`, but SIMD instructions are used if the CPU supports them.
+ *
+ * \param raw    Packed values, 2 bytes each in network byte order (i.e. the APDU without its
+ *               first byte)
+ * \param count  Number of values in `raw`
+ * \param values Output array with room for `count` values
+ */
+void knx_dpt_float16_decode_batch(const uint8_t* raw, size_t count, knx_float16* values);
+
+/**
+ * Encode many DPT 9.xxx values at once. Each value is rounded to the nearest representable
+ * value, values outside of the representable range are clamped.
+ *
+ * \param values Input values
+ * \param count  Number of values in `values`
+ * \param raw    Output buffer with room for `2 * count` bytes, receives the packed values in
+ *               network byte order
+ */
+void knx_dpt_float16_encode_batch(const knx_float16* values, size_t count, uint8_t* raw);
+
+/**
+ * Let `knx_dpt_from_apdu` decode DPT 9.xxx values by looking them up in the given table instead
+ * of computing them.
+ *
+ * \see knx_dpt_tables_enable
+ * \param table Table of 65536 values indexed by the raw 16-bit encoding, must stay valid as long
+ *              as it is in use; `NULL` restores the computation
+ */
+void knx_dpt_use_float16_table(const knx_float16* table);
+
 /**
  * APDU size for `bool`
  */
@@ -303,6 +519,36 @@ void knx_dpt_to_apdu(uint8_t* apdu, knx_dpt type, const void* value);
  */
 #define KNX_DPT_FLOAT32_SIZE    5
 
+/**
+ * APDU size for `string`
+ */
+#define KNX_DPT_STRING_SIZE     15
+
+/**
+ * APDU size for `datetime`
+ */
+#define KNX_DPT_DATETIME_SIZE   9
+
+/**
+ * APDU size for `enum8`
+ */
+#define KNX_DPT_ENUM8_SIZE      2
+
+/**
+ * APDU size for `signed64`
+ */
+#define KNX_DPT_SIGNED64_SIZE   9
+
+/**
+ * APDU size for `rgb`
+ */
+#define KNX_DPT_RGB_SIZE        4
+
+/**
+ * APDU size for `rgbw`
+ */
+#define KNX_DPT_RGBW_SIZE       7
+
 /**
  * APDU size needed to fit an instance of the given datapoint type.
  */
@@ -351,6 +597,24 @@ size_t knx_dpt_size(knx_dpt type) {
 		case KNX_DPT_FLOAT32:
 			return KNX_DPT_FLOAT32_SIZE;
 
+		case KNX_DPT_STRING:
+			return KNX_DPT_STRING_SIZE;
+
+		case KNX_DPT_DATETIME:
+			return KNX_DPT_DATETIME_SIZE;
+
+		case KNX_DPT_ENUM8:
+			return KNX_DPT_ENUM8_SIZE;
+
+		case KNX_DPT_SIGNED64:
+			return KNX_DPT_SIGNED64_SIZE;
+
+		case KNX_DPT_RGB:
+			return KNX_DPT_RGB_SIZE;
+
+		case KNX_DPT_RGBW:
+			return KNX_DPT_RGBW_SIZE;
+
 		default:
 			return 0;
 	}
@@ -20,16 +20,37 @@
  */
 
 #include "descres.h"
-#include "../util/alloc.h"
 
 #include <string.h>
 
-bool knx_description_response_parse(
+// Description Response:
+//   Octet 0-53: Device information DIB
+//   Octet 54:   Supported service families DIB length (including this header)
+//   Octet 55:   Supported service families DIB type
+//   Octet 56-n: Service family and version pairs
+//   Optional manufacturer DIB:
+//     Octet 0:   Length
+//     Octet 1:   Type
+//     Octet 2-3: Manufacturer ID
+//     Octet 4-n: Manufacturer-specific data
+
+#define KNX_DESCRIPTION_DIB_DEVICE_INFO  0x01
+#define KNX_DESCRIPTION_DIB_SERVICES     0x02
+#define KNX_DESCRIPTION_DIB_MANUFACTURER 0xFE
+
+// Services are borrowed from the message, hence their layout must match
+typedef char knx_description_service_size_check[sizeof(knx_description_service) == 2 ? 1 : -1];
+
+// Parse everything except for the service families
+static
+bool knx_description_response_parse_dibs(
 	const uint8_t*            buffer,
 	size_t                    length,
 	knx_description_response* res
 ) {
-	if (length < 56 || buffer[0] != 54 || buffer[1] != 1 || buffer[54] % 2 != 0 || buffer[55] != 2)
+	if (length < 56 || buffer[0] != 54 || buffer[1] != KNX_DESCRIPTION_DIB_DEVICE_INFO ||
+	    buffer[54] < 2 || buffer[54] % 2 != 0 || buffer[55] != KNX_DESCRIPTION_DIB_SERVICES ||
+	    54 + (size_t) buffer[54] > length)
 		return false;
 
 	res->medium = buffer[2];
@@ -44,23 +65,102 @@ bool knx_description_response_parse(
 	memcpy(&res->name, buffer + 24, 29);
 	res->name[29] = 0;
 
-	res->num_services = buffer[54] / 2;
+	res->num_services = (buffer[54] - 2) / 2;
+
+	// Look for a manufacturer DIB among the remaining DIBs
+	const uint8_t* dib = buffer + 54 + buffer[54];
+	size_t remaining = length - 54 - buffer[54];
+
+	res->manufacturer.present = false;
+	res->manufacturer.id = 0;
+	res->manufacturer.data = NULL;
+	res->manufacturer.length = 0;
+
+	while (remaining >= 2 && dib[0] >= 2 && dib[0] <= remaining) {
+		if (dib[1] == KNX_DESCRIPTION_DIB_MANUFACTURER && dib[0] >= 4) {
+			res->manufacturer.present = true;
+			res->manufacturer.id = dib[2] << 8 | dib[3];
+			res->manufacturer.data = dib + 4;
+			res->manufacturer.length = dib[0] - 4;
+			break;
+		}
+
+		remaining -= dib[0];
+		dib += dib[0];
+	}
+
+	return true;
+}
+
+bool knx_description_response_parse(
+	const uint8_t*            buffer,
+	size_t                    length,
+	knx_description_response* res
+) {
+	return knx_description_response_parse_with(buffer, length, res, NULL);
+}
+
+bool knx_description_response_parse_with(
+	const uint8_t*            buffer,
+	size_t                    length,
+	knx_description_response* res,
+	const knx_allocator*      allocator
+) {
+#ifdef KNXPROTO_NO_MALLOC
+	// Without a heap the default is to borrow the services from the message
+	if (!allocator)
+		return knx_description_response_parse_view(buffer, length, res);
+#endif
+
+	if (!knx_description_response_parse_dibs(buffer, length, res))
+		return false;
+
+	res->allocator = allocator;
 
 	if (res->num_services == 0) {
 		res->services = NULL;
 		return true;
 	}
 
-	buffer += 56;
-	length -= 56;
+	res->services = knx_allocator_alloc(
+		allocator,
+		sizeof(knx_description_service) * res->num_services
+	);
 
-	res->services = newa(knx_description_service, res->num_services);
+	if (!res->services)
+		return false;
 
-	for (size_t i = 0; i < res->num_services && length >= 2; length -= 2, buffer += 2, i++) {
-		res->services[i].family = buffer[0];
-		res->services[i].version = buffer[1];
-	}
+	memcpy(res->services, buffer + 56, sizeof(knx_description_service) * res->num_services);
+	return true;
+}
+
+bool knx_description_response_parse_view(
+	const uint8_t*            buffer,
+	size_t                    length,
+	knx_description_response* res
+) {
+	if (!knx_description_response_parse_dibs(buffer, length, res))
+		return false;
+
+	// The array is never written through, it is only non-const for the allocating variants
+	res->allocator = &knx_allocator_none;
+	res->services = res->num_services > 0 ? (knx_description_service*) (buffer + 56) : NULL;
+
+	return true;
+}
+
+bool knx_description_response_parse_inline(
+	const uint8_t*                   buffer,
+	size_t                           length,
+	knx_description_response_inline* res
+) {
+	if (!knx_description_response_parse_dibs(buffer, length, &res->response))
+		return false;
+
+	res->response.allocator = &knx_allocator_none;
+	res->response.services = res->services;
 
+	memcpy(res->services, buffer + 56, sizeof(knx_description_service) * res->response.num_services);
 	return true;
 }
 
@@ -68,6 +168,7 @@ void knx_description_response_free_services(knx_description_response* res) {
 	if (res->services == NULL || res->num_services == 0)
 		return;
 
-	free(res->services);
+	knx_allocator_free(res->allocator, res->services);
+	res->services = NULL;
 	res->num_services = 0;
 }
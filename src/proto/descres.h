@@ -23,12 +23,18 @@
 #define KNXPROTO_PROTO_DESCRES_H_
 
 #include "../util/address.h"
+#include "../util/allocator.h"
 
 #include <arpa/inet.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
 
+/**
+ * Maximum number of service families a description response can list
+ */
+#define KNX_DESCRIPTION_MAX_SERVICES 126
+
 typedef struct {
 	/**
 	 * Service type/family
@@ -41,6 +47,31 @@ typedef struct {
 	uint8_t version;
 } knx_description_service;
 
+/**
+ * Manufacturer Data
+ */
+typedef struct {
+	/**
+	 * Is the manufacturer DIB present?
+	 */
+	bool present;
+
+	/**
+	 * Manufacturer ID
+	 */
+	uint16_t id;
+
+	/**
+	 * Manufacturer-specific data, points into the parsed message
+	 */
+	const uint8_t* data;
+
+	/**
+	 * Number of bytes in `data`
+	 */
+	size_t length;
+} knx_description_manufacturer;
+
 /**
  * Description Response
  */
@@ -94,12 +125,40 @@ typedef struct {
 	 * Services array
 	 */
 	knx_description_service* services;
+
+	/**
+	 * Allocator which provided `services`
+	 */
+	const knx_allocator* allocator;
+
+	/**
+	 * Manufacturer DIB
+	 */
+	knx_description_manufacturer manufacturer;
 } knx_description_response;
 
+/**
+ * Description Response with inline service family storage
+ *
+ * \note `response.services` points into the structure itself, do not copy it by value.
+ */
+typedef struct {
+	/**
+	 * Description response
+	 */
+	knx_description_response response;
+
+	/**
+	 * Storage for `response.services`
+	 */
+	knx_description_service services[KNX_DESCRIPTION_MAX_SERVICES];
+} knx_description_response_inline;
+
 /**
  * Parse a raw description response.
  *
  * \note You have to free the `services` array using `knx_description_response_free_services`.
+ *       Builds with `KNXPROTO_NO_MALLOC` borrow the array from `message` instead.
  * \param message        Raw description response
  * \param message_length Number of bytes in `message`
  * \param res            Output description response
@@ -111,7 +170,52 @@ bool knx_description_response_parse(
 );
 
 /**
- * Free the dynamically allocated `services` array.
+ * Parse a raw description response and allocate the `services` array using the given allocator.
+ *
+ * \note The allocator must remain valid until the array has been freed.
+ * \param message        Raw description response
+ * \param message_length Number of bytes in `message`
+ * \param res            Output description response
+ * \param allocator      Allocator (`NULL` selects `malloc`, or borrowing from `message` in builds
+ *                       with `KNXPROTO_NO_MALLOC`)
+ */
+bool knx_description_response_parse_with(
+	const uint8_t*            message,
+	size_t                    message_length,
+	knx_description_response* res,
+	const knx_allocator*      allocator
+);
+
+/**
+ * Parse a raw description response without copying the service families. `services` points into
+ * `message` and is valid as long as `message` is.
+ *
+ * \param message        Raw description response
+ * \param message_length Number of bytes in `message`
+ * \param res            Output description response
+ */
+bool knx_description_response_parse_view(
+	const uint8_t*            message,
+	size_t                    message_length,
+	knx_description_response* res
+);
+
+/**
+ * Parse a raw description response and copy the service families into inline storage.
+ *
+ * \param message        Raw description response
+ * \param message_length Number of bytes in `message`
+ * \param res            Output description response
+ */
+bool knx_description_response_parse_inline(
+	const uint8_t*                   message,
+	size_t                           message_length,
+	knx_description_response_inline* res
+);
+
+/**
+ * Free the dynamically allocated `services` array. Does nothing for responses obtained through
+ * `knx_description_response_parse_view` or `knx_description_response_parse_inline`.
  */
 void knx_description_response_free_services(knx_description_response* res);
 
@@ -120,7 +224,7 @@ void knx_description_response_free_services(knx_description_response* res);
  */
 inline static
 size_t knx_description_response_size(const knx_description_response* res) {
-	return 56 + 2 * res->num_services;
+	return 56 + 2 * res->num_services + (res->manufacturer.present ? 4 + res->manufacturer.length : 0);
 }
 
 #endif
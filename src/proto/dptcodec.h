@@ -0,0 +1,477 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_PROTO_DPTCODEC_H_
+#define KNXPROTO_PROTO_DPTCODEC_H_
+
+#include "data.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * Each datapoint type has a decoder
+ *
+ *   bool knx_dpt_decode_<type>(const uint8_t* apdu, size_t length, knx_<type>* value)
+ *
+ * which behaves like `knx_dpt_from_apdu` and an encoder
+ *
+ *   void knx_dpt_encode_<type>(uint8_t* apdu, knx_<type> value)
+ *
+ * which behaves like `knx_dpt_to_apdu`. Since they are inline, conversions of a type known at
+ * compile time need no dispatch. Like on the wire, multi-byte values are big-endian regardless of
+ * the host's byte order.
+ */
+
+inline static
+bool knx_dpt_decode_bool(const uint8_t* apdu, size_t length, knx_bool* value) {
+	if (length != KNX_DPT_BOOL_SIZE)
+		return false;
+
+	*value = *apdu & 1;
+
+	return true;
+}
+
+inline static
+void knx_dpt_encode_bool(uint8_t* apdu, knx_bool value) {
+	apdu[0] &= ~63;
+	apdu[0] |= value & 1;
+}
+
+inline static
+bool knx_dpt_decode_cvalue(const uint8_t* apdu, size_t length, knx_cvalue* value) {
+	if (length != KNX_DPT_CVALUE_SIZE)
+		return false;
+
+	value->control = *apdu >> 1 & 1;
+	value->value = *apdu & 1;
+
+	return true;
+}
+
+inline static
+void knx_dpt_encode_cvalue(uint8_t* apdu, knx_cvalue value) {
+	apdu[0] &= ~63;
+	apdu[0] |= (value.control & 1) << 1 | (value.value & 1);
+}
+
+inline static
+bool knx_dpt_decode_cstep(const uint8_t* apdu, size_t length, knx_cstep* value) {
+	if (length != KNX_DPT_CSTEP_SIZE)
+		return false;
+
+	value->control = *apdu >> 3 & 1;
+	value->step = *apdu & 7;
+
+	return true;
+}
+
+inline static
+void knx_dpt_encode_cstep(uint8_t* apdu, knx_cstep value) {
+	apdu[0] &= ~63;
+	apdu[0] |= (value.control & 1) << 3 | (value.step & 7);
+}
+
+// Single-byte types which are stored as they are
+#define knx_dpt_define_as_is(name, type)                                         \
+	inline static                                                                \
+	bool knx_dpt_decode_##name(const uint8_t* apdu, size_t length, type* value) { \
+		if (length < sizeof(type) + 1)                                           \
+			return false;                                                        \
+		memcpy(value, apdu + 1, sizeof(type));                                   \
+		return true;                                                             \
+	}                                                                            \
+	                                                                             \
+	inline static                                                                \
+	void knx_dpt_encode_##name(uint8_t* apdu, type value) {                      \
+		apdu[0] &= ~63;                                                          \
+		memcpy(apdu + 1, &value, sizeof(type));                                  \
+	}
+
+// Multi-byte types which are transmitted in big-endian byte order
+#define knx_dpt_define_big_endian(name, type, raw_type)                          \
+	inline static                                                                \
+	bool knx_dpt_decode_##name(const uint8_t* apdu, size_t length, type* value) { \
+		if (length < sizeof(type) + 1)                                           \
+			return false;                                                        \
+		raw_type raw = 0;                                                        \
+		for (size_t i = 1; i <= sizeof(type); i++)                               \
+			raw = raw << 8 | apdu[i];                                            \
+		memcpy(value, &raw, sizeof(type));                                       \
+		return true;                                                             \
+	}                                                                            \
+	                                                                             \
+	inline static                                                                \
+	void knx_dpt_encode_##name(uint8_t* apdu, type value) {                      \
+		raw_type raw;                                                            \
+		memcpy(&raw, &value, sizeof(type));                                      \
+		apdu[0] &= ~63;                                                          \
+		for (size_t i = sizeof(type); i > 0; i--, raw >>= 8)                     \
+			apdu[i] = raw & 255;                                                 \
+	}
+
+knx_dpt_define_as_is(char, knx_char)
+knx_dpt_define_as_is(unsigned8, knx_unsigned8)
+knx_dpt_define_as_is(signed8, knx_signed8)
+knx_dpt_define_big_endian(unsigned16, knx_unsigned16, uint16_t)
+knx_dpt_define_big_endian(signed16, knx_signed16, uint16_t)
+knx_dpt_define_big_endian(unsigned32, knx_unsigned32, uint32_t)
+knx_dpt_define_big_endian(signed32, knx_signed32, uint32_t)
+knx_dpt_define_big_endian(float32, knx_float32, uint32_t)
+knx_dpt_define_as_is(enum8, knx_enum8)
+
+#undef knx_dpt_define_as_is
+#undef knx_dpt_define_big_endian
+
+/**
+ * Decode the 16-bit representation of a DPT 9.xxx value.
+ */
+inline static
+knx_float16 knx_dpt_float16_decode(uint8_t high, uint8_t low) {
+	// Mantissa
+	int32_t m = (high & 7) << 8 | low;
+
+	// Signed?
+	if (high & 128)
+		m -= 2048;
+
+	// Exponent
+	uint8_t e = high >> 3 & 15;
+
+	// m * 2^e is exact, only the scaling by 0.01 rounds
+	return (knx_float16) (0.01 * (double) (m * (1 << e)));
+}
+
+/**
+ * Encode a DPT 9.xxx value to its 16-bit representation.
+ */
+inline static
+uint16_t knx_dpt_float16_encode(knx_float16 value) {
+	// DPT 9 reserves this encoding for invalid data
+	if (isnan(value))
+		return 0x7FFF;
+
+	double target = fmin(fmax(value * 100.0, -67108864.0), 67076096.0);
+
+	// Since |target| < 2^k, this is the smallest exponent which may fit the mantissa in 12 bits
+	int k;
+	frexp(target, &k);
+
+	int e = k - 11;
+	e = e < 0 ? 0 : e;
+	e = e > 15 ? 15 : e;
+
+	// Scaling by 2^-e is exact, so this is the only rounding step
+	long m = lrint(ldexp(target, -e));
+
+	// Rounding up to 2048 requires the next exponent, which leaves a mantissa of exactly 1024
+	int carry = m == 2048;
+	m >>= carry;
+	e += carry;
+
+	return (uint16_t) ((m < 0) << 15 | e << 11 | (m & 0x7FF));
+}
+
+inline static
+bool knx_dpt_decode_float16(const uint8_t* apdu, size_t length, knx_float16* value) {
+	if (length != KNX_DPT_FLOAT16_SIZE)
+		return false;
+
+	*value = knx_dpt_float16_decode(apdu[1], apdu[2]);
+
+	return true;
+}
+
+inline static
+void knx_dpt_encode_float16(uint8_t* apdu, knx_float16 value) {
+	uint16_t raw = knx_dpt_float16_encode(value);
+
+	apdu[0] &= ~63;
+	apdu[1] = raw >> 8;
+	apdu[2] = raw & 255;
+}
+
+inline static
+bool knx_dpt_decode_timeofday(const uint8_t* apdu, size_t length, knx_timeofday* value) {
+	if (length != KNX_DPT_TIMEOFDAY_SIZE)
+		return false;
+
+	value->day = (knx_dayofweek) (apdu[1] >> 5 & 7);
+	value->hour = (apdu[1] & 31) % 24;
+	value->minute = (apdu[2] & 63) % 60;
+	value->second = (apdu[3] & 63) % 60;
+
+	return true;
+}
+
+inline static
+void knx_dpt_encode_timeofday(uint8_t* apdu, knx_timeofday value) {
+	apdu[0] &= ~63;
+	apdu[1] = (value.day & 7) << 5 | (value.hour % 24);
+	apdu[2] = value.minute % 60;
+	apdu[3] = value.second % 60;
+}
+
+inline static
+bool knx_dpt_decode_date(const uint8_t* apdu, size_t length, knx_date* value) {
+	if (length != KNX_DPT_DATE_SIZE)
+		return false;
+
+	// At least the KNX guys are not retarded
+	value->day = (apdu[1] & 31) % 32;
+	value->month = (apdu[2] & 15) % 13;
+	value->year = (apdu[3] & 127) % 100;
+
+	return true;
+}
+
+inline static
+void knx_dpt_encode_date(uint8_t* apdu, knx_date value) {
+	apdu[0] &= ~63;
+	apdu[1] = value.day % 32;
+	apdu[2] = value.month % 13;
+	apdu[3] = value.year % 100;
+}
+
+inline static
+bool knx_dpt_decode_string(const uint8_t* apdu, size_t length, knx_string* value) {
+	if (length != KNX_DPT_STRING_SIZE)
+		return false;
+
+	// Unused characters are null, so the copy is terminated early if the string is shorter
+	memcpy(value->value, apdu + 1, KNX_STRING_LENGTH);
+	value->value[KNX_STRING_LENGTH] = 0;
+
+	return true;
+}
+
+inline static
+void knx_dpt_encode_string(uint8_t* apdu, knx_string value) {
+	apdu[0] &= ~63;
+
+	// Standard C only, consumers may not have `strnlen`
+	const char* end = (const char*) memchr(value.value, 0, KNX_STRING_LENGTH);
+	size_t length = end ? (size_t) (end - value.value) : KNX_STRING_LENGTH;
+
+	memcpy(apdu + 1, value.value, length);
+	memset(apdu + 1 + length, 0, KNX_STRING_LENGTH - length);
+}
+
+inline static
+bool knx_dpt_decode_datetime(const uint8_t* apdu, size_t length, knx_datetime* value) {
+	if (length != KNX_DPT_DATETIME_SIZE)
+		return false;
+
+	value->year = 1900 + apdu[1];
+	value->month = apdu[2] & 15;
+	value->day = apdu[3] & 31;
+	value->dayofweek = (knx_dayofweek) (apdu[4] >> 5 & 7);
+	value->hour = apdu[4] & 31;
+	value->minute = apdu[5] & 63;
+	value->second = apdu[6] & 63;
+
+	value->fault = apdu[7] >> 7 & 1;
+	value->working_day = apdu[7] >> 6 & 1;
+	value->no_working_day = apdu[7] >> 5 & 1;
+	value->no_year = apdu[7] >> 4 & 1;
+	value->no_date = apdu[7] >> 3 & 1;
+	value->no_dayofweek = apdu[7] >> 2 & 1;
+	value->no_time = apdu[7] >> 1 & 1;
+	value->summer_time = apdu[7] & 1;
+
+	value->external_sync = apdu[8] >> 7 & 1;
+	value->reliable_sync = apdu[8] >> 6 & 1;
+
+	return true;
+}
+
+inline static
+void knx_dpt_encode_datetime(uint8_t* apdu, knx_datetime value) {
+	apdu[0] &= ~63;
+	apdu[1] = value.year - 1900;
+	apdu[2] = value.month & 15;
+	apdu[3] = value.day & 31;
+	apdu[4] = (value.dayofweek & 7) << 5 | (value.hour & 31);
+	apdu[5] = value.minute & 63;
+	apdu[6] = value.second & 63;
+	apdu[7] = value.fault << 7
+	        | value.working_day << 6
+	        | value.no_working_day << 5
+	        | value.no_year << 4
+	        | value.no_date << 3
+	        | value.no_dayofweek << 2
+	        | value.no_time << 1
+	        | value.summer_time;
+	apdu[8] = value.external_sync << 7
+	        | value.reliable_sync << 6;
+}
+
+inline static
+bool knx_dpt_decode_signed64(const uint8_t* apdu, size_t length, knx_signed64* value) {
+	if (length != KNX_DPT_SIGNED64_SIZE)
+		return false;
+
+	uint64_t raw = 0;
+
+	for (size_t i = 1; i < KNX_DPT_SIGNED64_SIZE; i++)
+		raw = raw << 8 | apdu[i];
+
+	*value = (knx_signed64) raw;
+
+	return true;
+}
+
+inline static
+void knx_dpt_encode_signed64(uint8_t* apdu, knx_signed64 value) {
+	uint64_t raw = (uint64_t) value;
+
+	apdu[0] &= ~63;
+
+	for (size_t i = KNX_DPT_SIGNED64_SIZE - 1; i > 0; i--, raw >>= 8)
+		apdu[i] = raw & 255;
+}
+
+inline static
+bool knx_dpt_decode_rgb(const uint8_t* apdu, size_t length, knx_rgb* value) {
+	if (length != KNX_DPT_RGB_SIZE)
+		return false;
+
+	value->red = apdu[1];
+	value->green = apdu[2];
+	value->blue = apdu[3];
+
+	return true;
+}
+
+inline static
+void knx_dpt_encode_rgb(uint8_t* apdu, knx_rgb value) {
+	apdu[0] &= ~63;
+	apdu[1] = value.red;
+	apdu[2] = value.green;
+	apdu[3] = value.blue;
+}
+
+inline static
+bool knx_dpt_decode_rgbw(const uint8_t* apdu, size_t length, knx_rgbw* value) {
+	if (length != KNX_DPT_RGBW_SIZE)
+		return false;
+
+	value->red = apdu[1];
+	value->green = apdu[2];
+	value->blue = apdu[3];
+	value->white = apdu[4];
+
+	// apdu[5] is reserved
+	value->red_valid = apdu[6] >> 3 & 1;
+	value->green_valid = apdu[6] >> 2 & 1;
+	value->blue_valid = apdu[6] >> 1 & 1;
+	value->white_valid = apdu[6] & 1;
+
+	return true;
+}
+
+inline static
+void knx_dpt_encode_rgbw(uint8_t* apdu, knx_rgbw value) {
+	apdu[0] &= ~63;
+	apdu[1] = value.red;
+	apdu[2] = value.green;
+	apdu[3] = value.blue;
+	apdu[4] = value.white;
+	apdu[5] = 0;
+	apdu[6] = value.red_valid << 3
+	        | value.green_valid << 2
+	        | value.blue_valid << 1
+	        | value.white_valid;
+}
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+
+/*
+ * Some datapoint types share their C type, which makes them indistinguishable here:
+ * `float` selects DPT 9.xxx (use `knx_dpt_encode_float32` and `knx_dpt_decode_float32` for
+ * DPT 14.xxx), `uint8_t` selects DPT 5.xxx (DPT 20.xxx is encoded identically).
+ */
+
+/**
+ * Encode a value whose datapoint type follows from its C type.
+ *
+ * \param apdu  Output APDU with room for the value
+ * \param value Value, e.g. `(knx_float16) 21.5`
+ */
+#define knx_dpt_encode(apdu, value)                 \
+	_Generic((value),                               \
+		knx_bool:       knx_dpt_encode_bool,        \
+		knx_cvalue:     knx_dpt_encode_cvalue,      \
+		knx_cstep:      knx_dpt_encode_cstep,       \
+		knx_char:       knx_dpt_encode_char,        \
+		knx_unsigned8:  knx_dpt_encode_unsigned8,   \
+		knx_signed8:    knx_dpt_encode_signed8,     \
+		knx_unsigned16: knx_dpt_encode_unsigned16,  \
+		knx_signed16:   knx_dpt_encode_signed16,    \
+		knx_float16:    knx_dpt_encode_float16,     \
+		knx_timeofday:  knx_dpt_encode_timeofday,   \
+		knx_date:       knx_dpt_encode_date,        \
+		knx_unsigned32: knx_dpt_encode_unsigned32,  \
+		knx_signed32:   knx_dpt_encode_signed32,    \
+		knx_string:     knx_dpt_encode_string,      \
+		knx_datetime:   knx_dpt_encode_datetime,    \
+		knx_signed64:   knx_dpt_encode_signed64,    \
+		knx_rgb:        knx_dpt_encode_rgb,         \
+		knx_rgbw:       knx_dpt_encode_rgbw         \
+	)(apdu, value)
+
+/**
+ * Decode a value whose datapoint type follows from the C type of the output.
+ *
+ * \param apdu   APDU
+ * \param length Number of bytes in `apdu`
+ * \param value  Pointer to the output value
+ * \returns `true` on success, otherwise `false`
+ */
+#define knx_dpt_decode(apdu, length, value)         \
+	_Generic((value),                               \
+		knx_bool*:       knx_dpt_decode_bool,       \
+		knx_cvalue*:     knx_dpt_decode_cvalue,     \
+		knx_cstep*:      knx_dpt_decode_cstep,      \
+		knx_char*:       knx_dpt_decode_char,       \
+		knx_unsigned8*:  knx_dpt_decode_unsigned8,  \
+		knx_signed8*:    knx_dpt_decode_signed8,    \
+		knx_unsigned16*: knx_dpt_decode_unsigned16, \
+		knx_signed16*:   knx_dpt_decode_signed16,   \
+		knx_float16*:    knx_dpt_decode_float16,    \
+		knx_timeofday*:  knx_dpt_decode_timeofday,  \
+		knx_date*:       knx_dpt_decode_date,       \
+		knx_unsigned32*: knx_dpt_decode_unsigned32, \
+		knx_signed32*:   knx_dpt_decode_signed32,   \
+		knx_string*:     knx_dpt_decode_string,     \
+		knx_datetime*:   knx_dpt_decode_datetime,   \
+		knx_signed64*:   knx_dpt_decode_signed64,   \
+		knx_rgb*:        knx_dpt_decode_rgb,        \
+		knx_rgbw*:       knx_dpt_decode_rgbw        \
+	)(apdu, length, value)
+
+#endif
+
+#endif
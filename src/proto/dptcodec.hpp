@@ -0,0 +1,141 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_PROTO_DPTCODEC_HPP_
+#define KNXPROTO_PROTO_DPTCODEC_HPP_
+
+extern "C" {
+	#include "dptcodec.h"
+}
+
+namespace knx {
+	/**
+	 * C type and codec of a datapoint type
+	 */
+	template <knx_dpt Type>
+	struct dpt_traits;
+
+	#define KNXPROTO_DPT_TRAITS(dpt, name)                                               \
+		template <>                                                                      \
+		struct dpt_traits<dpt> {                                                         \
+			typedef knx_##name type;                                                     \
+			static const size_t size = dpt##_SIZE;                                       \
+			                                                                             \
+			static bool decode(const uint8_t* apdu, size_t length, knx_##name* value) { \
+				return knx_dpt_decode_##name(apdu, length, value);                       \
+			}                                                                            \
+			                                                                             \
+			static void encode(uint8_t* apdu, knx_##name value) {                        \
+				knx_dpt_encode_##name(apdu, value);                                      \
+			}                                                                            \
+		};
+
+	KNXPROTO_DPT_TRAITS(KNX_DPT_BOOL,       bool)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_CVALUE,     cvalue)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_CSTEP,      cstep)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_CHAR,       char)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_UNSIGNED8,  unsigned8)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_SIGNED8,    signed8)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_UNSIGNED16, unsigned16)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_SIGNED16,   signed16)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_FLOAT16,    float16)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_TIMEOFDAY,  timeofday)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_DATE,       date)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_UNSIGNED32, unsigned32)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_SIGNED32,   signed32)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_FLOAT32,    float32)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_STRING,     string)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_DATETIME,   datetime)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_ENUM8,      enum8)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_SIGNED64,   signed64)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_RGB,        rgb)
+	KNXPROTO_DPT_TRAITS(KNX_DPT_RGBW,       rgbw)
+
+	#undef KNXPROTO_DPT_TRAITS
+
+	/**
+	 * Decode a value of the given datapoint type.
+	 */
+	template <knx_dpt Type> inline
+	bool dpt_decode(const uint8_t* apdu, size_t length, typename dpt_traits<Type>::type& value) {
+		return dpt_traits<Type>::decode(apdu, length, &value);
+	}
+
+	/**
+	 * Encode a value of the given datapoint type.
+	 */
+	template <knx_dpt Type> inline
+	void dpt_encode(uint8_t* apdu, const typename dpt_traits<Type>::type& value) {
+		dpt_traits<Type>::encode(apdu, value);
+	}
+
+	/**
+	 * Datapoint type selected by a C type. Like the C11 macros, `float` selects DPT 9.xxx and
+	 * `uint8_t` selects DPT 5.xxx.
+	 */
+	template <typename T>
+	struct dpt_of;
+
+	#define KNXPROTO_DPT_OF(name, dpt)                    \
+		template <>                                       \
+		struct dpt_of<knx_##name> {                       \
+			static const knx_dpt value = dpt;             \
+		};
+
+	KNXPROTO_DPT_OF(bool,       KNX_DPT_BOOL)
+	KNXPROTO_DPT_OF(cvalue,     KNX_DPT_CVALUE)
+	KNXPROTO_DPT_OF(cstep,      KNX_DPT_CSTEP)
+	KNXPROTO_DPT_OF(char,       KNX_DPT_CHAR)
+	KNXPROTO_DPT_OF(unsigned8,  KNX_DPT_UNSIGNED8)
+	KNXPROTO_DPT_OF(signed8,    KNX_DPT_SIGNED8)
+	KNXPROTO_DPT_OF(unsigned16, KNX_DPT_UNSIGNED16)
+	KNXPROTO_DPT_OF(signed16,   KNX_DPT_SIGNED16)
+	KNXPROTO_DPT_OF(float16,    KNX_DPT_FLOAT16)
+	KNXPROTO_DPT_OF(timeofday,  KNX_DPT_TIMEOFDAY)
+	KNXPROTO_DPT_OF(date,       KNX_DPT_DATE)
+	KNXPROTO_DPT_OF(unsigned32, KNX_DPT_UNSIGNED32)
+	KNXPROTO_DPT_OF(signed32,   KNX_DPT_SIGNED32)
+	KNXPROTO_DPT_OF(string,     KNX_DPT_STRING)
+	KNXPROTO_DPT_OF(datetime,   KNX_DPT_DATETIME)
+	KNXPROTO_DPT_OF(signed64,   KNX_DPT_SIGNED64)
+	KNXPROTO_DPT_OF(rgb,        KNX_DPT_RGB)
+	KNXPROTO_DPT_OF(rgbw,       KNX_DPT_RGBW)
+
+	#undef KNXPROTO_DPT_OF
+
+	/**
+	 * Decode a value whose datapoint type follows from its C type.
+	 */
+	template <typename T> inline
+	bool dpt_decode(const uint8_t* apdu, size_t length, T& value) {
+		return dpt_decode<dpt_of<T>::value>(apdu, length, value);
+	}
+
+	/**
+	 * Encode a value whose datapoint type follows from its C type.
+	 */
+	template <typename T> inline
+	void dpt_encode(uint8_t* apdu, const T& value) {
+		dpt_encode<dpt_of<T>::value>(apdu, value);
+	}
+}
+
+#endif
@@ -0,0 +1,384 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "dptreg.h"
+
+#include <math.h>
+
+// Sub-type arrays are dense and must be sorted by sub number
+#define knx_dpt_subtype(m, s, t, n, u, lo, hi, mul, div) {m, s, t, n, u, lo, hi, mul, div}
+
+#define knx_dpt_subtypes_bool(s, n) knx_dpt_subtype(1, s, KNX_DPT_BOOL, n, "", 0, 1, 1, 1)
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_1[] = {
+	knx_dpt_subtypes_bool(1,   "DPT_Switch"),
+	knx_dpt_subtypes_bool(2,   "DPT_Bool"),
+	knx_dpt_subtypes_bool(3,   "DPT_Enable"),
+	knx_dpt_subtypes_bool(4,   "DPT_Ramp"),
+	knx_dpt_subtypes_bool(5,   "DPT_Alarm"),
+	knx_dpt_subtypes_bool(6,   "DPT_BinaryValue"),
+	knx_dpt_subtypes_bool(7,   "DPT_Step"),
+	knx_dpt_subtypes_bool(8,   "DPT_UpDown"),
+	knx_dpt_subtypes_bool(9,   "DPT_OpenClose"),
+	knx_dpt_subtypes_bool(10,  "DPT_Start"),
+	knx_dpt_subtypes_bool(11,  "DPT_State"),
+	knx_dpt_subtypes_bool(12,  "DPT_Invert"),
+	knx_dpt_subtypes_bool(13,  "DPT_DimSendStyle"),
+	knx_dpt_subtypes_bool(14,  "DPT_InputSource"),
+	knx_dpt_subtypes_bool(15,  "DPT_Reset"),
+	knx_dpt_subtypes_bool(16,  "DPT_Ack"),
+	knx_dpt_subtypes_bool(17,  "DPT_Trigger"),
+	knx_dpt_subtypes_bool(18,  "DPT_Occupancy"),
+	knx_dpt_subtypes_bool(19,  "DPT_Window_Door"),
+	knx_dpt_subtypes_bool(21,  "DPT_LogicalFunction"),
+	knx_dpt_subtypes_bool(22,  "DPT_Scene_AB"),
+	knx_dpt_subtypes_bool(23,  "DPT_ShutterBlinds_Mode"),
+	knx_dpt_subtypes_bool(100, "DPT_Heat_Cool")
+};
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_2[] = {
+	knx_dpt_subtype(2, 1, KNX_DPT_CVALUE, "DPT_Switch_Control", "", 0, 0, 1, 1),
+	knx_dpt_subtype(2, 2, KNX_DPT_CVALUE, "DPT_Bool_Control",   "", 0, 0, 1, 1)
+};
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_3[] = {
+	knx_dpt_subtype(3, 7, KNX_DPT_CSTEP, "DPT_Control_Dimming", "", 0, 0, 1, 1),
+	knx_dpt_subtype(3, 8, KNX_DPT_CSTEP, "DPT_Control_Blinds",  "", 0, 0, 1, 1)
+};
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_4[] = {
+	knx_dpt_subtype(4, 1, KNX_DPT_CHAR, "DPT_Char_ASCII",   "", 0, 127, 1, 1),
+	knx_dpt_subtype(4, 2, KNX_DPT_CHAR, "DPT_Char_8859_1",  "", 0, 255, 1, 1)
+};
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_5[] = {
+	knx_dpt_subtype(5, 1,  KNX_DPT_UNSIGNED8, "DPT_Scaling",        "%",      0, 100, 100, 255),
+	knx_dpt_subtype(5, 3,  KNX_DPT_UNSIGNED8, "DPT_Angle",          "°",      0, 360, 360, 255),
+	knx_dpt_subtype(5, 4,  KNX_DPT_UNSIGNED8, "DPT_Percent_U8",     "%",      0, 255, 1,   1),
+	knx_dpt_subtype(5, 5,  KNX_DPT_UNSIGNED8, "DPT_DecimalFactor",  "",       0, 255, 1,   1),
+	knx_dpt_subtype(5, 6,  KNX_DPT_UNSIGNED8, "DPT_Tariff",         "",       0, 254, 1,   1),
+	knx_dpt_subtype(5, 10, KNX_DPT_UNSIGNED8, "DPT_Value_1_Ucount", "pulses", 0, 255, 1,   1)
+};
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_6[] = {
+	knx_dpt_subtype(6, 1,  KNX_DPT_SIGNED8, "DPT_Percent_V8",    "%",      -128, 127, 1, 1),
+	knx_dpt_subtype(6, 10, KNX_DPT_SIGNED8, "DPT_Value_1_Count", "pulses", -128, 127, 1, 1)
+};
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_7[] = {
+	knx_dpt_subtype(7, 1,   KNX_DPT_UNSIGNED16, "DPT_Value_2_Ucount",             "pulses", 0, 65535,   1,   1),
+	knx_dpt_subtype(7, 2,   KNX_DPT_UNSIGNED16, "DPT_TimePeriodMsec",             "ms",     0, 65535,   1,   1),
+	knx_dpt_subtype(7, 3,   KNX_DPT_UNSIGNED16, "DPT_TimePeriod10MSec",           "ms",     0, 655350,  10,  1),
+	knx_dpt_subtype(7, 4,   KNX_DPT_UNSIGNED16, "DPT_TimePeriod100MSec",          "ms",     0, 6553500, 100, 1),
+	knx_dpt_subtype(7, 5,   KNX_DPT_UNSIGNED16, "DPT_TimePeriodSec",              "s",      0, 65535,   1,   1),
+	knx_dpt_subtype(7, 6,   KNX_DPT_UNSIGNED16, "DPT_TimePeriodMin",              "min",    0, 65535,   1,   1),
+	knx_dpt_subtype(7, 7,   KNX_DPT_UNSIGNED16, "DPT_TimePeriodHrs",              "h",      0, 65535,   1,   1),
+	knx_dpt_subtype(7, 11,  KNX_DPT_UNSIGNED16, "DPT_Length_mm",                  "mm",     0, 65535,   1,   1),
+	knx_dpt_subtype(7, 12,  KNX_DPT_UNSIGNED16, "DPT_UElCurrentmA",               "mA",     0, 65535,   1,   1),
+	knx_dpt_subtype(7, 13,  KNX_DPT_UNSIGNED16, "DPT_Brightness",                 "lx",     0, 65535,   1,   1),
+	knx_dpt_subtype(7, 600, KNX_DPT_UNSIGNED16, "DPT_Absolute_Colour_Temperature", "K",     0, 65535,   1,   1)
+};
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_8[] = {
+	knx_dpt_subtype(8, 1,  KNX_DPT_SIGNED16, "DPT_Value_2_Count",   "pulses", -32768,  32767,  1, 1),
+	knx_dpt_subtype(8, 2,  KNX_DPT_SIGNED16, "DPT_DeltaTimeMsec",   "ms",     -32768,  32767,  1, 1),
+	knx_dpt_subtype(8, 5,  KNX_DPT_SIGNED16, "DPT_DeltaTimeSec",    "s",      -32768,  32767,  1, 1),
+	knx_dpt_subtype(8, 10, KNX_DPT_SIGNED16, "DPT_Percent_V16",     "%",      -327.68, 327.67, 1, 100),
+	knx_dpt_subtype(8, 11, KNX_DPT_SIGNED16, "DPT_Rotation_Angle",  "°",      -32768,  32767,  1, 1)
+};
+
+#define knx_dpt_subtypes_float16(s, n, u, lo, hi) knx_dpt_subtype(9, s, KNX_DPT_FLOAT16, n, u, lo, hi, 1, 1)
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_9[] = {
+	knx_dpt_subtypes_float16(1,  "DPT_Value_Temp",          "°C",    -273,      670760),
+	knx_dpt_subtypes_float16(2,  "DPT_Value_Tempd",         "K",     -670760,   670760),
+	knx_dpt_subtypes_float16(3,  "DPT_Value_Tempa",         "K/h",   -670760,   670760),
+	knx_dpt_subtypes_float16(4,  "DPT_Value_Lux",           "lx",    0,         670760),
+	knx_dpt_subtypes_float16(5,  "DPT_Value_Wsp",           "m/s",   0,         670760),
+	knx_dpt_subtypes_float16(6,  "DPT_Value_Pres",          "Pa",    0,         670760),
+	knx_dpt_subtypes_float16(7,  "DPT_Value_Humidity",      "%",     0,         670760),
+	knx_dpt_subtypes_float16(8,  "DPT_Value_AirQuality",    "ppm",   0,         670760),
+	knx_dpt_subtypes_float16(10, "DPT_Value_Time1",         "s",     -670760,   670760),
+	knx_dpt_subtypes_float16(11, "DPT_Value_Time2",         "ms",    -670760,   670760),
+	knx_dpt_subtypes_float16(20, "DPT_Value_Volt",          "mV",    -670760,   670760),
+	knx_dpt_subtypes_float16(21, "DPT_Value_Curr",          "mA",    -670760,   670760),
+	knx_dpt_subtypes_float16(22, "DPT_PowerDensity",        "W/m²",  -670760,   670760),
+	knx_dpt_subtypes_float16(23, "DPT_KelvinPerPercent",    "K/%",   -670760,   670760),
+	knx_dpt_subtypes_float16(24, "DPT_Power",               "kW",    -670760,   670760),
+	knx_dpt_subtypes_float16(25, "DPT_Value_Volume_Flow",   "l/h",   -670760,   670760),
+	knx_dpt_subtypes_float16(26, "DPT_Rain_Amount",         "l/m²",  -671088.64, 670760.96),
+	knx_dpt_subtypes_float16(27, "DPT_Value_Temp_F",        "°F",    -459.6,    670760),
+	knx_dpt_subtypes_float16(28, "DPT_Value_Wsp_kmh",       "km/h",  0,         670760)
+};
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_10[] = {
+	knx_dpt_subtype(10, 1, KNX_DPT_TIMEOFDAY, "DPT_TimeOfDay", "", 0, 0, 1, 1)
+};
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_11[] = {
+	knx_dpt_subtype(11, 1, KNX_DPT_DATE, "DPT_Date", "", 0, 0, 1, 1)
+};
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_12[] = {
+	knx_dpt_subtype(12, 1, KNX_DPT_UNSIGNED32, "DPT_Value_4_Ucount", "pulses", 0, 4294967295.0, 1, 1)
+};
+
+#define knx_dpt_subtypes_signed32(s, n, u, mul, div) \
+	knx_dpt_subtype(13, s, KNX_DPT_SIGNED32, n, u, -2147483648.0 * (mul) / (div), 2147483647.0 * (mul) / (div), mul, div)
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_13[] = {
+	knx_dpt_subtypes_signed32(1,   "DPT_Value_4_Count",     "pulses", 1, 1),
+	knx_dpt_subtypes_signed32(2,   "DPT_FlowRate_m3/h",     "m³/h",   1, 10000),
+	knx_dpt_subtypes_signed32(10,  "DPT_ActiveEnergy",      "Wh",     1, 1),
+	knx_dpt_subtypes_signed32(11,  "DPT_ApparantEnergy",    "VAh",    1, 1),
+	knx_dpt_subtypes_signed32(12,  "DPT_ReactiveEnergy",    "VARh",   1, 1),
+	knx_dpt_subtypes_signed32(13,  "DPT_ActiveEnergy_kWh",  "kWh",    1, 1),
+	knx_dpt_subtypes_signed32(14,  "DPT_ApparantEnergy_kVAh", "kVAh", 1, 1),
+	knx_dpt_subtypes_signed32(15,  "DPT_ReactiveEnergy_kVARh", "kVARh", 1, 1),
+	knx_dpt_subtypes_signed32(100, "DPT_LongDeltaTimeSec",  "s",      1, 1)
+};
+
+#define knx_dpt_subtypes_float32(s, n, u) knx_dpt_subtype(14, s, KNX_DPT_FLOAT32, n, u, -3.4028234663852886e38, 3.4028234663852886e38, 1, 1)
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_14[] = {
+	knx_dpt_subtypes_float32(0,  "DPT_Value_Acceleration",           "m/s²"),
+	knx_dpt_subtypes_float32(1,  "DPT_Value_Acceleration_Angular",   "rad/s²"),
+	knx_dpt_subtypes_float32(7,  "DPT_Value_AngleDeg",               "°"),
+	knx_dpt_subtypes_float32(19, "DPT_Value_Electric_Current",       "A"),
+	knx_dpt_subtypes_float32(27, "DPT_Value_Electric_Potential",     "V"),
+	knx_dpt_subtypes_float32(31, "DPT_Value_Energy",                 "J"),
+	knx_dpt_subtypes_float32(33, "DPT_Value_Frequency",              "Hz"),
+	knx_dpt_subtypes_float32(56, "DPT_Value_Power",                  "W"),
+	knx_dpt_subtypes_float32(57, "DPT_Value_Power_Factor",           ""),
+	knx_dpt_subtypes_float32(65, "DPT_Value_Speed",                  "m/s"),
+	knx_dpt_subtypes_float32(68, "DPT_Value_Common_Temperature",     "°C"),
+	knx_dpt_subtypes_float32(76, "DPT_Value_Volume",                 "m³"),
+	knx_dpt_subtypes_float32(77, "DPT_Value_Volume_Flux",            "m³/s")
+};
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_16[] = {
+	knx_dpt_subtype(16, 0, KNX_DPT_STRING, "DPT_String_ASCII",  "", 0, 0, 1, 1),
+	knx_dpt_subtype(16, 1, KNX_DPT_STRING, "DPT_String_8859_1", "", 0, 0, 1, 1)
+};
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_19[] = {
+	knx_dpt_subtype(19, 1, KNX_DPT_DATETIME, "DPT_DateTime", "", 0, 0, 1, 1)
+};
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_20[] = {
+	knx_dpt_subtype(20, 1,   KNX_DPT_ENUM8, "DPT_SCLOMode",           "", 0, 3,  1, 1),
+	knx_dpt_subtype(20, 2,   KNX_DPT_ENUM8, "DPT_BuildingMode",       "", 0, 2,  1, 1),
+	knx_dpt_subtype(20, 3,   KNX_DPT_ENUM8, "DPT_OccMode",            "", 0, 2,  1, 1),
+	knx_dpt_subtype(20, 4,   KNX_DPT_ENUM8, "DPT_Priority",           "", 0, 3,  1, 1),
+	knx_dpt_subtype(20, 5,   KNX_DPT_ENUM8, "DPT_LightApplicationMode", "", 0, 2, 1, 1),
+	knx_dpt_subtype(20, 102, KNX_DPT_ENUM8, "DPT_HVACMode",           "", 0, 4,  1, 1),
+	knx_dpt_subtype(20, 105, KNX_DPT_ENUM8, "DPT_HVACContrMode",      "", 0, 20, 1, 1)
+};
+
+#define knx_dpt_subtypes_signed64(s, n, u) \
+	knx_dpt_subtype(29, s, KNX_DPT_SIGNED64, n, u, -9223372036854775808.0, 9223372036854775807.0, 1, 1)
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_29[] = {
+	knx_dpt_subtypes_signed64(10, "DPT_ActiveEnergy_V64",   "Wh"),
+	knx_dpt_subtypes_signed64(11, "DPT_ApparantEnergy_V64", "VAh"),
+	knx_dpt_subtypes_signed64(12, "DPT_ReactiveEnergy_V64", "VARh")
+};
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_232[] = {
+	knx_dpt_subtype(232, 600, KNX_DPT_RGB, "DPT_Colour_RGB", "", 0, 0, 1, 1)
+};
+
+static
+const knx_dpt_descriptor knx_dpt_subtypes_251[] = {
+	knx_dpt_subtype(251, 600, KNX_DPT_RGBW, "DPT_Colour_RGBW", "", 0, 0, 1, 1)
+};
+
+#define knx_dpt_subtypes_entry(m) \
+	{m, knx_dpt_subtypes_##m, sizeof(knx_dpt_subtypes_##m) / sizeof(knx_dpt_descriptor)}
+
+// First level: main number, second level: sub number. Both are sorted for binary search.
+static
+const struct {
+	uint16_t main;
+	const knx_dpt_descriptor* subtypes;
+	size_t count;
+} knx_dpt_mains[] = {
+	knx_dpt_subtypes_entry(1),
+	knx_dpt_subtypes_entry(2),
+	knx_dpt_subtypes_entry(3),
+	knx_dpt_subtypes_entry(4),
+	knx_dpt_subtypes_entry(5),
+	knx_dpt_subtypes_entry(6),
+	knx_dpt_subtypes_entry(7),
+	knx_dpt_subtypes_entry(8),
+	knx_dpt_subtypes_entry(9),
+	knx_dpt_subtypes_entry(10),
+	knx_dpt_subtypes_entry(11),
+	knx_dpt_subtypes_entry(12),
+	knx_dpt_subtypes_entry(13),
+	knx_dpt_subtypes_entry(14),
+	knx_dpt_subtypes_entry(16),
+	knx_dpt_subtypes_entry(19),
+	knx_dpt_subtypes_entry(20),
+	knx_dpt_subtypes_entry(29),
+	knx_dpt_subtypes_entry(232),
+	knx_dpt_subtypes_entry(251)
+};
+
+const knx_dpt_descriptor* knx_dpt_subtype_find(uint16_t main, uint16_t sub) {
+	size_t a = 0, b = sizeof(knx_dpt_mains) / sizeof(knx_dpt_mains[0]);
+
+	while (a < b) {
+		size_t m = a + (b - a) / 2;
+
+		if (knx_dpt_mains[m].main < main)
+			a = m + 1;
+		else
+			b = m;
+	}
+
+	if (a == sizeof(knx_dpt_mains) / sizeof(knx_dpt_mains[0]) || knx_dpt_mains[a].main != main)
+		return NULL;
+
+	const knx_dpt_descriptor* subtypes = knx_dpt_mains[a].subtypes;
+	size_t count = knx_dpt_mains[a].count;
+
+	a = 0;
+	b = count;
+
+	while (a < b) {
+		size_t m = a + (b - a) / 2;
+
+		if (subtypes[m].sub < sub)
+			a = m + 1;
+		else
+			b = m;
+	}
+
+	return a < count && subtypes[a].sub == sub ? subtypes + a : NULL;
+}
+
+bool knx_dpt_subtype_decode(
+	const uint8_t*            apdu,
+	size_t                    length,
+	const knx_dpt_descriptor* descriptor,
+	double*                   value
+) {
+	knx_dpt_value raw;
+
+	// The codecs take care of the big-endian byte order of multi-byte types
+	if (!knx_dpt_from_apdu(apdu, length, descriptor->type, &raw))
+		return false;
+
+	double result;
+
+	if (!knx_dpt_value_number(descriptor->type, &raw, &result))
+		return false;
+
+	*value = result * descriptor->multiplier / descriptor->divisor;
+	return true;
+}
+
+#define knx_dpt_subtype_generate(ctype, lo, hi) {      \
+	ctype result = (ctype) fmin(fmax(rint(raw), lo), hi); \
+	knx_dpt_to_apdu(apdu, descriptor->type, &result);     \
+	return true;                                          \
+}
+
+bool knx_dpt_subtype_encode(uint8_t* apdu, const knx_dpt_descriptor* descriptor, double value) {
+	value = fmin(fmax(value, descriptor->min), descriptor->max);
+
+	double raw = value * descriptor->divisor / descriptor->multiplier;
+
+	switch (descriptor->type) {
+		case KNX_DPT_BOOL: {
+			knx_bool b = raw >= 0.5;
+			knx_dpt_to_apdu(apdu, descriptor->type, &b);
+			return true;
+		}
+
+		case KNX_DPT_CHAR: {
+			// knx_char may be signed, values above 127 must go through the unsigned type
+			knx_char c = (knx_char) (uint8_t) fmin(fmax(rint(raw), 0), UINT8_MAX);
+			knx_dpt_to_apdu(apdu, descriptor->type, &c);
+			return true;
+		}
+
+		case KNX_DPT_UNSIGNED8:
+			knx_dpt_subtype_generate(knx_unsigned8, 0, UINT8_MAX);
+
+		case KNX_DPT_SIGNED8:
+			knx_dpt_subtype_generate(knx_signed8, INT8_MIN, INT8_MAX);
+
+		case KNX_DPT_UNSIGNED16:
+			knx_dpt_subtype_generate(knx_unsigned16, 0, UINT16_MAX);
+
+		case KNX_DPT_SIGNED16:
+			knx_dpt_subtype_generate(knx_signed16, INT16_MIN, INT16_MAX);
+
+		case KNX_DPT_UNSIGNED32:
+			knx_dpt_subtype_generate(knx_unsigned32, 0, UINT32_MAX);
+
+		case KNX_DPT_SIGNED32:
+			knx_dpt_subtype_generate(knx_signed32, INT32_MIN, INT32_MAX);
+
+		case KNX_DPT_ENUM8:
+			knx_dpt_subtype_generate(knx_enum8, 0, UINT8_MAX);
+
+		case KNX_DPT_SIGNED64:
+			// The largest double below 2^63 keeps the conversion defined
+			knx_dpt_subtype_generate(knx_signed64, INT64_MIN, 9223372036854774784.0);
+
+		case KNX_DPT_FLOAT16: {
+			knx_float16 f = raw;
+			knx_dpt_to_apdu(apdu, descriptor->type, &f);
+			return true;
+		}
+
+		case KNX_DPT_FLOAT32: {
+			knx_float32 f = raw;
+			knx_dpt_to_apdu(apdu, descriptor->type, &f);
+			return true;
+		}
+
+		default:
+			return false;
+	}
+}
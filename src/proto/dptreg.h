@@ -0,0 +1,119 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_PROTO_DPTREG_H_
+#define KNXPROTO_PROTO_DPTREG_H_
+
+#include "data.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Datapoint Sub-Type Descriptor
+ *
+ * Numeric values are obtained from the raw value using
+ * `value = raw * multiplier / divisor`.
+ */
+typedef struct {
+	/**
+	 * Main number
+	 */
+	uint16_t main;
+
+	/**
+	 * Sub number
+	 */
+	uint16_t sub;
+
+	/**
+	 * Underlying datapoint type
+	 */
+	knx_dpt type;
+
+	/**
+	 * Name as found in the KNX specification (e.g. "DPT_Switch")
+	 */
+	const char* name;
+
+	/**
+	 * Unit of the scaled value (UTF-8, empty if there is none)
+	 */
+	const char* unit;
+
+	/**
+	 * Smallest valid scaled value
+	 */
+	double min;
+
+	/**
+	 * Largest valid scaled value
+	 */
+	double max;
+
+	/**
+	 * Scaling multiplier
+	 */
+	double multiplier;
+
+	/**
+	 * Scaling divisor
+	 */
+	double divisor;
+} knx_dpt_descriptor;
+
+/**
+ * Find the descriptor of a datapoint sub-type.
+ *
+ * \param main Main number (e.g. 9 for 9.001)
+ * \param sub  Sub number (e.g. 1 for 9.001)
+ * \returns Descriptor or `NULL` if the sub-type is unknown
+ */
+const knx_dpt_descriptor* knx_dpt_subtype_find(uint16_t main, uint16_t sub);
+
+/**
+ * Decode an APDU to a scaled numeric value.
+ *
+ * \param apdu       APDU
+ * \param length     Number of bytes in `apdu`
+ * \param descriptor Datapoint sub-type
+ * \param value      Output value
+ * \returns `true` on success, `false` if the APDU is invalid or the type is not numeric
+ */
+bool knx_dpt_subtype_decode(
+	const uint8_t*            apdu,
+	size_t                    length,
+	const knx_dpt_descriptor* descriptor,
+	double*                   value
+);
+
+/**
+ * Encode a scaled numeric value. It will be clamped to the sub-type's range.
+ *
+ * \param apdu       Output APDU with room for `knx_dpt_size(descriptor->type)` bytes
+ * \param descriptor Datapoint sub-type
+ * \param value      Scaled value
+ * \returns `true` on success, `false` if the type is not numeric
+ */
+bool knx_dpt_subtype_encode(uint8_t* apdu, const knx_dpt_descriptor* descriptor, double value);
+
+#endif
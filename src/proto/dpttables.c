@@ -0,0 +1,170 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "dpttables.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdio.h>
+#include <unistd.h>
+
+// Identifies a tables file: "KNXT"
+#define KNX_DPT_TABLES_MAGIC 0x4B4E5854
+
+#define KNX_DPT_TABLES_VERSION 1
+
+#define KNX_DPT_TABLES_BYTE_ORDER 0x0102
+
+static
+knx_dpt_tables knx_dpt_tables_local;
+
+// 0 = not built, 1 = being built, 2 = ready
+static
+int knx_dpt_tables_state = 0;
+
+static
+void knx_dpt_tables_build(knx_dpt_tables* tables) {
+	tables->magic = KNX_DPT_TABLES_MAGIC;
+	tables->version = KNX_DPT_TABLES_VERSION;
+	tables->byte_order = KNX_DPT_TABLES_BYTE_ORDER;
+
+	// Decode every encoding in chunks that share the high byte
+	uint8_t raw[512];
+
+	for (size_t high = 0; high < 256; high++) {
+		for (size_t low = 0; low < 256; low++) {
+			raw[2 * low] = high;
+			raw[2 * low + 1] = low;
+		}
+
+		knx_dpt_float16_decode_batch(raw, 256, tables->float16 + (high << 8));
+	}
+
+	for (size_t i = 0; i < 256; i++) {
+		tables->scaling[i] = i * 100.0f / 255.0f;
+		tables->angle[i] = i * 360.0f / 255.0f;
+	}
+}
+
+inline static
+bool knx_dpt_tables_valid(const knx_dpt_tables* tables) {
+	return
+		tables->magic == KNX_DPT_TABLES_MAGIC &&
+		tables->version == KNX_DPT_TABLES_VERSION &&
+		tables->byte_order == KNX_DPT_TABLES_BYTE_ORDER;
+}
+
+const knx_dpt_tables* knx_dpt_tables_get(void) {
+	int state = __atomic_load_n(&knx_dpt_tables_state, __ATOMIC_ACQUIRE);
+
+	if (state == 2)
+		return &knx_dpt_tables_local;
+
+	// Only one thread builds the tables, everyone else waits for it
+	int expected = 0;
+	if (__atomic_compare_exchange_n(&knx_dpt_tables_state, &expected, 1, false,
+	                                __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+		knx_dpt_tables_build(&knx_dpt_tables_local);
+		__atomic_store_n(&knx_dpt_tables_state, 2, __ATOMIC_RELEASE);
+	} else {
+		while (__atomic_load_n(&knx_dpt_tables_state, __ATOMIC_ACQUIRE) != 2)
+			sched_yield();
+	}
+
+	return &knx_dpt_tables_local;
+}
+
+inline static
+const knx_dpt_tables* knx_dpt_tables_map_existing(const char* path) {
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return NULL;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || (size_t) info.st_size != sizeof(knx_dpt_tables)) {
+		close(fd);
+		return NULL;
+	}
+
+	void* base = mmap(NULL, sizeof(knx_dpt_tables), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (base == MAP_FAILED)
+		return NULL;
+
+	if (!knx_dpt_tables_valid(base)) {
+		munmap(base, sizeof(knx_dpt_tables));
+		return NULL;
+	}
+
+	return base;
+}
+
+const knx_dpt_tables* knx_dpt_tables_map(const char* path) {
+	const knx_dpt_tables* tables = knx_dpt_tables_map_existing(path);
+	if (tables)
+		return tables;
+
+	// Write to a temporary file first, so concurrent processes never see a partial file
+	char temp_path[4096];
+	if (snprintf(temp_path, sizeof(temp_path), "%s.%ld", path, (long) getpid()) >= (int) sizeof(temp_path))
+		return NULL;
+
+	FILE* file = fopen(temp_path, "wb");
+	if (!file)
+		return NULL;
+
+	bool written = fwrite(knx_dpt_tables_get(), sizeof(knx_dpt_tables), 1, file) == 1;
+
+	if (fclose(file) != 0 || !written || rename(temp_path, path) != 0) {
+		unlink(temp_path);
+		return NULL;
+	}
+
+	return knx_dpt_tables_map_existing(path);
+}
+
+void knx_dpt_tables_unmap(const knx_dpt_tables* tables) {
+	if (tables && tables != &knx_dpt_tables_local)
+		munmap((void*) tables, sizeof(knx_dpt_tables));
+}
+
+void knx_dpt_tables_float16_batch(
+	const knx_dpt_tables* tables,
+	const uint8_t*        raw,
+	size_t                count,
+	knx_float16*          values
+) {
+	for (size_t i = 0; i < count; i++)
+		values[i] = tables->float16[raw[2 * i] << 8 | raw[2 * i + 1]];
+}
+
+void knx_dpt_tables_unsigned8_batch(
+	const float*   table,
+	const uint8_t* raw,
+	size_t         count,
+	float*         values
+) {
+	for (size_t i = 0; i < count; i++)
+		values[i] = table[raw[i]];
+}
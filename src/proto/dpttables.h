@@ -0,0 +1,135 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_PROTO_DPTTABLES_H_
+#define KNXPROTO_PROTO_DPTTABLES_H_
+
+#include "data.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Precomputed DPT Tables
+ *
+ * Every DPT 9.xxx value and every 8-bit scaled value decodes with a single load. The layout is
+ * fixed, so the tables can be stored in a file and mapped read-only by many processes.
+ */
+typedef struct {
+	/**
+	 * Identifies the tables
+	 */
+	uint32_t magic;
+
+	/**
+	 * Layout version
+	 */
+	uint16_t version;
+
+	/**
+	 * Detects a file created on a machine with different byte order
+	 */
+	uint16_t byte_order;
+
+	/**
+	 * DPT 9.xxx indexed by the raw 16-bit encoding
+	 */
+	knx_float16 float16[65536];
+
+	/**
+	 * DPT 5.001 (percentage from 0 to 100)
+	 */
+	float scaling[256];
+
+	/**
+	 * DPT 5.003 (angle from 0 to 360 degrees)
+	 */
+	float angle[256];
+} knx_dpt_tables;
+
+/**
+ * Retrieve the process-local tables, they are built during the first invocation.
+ */
+const knx_dpt_tables* knx_dpt_tables_get(void);
+
+/**
+ * Map the tables from a file. If the file does not exist or is invalid, it is (re-)created.
+ *
+ * \param path Path to the tables file
+ * \returns Read-only tables or `NULL` on failure
+ */
+const knx_dpt_tables* knx_dpt_tables_map(const char* path);
+
+/**
+ * Unmap tables which have been obtained using `knx_dpt_tables_map`.
+ */
+void knx_dpt_tables_unmap(const knx_dpt_tables* tables);
+
+/**
+ * Make `knx_dpt_from_apdu` use the given tables.
+ *
+ * \param tables Tables to use or `NULL` to stop using them
+ */
+inline static
+void knx_dpt_tables_enable(const knx_dpt_tables* tables) {
+	knx_dpt_use_float16_table(tables ? tables->float16 : NULL);
+}
+
+/**
+ * Look up a DPT 9.xxx value.
+ *
+ * \param tables Tables
+ * \param apdu   APDU of length `KNX_DPT_FLOAT16_SIZE`
+ */
+inline static
+knx_float16 knx_dpt_tables_float16(const knx_dpt_tables* tables, const uint8_t* apdu) {
+	return tables->float16[apdu[1] << 8 | apdu[2]];
+}
+
+/**
+ * Look up many DPT 9.xxx values.
+ *
+ * \see knx_dpt_float16_decode_batch
+ */
+void knx_dpt_tables_float16_batch(
+	const knx_dpt_tables* tables,
+	const uint8_t*        raw,
+	size_t                count,
+	knx_float16*          values
+);
+
+/**
+ * Look up many 8-bit values in one of the 256-entry tables.
+ *
+ * \param table  Either `tables->scaling` or `tables->angle`
+ * \param raw    Raw 8-bit values (i.e. the APDUs without their first byte)
+ * \param count  Number of values in `raw`
+ * \param values Output array with room for `count` values
+ */
+void knx_dpt_tables_unsigned8_batch(
+	const float*   table,
+	const uint8_t* raw,
+	size_t         count,
+	float*         values
+);
+
+#endif
@@ -0,0 +1,735 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "format.h"
+
+#include <math.h>
+#include <string.h>
+
+// Number of significant digits used for non-integral values, floats carry no more than this
+#define KNX_FORMAT_PRECISION 7
+
+static
+const char knx_format_digit_pairs[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+static
+const char knx_format_hex_digits[17] = "0123456789abcdef";
+
+static
+const uint64_t knx_format_powers_of_ten[] = {
+	1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull
+};
+
+typedef struct {
+	char* cursor;
+	char* end;
+	bool overflow;
+} knx_format_writer;
+
+inline static
+void knx_format_writer_init(knx_format_writer* writer, char* buffer, size_t size) {
+	// Reserve space for the null character
+	writer->cursor = buffer;
+	writer->end = size > 0 ? buffer + size - 1 : buffer;
+	writer->overflow = size == 0;
+}
+
+inline static
+ssize_t knx_format_writer_finish(knx_format_writer* writer, char* buffer) {
+	if (writer->overflow)
+		return -1;
+
+	*writer->cursor = 0;
+	return writer->cursor - buffer;
+}
+
+inline static
+void knx_format_put(knx_format_writer* writer, const char* data, size_t length) {
+	if ((size_t) (writer->end - writer->cursor) < length) {
+		writer->overflow = true;
+		return;
+	}
+
+	memcpy(writer->cursor, data, length);
+	writer->cursor += length;
+}
+
+inline static
+void knx_format_put_char(knx_format_writer* writer, char c) {
+	if (writer->cursor >= writer->end) {
+		writer->overflow = true;
+		return;
+	}
+
+	*writer->cursor++ = c;
+}
+
+#define knx_format_put_literal(writer, literal) \
+	knx_format_put(writer, literal, sizeof(literal) - 1)
+
+inline static
+void knx_format_put_string(knx_format_writer* writer, const char* string) {
+	knx_format_put(writer, string, strlen(string));
+}
+
+inline static
+void knx_format_put_uint(knx_format_writer* writer, uint64_t value) {
+	char digits[20];
+	char* start = digits + sizeof(digits);
+
+	// Two digits at a time
+	while (value >= 100) {
+		start -= 2;
+		memcpy(start, knx_format_digit_pairs + 2 * (value % 100), 2);
+		value /= 100;
+	}
+
+	if (value >= 10) {
+		start -= 2;
+		memcpy(start, knx_format_digit_pairs + 2 * value, 2);
+	} else {
+		*--start = '0' + value;
+	}
+
+	knx_format_put(writer, start, digits + sizeof(digits) - start);
+}
+
+inline static
+void knx_format_put_int(knx_format_writer* writer, int64_t value) {
+	if (value < 0) {
+		knx_format_put_char(writer, '-');
+		knx_format_put_uint(writer, 0 - (uint64_t) value);
+	} else {
+		knx_format_put_uint(writer, value);
+	}
+}
+
+// Fixed number of digits including leading zeros
+inline static
+void knx_format_put_padded(knx_format_writer* writer, uint64_t value, size_t width) {
+	char digits[20];
+
+	for (size_t i = width; i > 0; i--, value /= 10)
+		digits[i - 1] = '0' + value % 10;
+
+	knx_format_put(writer, digits, width);
+}
+
+inline static
+void knx_format_put_hex(knx_format_writer* writer, uint8_t value) {
+	const char digits[2] = {knx_format_hex_digits[value >> 4], knx_format_hex_digits[value & 15]};
+	knx_format_put(writer, digits, 2);
+}
+
+static
+void knx_format_put_double(knx_format_writer* writer, double value) {
+	if (!isfinite(value)) {
+		knx_format_put_literal(writer, "null");
+		return;
+	}
+
+	if (value < 0) {
+		knx_format_put_char(writer, '-');
+		value = -value;
+	}
+
+	if (value == 0) {
+		knx_format_put_char(writer, '0');
+		return;
+	}
+
+	int exponent = 0;
+
+	// Very large or small numbers use scientific notation
+	if (value >= 1e15 || value < 1e-4) {
+		exponent = (int) floor(log10(value));
+		value /= pow(10, exponent);
+
+		if (value >= 10) {
+			value /= 10;
+			exponent++;
+		} else if (value < 1) {
+			value *= 10;
+			exponent--;
+		}
+	}
+
+	size_t integer_digits = 1;
+	for (double limit = 10; value >= limit && integer_digits < KNX_FORMAT_PRECISION; limit *= 10)
+		integer_digits++;
+
+	size_t fraction_digits = value < 1 ? KNX_FORMAT_PRECISION : KNX_FORMAT_PRECISION - integer_digits;
+
+	uint64_t scale = knx_format_powers_of_ten[fraction_digits];
+	uint64_t scaled = llrint(value * scale);
+
+	// Rounding may carry into the exponent (e.g. 9.9999999e5 becomes 1e6)
+	if (exponent != 0 && scaled >= 10 * scale) {
+		scaled /= 10;
+		exponent++;
+	}
+
+	knx_format_put_uint(writer, scaled / scale);
+
+	uint64_t fraction = scaled % scale;
+
+	if (fraction > 0) {
+		while (fraction % 10 == 0) {
+			fraction /= 10;
+			fraction_digits--;
+		}
+
+		knx_format_put_char(writer, '.');
+		knx_format_put_padded(writer, fraction, fraction_digits);
+	}
+
+	if (exponent != 0) {
+		knx_format_put_char(writer, 'e');
+		knx_format_put_int(writer, exponent);
+	}
+}
+
+// Character values (DPT 4 and 16) are ISO-8859-1, other strings are already UTF-8
+static
+void knx_format_put_json_string(
+	knx_format_writer* writer,
+	const char*        string,
+	size_t             length,
+	bool               latin1
+) {
+	knx_format_put_char(writer, '"');
+
+	const char* end = string + length;
+
+	while (string < end) {
+		// Copy runs of characters that need no escaping
+		const char* run = string;
+		while (string < end && *string != '"' && *string != '\\' && (uint8_t) *string >= 0x20 &&
+		       (!latin1 || (uint8_t) *string < 0x80))
+			string++;
+
+		knx_format_put(writer, run, string - run);
+
+		if (string == end)
+			break;
+
+		uint8_t c = *string++;
+
+		switch (c) {
+			case '"':  knx_format_put_literal(writer, "\\\""); break;
+			case '\\': knx_format_put_literal(writer, "\\\\"); break;
+			case '\n': knx_format_put_literal(writer, "\\n");  break;
+			case '\r': knx_format_put_literal(writer, "\\r");  break;
+			case '\t': knx_format_put_literal(writer, "\\t");  break;
+
+			default:
+				if (c >= 0x80) {
+					// Latin-1 code points map directly onto two-byte UTF-8 sequences
+					const char encoded[2] = {0xC0 | (c >> 6), 0x80 | (c & 0x3F)};
+					knx_format_put(writer, encoded, 2);
+				} else {
+					knx_format_put_literal(writer, "\\u00");
+					knx_format_put_hex(writer, c);
+				}
+
+				break;
+		}
+	}
+
+	knx_format_put_char(writer, '"');
+}
+
+inline static
+void knx_format_put_individual_addr(knx_format_writer* writer, knx_addr addr) {
+	knx_format_put_uint(writer, addr >> 12 & 15);
+	knx_format_put_char(writer, '.');
+	knx_format_put_uint(writer, addr >> 8 & 15);
+	knx_format_put_char(writer, '.');
+	knx_format_put_uint(writer, addr & 255);
+}
+
+inline static
+void knx_format_put_group_addr(knx_format_writer* writer, knx_addr addr) {
+	knx_format_put_uint(writer, addr >> 11 & 15);
+	knx_format_put_char(writer, '/');
+	knx_format_put_uint(writer, addr >> 8 & 7);
+	knx_format_put_char(writer, '/');
+	knx_format_put_uint(writer, addr & 255);
+}
+
+size_t knx_format_individual_addr(char* buffer, knx_addr addr) {
+	knx_format_writer writer;
+	knx_format_writer_init(&writer, buffer, KNX_FORMAT_ADDR_SIZE);
+	knx_format_put_individual_addr(&writer, addr);
+
+	return knx_format_writer_finish(&writer, buffer);
+}
+
+size_t knx_format_group_addr(char* buffer, knx_addr addr) {
+	knx_format_writer writer;
+	knx_format_writer_init(&writer, buffer, KNX_FORMAT_ADDR_SIZE);
+	knx_format_put_group_addr(&writer, addr);
+
+	return knx_format_writer_finish(&writer, buffer);
+}
+
+const char* knx_format_service_name(knx_cemi_service service) {
+	switch (service) {
+		case KNX_CEMI_LDATA_REQ:
+			return "L_Data.req";
+
+		case KNX_CEMI_LDATA_IND:
+			return "L_Data.ind";
+
+		case KNX_CEMI_LDATA_CON:
+			return "L_Data.con";
+
+		default:
+			return "Unknown";
+	}
+}
+
+const char* knx_format_apci_name(knx_apci apci) {
+	static const char* const names[16] = {
+		"GroupValueRead",
+		"GroupValueResponse",
+		"GroupValueWrite",
+		"IndividualAddrWrite",
+		"IndividualAddrRequest",
+		"IndividualAddrResponse",
+		"ADCRead",
+		"ADCResponse",
+		"MemoryRead",
+		"MemoryResponse",
+		"MemoryWrite",
+		"UserMessage",
+		"MaskVersionRead",
+		"MaskVersionResponse",
+		"Restart",
+		"Escape"
+	};
+
+	return names[apci & 15];
+}
+
+static
+const char* const knx_format_priority_names[4] = {"system", "normal", "urgent", "low"};
+
+static
+const char* const knx_format_control_names[4] = {"Connect", "Disconnect", "ACK", "NAK"};
+
+static
+const char* const knx_format_day_names[8] = {"", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun"};
+
+inline static
+void knx_format_put_bool(knx_format_writer* writer, bool value) {
+	if (value)
+		knx_format_put_literal(writer, "true");
+	else
+		knx_format_put_literal(writer, "false");
+}
+
+inline static
+void knx_format_put_time(knx_format_writer* writer, uint8_t hour, uint8_t minute, uint8_t second) {
+	knx_format_put_padded(writer, hour, 2);
+	knx_format_put_char(writer, ':');
+	knx_format_put_padded(writer, minute, 2);
+	knx_format_put_char(writer, ':');
+	knx_format_put_padded(writer, second, 2);
+}
+
+inline static
+void knx_format_put_date(knx_format_writer* writer, unsigned year, uint8_t month, uint8_t day) {
+	knx_format_put_padded(writer, year, 4);
+	knx_format_put_char(writer, '-');
+	knx_format_put_padded(writer, month, 2);
+	knx_format_put_char(writer, '-');
+	knx_format_put_padded(writer, day, 2);
+}
+
+inline static
+void knx_format_put_number(knx_format_writer* writer, const knx_dpt_descriptor* descriptor, double value) {
+	knx_format_put_double(writer, value * descriptor->multiplier / descriptor->divisor);
+}
+
+// Integers without scaling are printed exactly
+inline static
+void knx_format_put_integer(knx_format_writer* writer, const knx_dpt_descriptor* descriptor, int64_t value) {
+	if (descriptor->multiplier == descriptor->divisor)
+		knx_format_put_int(writer, value);
+	else
+		knx_format_put_number(writer, descriptor, value);
+}
+
+static
+void knx_format_put_value(
+	knx_format_writer*        writer,
+	const knx_dpt_descriptor* descriptor,
+	const knx_dpt_value*      value
+) {
+	switch (descriptor->type) {
+		case KNX_DPT_BOOL:
+			knx_format_put_bool(writer, value->bool_value);
+			break;
+
+		case KNX_DPT_CVALUE:
+			knx_format_put_literal(writer, "{\"control\":");
+			knx_format_put_bool(writer, value->cvalue.control);
+			knx_format_put_literal(writer, ",\"value\":");
+			knx_format_put_bool(writer, value->cvalue.value);
+			knx_format_put_char(writer, '}');
+			break;
+
+		case KNX_DPT_CSTEP:
+			knx_format_put_literal(writer, "{\"control\":");
+			knx_format_put_bool(writer, value->cstep.control);
+			knx_format_put_literal(writer, ",\"step\":");
+			knx_format_put_uint(writer, value->cstep.step);
+			knx_format_put_char(writer, '}');
+			break;
+
+		case KNX_DPT_CHAR:
+			knx_format_put_json_string(writer, &value->char_value, 1, true);
+			break;
+
+		case KNX_DPT_UNSIGNED8:
+			knx_format_put_integer(writer, descriptor, value->unsigned8);
+			break;
+
+		case KNX_DPT_SIGNED8:
+			knx_format_put_integer(writer, descriptor, value->signed8);
+			break;
+
+		case KNX_DPT_UNSIGNED16:
+			knx_format_put_integer(writer, descriptor, value->unsigned16);
+			break;
+
+		case KNX_DPT_SIGNED16:
+			knx_format_put_integer(writer, descriptor, value->signed16);
+			break;
+
+		case KNX_DPT_FLOAT16:
+			knx_format_put_number(writer, descriptor, value->float16);
+			break;
+
+		case KNX_DPT_TIMEOFDAY:
+			knx_format_put_char(writer, '"');
+
+			if (value->timeofday.day != KNX_NODAY) {
+				knx_format_put_string(writer, knx_format_day_names[value->timeofday.day & 7]);
+				knx_format_put_char(writer, ' ');
+			}
+
+			knx_format_put_time(writer, value->timeofday.hour, value->timeofday.minute,
+			                    value->timeofday.second);
+			knx_format_put_char(writer, '"');
+			break;
+
+		case KNX_DPT_DATE:
+			// Two-digit years from 90 onwards belong to the 20th century
+			knx_format_put_char(writer, '"');
+			knx_format_put_date(writer, value->date.year + (value->date.year >= 90 ? 1900 : 2000),
+			                    value->date.month, value->date.day);
+			knx_format_put_char(writer, '"');
+			break;
+
+		case KNX_DPT_UNSIGNED32:
+			knx_format_put_integer(writer, descriptor, value->unsigned32);
+			break;
+
+		case KNX_DPT_SIGNED32:
+			knx_format_put_integer(writer, descriptor, value->signed32);
+			break;
+
+		case KNX_DPT_FLOAT32:
+			knx_format_put_number(writer, descriptor, value->float32);
+			break;
+
+		case KNX_DPT_STRING:
+			knx_format_put_json_string(writer, value->string.value,
+			                           strnlen(value->string.value, KNX_STRING_LENGTH), true);
+			break;
+
+		case KNX_DPT_DATETIME:
+			knx_format_put_char(writer, '"');
+			knx_format_put_date(writer, value->datetime.year, value->datetime.month, value->datetime.day);
+			knx_format_put_char(writer, 'T');
+			knx_format_put_time(writer, value->datetime.hour, value->datetime.minute,
+			                    value->datetime.second);
+			knx_format_put_char(writer, '"');
+			break;
+
+		case KNX_DPT_ENUM8:
+			knx_format_put_uint(writer, value->enum8);
+			break;
+
+		case KNX_DPT_SIGNED64:
+			knx_format_put_integer(writer, descriptor, value->signed64);
+			break;
+
+		case KNX_DPT_RGB:
+			knx_format_put_literal(writer, "\"#");
+			knx_format_put_hex(writer, value->rgb.red);
+			knx_format_put_hex(writer, value->rgb.green);
+			knx_format_put_hex(writer, value->rgb.blue);
+			knx_format_put_char(writer, '"');
+			break;
+
+		case KNX_DPT_RGBW:
+			knx_format_put_literal(writer, "\"#");
+			knx_format_put_hex(writer, value->rgbw.red);
+			knx_format_put_hex(writer, value->rgbw.green);
+			knx_format_put_hex(writer, value->rgbw.blue);
+			knx_format_put_hex(writer, value->rgbw.white);
+			knx_format_put_char(writer, '"');
+			break;
+
+		default:
+			knx_format_put_literal(writer, "null");
+			break;
+	}
+}
+
+ssize_t knx_format_value(
+	char*                     buffer,
+	size_t                    size,
+	const knx_dpt_descriptor* descriptor,
+	const knx_dpt_value*      value
+) {
+	knx_format_writer writer;
+	knx_format_writer_init(&writer, buffer, size);
+	knx_format_put_value(&writer, descriptor, value);
+
+	return knx_format_writer_finish(&writer, buffer);
+}
+
+// Key-value separators differ between the styles
+inline static
+void knx_format_put_key(knx_format_writer* writer, knx_format_style style, const char* key, size_t length) {
+	if (style == KNX_FORMAT_JSON) {
+		knx_format_put_literal(writer, ",\"");
+		knx_format_put(writer, key, length);
+		knx_format_put_literal(writer, "\":");
+	} else {
+		knx_format_put_char(writer, ' ');
+		knx_format_put(writer, key, length);
+		knx_format_put_char(writer, '=');
+	}
+}
+
+#define knx_format_put_key_literal(writer, style, key) \
+	knx_format_put_key(writer, style, key, sizeof(key) - 1)
+
+// Strings are quoted in JSON only
+inline static
+void knx_format_put_word(knx_format_writer* writer, knx_format_style style, const char* word) {
+	if (style == KNX_FORMAT_JSON) {
+		knx_format_put_char(writer, '"');
+		knx_format_put_string(writer, word);
+		knx_format_put_char(writer, '"');
+	} else {
+		knx_format_put_string(writer, word);
+	}
+}
+
+static
+void knx_format_put_ldata(
+	knx_format_writer*     writer,
+	knx_format_style       style,
+	const knx_ldata*       ldata,
+	const knx_group_index* index
+) {
+	bool group = ldata->control2.address_type == KNX_LDATA_ADDR_GROUP;
+
+	if (style == KNX_FORMAT_JSON) {
+		knx_format_put_literal(writer, ",\"source\":\"");
+		knx_format_put_individual_addr(writer, ldata->source);
+		knx_format_put_literal(writer, "\",\"destination\":\"");
+	} else {
+		knx_format_put_char(writer, ' ');
+		knx_format_put_individual_addr(writer, ldata->source);
+		knx_format_put_literal(writer, " -> ");
+	}
+
+	if (group)
+		knx_format_put_group_addr(writer, ldata->destination);
+	else
+		knx_format_put_individual_addr(writer, ldata->destination);
+
+	if (style == KNX_FORMAT_JSON)
+		knx_format_put_char(writer, '"');
+
+	knx_format_put_key_literal(writer, style, "priority");
+	knx_format_put_word(writer, style, knx_format_priority_names[ldata->control1.priority & 3]);
+
+	knx_format_put_key_literal(writer, style, "hops");
+	knx_format_put_uint(writer, ldata->control2.hops);
+
+	const knx_tpdu* tpdu = &ldata->tpdu;
+
+	if (tpdu->tpci == KNX_TPCI_NUMBERED_DATA || tpdu->tpci == KNX_TPCI_NUMBERED_CONTROL) {
+		knx_format_put_key_literal(writer, style, "seq");
+		knx_format_put_uint(writer, tpdu->seq_number);
+	}
+
+	if (tpdu->tpci == KNX_TPCI_UNNUMBERED_CONTROL || tpdu->tpci == KNX_TPCI_NUMBERED_CONTROL) {
+		knx_format_put_key_literal(writer, style, "control");
+		knx_format_put_word(writer, style, knx_format_control_names[tpdu->info.control & 3]);
+		return;
+	}
+
+	knx_format_put_key_literal(writer, style, "apci");
+	knx_format_put_word(writer, style, knx_format_apci_name(tpdu->info.data.apci));
+
+	knx_format_put_key_literal(writer, style, "data");
+
+	if (style == KNX_FORMAT_JSON)
+		knx_format_put_char(writer, '"');
+
+	// The upper two bits of the first byte belong to the APCI
+	for (size_t i = 0; i < tpdu->info.data.length; i++)
+		knx_format_put_hex(writer, tpdu->info.data.payload[i] & (i == 0 ? 63 : 255));
+
+	if (style == KNX_FORMAT_JSON)
+		knx_format_put_char(writer, '"');
+
+	if (!index || !group || ldata->destination >= KNX_GROUP_INDEX_SIZE)
+		return;
+
+	const char* name = knx_group_index_name(index, ldata->destination);
+
+	if (*name) {
+		knx_format_put_key_literal(writer, style, "name");
+		knx_format_put_json_string(writer, name, strlen(name), false);
+	}
+
+	knx_group_value value;
+	if (!knx_group_index_decode(index, ldata, &value))
+		return;
+
+	knx_format_put_key_literal(writer, style, "dpt");
+
+	if (style == KNX_FORMAT_JSON)
+		knx_format_put_char(writer, '"');
+
+	knx_format_put_uint(writer, value.descriptor->main);
+	knx_format_put_char(writer, '.');
+	knx_format_put_padded(writer, value.descriptor->sub, value.descriptor->sub < 1000 ? 3 : 4);
+
+	if (style == KNX_FORMAT_JSON)
+		knx_format_put_char(writer, '"');
+
+	knx_format_put_key_literal(writer, style, "value");
+	knx_format_put_value(writer, value.descriptor, &value.value);
+
+	if (*value.descriptor->unit == 0)
+		return;
+
+	if (style == KNX_FORMAT_JSON) {
+		knx_format_put_literal(writer, ",\"unit\":");
+		knx_format_put_json_string(writer, value.descriptor->unit, strlen(value.descriptor->unit),
+		                           false);
+	} else {
+		knx_format_put_char(writer, ' ');
+		knx_format_put_string(writer, value.descriptor->unit);
+	}
+}
+
+ssize_t knx_format_cemi(
+	char*                  buffer,
+	size_t                 size,
+	knx_format_style       style,
+	const knx_cemi*        frame,
+	const knx_group_index* index
+) {
+	knx_format_writer writer;
+	knx_format_writer_init(&writer, buffer, size);
+
+	const char* service = knx_format_service_name(frame->service);
+
+	if (style == KNX_FORMAT_JSON) {
+		knx_format_put_literal(&writer, "{\"service\":\"");
+		knx_format_put_string(&writer, service);
+		knx_format_put_char(&writer, '"');
+	} else {
+		knx_format_put_string(&writer, service);
+	}
+
+	switch (frame->service) {
+		case KNX_CEMI_LDATA_REQ:
+		case KNX_CEMI_LDATA_IND:
+		case KNX_CEMI_LDATA_CON:
+			knx_format_put_ldata(&writer, style, &frame->payload.ldata, index);
+			break;
+
+		default:
+			break;
+	}
+
+	if (style == KNX_FORMAT_JSON)
+		knx_format_put_char(&writer, '}');
+
+	return knx_format_writer_finish(&writer, buffer);
+}
+
+size_t knx_format_cemi_batch(
+	char*                  buffer,
+	size_t                 size,
+	knx_format_style       style,
+	const knx_cemi*        frames,
+	size_t                 count,
+	const knx_group_index* index,
+	size_t*                formatted
+) {
+	size_t written = 0, i = 0;
+
+	for (; i < count; i++) {
+		// Leave room for the line break
+		if (size - written < 2)
+			break;
+
+		ssize_t length = knx_format_cemi(buffer + written, size - written - 1, style, frames + i, index);
+
+		if (length < 0)
+			break;
+
+		written += length;
+		buffer[written++] = '\n';
+	}
+
+	if (written < size)
+		buffer[written] = 0;
+
+	if (formatted)
+		*formatted = i;
+
+	return written;
+}
@@ -0,0 +1,143 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_PROTO_FORMAT_H_
+#define KNXPROTO_PROTO_FORMAT_H_
+
+#include "cemi.h"
+#include "groupindex.h"
+#include "../util/address.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+/**
+ * Output Style
+ */
+typedef enum {
+	/**
+	 * Single line of human-readable text
+	 */
+	KNX_FORMAT_TEXT,
+
+	/**
+	 * Single JSON object
+	 */
+	KNX_FORMAT_JSON
+} knx_format_style;
+
+/**
+ * Space needed to format an address including the null character
+ */
+#define KNX_FORMAT_ADDR_SIZE 10
+
+/**
+ * Format an individual address as "area.line.device".
+ *
+ * \param buffer Output buffer with room for `KNX_FORMAT_ADDR_SIZE` characters
+ * \param addr   Individual address
+ * \returns Number of characters written, excluding the null character
+ */
+size_t knx_format_individual_addr(char* buffer, knx_addr addr);
+
+/**
+ * Format a group address as "main/sub/group".
+ *
+ * \param buffer Output buffer with room for `KNX_FORMAT_ADDR_SIZE` characters
+ * \param addr   Group address
+ * \returns Number of characters written, excluding the null character
+ */
+size_t knx_format_group_addr(char* buffer, knx_addr addr);
+
+/**
+ * Name of a CEMI service (e.g. "L_Data.ind").
+ */
+const char* knx_format_service_name(knx_cemi_service service);
+
+/**
+ * Name of an APCI (e.g. "GroupValueWrite").
+ */
+const char* knx_format_apci_name(knx_apci apci);
+
+/**
+ * Format a datapoint value as a JSON value. Numbers are scaled according to the sub-type.
+ *
+ * \param buffer     Output buffer
+ * \param size       Number of bytes in `buffer`
+ * \param descriptor Datapoint sub-type of `value`
+ * \param value      Value
+ * \returns Number of characters written (excluding the null character) or -1 if the buffer is too
+ *          small
+ */
+ssize_t knx_format_value(
+	char*                     buffer,
+	size_t                    size,
+	const knx_dpt_descriptor* descriptor,
+	const knx_dpt_value*      value
+);
+
+/**
+ * Format a CEMI frame. Service, addresses, priority, hop count, APCI and raw payload are always
+ * included. If an index is given and knows the destination group, its name and the decoded value
+ * are included as well.
+ *
+ * \param buffer Output buffer
+ * \param size   Number of bytes in `buffer`
+ * \param style  Output style
+ * \param frame  CEMI frame
+ * \param index  Group address index or `NULL`
+ * \returns Number of characters written (excluding the null character) or -1 if the buffer is too
+ *          small
+ */
+ssize_t knx_format_cemi(
+	char*                  buffer,
+	size_t                 size,
+	knx_format_style       style,
+	const knx_cemi*        frame,
+	const knx_group_index* index
+);
+
+/**
+ * Format many CEMI frames, each followed by a line break (i.e. newline-delimited JSON when using
+ * `KNX_FORMAT_JSON`). Formatting stops at the first frame which does not fit.
+ *
+ * \param buffer    Output buffer
+ * \param size      Number of bytes in `buffer`
+ * \param style     Output style
+ * \param frames    CEMI frames
+ * \param count     Number of frames in `frames`
+ * \param index     Group address index or `NULL`
+ * \param formatted Receives the number of frames that have been formatted
+ * \returns Number of characters written, excluding the null character
+ */
+size_t knx_format_cemi_batch(
+	char*                  buffer,
+	size_t                 size,
+	knx_format_style       style,
+	const knx_cemi*        frames,
+	size_t                 count,
+	const knx_group_index* index,
+	size_t*                formatted
+);
+
+#endif
@@ -0,0 +1,725 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "groupindex.h"
+#include "../util/alloc.h"
+#include "../util/allocator.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+// Identifies an index file: "KNXG"
+#define KNX_GROUP_INDEX_MAGIC 0x4B4E5847
+
+#define KNX_GROUP_INDEX_VERSION 1
+
+#define KNX_GROUP_INDEX_BYTE_ORDER 0x0102
+
+// Room for a single field of the export, longer fields are truncated
+#define KNX_GROUP_INDEX_FIELD_SIZE 256
+
+// Number of CSV columns that are considered
+#define KNX_GROUP_INDEX_COLUMNS 16
+
+typedef struct {
+	knx_group_index* index;
+	size_t capacity;
+	const knx_allocator* allocator;
+} knx_group_index_builder;
+
+static
+bool knx_group_index_builder_init(
+	knx_group_index_builder* builder,
+	const knx_allocator*     allocator
+) {
+	builder->allocator = allocator;
+	builder->capacity = 4096;
+	builder->index = knx_allocator_alloc(allocator, sizeof(knx_group_index) + builder->capacity);
+
+	if (!builder->index)
+		return false;
+
+	memset(builder->index, 0, sizeof(knx_group_index));
+
+	builder->index->magic = KNX_GROUP_INDEX_MAGIC;
+	builder->index->version = KNX_GROUP_INDEX_VERSION;
+	builder->index->byte_order = KNX_GROUP_INDEX_BYTE_ORDER;
+
+	// Offset 0 is reserved for unnamed group addresses
+	builder->index->pool[0] = 0;
+	builder->index->pool_size = 1;
+
+	return true;
+}
+
+static
+bool knx_group_index_builder_add(
+	knx_group_index_builder* builder,
+	knx_addr                 group,
+	uint16_t                 main,
+	uint16_t                 sub,
+	const char*              name
+) {
+	knx_group_index* index = builder->index;
+	size_t name_length = strlen(name);
+	size_t required = index->pool_size + name_length + 1;
+
+	if (required > UINT32_MAX)
+		return false;
+
+	if (required > builder->capacity) {
+		size_t capacity = builder->capacity;
+
+		while (capacity < required)
+			capacity *= 2;
+
+		index = knx_allocator_resize(builder->allocator, index,
+		                             sizeof(knx_group_index) + builder->capacity,
+		                             sizeof(knx_group_index) + capacity);
+		if (!index)
+			return false;
+
+		builder->index = index;
+		builder->capacity = capacity;
+	}
+
+	knx_group_entry* entry = index->entries + group;
+
+	if (entry->main == 0 && entry->name == 0)
+		index->count++;
+
+	entry->main = main;
+	entry->sub = sub;
+	entry->name = 0;
+
+	if (name_length > 0) {
+		entry->name = index->pool_size;
+		memcpy(index->pool + index->pool_size, name, name_length + 1);
+		index->pool_size += name_length + 1;
+	}
+
+	return true;
+}
+
+inline static
+bool knx_group_index_parse_number(const char** cursor, const char* end, unsigned long* value) {
+	const char* begin = *cursor;
+	unsigned long result = 0;
+
+	while (*cursor < end && **cursor >= '0' && **cursor <= '9' && result < 1000000)
+		result = result * 10 + (*(*cursor)++ - '0');
+
+	*value = result;
+	return *cursor > begin;
+}
+
+static
+bool knx_group_index_parse_address(const char* text, knx_addr* group) {
+	const char* end = text + strlen(text);
+	unsigned long parts[3];
+	size_t num_parts = 0;
+
+	while (num_parts < 3) {
+		if (!knx_group_index_parse_number(&text, end, parts + num_parts++))
+			return false;
+
+		if (text == end || *text != '/')
+			break;
+
+		text++;
+	}
+
+	if (text != end)
+		return false;
+
+	switch (num_parts) {
+		case 3:
+			if (parts[0] > 15 || parts[1] > 7 || parts[2] > 255)
+				return false;
+
+			*group = knx_group_addr(parts[0], parts[1], parts[2]);
+			return true;
+
+		case 2:
+			if (parts[0] > 15 || parts[1] > 2047)
+				return false;
+
+			*group = parts[0] << 11 | parts[1];
+			return true;
+
+		default:
+			if (parts[0] >= KNX_GROUP_INDEX_SIZE)
+				return false;
+
+			*group = parts[0];
+			return true;
+	}
+}
+
+static
+void knx_group_index_parse_dpt(const char* text, uint16_t* main, uint16_t* sub) {
+	const char* end = text;
+
+	// Only the first of several datapoint types is used
+	while (*end != 0 && *end != ' ' && *end != ',' && *end != ';')
+		end++;
+
+	unsigned long main_number, sub_number = 0;
+	bool has_sub = false;
+
+	if (strncasecmp(text, "DPST-", 5) == 0) {
+		text += 5;
+		has_sub = knx_group_index_parse_number(&text, end, &main_number)
+		       && text < end && *text++ == '-'
+		       && knx_group_index_parse_number(&text, end, &sub_number);
+	} else if (strncasecmp(text, "DPT-", 4) == 0) {
+		text += 4;
+		knx_group_index_parse_number(&text, end, &main_number);
+	} else if (knx_group_index_parse_number(&text, end, &main_number) && text < end && *text == '.') {
+		text++;
+		has_sub = knx_group_index_parse_number(&text, end, &sub_number);
+	}
+
+	*main = 0;
+	*sub = 0;
+
+	if (text != end || main_number > UINT16_MAX || sub_number > UINT16_MAX)
+		return;
+
+	*main = main_number;
+	*sub = sub_number;
+
+	// Without a sub number, the first known sub-type stands in for the main type
+	if (!has_sub) {
+		for (uint16_t candidate = 0; candidate < 1000; candidate++) {
+			if (knx_dpt_subtype_find(*main, candidate)) {
+				*sub = candidate;
+				break;
+			}
+		}
+	}
+}
+
+static
+bool knx_group_index_add_record(
+	knx_group_index_builder* builder,
+	const char*              address,
+	const char*              dpt,
+	const char*              name
+) {
+	knx_addr group;
+
+	// Group ranges (e.g. "1/-/-") and unparsable rows are skipped
+	if (!knx_group_index_parse_address(address, &group))
+		return true;
+
+	uint16_t main, sub;
+	knx_group_index_parse_dpt(dpt, &main, &sub);
+
+	return knx_group_index_builder_add(builder, group, main, sub, name);
+}
+
+inline static
+void knx_group_index_field_append(char* field, size_t* length, char c) {
+	if (*length < KNX_GROUP_INDEX_FIELD_SIZE - 1)
+		field[(*length)++] = c;
+}
+
+static
+size_t knx_group_index_csv_record(
+	const char** cursor,
+	const char*  end,
+	char         delimiter,
+	char         fields[KNX_GROUP_INDEX_COLUMNS][KNX_GROUP_INDEX_FIELD_SIZE]
+) {
+	const char* text = *cursor;
+	size_t num_fields = 0, length = 0;
+	bool quoted = false;
+	char discard[KNX_GROUP_INDEX_FIELD_SIZE];
+	char* field = fields[0];
+
+	for (; text < end; text++) {
+		char c = *text;
+
+		if (quoted) {
+			if (c != '"')
+				knx_group_index_field_append(field, &length, c);
+			else if (text + 1 < end && text[1] == '"')
+				knx_group_index_field_append(field, &length, *++text);
+			else
+				quoted = false;
+		} else if (c == '"') {
+			quoted = true;
+		} else if (c == delimiter || c == '\n') {
+			field[length] = 0;
+			length = 0;
+			num_fields++;
+			field = num_fields < KNX_GROUP_INDEX_COLUMNS ? fields[num_fields] : discard;
+
+			if (c == '\n') {
+				text++;
+				break;
+			}
+		} else if (c != '\r') {
+			knx_group_index_field_append(field, &length, c);
+		}
+	}
+
+	// Last record without line break
+	if (text == end && (length > 0 || text > *cursor) && (text[-1] != '\n')) {
+		field[length] = 0;
+		num_fields++;
+	}
+
+	*cursor = text;
+
+	// Unused columns read as empty
+	for (size_t i = num_fields; i < KNX_GROUP_INDEX_COLUMNS; i++)
+		fields[i][0] = 0;
+
+	return num_fields;
+}
+
+inline static
+char knx_group_index_csv_delimiter(const char* text, const char* end) {
+	size_t semicolons = 0, commas = 0, tabs = 0;
+	bool quoted = false;
+
+	for (; text < end && *text != '\n'; text++) {
+		if (*text == '"')
+			quoted = !quoted;
+		else if (quoted)
+			continue;
+		else if (*text == ';')
+			semicolons++;
+		else if (*text == ',')
+			commas++;
+		else if (*text == '\t')
+			tabs++;
+	}
+
+	if (tabs > semicolons && tabs > commas)
+		return '\t';
+	else if (commas > semicolons)
+		return ',';
+	else
+		return ';';
+}
+
+static
+bool knx_group_index_parse_csv(knx_group_index_builder* builder, const char* text, const char* end) {
+	char fields[KNX_GROUP_INDEX_COLUMNS][KNX_GROUP_INDEX_FIELD_SIZE];
+	char delimiter = knx_group_index_csv_delimiter(text, end);
+
+	// Without header line, ETS uses "Group name", "Address", "Central", "Unfiltered",
+	// "Description", "DatapointType", "Security"
+	size_t address_column = 1, dpt_column = 5;
+	size_t name_columns[3] = {0, 0, 0}, num_name_columns = 1;
+
+	const char* cursor = text;
+	size_t num_fields = knx_group_index_csv_record(&cursor, end, delimiter, fields);
+	bool header = false;
+
+	for (size_t i = 0; i < num_fields && i < KNX_GROUP_INDEX_COLUMNS; i++) {
+		if (strcasecmp(fields[i], "Address") == 0) {
+			address_column = i;
+			header = true;
+		}
+	}
+
+	if (header) {
+		num_name_columns = 0;
+		dpt_column = KNX_GROUP_INDEX_COLUMNS;
+
+		for (size_t i = 0; i < num_fields && i < KNX_GROUP_INDEX_COLUMNS; i++) {
+			const char* title = fields[i];
+
+			if (strcasecmp(title, "DatapointType") == 0 || strcasecmp(title, "Datapoint Type") == 0 ||
+			    strcasecmp(title, "DPT") == 0 || strcasecmp(title, "DPTs") == 0)
+				dpt_column = i;
+
+			// The "3/1" format spreads names across "Main", "Middle" and "Sub"
+			else if ((strcasecmp(title, "Group name") == 0 || strcasecmp(title, "Name") == 0 ||
+			          strcasecmp(title, "Main") == 0 || strcasecmp(title, "Middle") == 0 ||
+			          strcasecmp(title, "Sub") == 0) && num_name_columns < 3)
+				name_columns[num_name_columns++] = i;
+		}
+	} else {
+		cursor = text;
+	}
+
+	while (cursor < end) {
+		num_fields = knx_group_index_csv_record(&cursor, end, delimiter, fields);
+
+		if (num_fields <= address_column)
+			continue;
+
+		const char* name = "";
+		for (size_t i = 0; i < num_name_columns; i++) {
+			if (fields[name_columns[i]][0] != 0)
+				name = fields[name_columns[i]];
+		}
+
+		const char* dpt = dpt_column < KNX_GROUP_INDEX_COLUMNS ? fields[dpt_column] : "";
+
+		if (!knx_group_index_add_record(builder, fields[address_column], dpt, name))
+			return false;
+	}
+
+	return true;
+}
+
+static
+void knx_group_index_xml_unescape(const char* text, const char* end, char* field) {
+	size_t length = 0;
+
+	while (text < end) {
+		if (*text != '&') {
+			knx_group_index_field_append(field, &length, *text++);
+			continue;
+		}
+
+		const char* semicolon = memchr(text, ';', end - text);
+		if (!semicolon) {
+			knx_group_index_field_append(field, &length, *text++);
+			continue;
+		}
+
+		const char* entity = text + 1;
+		size_t entity_length = semicolon - entity;
+		unsigned long code = 0;
+
+		if (entity_length == 3 && memcmp(entity, "amp", 3) == 0) {
+			code = '&';
+		} else if (entity_length == 2 && memcmp(entity, "lt", 2) == 0) {
+			code = '<';
+		} else if (entity_length == 2 && memcmp(entity, "gt", 2) == 0) {
+			code = '>';
+		} else if (entity_length == 4 && memcmp(entity, "quot", 4) == 0) {
+			code = '"';
+		} else if (entity_length == 4 && memcmp(entity, "apos", 4) == 0) {
+			code = '\'';
+		} else if (entity_length > 1 && entity[0] == '#') {
+			char digits[16];
+
+			if (entity_length < sizeof(digits)) {
+				memcpy(digits, entity + 1, entity_length - 1);
+				digits[entity_length - 1] = 0;
+
+				if (digits[0] == 'x' || digits[0] == 'X')
+					code = strtoul(digits + 1, NULL, 16);
+				else
+					code = strtoul(digits, NULL, 10);
+			}
+		}
+
+		if (code == 0 || code > 0x10FFFF) {
+			knx_group_index_field_append(field, &length, *text++);
+			continue;
+		}
+
+		// Encode as UTF-8
+		if (code < 0x80) {
+			knx_group_index_field_append(field, &length, code);
+		} else if (code < 0x800) {
+			knx_group_index_field_append(field, &length, 0xC0 | code >> 6);
+			knx_group_index_field_append(field, &length, 0x80 | (code & 63));
+		} else if (code < 0x10000) {
+			knx_group_index_field_append(field, &length, 0xE0 | code >> 12);
+			knx_group_index_field_append(field, &length, 0x80 | (code >> 6 & 63));
+			knx_group_index_field_append(field, &length, 0x80 | (code & 63));
+		} else {
+			knx_group_index_field_append(field, &length, 0xF0 | code >> 18);
+			knx_group_index_field_append(field, &length, 0x80 | (code >> 12 & 63));
+			knx_group_index_field_append(field, &length, 0x80 | (code >> 6 & 63));
+			knx_group_index_field_append(field, &length, 0x80 | (code & 63));
+		}
+
+		text = semicolon + 1;
+	}
+
+	field[length] = 0;
+}
+
+inline static
+bool knx_group_index_is_space(char c) {
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static
+bool knx_group_index_parse_xml(knx_group_index_builder* builder, const char* text, const char* end) {
+	static const char tag[] = "<GroupAddress";
+	const size_t tag_length = sizeof(tag) - 1;
+
+	char name[KNX_GROUP_INDEX_FIELD_SIZE], address[KNX_GROUP_INDEX_FIELD_SIZE], dpt[KNX_GROUP_INDEX_FIELD_SIZE];
+
+	while (text < end) {
+		const char* element = memmem(text, end - text, tag, tag_length);
+
+		if (!element)
+			break;
+
+		text = element + tag_length;
+
+		// Skip elements like "<GroupAddress-Export"
+		if (text >= end || !knx_group_index_is_space(*text))
+			continue;
+
+		name[0] = address[0] = dpt[0] = 0;
+
+		// Attributes
+		while (true) {
+			while (text < end && knx_group_index_is_space(*text))
+				text++;
+
+			if (text >= end)
+				return false;
+
+			if (*text == '/' || *text == '>')
+				break;
+
+			const char* attribute = text;
+			while (text < end && *text != '=' && !knx_group_index_is_space(*text))
+				text++;
+
+			size_t attribute_length = text - attribute;
+
+			while (text < end && knx_group_index_is_space(*text))
+				text++;
+
+			if (text >= end || *text++ != '=')
+				return false;
+
+			while (text < end && knx_group_index_is_space(*text))
+				text++;
+
+			if (text >= end || (*text != '"' && *text != '\''))
+				return false;
+
+			const char* value = text + 1;
+			const char* value_end = memchr(value, *text, end - value);
+
+			if (!value_end)
+				return false;
+
+			text = value_end + 1;
+
+			if (attribute_length == 4 && memcmp(attribute, "Name", 4) == 0)
+				knx_group_index_xml_unescape(value, value_end, name);
+			else if (attribute_length == 7 && memcmp(attribute, "Address", 7) == 0)
+				knx_group_index_xml_unescape(value, value_end, address);
+			else if (attribute_length == 4 && memcmp(attribute, "DPTs", 4) == 0)
+				knx_group_index_xml_unescape(value, value_end, dpt);
+		}
+
+		if (!knx_group_index_add_record(builder, address, dpt, name))
+			return false;
+	}
+
+	return true;
+}
+
+knx_group_index* knx_group_index_parse(const char* text, size_t length) {
+	return knx_group_index_parse_with(text, length, NULL);
+}
+
+knx_group_index* knx_group_index_parse_with(
+	const char*          text,
+	size_t               length,
+	const knx_allocator* allocator
+) {
+	const char* end = text + length;
+
+	// UTF-8 byte order mark
+	if (length >= 3 && memcmp(text, "\xEF\xBB\xBF", 3) == 0)
+		text += 3;
+
+	knx_group_index_builder builder;
+	if (!knx_group_index_builder_init(&builder, allocator))
+		return NULL;
+
+	const char* first = text;
+	while (first < end && knx_group_index_is_space(*first))
+		first++;
+
+	bool success;
+
+	if (first < end && *first == '<')
+		success = knx_group_index_parse_xml(&builder, first, end);
+	else
+		success = knx_group_index_parse_csv(&builder, text, end);
+
+	if (!success) {
+		knx_allocator_free(allocator, builder.index);
+		return NULL;
+	}
+
+	// Trim the pool
+	knx_group_index* index = knx_allocator_resize(allocator, builder.index,
+	                                              sizeof(knx_group_index) + builder.capacity,
+	                                              knx_group_index_size(builder.index));
+	return index ? index : builder.index;
+}
+
+knx_group_index* knx_group_index_load(const char* path) {
+	return knx_group_index_load_with(path, NULL);
+}
+
+knx_group_index* knx_group_index_load_with(const char* path, const knx_allocator* allocator) {
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return NULL;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		return NULL;
+	}
+
+	if (info.st_size == 0) {
+		close(fd);
+		return knx_group_index_parse_with("", 0, allocator);
+	}
+
+	void* base = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (base == MAP_FAILED)
+		return NULL;
+
+	knx_group_index* index = knx_group_index_parse_with(base, info.st_size, allocator);
+	munmap(base, info.st_size);
+
+	return index;
+}
+
+void knx_group_index_free(knx_group_index* index) {
+	knx_free(index);
+}
+
+void knx_group_index_free_with(knx_group_index* index, const knx_allocator* allocator) {
+	knx_allocator_free(allocator, index);
+}
+
+bool knx_group_index_save(const knx_group_index* index, const char* path) {
+	// Write to a temporary file first, so concurrent processes never see a partial file
+	char temp_path[4096];
+	if (snprintf(temp_path, sizeof(temp_path), "%s.%ld", path, (long) getpid()) >= (int) sizeof(temp_path))
+		return false;
+
+	FILE* file = fopen(temp_path, "wb");
+	if (!file)
+		return false;
+
+	bool written = fwrite(index, knx_group_index_size(index), 1, file) == 1;
+
+	if (fclose(file) != 0 || !written || rename(temp_path, path) != 0) {
+		unlink(temp_path);
+		return false;
+	}
+
+	return true;
+}
+
+inline static
+bool knx_group_index_valid(const knx_group_index* index, size_t size) {
+	if (index->magic != KNX_GROUP_INDEX_MAGIC ||
+	    index->version != KNX_GROUP_INDEX_VERSION ||
+	    index->byte_order != KNX_GROUP_INDEX_BYTE_ORDER ||
+	    index->pool_size == 0 ||
+	    knx_group_index_size(index) != size ||
+	    index->pool[0] != 0 ||
+	    index->pool[index->pool_size - 1] != 0)
+		return false;
+
+	// Names must lie within the pool, so lookups never need to check
+	for (size_t i = 0; i < KNX_GROUP_INDEX_SIZE; i++) {
+		if (index->entries[i].name >= index->pool_size)
+			return false;
+	}
+
+	return true;
+}
+
+const knx_group_index* knx_group_index_map(const char* path) {
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return NULL;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || (size_t) info.st_size <= sizeof(knx_group_index)) {
+		close(fd);
+		return NULL;
+	}
+
+	void* base = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (base == MAP_FAILED)
+		return NULL;
+
+	if (!knx_group_index_valid(base, info.st_size)) {
+		munmap(base, info.st_size);
+		return NULL;
+	}
+
+	return base;
+}
+
+void knx_group_index_unmap(const knx_group_index* index) {
+	if (index)
+		munmap((void*) index, knx_group_index_size(index));
+}
+
+bool knx_group_index_decode(
+	const knx_group_index* index,
+	const knx_ldata*       ldata,
+	knx_group_value*       value
+) {
+	if (ldata->control2.address_type != KNX_LDATA_ADDR_GROUP ||
+	    ldata->destination >= KNX_GROUP_INDEX_SIZE ||
+	    ldata->tpdu.tpci != KNX_TPCI_UNNUMBERED_DATA)
+		return false;
+
+	knx_apci apci = ldata->tpdu.info.data.apci;
+	if (apci != KNX_APCI_GROUPVALUEWRITE && apci != KNX_APCI_GROUPVALUERESPONSE)
+		return false;
+
+	const knx_group_entry* entry = index->entries + ldata->destination;
+	const knx_dpt_descriptor* descriptor = knx_dpt_subtype_find(entry->main, entry->sub);
+
+	if (!descriptor ||
+	    !knx_dpt_from_apdu(ldata->tpdu.info.data.payload, ldata->tpdu.info.data.length,
+	                       descriptor->type, &value->value))
+		return false;
+
+	value->group = ldata->destination;
+	value->name = index->pool + entry->name;
+	value->descriptor = descriptor;
+
+	return true;
+}
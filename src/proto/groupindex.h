@@ -0,0 +1,234 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_PROTO_GROUPINDEX_H_
+#define KNXPROTO_PROTO_GROUPINDEX_H_
+
+#include "data.h"
+#include "dptreg.h"
+#include "ldata.h"
+#include "../util/address.h"
+#include "../util/allocator.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Number of group addresses (15-bit)
+ */
+#define KNX_GROUP_INDEX_SIZE 32768
+
+/**
+ * Group Address Information
+ */
+typedef struct {
+	/**
+	 * Main number of the datapoint type, 0 if unknown
+	 */
+	uint16_t main;
+
+	/**
+	 * Sub number of the datapoint type
+	 */
+	uint16_t sub;
+
+	/**
+	 * Offset of the name in the string pool, 0 if the group address is unnamed
+	 */
+	uint32_t name;
+} knx_group_entry;
+
+/**
+ * Group Address Index
+ *
+ * Maps every group address directly to its datapoint type and name. The index occupies a single
+ * contiguous block of memory, so it can be stored in a file and mapped read-only.
+ */
+typedef struct {
+	/**
+	 * Identifies the index
+	 */
+	uint32_t magic;
+
+	/**
+	 * Layout version
+	 */
+	uint16_t version;
+
+	/**
+	 * Detects a file created on a machine with different byte order
+	 */
+	uint16_t byte_order;
+
+	/**
+	 * Number of bytes in `pool`
+	 */
+	uint32_t pool_size;
+
+	/**
+	 * Number of group addresses found in the export
+	 */
+	uint32_t count;
+
+	/**
+	 * Information indexed by group address
+	 */
+	knx_group_entry entries[KNX_GROUP_INDEX_SIZE];
+
+	/**
+	 * Null-terminated names, the first byte is always a null character
+	 */
+	char pool[];
+} knx_group_index;
+
+/**
+ * Decoded Group Value
+ */
+typedef struct {
+	/**
+	 * Destination group address
+	 */
+	knx_addr group;
+
+	/**
+	 * Name of the group address
+	 */
+	const char* name;
+
+	/**
+	 * Datapoint sub-type of the group address
+	 */
+	const knx_dpt_descriptor* descriptor;
+
+	/**
+	 * Value interpreted as `descriptor->type`
+	 */
+	knx_dpt_value value;
+} knx_group_value;
+
+/**
+ * Build an index from an ETS group address export. XML exports and CSV exports (with or without
+ * header line, separated by semicolons, commas or tabs) are recognized. Datapoint types may be
+ * given as "DPST-9-1", "DPT-9" or "9.001".
+ *
+ * \param text   Contents of the export
+ * \param length Number of bytes in `text`
+ * \returns Index (free it using `knx_group_index_free`) or `NULL` if the export is malformed
+ */
+knx_group_index* knx_group_index_parse(const char* text, size_t length);
+
+/**
+ * Build an index using the given allocator.
+ *
+ * \see knx_group_index_parse
+ * \param allocator Allocator (may be `NULL`), free the index using `knx_group_index_free_with`
+ */
+knx_group_index* knx_group_index_parse_with(
+	const char*          text,
+	size_t               length,
+	const knx_allocator* allocator
+);
+
+/**
+ * Build an index from an ETS group address export file.
+ *
+ * \see knx_group_index_parse
+ * \param path Path to the export
+ * \returns Index (free it using `knx_group_index_free`) or `NULL` on failure
+ */
+knx_group_index* knx_group_index_load(const char* path);
+
+/**
+ * Build an index from an ETS group address export file using the given allocator.
+ *
+ * \see knx_group_index_load
+ * \param allocator Allocator (may be `NULL`), free the index using `knx_group_index_free_with`
+ */
+knx_group_index* knx_group_index_load_with(const char* path, const knx_allocator* allocator);
+
+/**
+ * Free an index created by `knx_group_index_parse` or `knx_group_index_load`.
+ */
+void knx_group_index_free(knx_group_index* index);
+
+/**
+ * Free an index created by `knx_group_index_parse_with` or `knx_group_index_load_with`.
+ */
+void knx_group_index_free_with(knx_group_index* index, const knx_allocator* allocator);
+
+/**
+ * Store the index in a file. The file is replaced atomically.
+ *
+ * \param index Index
+ * \param path  Path to the index file
+ * \returns `true` on success
+ */
+bool knx_group_index_save(const knx_group_index* index, const char* path);
+
+/**
+ * Map an index stored by `knx_group_index_save`.
+ *
+ * \param path Path to the index file
+ * \returns Read-only index (release it using `knx_group_index_unmap`) or `NULL` if the file is
+ *          missing or invalid
+ */
+const knx_group_index* knx_group_index_map(const char* path);
+
+/**
+ * Release a mapped index.
+ */
+void knx_group_index_unmap(const knx_group_index* index);
+
+/**
+ * Number of bytes occupied by the index.
+ */
+inline static
+size_t knx_group_index_size(const knx_group_index* index) {
+	return sizeof(knx_group_index) + index->pool_size;
+}
+
+/**
+ * Retrieve the name of a group address.
+ *
+ * \returns Name, empty if the group address is unknown
+ */
+inline static
+const char* knx_group_index_name(const knx_group_index* index, knx_addr group) {
+	return index->pool + index->entries[group % KNX_GROUP_INDEX_SIZE].name;
+}
+
+/**
+ * Decode the value carried by a GroupValueWrite or GroupValueResponse.
+ *
+ * \param index Index
+ * \param ldata L_Data frame
+ * \param value Output value
+ * \returns `true` on success, `false` if the frame carries no group value or the datapoint type of
+ *          its destination is unknown or does not match the payload
+ */
+bool knx_group_index_decode(
+	const knx_group_index* index,
+	const knx_ldata*       ldata,
+	knx_group_value*       value
+);
+
+#endif
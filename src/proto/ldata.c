@@ -20,17 +20,22 @@
  */
 
 #include "ldata.h"
-#include "../util/alloc.h"
 
+#include <sys/types.h>
 #include <string.h>
 
 bool knx_ldata_generate(uint8_t* buffer, const knx_ldata* req) {
 	size_t tpdu_length = knx_tpdu_size(&req->tpdu);
 
-	if (tpdu_length == 0 || tpdu_length > UINT8_MAX + 1)
+	if (tpdu_length == 0 || tpdu_length > KNX_LDATA_EXTENDED_TPDU_SIZE)
 		return false;
 
-	*buffer++ = (tpdu_length <= 16) << 7                    // Standard Frame
+	bool extended =
+		req->control1.extended ||
+		req->control2.extended_format != 0 ||
+		tpdu_length > KNX_LDATA_STANDARD_TPDU_SIZE;
+
+	*buffer++ = !extended << 7                              // Frame Type
 	          | (~req->control1.repeat & 1) << 5            // Repeat
 	          | (~req->control1.system_broadcast & 1) << 4  // System Broadcast
 	          | (req->control1.priority & 3) << 2           // Priority
@@ -38,7 +43,8 @@ bool knx_ldata_generate(uint8_t* buffer, const knx_ldata* req) {
 	          | (req->control1.error & 1);                  // Error
 
 	*buffer++ = (req->control2.address_type & 1) << 7       // Address Type
-	          | (req->control2.hops & 7) << 4;              // Hop Count
+	          | (req->control2.hops & 7) << 4               // Hop Count
+	          | (req->control2.extended_format & 15);       // Extended Frame Format
 
 	*buffer++ = req->source >> 8 & 0xFF;
 	*buffer++ = req->source & 0xFF;
@@ -53,10 +59,16 @@ bool knx_ldata_generate(uint8_t* buffer, const knx_ldata* req) {
 }
 
 bool knx_ldata_parse(const uint8_t* buffer, size_t buffer_length, knx_ldata* out) {
-	// Check for length and standard frame
-	if (buffer_length < 8 || (buffer[1] & 15))
+	if (buffer_length < 8)
+		return false;
+
+	bool extended = !(buffer[0] >> 7 & 1);
+
+	// Standard frames have no extended frame format, extended frames reserve length 255
+	if (extended ? buffer[6] == 0xFF : (buffer[1] & 15) != 0)
 		return false;
 
+	out->control1.extended = extended;
 	out->control1.repeat = !(buffer[0] >> 5 & 1);
 	out->control1.system_broadcast = !(buffer[0] >> 4 & 1);
 	out->control1.priority = buffer[0] >> 2 & 3;
@@ -65,6 +77,7 @@ bool knx_ldata_parse(const uint8_t* buffer, size_t buffer_length, knx_ldata* out
 
 	out->control2.address_type = buffer[1] >> 7 & 1;
 	out->control2.hops = buffer[1] >> 4 & 7;
+	out->control2.extended_format = buffer[1] & 15;
 
 	out->source = buffer[2] << 8 | buffer[3];
 	out->destination = buffer[4] << 8 | buffer[5];
@@ -80,35 +93,105 @@ size_t knx_ldata_size(const knx_ldata* req) {
 }
 
 knx_ldata* knx_ldata_duplicate(const knx_ldata* data) {
+	return knx_ldata_duplicate_with(data, NULL);
+}
+
+// Number of payload bytes a copy of the frame carries, or -1 if the frame cannot be copied
+inline static
+ssize_t knx_ldata_copy_size(const knx_ldata* data) {
 	switch (data->tpdu.tpci) {
 		case KNX_TPCI_UNNUMBERED_DATA:
-		case KNX_TPCI_NUMBERED_DATA: {
-			knx_ldata* copy = malloc(sizeof(knx_ldata) + data->tpdu.info.data.length);
+		case KNX_TPCI_NUMBERED_DATA:
+			return data->tpdu.info.data.length;
 
-			if (copy) {
-				memcpy(copy, data, sizeof(knx_ldata));
-				memcpy(copy + 1, data->tpdu.info.data.payload, data->tpdu.info.data.length);
-				copy->tpdu.info.data.payload = (const uint8_t*) (copy + 1);
+		case KNX_TPCI_UNNUMBERED_CONTROL:
+		case KNX_TPCI_NUMBERED_CONTROL:
+			return 0;
 
-				if (copy->tpdu.info.data.length > 0)
-					* (uint8_t*) (copy + 1) &= 63;
-			}
+		default:
+			return -1;
+	}
+}
 
-			return copy;
-		}
+// Copy the frame and its payload into the given places
+inline static
+void knx_ldata_copy(knx_ldata* copy, uint8_t* payload, const knx_ldata* data) {
+	memcpy(copy, data, sizeof(knx_ldata));
 
-		case KNX_TPCI_UNNUMBERED_CONTROL:
-		case KNX_TPCI_NUMBERED_CONTROL: {
-			knx_ldata* copy = new(knx_ldata);
+	if (data->tpdu.tpci != KNX_TPCI_UNNUMBERED_DATA && data->tpdu.tpci != KNX_TPCI_NUMBERED_DATA)
+		return;
 
-			if (copy) {
-				memcpy(copy, data, sizeof(knx_ldata));
-			}
+	memcpy(payload, data->tpdu.info.data.payload, data->tpdu.info.data.length);
+	copy->tpdu.info.data.payload = payload;
 
-			return copy;
-		}
+	if (copy->tpdu.info.data.length > 0)
+		payload[0] &= 63;
+}
 
-		default:
-			return NULL;
+knx_ldata* knx_ldata_duplicate_with(const knx_ldata* data, const knx_allocator* allocator) {
+	ssize_t payload_size = knx_ldata_copy_size(data);
+	if (payload_size < 0)
+		return NULL;
+
+	knx_ldata* copy = knx_allocator_alloc(allocator, sizeof(knx_ldata) + payload_size);
+
+	if (copy)
+		knx_ldata_copy(copy, (uint8_t*) (copy + 1), data);
+
+	return copy;
+}
+
+size_t knx_ldata_batch_size(const knx_ldata* frames, size_t count) {
+	if (count > SIZE_MAX / sizeof(knx_ldata))
+		return 0;
+
+	size_t size = sizeof(knx_ldata) * count;
+
+	for (size_t i = 0; i < count; i++) {
+		ssize_t payload_size = knx_ldata_copy_size(frames + i);
+		if (payload_size < 0 || (size_t) payload_size > SIZE_MAX - size)
+			return 0;
+
+		size += payload_size;
 	}
+
+	return size;
+}
+
+knx_ldata* knx_ldata_duplicate_batch_into(
+	const knx_ldata* frames,
+	size_t           count,
+	void*            buffer,
+	size_t           size
+) {
+	size_t required = knx_ldata_batch_size(frames, count);
+	if (required == 0 || required > size)
+		return NULL;
+
+	// Frames first, so iterating them is a sequential scan; payloads follow in the same order
+	knx_ldata* copies = buffer;
+	uint8_t* payload = (uint8_t*) (copies + count);
+
+	for (size_t i = 0; i < count; i++) {
+		knx_ldata_copy(copies + i, payload, frames + i);
+		payload += knx_ldata_copy_size(frames + i);
+	}
+
+	return copies;
+}
+
+knx_ldata* knx_ldata_duplicate_batch(
+	const knx_ldata*     frames,
+	size_t               count,
+	const knx_allocator* allocator
+) {
+	size_t size = knx_ldata_batch_size(frames, count);
+	if (size == 0)
+		return NULL;
+
+	void* buffer = knx_allocator_alloc(allocator, size);
+	if (!buffer)
+		return NULL;
+
+	return knx_ldata_duplicate_batch_into(frames, count, buffer, size);
 }
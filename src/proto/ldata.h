@@ -25,9 +25,20 @@
 #include "tpdu.h"
 
 #include "../util/address.h"
+#include "../util/allocator.h"
 
 #include <stdbool.h>
 
+/**
+ * Maximum TPDU size of a standard frame
+ */
+#define KNX_LDATA_STANDARD_TPDU_SIZE 16
+
+/**
+ * Maximum TPDU size of an extended frame (the APDU length 255 is reserved)
+ */
+#define KNX_LDATA_EXTENDED_TPDU_SIZE 255
+
 /**
  * L_Data Priority
  */
@@ -78,10 +89,15 @@ typedef struct {
 		 * Indicate an error (only L_Data.con)
 		 */
 		bool error;
+
+		/**
+		 * Use the extended frame format (implied for TPDUs longer than 16 bytes)
+		 */
+		bool extended;
 	} control1;
 
 	/**
-	 * Represents Control Field 1
+	 * Represents Control Field 2
 	 */
 	struct {
 		/**
@@ -93,6 +109,11 @@ typedef struct {
 		 * Routing hop count in range from 0 to 7 (7 means infinite hops)
 		 */
 		unsigned hops:4;
+
+		/**
+		 * Extended frame format (only extended frames)
+		 */
+		unsigned extended_format:4;
 	} control2;
 
 	/**
@@ -112,16 +133,18 @@ typedef struct {
 } knx_ldata;
 
 /**
- * Generate a raw L_Data frame.
+ * Generate a raw L_Data frame. TPDUs longer than `KNX_LDATA_STANDARD_TPDU_SIZE` bytes are sent as
+ * extended frames, which carry up to `KNX_LDATA_EXTENDED_TPDU_SIZE` bytes.
  *
  * \see knx_ldata_size
  * \param buffer Output buffer, you have to make sure there is enough space
  * \param ldata  Input L_Data frame
+ * \returns `true` if generating was successful, otherwise `false`
  */
 bool knx_ldata_generate(uint8_t* buffer, const knx_ldata* ldata);
 
 /**
- * Parse a raw L_Data frame.
+ * Parse a raw standard or extended L_Data frame.
  *
  * \param buffer        Raw frame
  * \param buffer_length Number of bytes in `buffer`
@@ -137,7 +160,57 @@ size_t knx_ldata_size(const knx_ldata* req);
 
 /**
  * Duplicate the L_Data structure including the data it might refer to.
+ *
+ * \note Always fails in builds with `KNXPROTO_NO_MALLOC`, use `knx_ldata_duplicate_with`.
  */
 knx_ldata* knx_ldata_duplicate(const knx_ldata* data);
 
+/**
+ * Duplicate the L_Data structure into a single block obtained from the given allocator.
+ *
+ * \param data      L_Data frame
+ * \param allocator Allocator (`NULL` selects `malloc`), must be used to free the copy
+ * \returns Copy or `NULL` on failure
+ */
+knx_ldata* knx_ldata_duplicate_with(const knx_ldata* data, const knx_allocator* allocator);
+
+/**
+ * Space required to duplicate the given frames as a batch.
+ *
+ * \returns Number of bytes or 0 if `count` is 0, a frame has an invalid TPCI or the size
+ *          does not fit into `size_t`
+ */
+size_t knx_ldata_batch_size(const knx_ldata* frames, size_t count);
+
+/**
+ * Duplicate frames into contiguous storage. The copies come first, followed by their payloads.
+ *
+ * \see knx_ldata_batch_size
+ * \param frames Frames to be copied
+ * \param count  Number of elements in `frames`
+ * \param buffer Output storage, must be suitably aligned for `knx_ldata`
+ * \param size   Size of `buffer` in bytes
+ * \returns Array of `count` copies (equals `buffer`) or `NULL` on failure
+ */
+knx_ldata* knx_ldata_duplicate_batch_into(
+	const knx_ldata* frames,
+	size_t           count,
+	void*            buffer,
+	size_t           size
+);
+
+/**
+ * Duplicate frames into a single block obtained from the given allocator.
+ *
+ * \param frames    Frames to be copied
+ * \param count     Number of elements in `frames`
+ * \param allocator Allocator (`NULL` selects `malloc`), release the returned array through it
+ * \returns Array of `count` copies or `NULL` on failure
+ */
+knx_ldata* knx_ldata_duplicate_batch(
+	const knx_ldata*     frames,
+	size_t               count,
+	const knx_allocator* allocator
+);
+
 #endif
@@ -74,13 +74,17 @@ ssize_t knx_unpack_header(
 	return packet_length;
 }
 
-ssize_t knx_parse(
-	const uint8_t* frame,
-	size_t         frame_length,
-	knx_packet*    output
+// Validate the header and determine the payload bounds
+static
+ssize_t knx_parse_header(
+	const uint8_t*  frame,
+	size_t          frame_length,
+	knx_service*    service,
+	const uint8_t** payload,
+	size_t*         payload_length
 ) {
 	// Unpack (and validate) header
-	ssize_t unpack_result = knx_unpack_header(frame, frame_length, &output->service);
+	ssize_t unpack_result = knx_unpack_header(frame, frame_length, service);
 	if (unpack_result < 0)
 		return unpack_result;
 
@@ -89,8 +93,33 @@ ssize_t knx_parse(
 		return -KNX_INVALID_BUFFER;
 
 	// Determine payload bounds
-	const uint8_t* payload = frame + KNX_HEADER_SIZE;
-	size_t payload_length = unpack_result - KNX_HEADER_SIZE;
+	*payload = frame + KNX_HEADER_SIZE;
+	*payload_length = unpack_result - KNX_HEADER_SIZE;
+
+	return unpack_result;
+}
+
+ssize_t knx_parse(
+	const uint8_t* frame,
+	size_t         frame_length,
+	knx_packet*    output
+) {
+	return knx_parse_with(frame, frame_length, output, NULL);
+}
+
+ssize_t knx_parse_with(
+	const uint8_t*       frame,
+	size_t               frame_length,
+	knx_packet*          output,
+	const knx_allocator* allocator
+) {
+	const uint8_t* payload;
+	size_t payload_length;
+
+	ssize_t unpack_result =
+		knx_parse_header(frame, frame_length, &output->service, &payload, &payload_length);
+	if (unpack_result < 0)
+		return unpack_result;
 
 	switch (output->service) {
 		case KNX_CONNECTION_REQUEST:
@@ -164,10 +193,11 @@ ssize_t knx_parse(
 			) ? unpack_result : -KNX_INVALID_PAYLOAD;
 
 		case KNX_DESCRIPTION_RESPONSE:
-			return knx_description_response_parse(
+			return knx_description_response_parse_with(
 				payload,
 				payload_length,
-				&output->payload.description_res
+				&output->payload.description_res,
+				allocator
 			) ? unpack_result : -KNX_INVALID_PAYLOAD;
 
 		default:
@@ -175,6 +205,142 @@ ssize_t knx_parse(
 	}
 }
 
+// Generates a parser for frames which carry one specific service
+#define knx_parse_service(name, type, srv, parser)                                        \
+	ssize_t name(const uint8_t* frame, size_t frame_length, type* output) {              \
+		knx_service service;                                                             \
+		const uint8_t* payload;                                                          \
+		size_t payload_length;                                                           \
+                                                                                         \
+		ssize_t unpack_result =                                                          \
+			knx_parse_header(frame, frame_length, &service, &payload, &payload_length);  \
+		if (unpack_result < 0)                                                           \
+			return unpack_result;                                                        \
+                                                                                         \
+		if (service != srv)                                                              \
+			return -KNX_UNKNOWN_SERVICE;                                                 \
+                                                                                         \
+		if (!parser(payload, payload_length, output))                                    \
+			return -KNX_INVALID_PAYLOAD;                                                 \
+                                                                                         \
+		return unpack_result;                                                            \
+	}
+
+knx_parse_service(knx_parse_connection_request, knx_connection_request,
+                  KNX_CONNECTION_REQUEST, knx_connection_request_parse)
+
+knx_parse_service(knx_parse_connection_response, knx_connection_response,
+                  KNX_CONNECTION_RESPONSE, knx_connection_response_parse)
+
+knx_parse_service(knx_parse_connection_state_request, knx_connection_state_request,
+                  KNX_CONNECTION_STATE_REQUEST, knx_connection_state_request_parse)
+
+knx_parse_service(knx_parse_connection_state_response, knx_connection_state_response,
+                  KNX_CONNECTION_STATE_RESPONSE, knx_connection_state_response_parse)
+
+knx_parse_service(knx_parse_disconnect_request, knx_disconnect_request,
+                  KNX_DISCONNECT_REQUEST, knx_disconnect_request_parse)
+
+knx_parse_service(knx_parse_disconnect_response, knx_disconnect_response,
+                  KNX_DISCONNECT_RESPONSE, knx_disconnect_response_parse)
+
+knx_parse_service(knx_parse_tunnel_request, knx_tunnel_request,
+                  KNX_TUNNEL_REQUEST, knx_tunnel_request_parse)
+
+knx_parse_service(knx_parse_tunnel_response, knx_tunnel_response,
+                  KNX_TUNNEL_RESPONSE, knx_tunnel_response_parse)
+
+knx_parse_service(knx_parse_routing_indication, knx_routing_indication,
+                  KNX_ROUTING_INDICATION, knx_routing_indication_parse)
+
+knx_parse_service(knx_parse_description_request, knx_description_request,
+                  KNX_DESCRIPTION_REQUEST, knx_description_request_parse)
+
+knx_parse_service(knx_parse_description_response, knx_description_response,
+                  KNX_DESCRIPTION_RESPONSE, knx_description_response_parse)
+
+ssize_t knx_parse_small(
+	const uint8_t*    frame,
+	size_t            frame_length,
+	knx_packet_small* output
+) {
+	knx_service service;
+	const uint8_t* payload;
+	size_t payload_length;
+
+	ssize_t unpack_result =
+		knx_parse_header(frame, frame_length, &service, &payload, &payload_length);
+	if (unpack_result < 0)
+		return unpack_result;
+
+	output->service = service;
+	output->channel = output->seq_number = output->status = 0;
+
+	bool valid;
+
+	switch (service) {
+		case KNX_TUNNEL_REQUEST:
+			// Connection header precedes the CEMI frame, see knx_tunnel_request_parse
+			valid = payload_length >= 4 && payload[0] == 4 &&
+			        knx_telegram_compact_from_cemi(&output->payload.ldata, payload + 4,
+			                                       payload_length - 4);
+
+			if (valid) {
+				output->channel = payload[1];
+				output->seq_number = payload[2];
+			}
+
+			break;
+
+		case KNX_ROUTING_INDICATION:
+			valid = knx_telegram_compact_from_cemi(&output->payload.ldata, payload, payload_length);
+			break;
+
+		case KNX_TUNNEL_RESPONSE: {
+			knx_tunnel_response res;
+			valid = knx_tunnel_response_parse(payload, payload_length, &res);
+
+			if (valid) {
+				output->channel = res.channel;
+				output->seq_number = res.seq_number;
+				output->status = res.status;
+			}
+
+			break;
+		}
+
+		case KNX_CONNECTION_STATE_REQUEST: {
+			knx_connection_state_request req;
+			valid = knx_connection_state_request_parse(payload, payload_length, &req);
+
+			if (valid) {
+				output->channel = req.channel;
+				output->status = req.status;
+				output->payload.host = req.host;
+			}
+
+			break;
+		}
+
+		case KNX_CONNECTION_STATE_RESPONSE: {
+			knx_connection_state_response res;
+			valid = knx_connection_state_response_parse(payload, payload_length, &res);
+
+			if (valid) {
+				output->channel = res.channel;
+				output->status = res.status;
+			}
+
+			break;
+		}
+
+		default:
+			return -KNX_UNKNOWN_SERVICE;
+	}
+
+	return valid ? unpack_result : -KNX_INVALID_PAYLOAD;
+}
+
 bool knx_generate(uint8_t* buffer, knx_service service, const void* payload) {
 	if (!knx_header_generate(buffer, service, knx_payload_size(service, payload)))
 		return false;
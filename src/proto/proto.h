@@ -33,6 +33,7 @@
 #include "tunnelreq.h"
 #include "tunnelres.h"
 #include "routingind.h"
+#include "telegram.h"
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -116,6 +117,51 @@ typedef struct {
 	} payload;
 } knx_packet;
 
+/**
+ * Slim KNXnet/IP Packet
+ *
+ * Covers the high-frequency services (tunnel request and response, routing indication, connection
+ * state request and response) in a fraction of the size of `knx_packet`. L_Data frames are kept
+ * as compact telegrams without additional information.
+ */
+typedef struct {
+	/**
+	 * Service identifier
+	 * \see knx_service
+	 */
+	uint16_t service;
+
+	/**
+	 * Communication channel (tunnel request/response, connection state request/response)
+	 */
+	uint8_t channel;
+
+	/**
+	 * Sequence number (tunnel request/response)
+	 */
+	uint8_t seq_number;
+
+	/**
+	 * Status (tunnel response, connection state request/response)
+	 */
+	uint8_t status;
+
+	/**
+	 * Packet payload
+	 */
+	union {
+		/**
+		 * L_Data frame (tunnel request, routing indication)
+		 */
+		knx_telegram_compact ldata;
+
+		/**
+		 * Host information (connection state request)
+		 */
+		knx_host_info host;
+	} payload;
+} knx_packet_small;
+
 /**
  * Unpack a KNXnet/IP header.
  *
@@ -144,6 +190,172 @@ ssize_t knx_parse(
 	knx_packet*    output
 );
 
+/**
+ * Parse a KNXnet/IP frame, payload parts which need to be allocated are obtained from the given
+ * allocator.
+ *
+ * \param frame        Frame buffer
+ * \param frame_length Number of bytes in `frame`
+ * \param output       Output packet
+ * \param allocator    Allocator (`NULL` selects `malloc`)
+ * \returns Actual frame length or negative integer indicating a `knx_parse_error`
+ */
+ssize_t knx_parse_with(
+	const uint8_t*       frame,
+	size_t               frame_length,
+	knx_packet*          output,
+	const knx_allocator* allocator
+);
+
+/**
+ * Parse a KNXnet/IP frame which carries a tunnel request, tunnel response, routing indication,
+ * connection state request or connection state response.
+ *
+ * \param frame        Contains the frame
+ * \param frame_length Length of `frame` in bytes
+ * \param output       Output packet
+ * \returns Actual frame length or negative integer indicating a `knx_parse_error`; L_Data frames
+ *          which do not fit a compact telegram are reported as `KNX_INVALID_PAYLOAD`, use
+ *          `knx_parse` for them
+ */
+ssize_t knx_parse_small(
+	const uint8_t*    frame,
+	size_t            frame_length,
+	knx_packet_small* output
+);
+
+/**
+ * Parse a KNXnet/IP frame which must carry a connection request.
+ *
+ * \returns Actual frame length or negative integer indicating a `knx_parse_error`
+ *          (`KNX_UNKNOWN_SERVICE` if the frame carries another service)
+ */
+ssize_t knx_parse_connection_request(
+	const uint8_t*          frame,
+	size_t                  frame_length,
+	knx_connection_request* output
+);
+
+/**
+ * Parse a KNXnet/IP frame which must carry a connection response.
+ *
+ * \returns Actual frame length or negative integer indicating a `knx_parse_error`
+ *          (`KNX_UNKNOWN_SERVICE` if the frame carries another service)
+ */
+ssize_t knx_parse_connection_response(
+	const uint8_t*           frame,
+	size_t                   frame_length,
+	knx_connection_response* output
+);
+
+/**
+ * Parse a KNXnet/IP frame which must carry a connection state request.
+ *
+ * \returns Actual frame length or negative integer indicating a `knx_parse_error`
+ *          (`KNX_UNKNOWN_SERVICE` if the frame carries another service)
+ */
+ssize_t knx_parse_connection_state_request(
+	const uint8_t*                frame,
+	size_t                        frame_length,
+	knx_connection_state_request* output
+);
+
+/**
+ * Parse a KNXnet/IP frame which must carry a connection state response.
+ *
+ * \returns Actual frame length or negative integer indicating a `knx_parse_error`
+ *          (`KNX_UNKNOWN_SERVICE` if the frame carries another service)
+ */
+ssize_t knx_parse_connection_state_response(
+	const uint8_t*                 frame,
+	size_t                         frame_length,
+	knx_connection_state_response* output
+);
+
+/**
+ * Parse a KNXnet/IP frame which must carry a disconnect request.
+ *
+ * \returns Actual frame length or negative integer indicating a `knx_parse_error`
+ *          (`KNX_UNKNOWN_SERVICE` if the frame carries another service)
+ */
+ssize_t knx_parse_disconnect_request(
+	const uint8_t*          frame,
+	size_t                  frame_length,
+	knx_disconnect_request* output
+);
+
+/**
+ * Parse a KNXnet/IP frame which must carry a disconnect response.
+ *
+ * \returns Actual frame length or negative integer indicating a `knx_parse_error`
+ *          (`KNX_UNKNOWN_SERVICE` if the frame carries another service)
+ */
+ssize_t knx_parse_disconnect_response(
+	const uint8_t*           frame,
+	size_t                   frame_length,
+	knx_disconnect_response* output
+);
+
+/**
+ * Parse a KNXnet/IP frame which must carry a tunnel request.
+ *
+ * \returns Actual frame length or negative integer indicating a `knx_parse_error`
+ *          (`KNX_UNKNOWN_SERVICE` if the frame carries another service)
+ */
+ssize_t knx_parse_tunnel_request(
+	const uint8_t*      frame,
+	size_t              frame_length,
+	knx_tunnel_request* output
+);
+
+/**
+ * Parse a KNXnet/IP frame which must carry a tunnel response.
+ *
+ * \returns Actual frame length or negative integer indicating a `knx_parse_error`
+ *          (`KNX_UNKNOWN_SERVICE` if the frame carries another service)
+ */
+ssize_t knx_parse_tunnel_response(
+	const uint8_t*       frame,
+	size_t               frame_length,
+	knx_tunnel_response* output
+);
+
+/**
+ * Parse a KNXnet/IP frame which must carry a routing indication.
+ *
+ * \returns Actual frame length or negative integer indicating a `knx_parse_error`
+ *          (`KNX_UNKNOWN_SERVICE` if the frame carries another service)
+ */
+ssize_t knx_parse_routing_indication(
+	const uint8_t*          frame,
+	size_t                  frame_length,
+	knx_routing_indication* output
+);
+
+/**
+ * Parse a KNXnet/IP frame which must carry a description request.
+ *
+ * \returns Actual frame length or negative integer indicating a `knx_parse_error`
+ *          (`KNX_UNKNOWN_SERVICE` if the frame carries another service)
+ */
+ssize_t knx_parse_description_request(
+	const uint8_t*           frame,
+	size_t                   frame_length,
+	knx_description_request* output
+);
+
+/**
+ * Parse a KNXnet/IP frame which must carry a description response.
+ *
+ * \returns Actual frame length or negative integer indicating a `knx_parse_error`
+ *          (`KNX_UNKNOWN_SERVICE` if the frame carries another service)
+ */
+ssize_t knx_parse_description_response(
+	const uint8_t*            frame,
+	size_t                    frame_length,
+	knx_description_response* output
+);
+
 /**
  * Generate a message.
  *
@@ -0,0 +1,104 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "telegram.h"
+
+#include <string.h>
+
+typedef char knx_telegram_compact_size_check[sizeof(knx_telegram_compact) == 32 ? 1 : -1];
+
+// Start of the raw L_Data frame within a telegram
+#define knx_telegram_compact_ldata(telegram) (&(telegram)->control1)
+
+inline static
+bool knx_telegram_compact_service_valid(uint8_t service) {
+	return service == KNX_CEMI_LDATA_REQ ||
+	       service == KNX_CEMI_LDATA_IND ||
+	       service == KNX_CEMI_LDATA_CON;
+}
+
+bool knx_telegram_compact_from_ldata(
+	knx_telegram_compact* telegram,
+	knx_cemi_service      service,
+	const knx_ldata*      ldata
+) {
+	size_t tpdu_length = knx_tpdu_size(&ldata->tpdu);
+
+	if (tpdu_length == 0 || tpdu_length > KNX_TELEGRAM_COMPACT_TPDU_SIZE)
+		return false;
+
+	telegram->service = service;
+
+	// Unused TPDU bytes are cleared, so equal telegrams compare equal byte by byte
+	memset(telegram->tpdu + tpdu_length, 0, KNX_TELEGRAM_COMPACT_TPDU_SIZE - tpdu_length);
+
+	return knx_ldata_generate(knx_telegram_compact_ldata(telegram), ldata);
+}
+
+bool knx_telegram_compact_to_ldata(const knx_telegram_compact* telegram, knx_ldata* ldata) {
+	if (telegram->length >= KNX_TELEGRAM_COMPACT_TPDU_SIZE)
+		return false;
+
+	return knx_ldata_parse(
+		knx_telegram_compact_ldata(telegram),
+		knx_telegram_compact_ldata_size(telegram),
+		ldata
+	);
+}
+
+bool knx_telegram_compact_from_cemi(
+	knx_telegram_compact* telegram,
+	const uint8_t*        cemi,
+	size_t                length
+) {
+	if (length < KNX_CEMI_HEADER_SIZE || !knx_telegram_compact_service_valid(cemi[0]))
+		return false;
+
+	size_t offset = KNX_CEMI_HEADER_SIZE + (size_t) cemi[1];
+
+	// Header of the L_Data frame and at least one TPDU byte
+	if (offset + 8 > length)
+		return false;
+
+	const uint8_t* ldata = cemi + offset;
+	size_t tpdu_length = (size_t) ldata[6] + 1;
+
+	// Extended frame format bits are only valid in extended frames, the TPDU must fit
+	if (((ldata[0] & 0x80) && (ldata[1] & 15)) || 7 + tpdu_length > length - offset ||
+	    tpdu_length > KNX_TELEGRAM_COMPACT_TPDU_SIZE)
+		return false;
+
+	telegram->service = cemi[0];
+	memcpy(knx_telegram_compact_ldata(telegram), ldata, 7 + tpdu_length);
+	memset(telegram->tpdu + tpdu_length, 0, KNX_TELEGRAM_COMPACT_TPDU_SIZE - tpdu_length);
+
+	return true;
+}
+
+size_t knx_telegram_compact_to_cemi(const knx_telegram_compact* telegram, uint8_t* buffer) {
+	size_t ldata_length = knx_telegram_compact_ldata_size(telegram);
+
+	buffer[0] = telegram->service;
+	buffer[1] = 0;
+	memcpy(buffer + KNX_CEMI_HEADER_SIZE, knx_telegram_compact_ldata(telegram), ldata_length);
+
+	return KNX_CEMI_HEADER_SIZE + ldata_length;
+}
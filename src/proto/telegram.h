@@ -0,0 +1,170 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_PROTO_TELEGRAM_H_
+#define KNXPROTO_PROTO_TELEGRAM_H_
+
+#include "cemi.h"
+#include "ldata.h"
+#include "../util/address.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Maximum number of TPDU bytes a compact telegram can hold
+ */
+#define KNX_TELEGRAM_COMPACT_TPDU_SIZE 24
+
+/**
+ * Compact Telegram
+ *
+ * Fixed-size record of 32 bytes for queues and storage. The fields from `control1` to the end of
+ * `tpdu` are the raw L_Data frame exactly as it appears on the wire, which makes conversions a
+ * matter of copying bytes. Additional information is not retained.
+ */
+typedef struct {
+	/**
+	 * CEMI message code
+	 * \see knx_cemi_service
+	 */
+	uint8_t service;
+
+	/**
+	 * Raw control field 1
+	 */
+	uint8_t control1;
+
+	/**
+	 * Raw control field 2
+	 */
+	uint8_t control2;
+
+	/**
+	 * Source address (big-endian)
+	 */
+	uint8_t source[2];
+
+	/**
+	 * Destination address (big-endian)
+	 */
+	uint8_t destination[2];
+
+	/**
+	 * Number of TPDU bytes minus 1
+	 */
+	uint8_t length;
+
+	/**
+	 * Transport protocol data unit
+	 */
+	uint8_t tpdu[KNX_TELEGRAM_COMPACT_TPDU_SIZE];
+} knx_telegram_compact;
+
+/**
+ * Source address
+ */
+inline static
+knx_addr knx_telegram_compact_source(const knx_telegram_compact* telegram) {
+	return telegram->source[0] << 8 | telegram->source[1];
+}
+
+/**
+ * Destination address
+ */
+inline static
+knx_addr knx_telegram_compact_destination(const knx_telegram_compact* telegram) {
+	return telegram->destination[0] << 8 | telegram->destination[1];
+}
+
+/**
+ * Is the destination a group address?
+ */
+inline static
+bool knx_telegram_compact_is_group(const knx_telegram_compact* telegram) {
+	return telegram->control2 >> 7 & 1;
+}
+
+/**
+ * Size of the raw L_Data frame
+ */
+inline static
+size_t knx_telegram_compact_ldata_size(const knx_telegram_compact* telegram) {
+	return 8 + (size_t) telegram->length;
+}
+
+/**
+ * Space needed to generate the telegram as a raw CEMI frame.
+ */
+inline static
+size_t knx_telegram_compact_cemi_size(const knx_telegram_compact* telegram) {
+	return KNX_CEMI_HEADER_SIZE + knx_telegram_compact_ldata_size(telegram);
+}
+
+/**
+ * Pack an L_Data frame.
+ *
+ * \param telegram Output telegram
+ * \param service  CEMI message code
+ * \param ldata    L_Data frame
+ * \returns `true` on success, `false` if the TPDU exceeds `KNX_TELEGRAM_COMPACT_TPDU_SIZE`
+ */
+bool knx_telegram_compact_from_ldata(
+	knx_telegram_compact* telegram,
+	knx_cemi_service      service,
+	const knx_ldata*      ldata
+);
+
+/**
+ * Unpack into an L_Data frame.
+ *
+ * \param telegram Telegram, `ldata` borrows its payload from it
+ * \param ldata    Output L_Data frame
+ * \returns `true` on success, otherwise `false`
+ */
+bool knx_telegram_compact_to_ldata(const knx_telegram_compact* telegram, knx_ldata* ldata);
+
+/**
+ * Pack a raw CEMI frame.
+ *
+ * \param telegram Output telegram
+ * \param cemi     Raw CEMI frame
+ * \param length   Number of bytes in `cemi`
+ * \returns `true` on success, `false` if the frame is malformed, not an L_Data frame or too large
+ */
+bool knx_telegram_compact_from_cemi(
+	knx_telegram_compact* telegram,
+	const uint8_t*        cemi,
+	size_t                length
+);
+
+/**
+ * Generate a raw CEMI frame without additional information.
+ *
+ * \see knx_telegram_compact_cemi_size
+ * \param telegram Telegram
+ * \param buffer   Output buffer, you have to make sure there is enough space
+ * \returns Number of bytes written
+ */
+size_t knx_telegram_compact_to_cemi(const knx_telegram_compact* telegram, uint8_t* buffer);
+
+#endif
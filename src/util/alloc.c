@@ -0,0 +1,95 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "alloc.h"
+
+#include <stdlib.h>
+
+static __thread knx_alloc_stats knx_alloc_counters;
+
+inline static
+void knx_alloc_count(size_t size) {
+	knx_alloc_counters.allocations++;
+	knx_alloc_counters.bytes += size;
+}
+
+#ifdef KNXPROTO_NO_MALLOC
+
+// The heap is off limits, callers provide storage through allocators instead
+
+void* knx_alloc(size_t size) {
+	knx_alloc_count(size);
+	return NULL;
+}
+
+void* knx_realloc(void* pointer, size_t size) {
+	knx_alloc_count(size);
+	return NULL;
+}
+
+void* knx_alloc_aligned(size_t alignment, size_t size) {
+	knx_alloc_count(size);
+	return NULL;
+}
+
+void knx_free(void* pointer) {
+	if (pointer)
+		knx_alloc_counters.frees++;
+}
+
+#else
+
+void* knx_alloc(size_t size) {
+	knx_alloc_count(size);
+	return malloc(size);
+}
+
+void* knx_realloc(void* pointer, size_t size) {
+	knx_alloc_count(size);
+	return realloc(pointer, size);
+}
+
+void* knx_alloc_aligned(size_t alignment, size_t size) {
+	void* pointer;
+
+	knx_alloc_count(size);
+	return posix_memalign(&pointer, alignment, size) == 0 ? pointer : NULL;
+}
+
+void knx_free(void* pointer) {
+	if (!pointer)
+		return;
+
+	knx_alloc_counters.frees++;
+	free(pointer);
+}
+
+#endif
+
+void knx_alloc_stats_get(knx_alloc_stats* stats) {
+	*stats = knx_alloc_counters;
+}
+
+void knx_alloc_stats_reset(void) {
+	knx_alloc_counters.allocations = 0;
+	knx_alloc_counters.frees = 0;
+	knx_alloc_counters.bytes = 0;
+}
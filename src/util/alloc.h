@@ -22,22 +22,78 @@
 #ifndef KNXPROTO_UTIL_ALLOC_H_
 #define KNXPROTO_UTIL_ALLOC_H_
 
-#include <malloc.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Allocation Counters
+ *
+ * Counters are kept per thread, so the difference between two snapshots taken around a function
+ * call is exactly what that call allocated.
+ */
+typedef struct {
+	/**
+	 * Number of allocations (including reallocations)
+	 */
+	uint64_t allocations;
+
+	/**
+	 * Number of releases
+	 */
+	uint64_t frees;
+
+	/**
+	 * Number of bytes requested
+	 */
+	uint64_t bytes;
+} knx_alloc_stats;
+
+/**
+ * Allocate `size` bytes from the heap. Always fails if the library has been built with
+ * `KNXPROTO_NO_MALLOC`.
+ */
+void* knx_alloc(size_t size);
+
+/**
+ * Resize a heap block.
+ */
+void* knx_realloc(void* pointer, size_t size);
+
+/**
+ * Allocate `size` bytes from the heap, aligned to `alignment` (a power of two multiple of
+ * `sizeof(void*)`).
+ */
+void* knx_alloc_aligned(size_t alignment, size_t size);
+
+/**
+ * Release a heap block.
+ */
+void knx_free(void* pointer);
+
+/**
+ * Snapshot of the calling thread's allocation counters.
+ */
+void knx_alloc_stats_get(knx_alloc_stats* stats);
+
+/**
+ * Reset the calling thread's allocation counters.
+ */
+void knx_alloc_stats_reset(void);
 
 /**
  * Allocate a new instance of `t`.
  */
-#define new(t) ((t*) malloc(sizeof(t)))
+#define new(t) ((t*) knx_alloc(sizeof(t)))
 
 /**
  * Allocate an array of `n` instances of `t`.
  */
-#define newa(t, n) ((t*) malloc(sizeof(t) * (n)))
+#define newa(t, n) ((t*) knx_alloc(sizeof(t) * (n)))
 
 /**
  * Reallocate an array of `n` instances of `t`.
  */
-#define renewa(p, t, n) ((t*) realloc(p, sizeof(t) * (n)))
+#define renewa(p, t, n) ((t*) knx_realloc(p, sizeof(t) * (n)))
 
 /**
  * Define an anonymous array of `t`s.
@@ -0,0 +1,278 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "allocator.h"
+#include "alloc.h"
+
+#include <string.h>
+
+// Largest size that can be rounded up to the alignment without wrapping around
+#define KNX_ALLOCATOR_MAX_SIZE (SIZE_MAX - (KNX_ALLOCATOR_ALIGNMENT - 1))
+
+inline static
+size_t knx_allocator_align(size_t size) {
+	return (size + KNX_ALLOCATOR_ALIGNMENT - 1) & ~((size_t) KNX_ALLOCATOR_ALIGNMENT - 1);
+}
+
+static
+void* knx_allocator_default_alloc(void* context, size_t size) {
+	(void) context;
+	return knx_alloc(size);
+}
+
+static
+void knx_allocator_default_free(void* context, void* pointer) {
+	(void) context;
+	knx_free(pointer);
+}
+
+const knx_allocator knx_allocator_default = {
+	knx_allocator_default_alloc,
+	knx_allocator_default_free,
+	NULL
+};
+
+static
+void* knx_allocator_none_alloc(void* context, size_t size) {
+	(void) context;
+	(void) size;
+	return NULL;
+}
+
+static
+void knx_allocator_none_free(void* context, void* pointer) {
+	(void) context;
+	(void) pointer;
+}
+
+const knx_allocator knx_allocator_none = {
+	knx_allocator_none_alloc,
+	knx_allocator_none_free,
+	NULL
+};
+
+void* knx_allocator_resize(
+	const knx_allocator* allocator,
+	void*                pointer,
+	size_t               size,
+	size_t               new_size
+) {
+	if (!allocator || allocator == &knx_allocator_default)
+		return knx_realloc(pointer, new_size);
+
+	if (pointer && new_size <= size)
+		return pointer;
+
+	void* block = knx_allocator_alloc(allocator, new_size);
+	if (!block)
+		return NULL;
+
+	if (pointer) {
+		memcpy(block, pointer, size);
+		knx_allocator_free(allocator, pointer);
+	}
+
+	return block;
+}
+
+bool knx_arena_init(knx_arena* arena, size_t size) {
+	if (size > KNX_ALLOCATOR_MAX_SIZE)
+		return false;
+
+	size = knx_allocator_align(size);
+
+	// malloc only guarantees the alignment of the largest fundamental type
+	arena->base = knx_alloc_aligned(KNX_ALLOCATOR_ALIGNMENT, size);
+	if (!arena->base)
+		return false;
+
+	arena->size = size;
+	arena->used = 0;
+	arena->owned = true;
+
+	return true;
+}
+
+void knx_arena_init_buffer(knx_arena* arena, void* buffer, size_t size) {
+	arena->base = buffer;
+	arena->size = size;
+	arena->owned = false;
+
+	// Skip ahead so that blocks are aligned relative to the address space
+	size_t misalignment = (uintptr_t) buffer % KNX_ALLOCATOR_ALIGNMENT;
+	arena->used = misalignment > 0 ? KNX_ALLOCATOR_ALIGNMENT - misalignment : 0;
+
+	if (arena->used > size)
+		arena->used = size;
+}
+
+void knx_arena_destroy(knx_arena* arena) {
+	if (arena->owned)
+		knx_free(arena->base);
+
+	arena->base = NULL;
+	arena->size = arena->used = 0;
+}
+
+void* knx_arena_alloc(knx_arena* arena, size_t size) {
+	if (size > KNX_ALLOCATOR_MAX_SIZE)
+		return NULL;
+
+	size = knx_allocator_align(size > 0 ? size : 1);
+
+	if (size > arena->size - arena->used)
+		return NULL;
+
+	void* pointer = arena->base + arena->used;
+	arena->used += size;
+
+	return pointer;
+}
+
+static
+void* knx_arena_allocator_alloc(void* context, size_t size) {
+	return knx_arena_alloc(context, size);
+}
+
+static
+void knx_arena_allocator_free(void* context, void* pointer) {
+	(void) context;
+	(void) pointer;
+}
+
+knx_allocator knx_arena_allocator(knx_arena* arena) {
+	return (knx_allocator) {knx_arena_allocator_alloc, knx_arena_allocator_free, arena};
+}
+
+// Slots follow the chunk header, which is padded to keep them aligned
+#define KNX_SLAB_HEADER_SIZE knx_allocator_align(sizeof(knx_slab_chunk))
+
+void knx_slab_init(knx_slab* slab, size_t object_size, size_t objects_per_chunk) {
+	knx_slab_init_with(slab, object_size, objects_per_chunk, NULL);
+}
+
+void knx_slab_init_with(
+	knx_slab*            slab,
+	size_t               object_size,
+	size_t               objects_per_chunk,
+	const knx_allocator* backing
+) {
+	if (object_size < sizeof(void*))
+		object_size = sizeof(void*);
+
+	// Such slots can never be allocated, knx_slab_grow refuses them
+	if (object_size > KNX_ALLOCATOR_MAX_SIZE)
+		object_size = KNX_ALLOCATOR_MAX_SIZE;
+
+	slab->object_size = knx_allocator_align(object_size);
+	slab->objects_per_chunk = objects_per_chunk > 0 ? objects_per_chunk : 1;
+	slab->chunks = NULL;
+	slab->free_list = NULL;
+	slab->used = 0;
+	slab->backing = backing;
+}
+
+void knx_slab_destroy(knx_slab* slab) {
+	knx_slab_chunk* chunk = slab->chunks;
+
+	while (chunk) {
+		knx_slab_chunk* next = chunk->next;
+
+		if (slab->backing)
+			knx_allocator_free(slab->backing, chunk);
+		else
+			knx_free(chunk);
+
+		chunk = next;
+	}
+
+	slab->chunks = NULL;
+	slab->free_list = NULL;
+	slab->used = 0;
+}
+
+static
+bool knx_slab_grow(knx_slab* slab) {
+	if (slab->object_size > (SIZE_MAX - KNX_SLAB_HEADER_SIZE) / slab->objects_per_chunk)
+		return false;
+
+	size_t size = KNX_SLAB_HEADER_SIZE + slab->object_size * slab->objects_per_chunk;
+
+	// The bundled allocators align their blocks already, malloc might not
+	knx_slab_chunk* chunk = slab->backing
+		? knx_allocator_alloc(slab->backing, size)
+		: knx_alloc_aligned(KNX_ALLOCATOR_ALIGNMENT, size);
+
+	if (!chunk)
+		return false;
+
+	chunk->next = slab->chunks;
+	slab->chunks = chunk;
+
+	// Thread the new slots onto the free list, lowest address first
+	uint8_t* base = (uint8_t*) chunk + KNX_SLAB_HEADER_SIZE;
+
+	for (size_t i = slab->objects_per_chunk; i > 0; i--) {
+		void** slot = (void**) (base + (i - 1) * slab->object_size);
+		*slot = slab->free_list;
+		slab->free_list = slot;
+	}
+
+	return true;
+}
+
+void* knx_slab_alloc(knx_slab* slab, size_t size) {
+	// Every block is a slot, so releasing one never has to search for its owner
+	if (size > slab->object_size)
+		return NULL;
+
+	if (!slab->free_list && !knx_slab_grow(slab))
+		return NULL;
+
+	void** slot = slab->free_list;
+	slab->free_list = *slot;
+	slab->used++;
+
+	return slot;
+}
+
+void knx_slab_free(knx_slab* slab, void* pointer) {
+	if (!pointer)
+		return;
+
+	* (void**) pointer = slab->free_list;
+	slab->free_list = pointer;
+	slab->used--;
+}
+
+static
+void* knx_slab_allocator_alloc(void* context, size_t size) {
+	return knx_slab_alloc(context, size);
+}
+
+static
+void knx_slab_allocator_free(void* context, void* pointer) {
+	knx_slab_free(context, pointer);
+}
+
+knx_allocator knx_slab_allocator(knx_slab* slab) {
+	return (knx_allocator) {knx_slab_allocator_alloc, knx_slab_allocator_free, slab};
+}
@@ -0,0 +1,271 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_UTIL_ALLOCATOR_H_
+#define KNXPROTO_UTIL_ALLOCATOR_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Alignment of every block handed out by the bundled allocators
+ */
+#define KNX_ALLOCATOR_ALIGNMENT 16
+
+/**
+ * Allocator
+ *
+ * Allocating functions accept a pointer to an allocator; `NULL` selects `malloc` and `free`.
+ * Memory must be released through the allocator it was obtained from.
+ */
+typedef struct {
+	/**
+	 * Allocate `size` bytes, returns `NULL` on failure
+	 */
+	void* (* alloc)(void* context, size_t size);
+
+	/**
+	 * Release a block obtained from `alloc`
+	 */
+	void (* free)(void* context, void* pointer);
+
+	/**
+	 * Passed to `alloc` and `free`
+	 */
+	void* context;
+} knx_allocator;
+
+/**
+ * Allocator backed by `malloc` and `free`
+ */
+extern const knx_allocator knx_allocator_default;
+
+/**
+ * Allocator which never hands out memory and ignores releases. Structures whose memory is owned by
+ * something else (e.g. the message they were parsed from) refer to it.
+ */
+extern const knx_allocator knx_allocator_none;
+
+/**
+ * Allocate using the given allocator (may be `NULL`).
+ */
+inline static
+void* knx_allocator_alloc(const knx_allocator* allocator, size_t size) {
+	if (!allocator)
+		allocator = &knx_allocator_default;
+
+	return allocator->alloc(allocator->context, size);
+}
+
+/**
+ * Release using the given allocator (may be `NULL`).
+ */
+inline static
+void knx_allocator_free(const knx_allocator* allocator, void* pointer) {
+	if (!allocator)
+		allocator = &knx_allocator_default;
+
+	allocator->free(allocator->context, pointer);
+}
+
+/**
+ * Resize a block using the given allocator (may be `NULL`). Allocators other than the default
+ * cannot resize in place: growing moves the contents to a new block, shrinking keeps the block.
+ *
+ * \param allocator Allocator the block has been obtained from
+ * \param pointer   Block or `NULL`
+ * \param size      Current size of the block
+ * \param new_size  Requested size
+ * \returns Resized block or `NULL` on failure, in which case `pointer` remains valid
+ */
+void* knx_allocator_resize(
+	const knx_allocator* allocator,
+	void*                pointer,
+	size_t               size,
+	size_t               new_size
+);
+
+/**
+ * Bump Arena
+ *
+ * Hands out memory from a fixed buffer by advancing an offset. Individual blocks cannot be
+ * released, instead the entire arena is reset at once.
+ */
+typedef struct {
+	/**
+	 * Buffer
+	 */
+	uint8_t* base;
+
+	/**
+	 * Size of the buffer
+	 */
+	size_t size;
+
+	/**
+	 * Number of bytes in use
+	 */
+	size_t used;
+
+	/**
+	 * Has the buffer been allocated by the arena?
+	 */
+	bool owned;
+} knx_arena;
+
+/**
+ * Initialize an arena with a heap buffer.
+ *
+ * \param arena Output arena
+ * \param size  Capacity in bytes
+ * \returns `true` on success, `false` if the buffer could not be allocated
+ */
+bool knx_arena_init(knx_arena* arena, size_t size);
+
+/**
+ * Initialize an arena with a caller-provided buffer (e.g. on the stack).
+ *
+ * \param arena  Output arena
+ * \param buffer Buffer, must outlive the arena
+ * \param size   Size of `buffer`
+ */
+void knx_arena_init_buffer(knx_arena* arena, void* buffer, size_t size);
+
+/**
+ * Release every block handed out so far.
+ */
+inline static
+void knx_arena_reset(knx_arena* arena) {
+	arena->used = 0;
+}
+
+/**
+ * Free the buffer if the arena owns it.
+ */
+void knx_arena_destroy(knx_arena* arena);
+
+/**
+ * Allocate from the arena.
+ *
+ * \returns Aligned block or `NULL` if the arena is exhausted
+ */
+void* knx_arena_alloc(knx_arena* arena, size_t size);
+
+/**
+ * Allocator interface to the arena. Freeing through it does nothing.
+ */
+knx_allocator knx_arena_allocator(knx_arena* arena);
+
+/**
+ * Slab Chunk
+ */
+typedef struct knx_slab_chunk {
+	/**
+	 * Next chunk
+	 */
+	struct knx_slab_chunk* next;
+} knx_slab_chunk;
+
+/**
+ * Slab Allocator
+ *
+ * Serves blocks of up to `object_size` bytes from chunks of equally sized slots and recycles
+ * released slots through a free list. Larger requests fail. A slab is not synchronized; give each
+ * thread its own slab to avoid contention on the global heap.
+ */
+typedef struct {
+	/**
+	 * Size of a slot
+	 */
+	size_t object_size;
+
+	/**
+	 * Number of slots per chunk
+	 */
+	size_t objects_per_chunk;
+
+	/**
+	 * Allocated chunks
+	 */
+	knx_slab_chunk* chunks;
+
+	/**
+	 * Released slots
+	 */
+	void* free_list;
+
+	/**
+	 * Number of slots in use
+	 */
+	size_t used;
+
+	/**
+	 * Allocator the chunks are obtained from, `NULL` means the heap
+	 */
+	const knx_allocator* backing;
+} knx_slab;
+
+/**
+ * Initialize a slab. Chunks are allocated on demand.
+ *
+ * \param slab              Output slab
+ * \param object_size       Largest block served from a slot
+ * \param objects_per_chunk Number of slots allocated at once
+ */
+void knx_slab_init(knx_slab* slab, size_t object_size, size_t objects_per_chunk);
+
+/**
+ * Initialize a slab whose chunks are obtained from another allocator (e.g. an arena).
+ *
+ * \see knx_slab_init
+ * \param backing Allocator for the chunks, must outlive the slab
+ */
+void knx_slab_init_with(
+	knx_slab*            slab,
+	size_t               object_size,
+	size_t               objects_per_chunk,
+	const knx_allocator* backing
+);
+
+/**
+ * Free all chunks, including the blocks which are still in use.
+ */
+void knx_slab_destroy(knx_slab* slab);
+
+/**
+ * Allocate from the slab.
+ *
+ * \returns Aligned block or `NULL` if `size` exceeds `object_size` or no chunk can be allocated
+ */
+void* knx_slab_alloc(knx_slab* slab, size_t size);
+
+/**
+ * Release a block obtained from `knx_slab_alloc` of the same slab.
+ */
+void knx_slab_free(knx_slab* slab, void* pointer);
+
+/**
+ * Allocator interface to the slab.
+ */
+knx_allocator knx_slab_allocator(knx_slab* slab);
+
+#endif
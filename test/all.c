@@ -2,10 +2,40 @@
 
 externtest(knxnetip)
 externtest(cemi)
+externtest(telegram)
+externtest(data)
+externtest(groupindex)
+externtest(format)
+externtest(ring)
+externtest(log)
+externtest(capture)
+externtest(series)
+externtest(pool)
+externtest(busload)
+externtest(shaper)
+externtest(filter)
+externtest(allocator)
+externtest(transport)
+externtest(memory)
 
 deftest(all, {
 	runsubtest(knxnetip);
 	runsubtest(cemi);
+	runsubtest(telegram);
+	runsubtest(data);
+	runsubtest(groupindex);
+	runsubtest(format);
+	runsubtest(ring);
+	runsubtest(log);
+	runsubtest(capture);
+	runsubtest(series);
+	runsubtest(pool);
+	runsubtest(busload);
+	runsubtest(shaper);
+	runsubtest(filter);
+	runsubtest(allocator);
+	runsubtest(transport);
+	runsubtest(memory);
 })
 
 int main(void) {
@@ -0,0 +1,516 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+#include "testalloc.h"
+
+#include "../src/util/allocator.h"
+#include "../src/util/alloc.h"
+#include "../src/proto/proto.h"
+#include "../src/proto/ldata.h"
+#include "../src/proto/data.h"
+#include "../src/proto/format.h"
+#include "../src/proto/groupindex.h"
+#include "../src/bus/filter.h"
+#include "../src/bus/shaper.h"
+#include "../src/io/pool.h"
+#include "../src/io/series.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+inline static
+bool example_allocator_aligned(const void* pointer) {
+	return (uintptr_t) pointer % KNX_ALLOCATOR_ALIGNMENT == 0;
+}
+
+deftest(allocator_arena, {
+	knx_arena arena;
+	assert(knx_arena_init(&arena, 100));
+	assert(arena.size == 112);
+
+	void* a = knx_arena_alloc(&arena, 1);
+	void* b = knx_arena_alloc(&arena, 17);
+	assert(a != NULL && b != NULL);
+	assert(example_allocator_aligned(a) && example_allocator_aligned(b));
+	assert((uint8_t*) b - (uint8_t*) a == 16);
+	assert(arena.used == 48);
+
+	// Exhausted
+	assert(knx_arena_alloc(&arena, 65) == NULL);
+	assert(knx_arena_alloc(&arena, 64) != NULL);
+	assert(knx_arena_alloc(&arena, 1) == NULL);
+
+	// Reset releases everything at once
+	knx_arena_reset(&arena);
+	assert(knx_arena_alloc(&arena, 1) == a);
+
+	knx_arena_destroy(&arena);
+})
+
+deftest(allocator_arena_buffer, {
+	// Caller-provided buffer with an unaligned start
+	static uint8_t buffer[64];
+	knx_arena arena;
+	knx_arena_init_buffer(&arena, buffer + 1, sizeof(buffer) - 1);
+
+	void* a = knx_arena_alloc(&arena, 8);
+	assert(a != NULL && example_allocator_aligned(a));
+	assert((uint8_t*) a + 16 <= buffer + sizeof(buffer));
+
+	knx_arena_destroy(&arena);
+})
+
+deftest(allocator_slab, {
+	knx_slab slab;
+	knx_slab_init_with(&slab, 24, 4, test_allocator());
+	assert(slab.object_size == 32);
+
+	void* slots[5];
+	for (size_t i = 0; i < 5; i++) {
+		slots[i] = knx_slab_alloc(&slab, 24);
+		assert(slots[i] != NULL && example_allocator_aligned(slots[i]));
+		memset(slots[i], 0xAA, 24);
+	}
+
+	assert(slab.used == 5);
+	assert(slab.chunks != NULL && slab.chunks->next != NULL && slab.chunks->next->next == NULL);
+
+	// Released slots are recycled
+	knx_slab_free(&slab, slots[2]);
+	assert(slab.used == 4);
+	assert(knx_slab_alloc(&slab, 8) == slots[2]);
+
+	// Blocks larger than a slot are refused
+	knx_alloc_stats stats;
+	knx_alloc_stats_reset();
+
+	assert(knx_slab_alloc(&slab, 33) == NULL);
+	assert(slab.used == 5);
+
+	knx_alloc_stats_get(&stats);
+	assert(stats.allocations == 0);
+
+	// Through the allocator interface
+	knx_allocator allocator = knx_slab_allocator(&slab);
+	void* c = knx_allocator_alloc(&allocator, 16);
+	assert(c != NULL && slab.used == 6);
+	knx_allocator_free(&allocator, c);
+	assert(slab.used == 5);
+
+	knx_slab_destroy(&slab);
+	assert(slab.chunks == NULL);
+
+	// Chunks from an arena
+	static uint8_t buffer[256];
+	knx_arena arena;
+	knx_arena_init_buffer(&arena, buffer, sizeof(buffer));
+	knx_allocator backing = knx_arena_allocator(&arena);
+
+	knx_slab_init_with(&slab, 24, 4, &backing);
+	knx_alloc_stats_reset();
+
+	c = knx_slab_alloc(&slab, 24);
+	assert(c != NULL && (uint8_t*) c > buffer && (uint8_t*) c < buffer + sizeof(buffer));
+	knx_slab_free(&slab, c);
+	assert(knx_slab_alloc(&slab, 24) == c);
+
+	knx_alloc_stats_get(&stats);
+	assert(stats.allocations == 0);
+
+	knx_slab_destroy(&slab);
+})
+
+deftest(allocator_overflow, {
+	// Sizes close to SIZE_MAX must not wrap around when they are rounded up
+	knx_arena arena;
+	assert(!knx_arena_init(&arena, SIZE_MAX));
+	assert(!knx_arena_init(&arena, SIZE_MAX - 3));
+
+	static uint8_t buffer[64];
+	knx_arena_init_buffer(&arena, buffer, sizeof(buffer));
+	size_t used = arena.used;
+
+	assert(knx_arena_alloc(&arena, SIZE_MAX) == NULL);
+	assert(knx_arena_alloc(&arena, SIZE_MAX - 3) == NULL);
+	assert(arena.used == used);
+
+	knx_allocator backing = knx_arena_allocator(&arena);
+
+	// Chunk sizes which do not fit into size_t
+	knx_slab slab;
+	knx_slab_init_with(&slab, SIZE_MAX, 1, &backing);
+	assert(slab.object_size != 0);
+	assert(knx_slab_alloc(&slab, 8) == NULL);
+	assert(slab.chunks == NULL);
+
+	knx_slab_init_with(&slab, SIZE_MAX / 2, 4, &backing);
+	assert(knx_slab_alloc(&slab, 8) == NULL);
+	assert(slab.chunks == NULL && arena.used == used);
+})
+
+inline static
+bool example_allocator_owns(const knx_arena* arena, const void* pointer) {
+	return (const uint8_t*) pointer >= arena->base &&
+	       (const uint8_t*) pointer < arena->base + arena->size;
+}
+
+static
+void example_allocator_send(const knx_ldata* ldata, void* user, void* data) {
+	(void) ldata;
+	(void) user;
+	(void) data;
+}
+
+deftest(allocator_modules, {
+	static uint8_t buffer[3 << 20];
+	knx_arena arena;
+	knx_arena_init_buffer(&arena, buffer, sizeof(buffer));
+	knx_allocator allocator = knx_arena_allocator(&arena);
+
+	knx_alloc_stats stats;
+	knx_alloc_stats_reset();
+
+	// Group index
+	const char csv[] = "Switch,0/0/1,,,,DPST-1-1,Auto\n";
+	knx_group_index* index = knx_group_index_parse_with(csv, sizeof(csv) - 1, &allocator);
+	assert(index != NULL && example_allocator_owns(&arena, index));
+	assert(index->count == 1);
+	knx_group_index_free_with(index, &allocator);
+	knx_arena_reset(&arena);
+
+	// Filter
+	static knx_filter filter;
+	assert(knx_filter_init_with(&filter, NULL, &allocator));
+	assert(example_allocator_owns(&arena, filter.states));
+	assert(knx_filter_update(&filter, 0, 1, 1));
+	assert(!knx_filter_update(&filter, 1, 1, 1));
+	knx_filter_destroy(&filter);
+	knx_arena_reset(&arena);
+
+	// Shaper
+	knx_shaper shaper;
+	assert(knx_shaper_init_with(&shaper, 8, KNX_SHAPER_DEFAULT_RATE, 1, example_allocator_send,
+	                            NULL, &allocator));
+	assert(example_allocator_owns(&arena, shaper.entries));
+	knx_shaper_destroy(&shaper);
+	knx_arena_reset(&arena);
+
+	// Pool buffers remain aligned to cache lines
+	knx_pool pool;
+	assert(knx_pool_init_with(&pool, 4, 100, &allocator));
+	assert(example_allocator_owns(&arena, pool.buffers));
+	assert(example_allocator_owns(&arena, pool.storage));
+	assert((uintptr_t) pool.storage % 64 == 0);
+
+	knx_pool_buffer* pooled = knx_pool_acquire(&pool);
+	assert(pooled != NULL && pooled->data + 100 <= arena.base + arena.used);
+	knx_pool_release(pooled);
+
+	knx_pool_destroy(&pool);
+	knx_arena_reset(&arena);
+
+	// Time series
+	static knx_series series;
+	knx_series_init_with(&series, 1, &allocator);
+
+	for (size_t i = 0; i < KNX_SERIES_BLOCK_SAMPLES + 10; i++)
+		assert(knx_series_append(&series, 1, KNX_DPT_FLOAT16, i, i % 7));
+
+	assert(series.columns[1]->head != series.columns[1]->tail);
+	assert(example_allocator_owns(&arena, series.columns[1]->head->values.data));
+	knx_series_destroy(&series);
+
+	knx_alloc_stats_get(&stats);
+	assert(stats.allocations == 0);
+})
+
+deftest(allocator_ldata, {
+	static uint8_t buffer[4096];
+	knx_arena arena;
+	knx_arena_init_buffer(&arena, buffer, sizeof(buffer));
+	knx_allocator allocator = knx_arena_allocator(&arena);
+
+	const uint8_t payload[3] = {0x80, 0x0C, 0x1A};
+
+	knx_ldata ldata;
+	memset(&ldata, 0, sizeof(knx_ldata));
+	ldata.tpdu.tpci = KNX_TPCI_UNNUMBERED_DATA;
+	ldata.tpdu.info.data.apci = KNX_APCI_GROUPVALUEWRITE;
+	ldata.tpdu.info.data.payload = payload;
+	ldata.tpdu.info.data.length = sizeof(payload);
+
+	knx_ldata* copy = knx_ldata_duplicate_with(&ldata, &allocator);
+	assert(copy != NULL);
+	assert((uint8_t*) copy >= arena.base && (uint8_t*) copy < arena.base + arena.size);
+	assert(copy->tpdu.info.data.payload == (const uint8_t*) (copy + 1));
+	assert(copy->tpdu.info.data.payload[0] == 0 && copy->tpdu.info.data.payload[2] == 0x1A);
+
+	knx_allocator_free(&allocator, copy);
+
+	// Default allocator
+	if (TEST_HEAP) {
+		copy = knx_ldata_duplicate_with(&ldata, NULL);
+		assert(copy != NULL);
+		knx_allocator_free(NULL, copy);
+	}
+
+	knx_arena_destroy(&arena);
+})
+
+deftest(allocator_ldata_batch, {
+	const uint8_t payloads[3][4] = {{0x80, 1}, {0x40, 2, 3}, {0xC0, 4, 5, 6}};
+
+	knx_ldata frames[4];
+	memset(frames, 0, sizeof(frames));
+
+	for (size_t i = 0; i < 3; i++) {
+		frames[i].destination = i + 1;
+		frames[i].tpdu.tpci = KNX_TPCI_UNNUMBERED_DATA;
+		frames[i].tpdu.info.data.apci = KNX_APCI_GROUPVALUEWRITE;
+		frames[i].tpdu.info.data.payload = payloads[i];
+		frames[i].tpdu.info.data.length = i + 2;
+	}
+
+	frames[3].destination = 4;
+	frames[3].tpdu.tpci = KNX_TPCI_NUMBERED_CONTROL;
+	frames[3].tpdu.info.control = KNX_TPCI_CONTROL_ACK;
+
+	size_t size = knx_ldata_batch_size(frames, 4);
+	assert(size == 4 * sizeof(knx_ldata) + 2 + 3 + 4);
+
+	// Caller-provided storage
+	static knx_ldata storage[8];
+	knx_ldata* batch = knx_ldata_duplicate_batch_into(frames, 4, storage, sizeof(storage));
+	assert(batch == storage);
+
+	const uint8_t* payload = (const uint8_t*) (batch + 4);
+
+	for (size_t i = 0; i < 3; i++) {
+		assert(batch[i].destination == i + 1);
+		assert(batch[i].tpdu.info.data.payload == payload);
+		assert(batch[i].tpdu.info.data.length == i + 2);
+
+		// APCI bits are masked like knx_ldata_duplicate does
+		assert(payload[0] == 0);
+		assert(memcmp(payload + 1, payloads[i] + 1, i + 1) == 0);
+
+		payload += i + 2;
+	}
+
+	assert(batch[3].tpdu.tpci == KNX_TPCI_NUMBERED_CONTROL);
+	assert(batch[3].tpdu.info.control == KNX_TPCI_CONTROL_ACK);
+
+	// Too small
+	assert(knx_ldata_duplicate_batch_into(frames, 4, storage, size - 1) == NULL);
+
+	// The frames alone would not fit into size_t, nothing is read in that case
+	assert(knx_ldata_batch_size(frames, SIZE_MAX / sizeof(knx_ldata) + 1) == 0);
+	assert(knx_ldata_duplicate_batch_into(frames, SIZE_MAX / sizeof(knx_ldata) + 1,
+	                                      storage, SIZE_MAX) == NULL);
+
+	// Single allocation
+	if (TEST_HEAP) {
+		knx_alloc_stats stats;
+		knx_alloc_stats_reset();
+
+		batch = knx_ldata_duplicate_batch(frames, 4, NULL);
+		assert(batch != NULL && batch[2].tpdu.info.data.payload[3] == 6);
+
+		knx_alloc_stats_get(&stats);
+		assert(stats.allocations == 1 && stats.bytes == size);
+
+		knx_allocator_free(NULL, batch);
+	}
+
+	// Invalid TPCI
+	frames[1].tpdu.tpci = 7;
+	assert(knx_ldata_batch_size(frames, 4) == 0);
+	assert(knx_ldata_duplicate_batch(frames, 4, NULL) == NULL);
+})
+
+deftest(allocator_description_response, {
+	uint8_t frame[KNX_HEADER_SIZE + 60];
+	memset(frame, 0, sizeof(frame));
+
+	frame[0] = KNX_HEADER_SIZE;
+	frame[1] = 16;
+	frame[2] = KNX_DESCRIPTION_RESPONSE >> 8;
+	frame[3] = KNX_DESCRIPTION_RESPONSE & 0xFF;
+	frame[5] = sizeof(frame);
+
+	uint8_t* payload = frame + KNX_HEADER_SIZE;
+	payload[0] = 54;
+	payload[1] = 1;
+	payload[54] = 6;
+	payload[55] = 2;
+	payload[56] = 2;
+	payload[57] = 1;
+	payload[58] = 4;
+	payload[59] = 2;
+
+	static uint8_t buffer[256];
+	knx_arena arena;
+	knx_arena_init_buffer(&arena, buffer, sizeof(buffer));
+	knx_allocator allocator = knx_arena_allocator(&arena);
+
+	knx_packet packet;
+	assert(knx_parse_with(frame, sizeof(frame), &packet, &allocator) == sizeof(frame));
+	assert(packet.service == KNX_DESCRIPTION_RESPONSE);
+
+	knx_description_response* res = &packet.payload.description_res;
+	assert(res->num_services == 2);
+	assert((uint8_t*) res->services == arena.base);
+	assert(res->services[0].family == 2 && res->services[0].version == 1);
+	assert(res->services[1].family == 4 && res->services[1].version == 2);
+	assert(res->allocator == &allocator);
+
+	knx_description_response_free_services(res);
+	assert(res->services == NULL && res->num_services == 0);
+
+	// Exhausted allocator
+	knx_arena_alloc(&arena, arena.size - arena.used);
+	assert(knx_parse_with(frame, sizeof(frame), &packet, &allocator) == -KNX_INVALID_PAYLOAD);
+
+	knx_arena_destroy(&arena);
+})
+
+deftest(allocator_accounting, {
+	const uint8_t payload[2] = {0x00, 0x01};
+
+	knx_ldata ldata;
+	memset(&ldata, 0, sizeof(knx_ldata));
+	ldata.tpdu.tpci = KNX_TPCI_UNNUMBERED_DATA;
+	ldata.tpdu.info.data.payload = payload;
+	ldata.tpdu.info.data.length = sizeof(payload);
+
+	knx_alloc_stats stats;
+
+	// Heap allocations are counted
+	if (TEST_HEAP) {
+		knx_alloc_stats_reset();
+
+		knx_ldata* copy = knx_ldata_duplicate(&ldata);
+		assert(copy != NULL);
+
+		knx_alloc_stats_get(&stats);
+		assert(stats.allocations == 1 && stats.frees == 0);
+		assert(stats.bytes == sizeof(knx_ldata) + sizeof(payload));
+
+		knx_allocator_free(NULL, copy);
+
+		knx_alloc_stats_get(&stats);
+		assert(stats.frees == 1);
+	}
+
+	// Arenas over caller-provided storage never touch the heap
+	static uint8_t buffer[1024];
+	knx_arena arena;
+	knx_arena_init_buffer(&arena, buffer, sizeof(buffer));
+	knx_allocator allocator = knx_arena_allocator(&arena);
+
+	knx_alloc_stats_reset();
+	assert(knx_ldata_duplicate_with(&ldata, &allocator) != NULL);
+
+	knx_alloc_stats_get(&stats);
+	assert(stats.allocations == 0);
+
+	knx_arena_destroy(&arena);
+})
+
+deftest(allocator_steady_state, {
+	const uint8_t payload[3] = {0x00, 0x0C, 0x1A};
+
+	knx_tunnel_request req;
+	memset(&req, 0, sizeof(req));
+	req.channel = 1;
+	req.data.service = KNX_CEMI_LDATA_IND;
+	req.data.payload.ldata.control2.address_type = KNX_LDATA_ADDR_GROUP;
+	req.data.payload.ldata.destination = 0x0A04;
+	req.data.payload.ldata.tpdu.tpci = KNX_TPCI_UNNUMBERED_DATA;
+	req.data.payload.ldata.tpdu.info.data.apci = KNX_APCI_GROUPVALUEWRITE;
+	req.data.payload.ldata.tpdu.info.data.payload = payload;
+	req.data.payload.ldata.tpdu.info.data.length = sizeof(payload);
+
+	knx_tunnel_response res = {1, 0, 0};
+
+	uint8_t desc[56 + 4];
+	memset(desc, 0, sizeof(desc));
+	desc[0] = 54;
+	desc[1] = 1;
+	desc[54] = 6;
+	desc[55] = 2;
+
+	uint8_t frame[64];
+	uint8_t ack[KNX_HEADER_SIZE + KNX_TUNNEL_RESPONSE_SIZE];
+	char text[256];
+
+	knx_alloc_stats stats;
+	knx_alloc_stats_reset();
+
+	for (size_t i = 0; i < 100; i++) {
+		req.seq_number = i;
+		res.seq_number = i;
+
+		// Generate
+		assert(knx_generate(frame, KNX_TUNNEL_REQUEST, &req));
+		assert(knx_generate(ack, KNX_TUNNEL_RESPONSE, &res));
+
+		// Parse
+		knx_packet packet;
+		assert(knx_parse(frame, sizeof(frame), &packet) > 0);
+		assert(knx_parse(ack, sizeof(ack), &packet) > 0);
+
+		knx_packet_small small;
+		assert(knx_parse_small(frame, sizeof(frame), &small) > 0);
+
+		knx_tunnel_request typed;
+		assert(knx_parse_tunnel_request(frame, sizeof(frame), &typed) > 0);
+
+		knx_description_response_inline description;
+		assert(knx_description_response_parse_view(desc, sizeof(desc), &description.response));
+		assert(knx_description_response_parse_inline(desc, sizeof(desc), &description));
+
+		// Decode and format
+		knx_dpt_value value;
+		assert(knx_dpt_from_apdu(payload, sizeof(payload), KNX_DPT_FLOAT16, &value));
+		assert(knx_format_cemi(text, sizeof(text), KNX_FORMAT_JSON, &typed.data, NULL) > 0);
+	}
+
+	knx_alloc_stats_get(&stats);
+	assert(stats.allocations == 0 && stats.frees == 0 && stats.bytes == 0);
+})
+
+deftest(allocator, {
+	if (TEST_HEAP)
+		runsubtest(allocator_arena);
+
+	runsubtest(allocator_arena_buffer);
+	runsubtest(allocator_slab);
+	runsubtest(allocator_overflow);
+	runsubtest(allocator_modules);
+	runsubtest(allocator_ldata);
+	runsubtest(allocator_ldata_batch);
+	runsubtest(allocator_description_response);
+	runsubtest(allocator_accounting);
+	runsubtest(allocator_steady_state);
+})
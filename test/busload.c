@@ -0,0 +1,85 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+
+#include "../src/bus/busload.h"
+
+#include <math.h>
+#include <stdbool.h>
+
+static
+const uint8_t example_busload_payload[3] = {0, 0x0C, 0x1A};
+
+deftest(busload_rate, {
+	knx_ldata ldata = {
+		.control1 = {KNX_LDATA_PRIO_LOW, true, true, false, false},
+		.control2 = {KNX_LDATA_ADDR_GROUP, 6},
+		.source = knx_individual_addr(1, 1, 5),
+		.destination = knx_group_addr(1, 2, 3),
+		.tpdu = {
+			.tpci = KNX_TPCI_UNNUMBERED_DATA,
+			.info = {
+				.data = {
+					.apci = KNX_APCI_GROUPVALUEWRITE,
+					.payload = example_busload_payload,
+					.length = sizeof(example_busload_payload)
+				}
+			}
+		}
+	};
+
+	assert(knx_busload_bits(&ldata) == 50 + 13 * 11 + 26);
+
+	static knx_busload load;
+	knx_busload_init(&load, 1000000000);
+
+	// 20 telegrams per second for a minute
+	uint64_t now = 0;
+	for (size_t i = 0; i < 60 * 20; i++) {
+		now = i * 50000000;
+		knx_busload_update(&load, now, &ldata);
+	}
+
+	float rate;
+	float utilisation = knx_busload_utilisation(&load, now, knx_individual_addr(1, 1, 0), &rate);
+
+	float expected = 100.0f * 20 * knx_busload_bits(&ldata) / KNX_BUSLOAD_BIT_RATE;
+	assert(fabsf(utilisation - expected) < 1.0f);
+	assert(fabsf(rate - 20) < 0.5f);
+
+	// Other lines are idle
+	assert(knx_busload_utilisation(&load, now, knx_individual_addr(1, 2, 0), NULL) == 0);
+
+	knx_busload_snapshot snapshots[4];
+	assert(knx_busload_snapshot_all(&load, now, snapshots, 4) == 1);
+	assert(snapshots[0].line == knx_individual_addr(1, 1, 0));
+	assert(fabsf(snapshots[0].utilisation - utilisation) < 0.01f);
+
+	// The load fades once the window has moved on
+	now += (KNX_BUSLOAD_BUCKETS + 1) * 1000000000ull;
+	assert(knx_busload_utilisation(&load, now, knx_individual_addr(1, 1, 0), NULL) == 0);
+	assert(knx_busload_snapshot_all(&load, now, snapshots, 4) == 0);
+})
+
+deftest(busload, {
+	runsubtest(busload_rate);
+})
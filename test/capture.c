@@ -0,0 +1,177 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+
+#include "../src/io/capture.h"
+#include "../src/proto/proto.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static
+bool capture_count(const knx_capture_frame* frame, void* data) {
+	knx_packet packet;
+
+	if (knx_parse(frame->data, frame->length, &packet) > 0)
+		(* (size_t*) data)++;
+
+	return true;
+}
+
+deftest(capture_roundtrip, {
+	char path[] = "/tmp/knxproto-capture-XXXXXX";
+	int fd = mkstemp(path);
+	assert(fd >= 0);
+	close(fd);
+
+	const knx_host_info gateway = {KNX_PROTO_UDP, htonl(0xC0A80001), htons(3671)};
+	const knx_host_info client = {KNX_PROTO_UDP, htonl(0xC0A80002), htons(50000)};
+
+	knx_connection_state_request request = {
+		100,
+		0,
+		{KNX_PROTO_UDP, htonl(INADDR_LOOPBACK), 12345}
+	};
+
+	uint8_t buffer[KNX_HEADER_SIZE + KNX_CONNECTION_STATE_REQUEST_SIZE];
+	assert(knx_generate(buffer, KNX_CONNECTION_STATE_REQUEST, &request));
+
+	// Write a few frames, 1ms apart
+	knx_capture_writer writer;
+	assert(knx_capture_writer_open(&writer, path));
+
+	for (size_t i = 0; i < 5; i++) {
+		// Odd length frames require padding
+		size_t length = i == 4 ? sizeof(buffer) - 1 : sizeof(buffer);
+
+		assert(knx_capture_write(&writer, 1000000000000000000ull + i * 1000000,
+		                         &client, &gateway, buffer, length));
+	}
+
+	assert(knx_capture_writer_close(&writer));
+
+	// Read them back
+	knx_capture_reader reader;
+	assert(knx_capture_reader_open(&reader, path));
+
+	knx_capture_frame frame;
+	for (size_t i = 0; i < 5; i++) {
+		assert(knx_capture_next(&reader, &frame));
+		assert(frame.timestamp == 1000000000000000000ull + i * 1000000);
+		assert(frame.source.address == client.address);
+		assert(frame.source.port == client.port);
+		assert(frame.destination.address == gateway.address);
+		assert(frame.destination.port == gateway.port);
+
+		if (i < 4) {
+			assert(frame.length == sizeof(buffer));
+			assert(memcmp(frame.data, buffer, sizeof(buffer)) == 0);
+
+			knx_packet packet;
+			assert(knx_parse(frame.data, frame.length, &packet) == sizeof(buffer));
+			assert(packet.service == KNX_CONNECTION_STATE_REQUEST);
+			assert(packet.payload.conn_state_req.channel == request.channel);
+		} else {
+			assert(frame.length == sizeof(buffer) - 1);
+		}
+	}
+
+	assert(!knx_capture_next(&reader, &frame));
+
+	// Fast replay
+	size_t parsed = 0;
+	knx_capture_rewind(&reader);
+	assert(knx_capture_replay(&reader, KNX_CAPTURE_REPLAY_FAST, capture_count, &parsed) == 5);
+	assert(parsed == 4);
+
+	// Real time replay preserves the gaps
+	struct timespec before, after;
+	clock_gettime(CLOCK_MONOTONIC, &before);
+
+	knx_capture_rewind(&reader);
+	assert(knx_capture_replay(&reader, KNX_CAPTURE_REPLAY_REALTIME, capture_count, &parsed) == 5);
+
+	clock_gettime(CLOCK_MONOTONIC, &after);
+	assert((after.tv_sec - before.tv_sec) * 1000000000 + (after.tv_nsec - before.tv_nsec) >= 4000000);
+
+	knx_capture_reader_close(&reader);
+	unlink(path);
+})
+
+deftest(capture_resolution, {
+	char path[] = "/tmp/knxproto-capture-XXXXXX";
+	int fd = mkstemp(path);
+	assert(fd >= 0);
+	close(fd);
+
+	const knx_host_info host = {KNX_PROTO_UDP, htonl(0xC0A80001), htons(3671)};
+	const uint8_t payload[4] = {1, 2, 3, 4};
+
+	knx_capture_writer writer;
+	assert(knx_capture_writer_open(&writer, path));
+	assert(knx_capture_write(&writer, 3000000000ull, &host, &host, payload, sizeof(payload)));
+	assert(knx_capture_writer_close(&writer));
+
+	// Patch the if_tsresol option of the interface description block
+	static const struct {
+		uint8_t resolution;
+		bool valid;
+		uint64_t timestamp;
+	} cases[] = {
+		{6,         true,  3000000000000ull},
+		{19,        true,  0},
+		{20,        false, 0},
+		{128 | 10,  true,  2929687500000000ull},
+		{128 | 63,  true,  0},
+		{128 | 64,  false, 0},
+		{128 | 127, false, 0}
+	};
+
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		fd = open(path, O_WRONLY);
+		assert(fd >= 0);
+		assert(pwrite(fd, &cases[i].resolution, 1, 48) == 1);
+		close(fd);
+
+		knx_capture_reader reader;
+		assert(knx_capture_reader_open(&reader, path));
+
+		knx_capture_frame frame;
+		assert(knx_capture_next(&reader, &frame) == cases[i].valid);
+
+		if (cases[i].valid)
+			assert(frame.timestamp == cases[i].timestamp);
+
+		knx_capture_reader_close(&reader);
+	}
+
+	unlink(path);
+})
+
+deftest(capture, {
+	runsubtest(capture_roundtrip);
+	runsubtest(capture_resolution);
+})
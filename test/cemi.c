@@ -26,7 +26,7 @@
 #include <stdbool.h>
 #include <string.h>
 
-deftest(cemi, {
+deftest(cemi_ldata, {
 	uint8_t example_Data[4] = {11, 22, 33, 44};
 
 	knx_cemi req = {
@@ -84,3 +84,79 @@ deftest(cemi, {
 	assert(memcmp(frame.payload.ldata.tpdu.info.data.payload + 1,
 	              req.payload.ldata.tpdu.info.data.payload + 1, req.payload.ldata.tpdu.info.data.length - 1) == 0);
 })
+
+deftest(cemi_extended, {
+	uint8_t payload[KNX_LDATA_EXTENDED_TPDU_SIZE - 1];
+	for (size_t i = 0; i < sizeof(payload); i++)
+		payload[i] = i;
+
+	knx_cemi req;
+	memset(&req, 0, sizeof(req));
+	req.service = KNX_CEMI_LDATA_REQ;
+	req.payload.ldata.control2.hops = 6;
+	req.payload.ldata.source = 0x1101;
+	req.payload.ldata.destination = 0x1102;
+	req.payload.ldata.tpdu.tpci = KNX_TPCI_NUMBERED_DATA;
+	req.payload.ldata.tpdu.seq_number = 5;
+	req.payload.ldata.tpdu.info.data.apci = KNX_APCI_MEMORYRESPONSE;
+	req.payload.ldata.tpdu.info.data.payload = payload;
+	req.payload.ldata.tpdu.info.data.length = sizeof(payload);
+
+	// Long TPDUs switch to the extended frame format
+	uint8_t buffer[KNX_CEMI_HEADER_SIZE + 7 + KNX_LDATA_EXTENDED_TPDU_SIZE];
+	assert(knx_cemi_size(&req) == sizeof(buffer));
+	assert(knx_cemi_generate(buffer, &req));
+	assert((buffer[2] & 0x80) == 0);
+	assert(buffer[8] == 254);
+
+	knx_cemi frame;
+	assert(knx_cemi_parse(buffer, sizeof(buffer), &frame));
+	assert(frame.payload.ldata.control1.extended);
+	assert(frame.payload.ldata.control2.hops == 6);
+	assert(frame.payload.ldata.tpdu.tpci == KNX_TPCI_NUMBERED_DATA);
+	assert(frame.payload.ldata.tpdu.seq_number == 5);
+	assert(frame.payload.ldata.tpdu.info.data.apci == KNX_APCI_MEMORYRESPONSE);
+	assert(frame.payload.ldata.tpdu.info.data.length == sizeof(payload));
+	assert(memcmp(frame.payload.ldata.tpdu.info.data.payload + 1, payload + 1, sizeof(payload) - 1) == 0);
+
+	// Short TPDUs keep the frame type and extended frame format they were given
+	req.payload.ldata.tpdu.info.data.length = 4;
+	req.payload.ldata.control2.extended_format = 5;
+	assert(knx_cemi_generate(buffer, &req));
+	assert((buffer[2] & 0x80) == 0);
+	assert((buffer[3] & 15) == 5);
+
+	assert(knx_cemi_parse(buffer, knx_cemi_size(&req), &frame));
+	assert(frame.payload.ldata.control1.extended);
+	assert(frame.payload.ldata.control2.extended_format == 5);
+
+	req.payload.ldata.control2.extended_format = 0;
+	req.payload.ldata.control1.extended = true;
+	assert(knx_cemi_generate(buffer, &req));
+	assert((buffer[2] & 0x80) == 0);
+
+	req.payload.ldata.control1.extended = false;
+	assert(knx_cemi_generate(buffer, &req));
+	assert((buffer[2] & 0x80) != 0);
+
+	// Standard frames must not carry an extended frame format
+	buffer[3] |= 1;
+	assert(!knx_cemi_parse(buffer, knx_cemi_size(&req), &frame));
+
+	// Length 255 is reserved in extended frames
+	uint8_t reserved[KNX_CEMI_HEADER_SIZE + 8 + 255] = {KNX_CEMI_LDATA_IND, 0, 0x3C, 0xE0};
+	reserved[8] = 0xFF;
+	assert(!knx_cemi_parse(reserved, sizeof(reserved), &frame));
+
+	// TPDUs beyond the extended frame limit cannot be generated
+	uint8_t oversized[KNX_LDATA_EXTENDED_TPDU_SIZE];
+	memset(oversized, 0, sizeof(oversized));
+	req.payload.ldata.tpdu.info.data.payload = oversized;
+	req.payload.ldata.tpdu.info.data.length = sizeof(oversized);
+	assert(!knx_cemi_generate(buffer, &req));
+})
+
+deftest(cemi, {
+	runsubtest(cemi_ldata);
+	runsubtest(cemi_extended);
+})
@@ -0,0 +1,488 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+
+#include "../src/proto/data.h"
+#include "../src/proto/dpttables.h"
+#include "../src/proto/dptreg.h"
+#include "../src/proto/dptcodec.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// C11 and C++ consumers of the codecs
+externtest(dpt_codec_generic)
+externtest(dpt_codec_cpp)
+
+deftest(dpt_float16_decode, {
+	const uint8_t apdu[3] = {0, 0x0C, 0x1A};
+	knx_float16 value;
+
+	assert(knx_dpt_from_apdu(apdu, sizeof(apdu), KNX_DPT_FLOAT16, &value));
+	assert(value == 21.0f);
+
+	const uint8_t negative[3] = {0, 0x87, 0x9C};
+	assert(knx_dpt_from_apdu(negative, sizeof(negative), KNX_DPT_FLOAT16, &value));
+	assert(value == -1.0f);
+})
+
+deftest(dpt_float16_decode_batch, {
+	static uint8_t raw[2 * 65536];
+	static knx_float16 expected[65536], actual[65536];
+
+	for (size_t i = 0; i < 65536; i++) {
+		const uint8_t apdu[3] = {0, i >> 8, i & 255};
+
+		raw[2 * i] = apdu[1];
+		raw[2 * i + 1] = apdu[2];
+
+		assert(knx_dpt_from_apdu(apdu, sizeof(apdu), KNX_DPT_FLOAT16, expected + i));
+	}
+
+	// Every encoding, bit for bit
+	knx_dpt_float16_decode_batch(raw, 65536, actual);
+	assert(memcmp(expected, actual, sizeof(expected)) == 0);
+
+	// Counts which leave a remainder for the scalar path
+	memset(actual, 0, sizeof(actual));
+	knx_dpt_float16_decode_batch(raw + 2, 13, actual);
+	assert(memcmp(expected + 1, actual, 13 * sizeof(knx_float16)) == 0);
+	assert(actual[13] == 0);
+})
+
+deftest(dpt_float16_encode, {
+	uint8_t apdu[3] = {0xC0, 0, 0};
+
+	knx_float16 value = 21.0f;
+	knx_dpt_to_apdu(apdu, KNX_DPT_FLOAT16, &value);
+	assert(apdu[0] == 0xC0 && apdu[1] == 0x0C && apdu[2] == 0x1A);
+
+	value = -1.0f;
+	knx_dpt_to_apdu(apdu, KNX_DPT_FLOAT16, &value);
+	assert(apdu[1] == 0x87 && apdu[2] == 0x9C);
+
+	// Rounds to the nearest representable value instead of truncating
+	value = 20.466f;
+	knx_dpt_to_apdu(apdu, KNX_DPT_FLOAT16, &value);
+	assert(apdu[1] == 0x07 && apdu[2] == 0xFF);
+
+	// Rounding may require the next exponent
+	value = 20.4799f;
+	knx_dpt_to_apdu(apdu, KNX_DPT_FLOAT16, &value);
+	assert(apdu[1] == 0x0C && apdu[2] == 0x00);
+
+	// Out of range values are clamped
+	value = 1e9f;
+	knx_dpt_to_apdu(apdu, KNX_DPT_FLOAT16, &value);
+	assert(apdu[1] == 0x7F && apdu[2] == 0xFF);
+
+	value = -1e9f;
+	knx_dpt_to_apdu(apdu, KNX_DPT_FLOAT16, &value);
+	assert(apdu[1] == 0xF8 && apdu[2] == 0x00);
+})
+
+deftest(dpt_float16_roundtrip, {
+	static knx_float16 values[65536];
+	static uint8_t raw[2 * 65536];
+
+	// Every encoding survives decoding and re-encoding, bit for bit
+	for (size_t i = 0; i < 65536; i++) {
+		uint8_t apdu[3] = {0, i >> 8, i & 255};
+		knx_float16 decoded;
+
+		assert(knx_dpt_from_apdu(apdu, sizeof(apdu), KNX_DPT_FLOAT16, values + i));
+		knx_dpt_to_apdu(apdu, KNX_DPT_FLOAT16, values + i);
+		assert(knx_dpt_from_apdu(apdu, sizeof(apdu), KNX_DPT_FLOAT16, &decoded));
+
+		assert(memcmp(&decoded, values + i, sizeof(knx_float16)) == 0);
+	}
+
+	// The batch encoder produces the same encodings
+	knx_dpt_float16_encode_batch(values, 65536, raw);
+
+	for (size_t i = 0; i < 65536; i++) {
+		uint8_t apdu[3] = {0, 0, 0};
+		knx_dpt_to_apdu(apdu, KNX_DPT_FLOAT16, values + i);
+
+		assert(raw[2 * i] == apdu[1] && raw[2 * i + 1] == apdu[2]);
+	}
+})
+
+deftest(dpt_tables, {
+	static knx_float16 expected[65536], actual[65536];
+	static uint8_t raw[2 * 65536];
+
+	for (size_t i = 0; i < 65536; i++) {
+		const uint8_t apdu[3] = {0, i >> 8, i & 255};
+
+		raw[2 * i] = apdu[1];
+		raw[2 * i + 1] = apdu[2];
+
+		assert(knx_dpt_from_apdu(apdu, sizeof(apdu), KNX_DPT_FLOAT16, expected + i));
+	}
+
+	const knx_dpt_tables* tables = knx_dpt_tables_get();
+	assert(tables == knx_dpt_tables_get());
+
+	knx_dpt_tables_float16_batch(tables, raw, 65536, actual);
+	assert(memcmp(expected, actual, sizeof(expected)) == 0);
+
+	// Share the tables through a file
+	char path[] = "/tmp/knxproto-tables-XXXXXX";
+	int fd = mkstemp(path);
+	assert(fd >= 0);
+	close(fd);
+
+	// The empty file is replaced
+	const knx_dpt_tables* mapped = knx_dpt_tables_map(path);
+	assert(mapped != NULL && mapped != tables);
+	assert(memcmp(mapped, tables, sizeof(knx_dpt_tables)) == 0);
+	knx_dpt_tables_unmap(mapped);
+
+	// The existing file is reused
+	mapped = knx_dpt_tables_map(path);
+	assert(mapped != NULL);
+
+	// Decoding through the tables yields the same values
+	knx_dpt_tables_enable(mapped);
+
+	for (size_t i = 0; i < 65536; i++) {
+		const uint8_t apdu[3] = {0, i >> 8, i & 255};
+		assert(knx_dpt_from_apdu(apdu, sizeof(apdu), KNX_DPT_FLOAT16, actual + i));
+	}
+
+	knx_dpt_tables_enable(NULL);
+	assert(memcmp(expected, actual, sizeof(expected)) == 0);
+
+	const uint8_t scaled[3] = {0, 255, 128};
+	float values[3];
+
+	knx_dpt_tables_unsigned8_batch(mapped->scaling, scaled, 3, values);
+	assert(values[0] == 0 && values[1] == 100 && values[2] > 50.19f && values[2] < 50.2f);
+
+	knx_dpt_tables_unsigned8_batch(mapped->angle, scaled, 3, values);
+	assert(values[0] == 0 && values[1] == 360);
+
+	knx_dpt_tables_unmap(mapped);
+	unlink(path);
+})
+
+deftest(dpt_subtype, {
+	const knx_dpt_descriptor* temp = knx_dpt_subtype_find(9, 1);
+	assert(temp != NULL);
+	assert(temp->main == 9 && temp->sub == 1 && temp->type == KNX_DPT_FLOAT16);
+	assert(strcmp(temp->unit, "°C") == 0);
+
+	const knx_dpt_descriptor* power = knx_dpt_subtype_find(14, 56);
+	assert(power != NULL && power->type == KNX_DPT_FLOAT32);
+
+	assert(knx_dpt_subtype_find(9, 9) == NULL);
+	assert(knx_dpt_subtype_find(9, 1000) == NULL);
+	assert(knx_dpt_subtype_find(0, 1) == NULL);
+	assert(knx_dpt_subtype_find(300, 1) == NULL);
+
+	// First, last and widely spaced entries of the sorted tables
+	static const uint16_t present[][2] = {
+		{1, 1}, {1, 100}, {7, 600}, {13, 100}, {14, 0}, {14, 77}, {20, 102}, {20, 105},
+		{232, 600}, {251, 600}
+	};
+
+	for (size_t i = 0; i < sizeof(present) / sizeof(present[0]); i++) {
+		const knx_dpt_descriptor* descriptor = knx_dpt_subtype_find(present[i][0], present[i][1]);
+		assert(descriptor != NULL);
+		assert(descriptor->main == present[i][0] && descriptor->sub == present[i][1]);
+	}
+
+	assert(knx_dpt_subtype_find(1, 20) == NULL);
+	assert(knx_dpt_subtype_find(14, 2) == NULL);
+	assert(knx_dpt_subtype_find(15, 1) == NULL);
+	assert(knx_dpt_subtype_find(20, 103) == NULL);
+	assert(knx_dpt_subtype_find(252, 600) == NULL);
+
+	const knx_dpt_descriptor* scaling = knx_dpt_subtype_find(5, 1);
+	assert(scaling != NULL);
+
+	uint8_t apdu[6] = {0, 255};
+	double value;
+
+	assert(knx_dpt_subtype_decode(apdu, 2, scaling, &value));
+	assert(value == 100);
+
+	assert(knx_dpt_subtype_encode(apdu, scaling, 50));
+	assert(apdu[1] == 128);
+
+	assert(knx_dpt_subtype_encode(apdu, scaling, 150));
+	assert(apdu[1] == 255);
+
+	assert(knx_dpt_subtype_encode(apdu, temp, 21.5));
+	assert(knx_dpt_subtype_decode(apdu, 3, temp, &value));
+	assert(value == 21.5);
+
+	assert(knx_dpt_subtype_encode(apdu, temp, -300));
+	assert(knx_dpt_subtype_decode(apdu, 3, temp, &value));
+	assert(value > -273.1 && value < -272.9);
+
+	const knx_dpt_descriptor* period = knx_dpt_subtype_find(7, 4);
+	assert(knx_dpt_subtype_encode(apdu, period, 1549));
+	assert(knx_dpt_subtype_decode(apdu, 3, period, &value));
+	assert(value == 1500);
+
+	assert(knx_dpt_subtype_encode(apdu, knx_dpt_subtype_find(1, 1), 1));
+	assert(knx_dpt_subtype_decode(apdu, 1, knx_dpt_subtype_find(1, 1), &value));
+	assert(value == 1);
+
+	// Latin-1 characters beyond the signed range
+	const knx_dpt_descriptor* latin1 = knx_dpt_subtype_find(4, 2);
+	assert(knx_dpt_subtype_encode(apdu, latin1, 200));
+	assert(apdu[1] == 200);
+	assert(knx_dpt_subtype_decode(apdu, 2, latin1, &value));
+	assert(value == 200);
+
+	assert(knx_dpt_subtype_encode(apdu, knx_dpt_subtype_find(4, 1), 200));
+	assert(apdu[1] == 127);
+
+	assert(!knx_dpt_subtype_encode(apdu, knx_dpt_subtype_find(10, 1), 0));
+	assert(!knx_dpt_subtype_decode(apdu, 4, knx_dpt_subtype_find(10, 1), &value));
+})
+
+deftest(dpt_subtype_wire, {
+	// One wire vector per multi-byte numeric main type, values are big-endian
+	static const struct {
+		uint16_t main, sub;
+		uint8_t apdu[9];
+		size_t length;
+		double value;
+	} vectors[] = {
+		{7,  1,  {0, 0x01, 0x00},                         3, 256},
+		{7,  4,  {0, 0x00, 0x0F},                         3, 1500},
+		{8,  10, {0, 0xFF, 0x9C},                         3, -1},
+		{9,  1,  {0, 0x0C, 0x1A},                         3, 21},
+		{12, 1,  {0, 0x00, 0x01, 0x00, 0x00},             5, 65536},
+		{13, 2,  {0, 0x00, 0x00, 0x27, 0x10},             5, 1},
+		{14, 56, {0, 0x3F, 0x80, 0x00, 0x00},             5, 1},
+		{29, 10, {0, 0, 0, 0, 0, 0, 0, 0x01, 0x00},       9, 256}
+	};
+
+	for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+		const knx_dpt_descriptor* descriptor = knx_dpt_subtype_find(vectors[i].main, vectors[i].sub);
+		assert(descriptor != NULL);
+
+		double value;
+		assert(knx_dpt_subtype_decode(vectors[i].apdu, vectors[i].length, descriptor, &value));
+		assert(value == vectors[i].value);
+
+		uint8_t apdu[9];
+		memset(apdu, 0, sizeof(apdu));
+		assert(knx_dpt_subtype_encode(apdu, descriptor, vectors[i].value));
+		assert(memcmp(apdu, vectors[i].apdu, vectors[i].length) == 0);
+	}
+})
+
+deftest(dpt_extended, {
+	uint8_t apdu[16];
+
+	// DPT 16
+	knx_string string = {"KNX is great"}, string_out;
+	memset(apdu, 0xFF, sizeof(apdu));
+	knx_dpt_to_apdu(apdu, KNX_DPT_STRING, &string);
+	assert(apdu[0] == 0xC0 && apdu[1] == 'K' && apdu[13] == 0 && apdu[14] == 0);
+	assert(knx_dpt_from_apdu(apdu, KNX_DPT_STRING_SIZE, KNX_DPT_STRING, &string_out));
+	assert(strcmp(string_out.value, "KNX is great") == 0);
+
+	const uint8_t full[15] = {0, 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n'};
+	assert(knx_dpt_from_apdu(full, sizeof(full), KNX_DPT_STRING, &string_out));
+	assert(strcmp(string_out.value, "abcdefghijklmn") == 0);
+	assert(!knx_dpt_from_apdu(full, 14, KNX_DPT_STRING, &string_out));
+
+	// DPT 19
+	const uint8_t datetime_raw[9] = {0, 124, 10, 18, 3 << 5 | 14, 30, 15, 0x41, 0x80};
+	knx_datetime datetime;
+	assert(knx_dpt_from_apdu(datetime_raw, sizeof(datetime_raw), KNX_DPT_DATETIME, &datetime));
+	assert(datetime.year == 2024 && datetime.month == 10 && datetime.day == 18);
+	assert(datetime.dayofweek == KNX_WEDNESDAY);
+	assert(datetime.hour == 14 && datetime.minute == 30 && datetime.second == 15);
+	assert(!datetime.fault && datetime.working_day && !datetime.no_time && datetime.summer_time);
+	assert(datetime.external_sync && !datetime.reliable_sync);
+
+	memset(apdu, 0, sizeof(apdu));
+	knx_dpt_to_apdu(apdu, KNX_DPT_DATETIME, &datetime);
+	assert(memcmp(apdu, datetime_raw, sizeof(datetime_raw)) == 0);
+
+	// DPT 20
+	knx_enum8 mode = 3, mode_out;
+	knx_dpt_to_apdu(apdu, KNX_DPT_ENUM8, &mode);
+	assert(apdu[1] == 3);
+	assert(knx_dpt_from_apdu(apdu, KNX_DPT_ENUM8_SIZE, KNX_DPT_ENUM8, &mode_out) && mode_out == 3);
+
+	// DPT 29
+	knx_signed64 energy = -1234567890123LL, energy_out;
+	knx_dpt_to_apdu(apdu, KNX_DPT_SIGNED64, &energy);
+	assert(apdu[1] == 0xFF && apdu[8] == 0x35);
+	assert(knx_dpt_from_apdu(apdu, KNX_DPT_SIGNED64_SIZE, KNX_DPT_SIGNED64, &energy_out));
+	assert(energy_out == energy);
+
+	const uint8_t energy_raw[9] = {0, 0, 0, 0, 0, 0, 1, 0, 2};
+	assert(knx_dpt_from_apdu(energy_raw, sizeof(energy_raw), KNX_DPT_SIGNED64, &energy_out));
+	assert(energy_out == 65538);
+
+	// DPT 232
+	knx_rgb rgb = {255, 128, 1}, rgb_out;
+	knx_dpt_to_apdu(apdu, KNX_DPT_RGB, &rgb);
+	assert(apdu[1] == 255 && apdu[2] == 128 && apdu[3] == 1);
+	assert(knx_dpt_from_apdu(apdu, KNX_DPT_RGB_SIZE, KNX_DPT_RGB, &rgb_out));
+	assert(rgb_out.red == 255 && rgb_out.green == 128 && rgb_out.blue == 1);
+
+	// DPT 251
+	knx_rgbw rgbw = {1, 2, 3, 4, true, false, true, true}, rgbw_out;
+	knx_dpt_to_apdu(apdu, KNX_DPT_RGBW, &rgbw);
+	assert(apdu[4] == 4 && apdu[5] == 0 && apdu[6] == 0x0B);
+	assert(knx_dpt_from_apdu(apdu, KNX_DPT_RGBW_SIZE, KNX_DPT_RGBW, &rgbw_out));
+	assert(rgbw_out.white == 4 && rgbw_out.red_valid && !rgbw_out.green_valid && rgbw_out.white_valid);
+
+	// Registry
+	double value;
+	const knx_dpt_descriptor* active_energy = knx_dpt_subtype_find(29, 10);
+	assert(active_energy != NULL && active_energy->type == KNX_DPT_SIGNED64);
+	assert(knx_dpt_subtype_encode(apdu, active_energy, 123456789));
+	assert(knx_dpt_subtype_decode(apdu, KNX_DPT_SIGNED64_SIZE, active_energy, &value));
+	assert(value == 123456789);
+
+	assert(knx_dpt_subtype_find(232, 600) != NULL);
+	assert(knx_dpt_subtype_find(251, 600) != NULL);
+	assert(!knx_dpt_subtype_decode(apdu, KNX_DPT_RGBW_SIZE, knx_dpt_subtype_find(251, 600), &value));
+})
+
+deftest(dpt_codec, {
+	uint8_t typed[16], dynamic[16];
+
+	// Encoders agree with the runtime dispatch
+	memset(typed, 0, sizeof(typed));
+	memset(dynamic, 0, sizeof(dynamic));
+	knx_dpt_encode_float16(typed, 21.5f);
+	knx_dpt_to_apdu(dynamic, KNX_DPT_FLOAT16, &(knx_float16) {21.5f});
+	assert(memcmp(typed, dynamic, KNX_DPT_FLOAT16_SIZE) == 0);
+
+	knx_dpt_encode_unsigned16(typed, 4711);
+	knx_dpt_to_apdu(dynamic, KNX_DPT_UNSIGNED16, &(knx_unsigned16) {4711});
+	assert(memcmp(typed, dynamic, KNX_DPT_UNSIGNED16_SIZE) == 0);
+
+	knx_dpt_encode_float32(typed, -1.25f);
+	knx_dpt_to_apdu(dynamic, KNX_DPT_FLOAT32, &(knx_float32) {-1.25f});
+	assert(memcmp(typed, dynamic, KNX_DPT_FLOAT32_SIZE) == 0);
+
+	// Day of the week occupies the upper three bits
+	knx_timeofday time = {KNX_FRIDAY, 23, 59, 58}, time_out;
+	knx_dpt_encode_timeofday(typed, time);
+	assert(typed[1] == (5 << 5 | 23) && typed[2] == 59 && typed[3] == 58);
+	assert(knx_dpt_decode_timeofday(typed, KNX_DPT_TIMEOFDAY_SIZE, &time_out));
+	assert(time_out.day == KNX_FRIDAY && time_out.hour == 23);
+
+	// Decoders agree with the runtime dispatch
+	knx_float16 typed_value, dynamic_value;
+	for (size_t i = 0; i < 65536; i += 7) {
+		const uint8_t apdu[3] = {0, i >> 8, i & 255};
+
+		assert(knx_dpt_decode_float16(apdu, sizeof(apdu), &typed_value));
+		assert(knx_dpt_from_apdu(apdu, sizeof(apdu), KNX_DPT_FLOAT16, &dynamic_value));
+		assert(memcmp(&typed_value, &dynamic_value, sizeof(knx_float16)) == 0);
+	}
+
+	assert(!knx_dpt_decode_float16(typed, 2, &typed_value));
+})
+
+deftest(dpt_codec_wire, {
+	uint8_t apdu[5];
+
+	// DPT 7, most significant byte first
+	const uint8_t unsigned16_raw[3] = {0, 0x01, 0x00};
+	knx_unsigned16 unsigned16;
+	assert(knx_dpt_decode_unsigned16(unsigned16_raw, sizeof(unsigned16_raw), &unsigned16));
+	assert(unsigned16 == 256);
+	assert(knx_dpt_from_apdu(unsigned16_raw, sizeof(unsigned16_raw), KNX_DPT_UNSIGNED16,
+	                         &unsigned16));
+	assert(unsigned16 == 256);
+
+	memset(apdu, 0, sizeof(apdu));
+	knx_dpt_encode_unsigned16(apdu, 256);
+	assert(memcmp(apdu, unsigned16_raw, sizeof(unsigned16_raw)) == 0);
+
+	// DPT 8
+	const uint8_t signed16_raw[3] = {0, 0xFF, 0xFE};
+	knx_signed16 signed16;
+	assert(knx_dpt_decode_signed16(signed16_raw, sizeof(signed16_raw), &signed16));
+	assert(signed16 == -2);
+
+	memset(apdu, 0, sizeof(apdu));
+	knx_dpt_to_apdu(apdu, KNX_DPT_SIGNED16, &(knx_signed16) {-2});
+	assert(memcmp(apdu, signed16_raw, sizeof(signed16_raw)) == 0);
+
+	// DPT 12
+	const uint8_t unsigned32_raw[5] = {0, 0x00, 0x01, 0x02, 0x03};
+	knx_unsigned32 unsigned32;
+	assert(knx_dpt_decode_unsigned32(unsigned32_raw, sizeof(unsigned32_raw), &unsigned32));
+	assert(unsigned32 == 0x00010203);
+
+	memset(apdu, 0, sizeof(apdu));
+	knx_dpt_encode_unsigned32(apdu, 0x00010203);
+	assert(memcmp(apdu, unsigned32_raw, sizeof(unsigned32_raw)) == 0);
+
+	// DPT 13
+	const uint8_t signed32_raw[5] = {0, 0xFF, 0xFF, 0xFF, 0xFE};
+	knx_signed32 signed32;
+	assert(knx_dpt_from_apdu(signed32_raw, sizeof(signed32_raw), KNX_DPT_SIGNED32, &signed32));
+	assert(signed32 == -2);
+
+	memset(apdu, 0, sizeof(apdu));
+	knx_dpt_encode_signed32(apdu, -2);
+	assert(memcmp(apdu, signed32_raw, sizeof(signed32_raw)) == 0);
+
+	// DPT 14, IEEE 754 single precision
+	const uint8_t float32_raw[5] = {0, 0x3F, 0x80, 0x00, 0x00};
+	knx_float32 float32;
+	assert(knx_dpt_decode_float32(float32_raw, sizeof(float32_raw), &float32));
+	assert(float32 == 1.0f);
+	assert(knx_dpt_from_apdu(float32_raw, sizeof(float32_raw), KNX_DPT_FLOAT32, &float32));
+	assert(float32 == 1.0f);
+
+	memset(apdu, 0, sizeof(apdu));
+	knx_dpt_to_apdu(apdu, KNX_DPT_FLOAT32, &(knx_float32) {1.0f});
+	assert(memcmp(apdu, float32_raw, sizeof(float32_raw)) == 0);
+
+	assert(!knx_dpt_decode_float32(float32_raw, 4, &float32));
+})
+
+deftest(data, {
+	runsubtest(dpt_float16_decode);
+	runsubtest(dpt_float16_decode_batch);
+	runsubtest(dpt_float16_encode);
+	runsubtest(dpt_float16_roundtrip);
+	runsubtest(dpt_tables);
+	runsubtest(dpt_subtype);
+	runsubtest(dpt_subtype_wire);
+	runsubtest(dpt_extended);
+	runsubtest(dpt_codec);
+	runsubtest(dpt_codec_wire);
+	runsubtest(dpt_codec_generic);
+	runsubtest(dpt_codec_cpp);
+})
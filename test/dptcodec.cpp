@@ -0,0 +1,63 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "../src/proto/dptcodec.hpp"
+
+extern "C" {
+	#include "testfw.h"
+}
+
+#include <string.h>
+
+extern "C" {
+	deftest(dpt_codec_cpp, {
+		uint8_t typed[16], traits[16];
+
+		// Explicit datapoint type
+		memset(typed, 0, sizeof(typed));
+		memset(traits, 0, sizeof(traits));
+		knx_dpt_encode_float32(typed, 1.0f);
+		knx::dpt_encode<KNX_DPT_FLOAT32>(traits, 1.0f);
+		assert(memcmp(typed, traits, KNX_DPT_FLOAT32_SIZE) == 0);
+		assert(traits[1] == 0x3F && traits[2] == 0x80);
+
+		knx_float32 float32;
+		assert(knx::dpt_decode<KNX_DPT_FLOAT32>(traits, KNX_DPT_FLOAT32_SIZE, float32));
+		assert(float32 == 1.0f);
+
+		// Datapoint type deduced from the C type
+		knx_unsigned16 unsigned16 = 256;
+		knx::dpt_encode(traits, unsigned16);
+		assert(traits[1] == 0x01 && traits[2] == 0x00);
+
+		unsigned16 = 0;
+		assert(knx::dpt_decode(traits, KNX_DPT_UNSIGNED16_SIZE, unsigned16));
+		assert(unsigned16 == 256);
+
+		knx_float16 float16 = 21.5f;
+		knx::dpt_encode(traits, float16);
+		knx_dpt_encode_float16(typed, 21.5f);
+		assert(memcmp(typed, traits, KNX_DPT_FLOAT16_SIZE) == 0);
+
+		assert(knx::dpt_traits<KNX_DPT_SIGNED64>::size == KNX_DPT_SIGNED64_SIZE);
+		assert(!knx::dpt_decode(traits, 2, unsigned16));
+	})
+}
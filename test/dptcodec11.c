@@ -0,0 +1,66 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+// Compiled as strict C11 without feature test macros, see the Makefile
+
+#include "testfw.h"
+
+#include "../src/proto/dptcodec.h"
+
+#include <string.h>
+
+deftest(dpt_codec_generic, {
+	uint8_t typed[16], generic[16];
+
+	// The C type selects the codec
+	memset(typed, 0, sizeof(typed));
+	memset(generic, 0, sizeof(generic));
+	knx_dpt_encode_float16(typed, 21.5f);
+	knx_dpt_encode(generic, (knx_float16) 21.5f);
+	assert(memcmp(typed, generic, KNX_DPT_FLOAT16_SIZE) == 0);
+
+	knx_dpt_encode(generic, (knx_unsigned16) 256);
+	assert(generic[1] == 0x01 && generic[2] == 0x00);
+
+	knx_unsigned16 unsigned16;
+	assert(knx_dpt_decode(generic, KNX_DPT_UNSIGNED16_SIZE, &unsigned16));
+	assert(unsigned16 == 256);
+
+	knx_dpt_encode(generic, (knx_signed32) -2);
+	assert(generic[1] == 0xFF && generic[4] == 0xFE);
+
+	knx_signed32 signed32;
+	assert(knx_dpt_decode(generic, KNX_DPT_SIGNED32_SIZE, &signed32));
+	assert(signed32 == -2);
+
+	knx_timeofday time = {KNX_FRIDAY, 23, 59, 58}, time_out;
+	knx_dpt_encode(generic, time);
+	assert(knx_dpt_decode(generic, KNX_DPT_TIMEOFDAY_SIZE, &time_out));
+	assert(time_out.day == KNX_FRIDAY && time_out.second == 58);
+
+	knx_string string = {"KNX"}, string_out;
+	knx_dpt_encode(generic, string);
+	assert(generic[3] == 'X' && generic[4] == 0 && generic[14] == 0);
+	assert(knx_dpt_decode(generic, KNX_DPT_STRING_SIZE, &string_out));
+	assert(strcmp(string_out.value, "KNX") == 0);
+
+	assert(!knx_dpt_decode(generic, 2, &unsigned16));
+})
@@ -0,0 +1,153 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+#include "testalloc.h"
+
+#include "../src/bus/filter.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define SECOND 1000000000ull
+
+deftest(filter_deadband, {
+	static knx_filter filter;
+	assert(knx_filter_init_with(&filter, &(knx_filter_profile) {.absolute = 0.5}, test_allocator()));
+
+	knx_addr group = knx_group_addr(1, 2, 3);
+
+	assert(knx_filter_update(&filter, 0, group, 21.0));
+	assert(!knx_filter_update(&filter, 1 * SECOND, group, 21.01));
+	assert(!knx_filter_update(&filter, 2 * SECOND, group, 21.49));
+	assert(knx_filter_update(&filter, 3 * SECOND, group, 21.5));
+
+	// Compared to the last forwarded value, not the last received one
+	assert(!knx_filter_update(&filter, 4 * SECOND, group, 21.2));
+	assert(!knx_filter_update(&filter, 5 * SECOND, group, 21.9));
+	assert(knx_filter_update(&filter, 6 * SECOND, group, 21.0));
+
+	// Other groups are independent
+	assert(knx_filter_update(&filter, 6 * SECOND, group + 1, 21.0));
+
+	assert(filter.forwarded == 4);
+	assert(filter.dropped == 4);
+
+	// Relative deadband
+	filter.profiles[1] = (knx_filter_profile) {.relative = 0.1};
+	knx_filter_configure(&filter, group, 1);
+
+	assert(knx_filter_update(&filter, 7 * SECOND, group, 100));
+	assert(!knx_filter_update(&filter, 8 * SECOND, group, 109));
+	assert(knx_filter_update(&filter, 9 * SECOND, group, 89));
+	assert(!knx_filter_update(&filter, 10 * SECOND, group, 89));
+
+	// Change detection only
+	filter.profiles[2] = (knx_filter_profile) {0};
+	knx_filter_configure(&filter, group, 2);
+
+	assert(knx_filter_update(&filter, 11 * SECOND, group, 1));
+	assert(!knx_filter_update(&filter, 12 * SECOND, group, 1));
+	assert(knx_filter_update(&filter, 13 * SECOND, group, 0));
+	assert(knx_filter_update(&filter, 14 * SECOND, group, NAN));
+	assert(!knx_filter_update(&filter, 15 * SECOND, group, NAN));
+
+	knx_filter_destroy(&filter);
+})
+
+deftest(filter_intervals, {
+	static knx_filter filter;
+	assert(knx_filter_init_with(&filter, &(knx_filter_profile) {
+		.absolute = 1,
+		.min_interval = 2 * SECOND,
+		.max_interval = 60 * SECOND
+	}, test_allocator()));
+
+	knx_addr group = knx_group_addr(0, 0, 1);
+
+	assert(knx_filter_update(&filter, 0, group, 20));
+
+	// Significant, but too soon
+	assert(!knx_filter_update(&filter, 1 * SECOND, group, 30));
+	assert(knx_filter_update(&filter, 2 * SECOND, group, 30));
+
+	// Unchanged values are repeated as a heartbeat
+	assert(!knx_filter_update(&filter, 61 * SECOND, group, 30));
+	assert(knx_filter_update(&filter, 62 * SECOND, group, 30));
+	assert(!knx_filter_update(&filter, 63 * SECOND, group, 30));
+
+	knx_filter_destroy(&filter);
+})
+
+deftest(filter_group_value, {
+	static knx_filter filter;
+	assert(knx_filter_init_with(&filter, &(knx_filter_profile) {.absolute = 1}, test_allocator()));
+
+	knx_group_value value;
+	memset(&value, 0, sizeof(value));
+
+	// Scaled 5.001: 3 / 255 * 100 > 1 %
+	value.group = 1;
+	value.descriptor = knx_dpt_subtype_find(5, 1);
+	value.value.unsigned8 = 100;
+	assert(knx_filter_group_value(&filter, 0, &value));
+	value.value.unsigned8 = 102;
+	assert(!knx_filter_group_value(&filter, SECOND, &value));
+	value.value.unsigned8 = 103;
+	assert(knx_filter_group_value(&filter, 2 * SECOND, &value));
+
+	// Non-numeric values are forwarded when they change
+	value.group = 2;
+	value.descriptor = knx_dpt_subtype_find(232, 600);
+	value.value.rgb = (knx_rgb) {255, 0, 0};
+	assert(knx_filter_group_value(&filter, 0, &value));
+	assert(!knx_filter_group_value(&filter, SECOND, &value));
+	value.value.rgb.green = 1;
+	assert(knx_filter_group_value(&filter, 2 * SECOND, &value));
+
+	value.group = 3;
+	value.descriptor = knx_dpt_subtype_find(16, 0);
+	strcpy(value.value.string.value, "Hello");
+	assert(knx_filter_group_value(&filter, 0, &value));
+	assert(!knx_filter_group_value(&filter, SECOND, &value));
+	strcpy(value.value.string.value, "World");
+	assert(knx_filter_group_value(&filter, 2 * SECOND, &value));
+
+	value.group = 4;
+	value.descriptor = knx_dpt_subtype_find(11, 1);
+	value.value.date = (knx_date) {24, 12, 15};
+	assert(knx_filter_group_value(&filter, 0, &value));
+	assert(!knx_filter_group_value(&filter, SECOND, &value));
+	value.value.date.year = 16;
+	assert(knx_filter_group_value(&filter, 2 * SECOND, &value));
+
+	assert(filter.forwarded == 8);
+	assert(filter.dropped == 4);
+
+	knx_filter_destroy(&filter);
+})
+
+deftest(filter, {
+	runsubtest(filter_deadband);
+	runsubtest(filter_intervals);
+	runsubtest(filter_group_value);
+})
@@ -0,0 +1,212 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+#include "testalloc.h"
+
+#include "../src/proto/format.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+static
+const char example_format_export[] =
+	"Group name;Address;Central;Unfiltered;Description;DatapointType;Security\n"
+	"Temperature;1/2/4;;;;DPST-9-1;Auto\n"
+	"Scene \"A\";1/2/5;;;;DPST-5-1;Auto\n";
+
+static
+const uint8_t example_format_payload[3] = {0x80, 0x0C, 0x1A};
+
+static
+void example_format_frame(knx_cemi* frame, knx_addr destination) {
+	memset(frame, 0, sizeof(knx_cemi));
+	frame->service = KNX_CEMI_LDATA_IND;
+
+	knx_ldata* ldata = &frame->payload.ldata;
+	ldata->control1.priority = KNX_LDATA_PRIO_LOW;
+	ldata->control2.address_type = KNX_LDATA_ADDR_GROUP;
+	ldata->control2.hops = 6;
+	ldata->source = knx_individual_addr(1, 1, 5);
+	ldata->destination = destination;
+	ldata->tpdu.tpci = KNX_TPCI_UNNUMBERED_DATA;
+	ldata->tpdu.info.data.apci = KNX_APCI_GROUPVALUEWRITE;
+	ldata->tpdu.info.data.payload = example_format_payload;
+	ldata->tpdu.info.data.length = sizeof(example_format_payload);
+}
+
+deftest(format_addr, {
+	char buffer[KNX_FORMAT_ADDR_SIZE];
+
+	assert(knx_format_individual_addr(buffer, knx_individual_addr(15, 15, 255)) == 9);
+	assert(strcmp(buffer, "15.15.255") == 0);
+
+	assert(knx_format_group_addr(buffer, knx_group_addr(1, 2, 3)) == 5);
+	assert(strcmp(buffer, "1/2/3") == 0);
+})
+
+deftest(format_value, {
+	char buffer[64];
+	knx_dpt_value value;
+
+	value.float16 = 21.4f;
+	assert(knx_format_value(buffer, sizeof(buffer), knx_dpt_subtype_find(9, 1), &value) == 4);
+	assert(strcmp(buffer, "21.4") == 0);
+
+	value.float16 = -0.5f;
+	knx_format_value(buffer, sizeof(buffer), knx_dpt_subtype_find(9, 1), &value);
+	assert(strcmp(buffer, "-0.5") == 0);
+
+	value.float32 = 123.456f;
+	knx_format_value(buffer, sizeof(buffer), knx_dpt_subtype_find(14, 56), &value);
+	assert(strcmp(buffer, "123.456") == 0);
+
+	value.float32 = 6.02214076e23f;
+	knx_format_value(buffer, sizeof(buffer), knx_dpt_subtype_find(14, 56), &value);
+	assert(strcmp(buffer, "6.022141e23") == 0);
+
+	value.float32 = 0.00001f;
+	knx_format_value(buffer, sizeof(buffer), knx_dpt_subtype_find(14, 56), &value);
+	assert(strcmp(buffer, "1e-5") == 0);
+
+	value.unsigned8 = 255;
+	knx_format_value(buffer, sizeof(buffer), knx_dpt_subtype_find(5, 1), &value);
+	assert(strcmp(buffer, "100") == 0);
+
+	value.signed64 = INT64_MIN;
+	knx_format_value(buffer, sizeof(buffer), knx_dpt_subtype_find(29, 10), &value);
+	assert(strcmp(buffer, "-9223372036854775808") == 0);
+
+	value.bool_value = true;
+	knx_format_value(buffer, sizeof(buffer), knx_dpt_subtype_find(1, 1), &value);
+	assert(strcmp(buffer, "true") == 0);
+
+	memset(&value.string, 0, sizeof(value.string));
+	strcpy(value.string.value, "a\"b\\c\n");
+	knx_format_value(buffer, sizeof(buffer), knx_dpt_subtype_find(16, 0), &value);
+	assert(strcmp(buffer, "\"a\\\"b\\\\c\\n\"") == 0);
+
+	// ISO-8859-1 is transcoded to UTF-8
+	memset(&value.string, 0, sizeof(value.string));
+	strcpy(value.string.value, "\xC4pfel \xFF");
+	knx_format_value(buffer, sizeof(buffer), knx_dpt_subtype_find(16, 1), &value);
+	assert(strcmp(buffer, "\"\xC3\x84pfel \xC3\xBF\"") == 0);
+
+	value.char_value = (knx_char) 0xE9;
+	knx_format_value(buffer, sizeof(buffer), knx_dpt_subtype_find(4, 2), &value);
+	assert(strcmp(buffer, "\"\xC3\xA9\"") == 0);
+
+	value.timeofday = (knx_timeofday) {KNX_WEDNESDAY, 7, 5, 9};
+	knx_format_value(buffer, sizeof(buffer), knx_dpt_subtype_find(10, 1), &value);
+	assert(strcmp(buffer, "\"Wed 07:05:09\"") == 0);
+
+	value.date = (knx_date) {18, 10, 24};
+	knx_format_value(buffer, sizeof(buffer), knx_dpt_subtype_find(11, 1), &value);
+	assert(strcmp(buffer, "\"2024-10-18\"") == 0);
+
+	value.rgb = (knx_rgb) {255, 16, 0};
+	knx_format_value(buffer, sizeof(buffer), knx_dpt_subtype_find(232, 600), &value);
+	assert(strcmp(buffer, "\"#ff1000\"") == 0);
+
+	// Too small
+	value.float16 = 21.4f;
+	assert(knx_format_value(buffer, 4, knx_dpt_subtype_find(9, 1), &value) == -1);
+	assert(knx_format_value(buffer, 5, knx_dpt_subtype_find(9, 1), &value) == 4);
+})
+
+deftest(format_cemi, {
+	knx_group_index* index = knx_group_index_parse_with(
+		example_format_export, sizeof(example_format_export) - 1, test_allocator()
+	);
+	assert(index != NULL);
+
+	knx_cemi frame;
+	example_format_frame(&frame, knx_group_addr(1, 2, 4));
+
+	char buffer[512];
+
+	assert(knx_format_cemi(buffer, sizeof(buffer), KNX_FORMAT_JSON, &frame, NULL) > 0);
+	assert(strcmp(buffer,
+		"{\"service\":\"L_Data.ind\",\"source\":\"1.1.5\",\"destination\":\"1/2/4\",\"priority\":\"low\","
+		"\"hops\":6,\"apci\":\"GroupValueWrite\",\"data\":\"000c1a\"}") == 0);
+
+	assert(knx_format_cemi(buffer, sizeof(buffer), KNX_FORMAT_JSON, &frame, index) > 0);
+	assert(strcmp(buffer,
+		"{\"service\":\"L_Data.ind\",\"source\":\"1.1.5\",\"destination\":\"1/2/4\",\"priority\":\"low\","
+		"\"hops\":6,\"apci\":\"GroupValueWrite\",\"data\":\"000c1a\",\"name\":\"Temperature\","
+		"\"dpt\":\"9.001\",\"value\":21,\"unit\":\"°C\"}") == 0);
+
+	assert(knx_format_cemi(buffer, sizeof(buffer), KNX_FORMAT_TEXT, &frame, index) > 0);
+	assert(strcmp(buffer,
+		"L_Data.ind 1.1.5 -> 1/2/4 priority=low hops=6 apci=GroupValueWrite data=000c1a "
+		"name=\"Temperature\" dpt=9.001 value=21 °C") == 0);
+
+	// Control frames have no payload
+	frame.payload.ldata.control2.address_type = KNX_LDATA_ADDR_INDIVIDUAL;
+	frame.payload.ldata.tpdu.tpci = KNX_TPCI_NUMBERED_CONTROL;
+	frame.payload.ldata.tpdu.seq_number = 3;
+	frame.payload.ldata.tpdu.info.control = KNX_TPCI_CONTROL_ACK;
+
+	assert(knx_format_cemi(buffer, sizeof(buffer), KNX_FORMAT_TEXT, &frame, index) > 0);
+	assert(strcmp(buffer, "L_Data.ind 1.1.5 -> 0.10.4 priority=low hops=6 seq=3 control=ACK") == 0);
+
+	// Every truncation is detected
+	example_format_frame(&frame, knx_group_addr(1, 2, 4));
+	ssize_t length = knx_format_cemi(buffer, sizeof(buffer), KNX_FORMAT_JSON, &frame, index);
+
+	for (ssize_t size = 0; size <= length; size++)
+		assert(knx_format_cemi(buffer, size, KNX_FORMAT_JSON, &frame, index) == -1);
+
+	knx_group_index_free_with(index, test_allocator());
+})
+
+deftest(format_batch, {
+	knx_cemi frames[3];
+	example_format_frame(frames + 0, knx_group_addr(1, 2, 4));
+	example_format_frame(frames + 1, knx_group_addr(1, 2, 5));
+	example_format_frame(frames + 2, knx_group_addr(1, 2, 6));
+
+	char line[256];
+	ssize_t line_length = knx_format_cemi(line, sizeof(line), KNX_FORMAT_JSON, frames, NULL);
+	assert(line_length > 0);
+
+	char buffer[1024];
+	size_t formatted;
+
+	size_t length = knx_format_cemi_batch(buffer, sizeof(buffer), KNX_FORMAT_JSON, frames, 3, NULL, &formatted);
+	assert(formatted == 3);
+	assert(length == 3 * (size_t) line_length + 3);
+	assert(buffer[length - 1] == '\n' && buffer[length] == 0);
+	assert(memcmp(buffer, line, line_length) == 0);
+
+	// Only whole lines are written
+	length = knx_format_cemi_batch(buffer, 2 * line_length + 3, KNX_FORMAT_JSON, frames, 3, NULL, &formatted);
+	assert(formatted == 2);
+	assert(length == 2 * (size_t) line_length + 2);
+	assert(strlen(buffer) == length);
+})
+
+deftest(format, {
+	runsubtest(format_addr);
+	runsubtest(format_value);
+	runsubtest(format_cemi);
+	runsubtest(format_batch);
+})
@@ -0,0 +1,194 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+#include "testalloc.h"
+
+#include "../src/proto/groupindex.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static
+const char example_groupindex_csv[] =
+	"\xEF\xBB\xBF\"Group name\";\"Address\";\"Central\";\"Unfiltered\";\"Description\";\"DatapointType\";\"Security\"\r\n"
+	"\"Lighting\";\"1/-/-\";\"\";\"\";\"\";\"\";\"Auto\"\r\n"
+	"\"Living room\";\"1/2/-\";\"\";\"\";\"\";\"\";\"Auto\"\r\n"
+	"\"Ceiling \"\"main\"\"\";\"1/2/3\";\"\";\"\";\"\";\"DPST-1-1\";\"Auto\"\r\n"
+	"\"Temperature\";\"1/2/4\";\"\";\"\";\"\";\"DPST-9-1\";\"Auto\"\r\n"
+	"\"Dimmer\";\"1/2/5\";\"\";\"\";\"\";\"DPT-5\";\"Auto\"\r\n"
+	"\"Unknown\";\"1/2/6\";\"\";\"\";\"\";\"\";\"Auto\"";
+
+static
+const char example_groupindex_xml[] =
+	"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+	"<GroupAddress-Export xmlns=\"http://knx.org/xml/ga-export/01\">\n"
+	"  <GroupRange Name=\"Heating\" RangeStart=\"2048\" RangeEnd=\"4095\">\n"
+	"    <GroupAddress Name=\"Flow &amp; return\" Address=\"1/0/1\" DPTs=\"DPST-9-1\" />\n"
+	"    <GroupAddress Name='Energy &#x2192; meter' Address=\"1/0/2\" DPTs=\"DPST-29-10 DPST-13-10\" />\n"
+	"    <GroupAddress Name=\"Valve\" Address=\"4000\" DPTs=\"5.001\"/>\n"
+	"  </GroupRange>\n"
+	"</GroupAddress-Export>\n";
+
+static
+void example_groupindex_ldata(knx_ldata* ldata, knx_addr group, const uint8_t* payload, size_t length) {
+	memset(ldata, 0, sizeof(knx_ldata));
+	ldata->control2.address_type = KNX_LDATA_ADDR_GROUP;
+	ldata->destination = group;
+	ldata->tpdu.tpci = KNX_TPCI_UNNUMBERED_DATA;
+	ldata->tpdu.info.data.apci = KNX_APCI_GROUPVALUEWRITE;
+	ldata->tpdu.info.data.payload = payload;
+	ldata->tpdu.info.data.length = length;
+}
+
+deftest(groupindex_csv, {
+	knx_group_index* index = knx_group_index_parse_with(
+		example_groupindex_csv, sizeof(example_groupindex_csv) - 1, test_allocator()
+	);
+	assert(index != NULL);
+	assert(index->count == 4);
+
+	const knx_group_entry* ceiling = index->entries + knx_group_addr(1, 2, 3);
+	assert(ceiling->main == 1 && ceiling->sub == 1);
+	assert(strcmp(knx_group_index_name(index, knx_group_addr(1, 2, 3)), "Ceiling \"main\"") == 0);
+
+	const knx_group_entry* dimmer = index->entries + knx_group_addr(1, 2, 5);
+	assert(dimmer->main == 5 && dimmer->sub == 1);
+
+	assert(index->entries[knx_group_addr(1, 2, 6)].main == 0);
+	assert(strcmp(knx_group_index_name(index, knx_group_addr(1, 2, 6)), "Unknown") == 0);
+	assert(strcmp(knx_group_index_name(index, knx_group_addr(3, 0, 0)), "") == 0);
+
+	// Without header line
+	const char headless[] = "Switch,0/0/1,,,,DPST-1-1,Auto\nLevel,0/0/2,,,,DPST-5-1,Auto\n";
+	knx_group_index* headless_index = knx_group_index_parse_with(
+		headless, sizeof(headless) - 1, test_allocator()
+	);
+	assert(headless_index != NULL);
+	assert(headless_index->count == 2);
+	assert(headless_index->entries[2].main == 5);
+	assert(strcmp(knx_group_index_name(headless_index, 2), "Level") == 0);
+
+	knx_group_index_free_with(headless_index, test_allocator());
+	knx_group_index_free_with(index, test_allocator());
+})
+
+deftest(groupindex_xml, {
+	knx_group_index* index = knx_group_index_parse_with(
+		example_groupindex_xml, sizeof(example_groupindex_xml) - 1, test_allocator()
+	);
+	assert(index != NULL);
+	assert(index->count == 3);
+
+	assert(strcmp(knx_group_index_name(index, knx_group_addr(1, 0, 1)), "Flow & return") == 0);
+	assert(strcmp(knx_group_index_name(index, knx_group_addr(1, 0, 2)), "Energy \xE2\x86\x92 meter") == 0);
+	assert(index->entries[knx_group_addr(1, 0, 2)].main == 29);
+	assert(index->entries[4000].main == 5 && index->entries[4000].sub == 1);
+
+	knx_group_index_free_with(index, test_allocator());
+
+	const char broken[] = "<GroupAddress-Export><GroupAddress Name=\"Oops";
+	assert(knx_group_index_parse_with(broken, sizeof(broken) - 1, test_allocator()) == NULL);
+})
+
+deftest(groupindex_decode, {
+	knx_group_index* index = knx_group_index_parse_with(
+		example_groupindex_csv, sizeof(example_groupindex_csv) - 1, test_allocator()
+	);
+	assert(index != NULL);
+
+	knx_ldata ldata;
+	knx_group_value value;
+
+	const uint8_t switch_payload[1] = {1};
+	example_groupindex_ldata(&ldata, knx_group_addr(1, 2, 3), switch_payload, sizeof(switch_payload));
+	assert(knx_group_index_decode(index, &ldata, &value));
+	assert(value.group == knx_group_addr(1, 2, 3));
+	assert(value.descriptor->type == KNX_DPT_BOOL && value.value.bool_value);
+	assert(strcmp(value.name, "Ceiling \"main\"") == 0);
+
+	const uint8_t temp_payload[3] = {0, 0x0C, 0x1A};
+	example_groupindex_ldata(&ldata, knx_group_addr(1, 2, 4), temp_payload, sizeof(temp_payload));
+	assert(knx_group_index_decode(index, &ldata, &value));
+	assert(value.descriptor->type == KNX_DPT_FLOAT16);
+	assert(value.value.float16 == 21.0f);
+
+	// Payload does not match the datapoint type
+	example_groupindex_ldata(&ldata, knx_group_addr(1, 2, 4), switch_payload, sizeof(switch_payload));
+	assert(!knx_group_index_decode(index, &ldata, &value));
+
+	// Unknown datapoint type
+	example_groupindex_ldata(&ldata, knx_group_addr(1, 2, 6), switch_payload, sizeof(switch_payload));
+	assert(!knx_group_index_decode(index, &ldata, &value));
+
+	// Reads carry no value
+	example_groupindex_ldata(&ldata, knx_group_addr(1, 2, 3), switch_payload, sizeof(switch_payload));
+	ldata.tpdu.info.data.apci = KNX_APCI_GROUPVALUEREAD;
+	assert(!knx_group_index_decode(index, &ldata, &value));
+
+	knx_group_index_free_with(index, test_allocator());
+})
+
+deftest(groupindex_persist, {
+	knx_group_index* index = knx_group_index_parse_with(
+		example_groupindex_xml, sizeof(example_groupindex_xml) - 1, test_allocator()
+	);
+	assert(index != NULL);
+
+	char path[] = "/tmp/knxproto-groupindex-XXXXXX";
+	int fd = mkstemp(path);
+	assert(fd >= 0);
+	close(fd);
+
+	assert(knx_group_index_save(index, path));
+
+	const knx_group_index* mapped = knx_group_index_map(path);
+	assert(mapped != NULL);
+	assert(knx_group_index_size(mapped) == knx_group_index_size(index));
+	assert(memcmp(mapped, index, knx_group_index_size(index)) == 0);
+	assert(strcmp(knx_group_index_name(mapped, knx_group_addr(1, 0, 1)), "Flow & return") == 0);
+	knx_group_index_unmap(mapped);
+
+	// Export files are loaded directly
+	FILE* file = fopen(path, "wb");
+	assert(file != NULL);
+	fwrite(example_groupindex_xml, sizeof(example_groupindex_xml) - 1, 1, file);
+	fclose(file);
+
+	assert(knx_group_index_map(path) == NULL);
+
+	knx_group_index* loaded = knx_group_index_load_with(path, test_allocator());
+	assert(loaded != NULL);
+	assert(memcmp(loaded, index, knx_group_index_size(index)) == 0);
+
+	knx_group_index_free_with(loaded, test_allocator());
+	knx_group_index_free_with(index, test_allocator());
+	unlink(path);
+})
+
+deftest(groupindex, {
+	runsubtest(groupindex_csv);
+	runsubtest(groupindex_xml);
+	runsubtest(groupindex_decode);
+	runsubtest(groupindex_persist);
+})
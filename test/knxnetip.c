@@ -265,6 +265,181 @@ deftest(knx_description_request, {
 	assert(host_info_equal(&packet_out.payload.description_req.control_host, &packet_in.control_host));
 })
 
+// Device information, three service families and a manufacturer DIB
+static
+void example_description_response(uint8_t* message) {
+	memset(message, 0, 70);
+
+	message[0] = 54;
+	message[1] = 1;
+	message[2] = 0x02;
+	message[4] = 0x11;
+	message[5] = 0x05;
+	memcpy(message + 24, "Example Router", 14);
+
+	message[54] = 8;
+	message[55] = 2;
+	message[56] = 2;
+	message[57] = 1;
+	message[58] = 4;
+	message[59] = 1;
+	message[60] = 5;
+	message[61] = 2;
+
+	message[62] = 8;
+	message[63] = 0xFE;
+	message[64] = 0x00;
+	message[65] = 0xC5;
+	message[66] = 0xDE;
+	message[67] = 0xAD;
+	message[68] = 0xBE;
+	message[69] = 0xEF;
+}
+
+deftest(knx_description_response, {
+	uint8_t message[70];
+	example_description_response(message);
+
+	// Allocated
+	knx_description_response res;
+	assert(knx_description_response_parse(message, sizeof(message), &res));
+	assert(res.medium == 0x02 && res.address == 0x1105);
+	assert(strcmp(res.name, "Example Router") == 0);
+	assert(res.num_services == 3);
+	assert(res.services[0].family == 2 && res.services[2].family == 5);
+	assert(res.services[2].version == 2);
+	assert(res.manufacturer.present && res.manufacturer.id == 0xC5);
+	assert(res.manufacturer.length == 4 && res.manufacturer.data == message + 66);
+	assert(knx_description_response_size(&res) == sizeof(message));
+	knx_description_response_free_services(&res);
+
+	// Borrowed
+	assert(knx_description_response_parse_view(message, sizeof(message), &res));
+	assert(res.num_services == 3);
+	assert((const uint8_t*) res.services == message + 56);
+	assert(res.services[1].family == 4 && res.services[1].version == 1);
+	knx_description_response_free_services(&res);
+
+	// Inline
+	static knx_description_response_inline inline_res;
+	assert(knx_description_response_parse_inline(message, sizeof(message), &inline_res));
+	assert(inline_res.response.services == inline_res.services);
+	assert(inline_res.response.num_services == 3 && inline_res.services[2].family == 5);
+	assert(inline_res.response.manufacturer.present);
+
+	// Without manufacturer DIB
+	assert(knx_description_response_parse_view(message, 62, &res));
+	assert(!res.manufacturer.present && res.num_services == 3);
+
+	// Service families exceed the message
+	assert(!knx_description_response_parse_view(message, 61, &res));
+	assert(!knx_description_response_parse(message, 61, &res));
+
+	// Empty service families DIB
+	message[54] = 2;
+	assert(knx_description_response_parse(message, 56, &res));
+	assert(res.num_services == 0 && res.services == NULL);
+
+	message[54] = 0;
+	assert(!knx_description_response_parse(message, 56, &res));
+})
+
+deftest(knx_parse_typed, {
+	knx_tunnel_response res_in = {100, 50, 0};
+
+	uint8_t buffer[KNX_HEADER_SIZE + KNX_TUNNEL_RESPONSE_SIZE];
+	assert(knx_generate(buffer, KNX_TUNNEL_RESPONSE, &res_in));
+
+	knx_tunnel_response res_out;
+	assert(knx_parse_tunnel_response(buffer, sizeof(buffer), &res_out) == (ssize_t) sizeof(buffer));
+	assert(res_out.channel == 100 && res_out.seq_number == 50 && res_out.status == 0);
+
+	// Different service
+	knx_tunnel_request req_out;
+	assert(knx_parse_tunnel_request(buffer, sizeof(buffer), &req_out) == -KNX_UNKNOWN_SERVICE);
+
+	// Truncated frame
+	assert(knx_parse_tunnel_response(buffer, sizeof(buffer) - 1, &res_out) == -KNX_INVALID_BUFFER);
+
+	knx_description_request desc_in = {
+		{KNX_PROTO_UDP, htonl(INADDR_LOOPBACK), 12345}
+	};
+
+	uint8_t desc_buffer[KNX_HEADER_SIZE + KNX_DESCRIPTION_REQUEST_SIZE];
+	assert(knx_generate(desc_buffer, KNX_DESCRIPTION_REQUEST, &desc_in));
+
+	knx_description_request desc_out;
+	assert(knx_parse_description_request(desc_buffer, sizeof(desc_buffer), &desc_out) > 0);
+	assert(host_info_equal(&desc_out.control_host, &desc_in.control_host));
+})
+
+deftest(knx_parse_small, {
+	assert(sizeof(knx_packet_small) * 2 <= sizeof(knx_packet));
+
+	knx_packet_small packet;
+
+	// Tunnel request
+	knx_tunnel_request req = {
+		100,
+		7,
+		{
+			KNX_CEMI_LDATA_REQ,
+			0,
+			NULL,
+			{
+				.ldata = example_ldata
+			}
+		}
+	};
+
+	uint8_t req_buffer[KNX_HEADER_SIZE + knx_tunnel_request_size(&req)];
+	assert(knx_generate(req_buffer, KNX_TUNNEL_REQUEST, &req));
+	assert(knx_parse_small(req_buffer, sizeof(req_buffer), &packet) == (ssize_t) sizeof(req_buffer));
+
+	assert(packet.service == KNX_TUNNEL_REQUEST);
+	assert(packet.channel == 100 && packet.seq_number == 7);
+	assert(packet.payload.ldata.service == KNX_CEMI_LDATA_REQ);
+	assert(knx_telegram_compact_destination(&packet.payload.ldata) == example_ldata.destination);
+
+	knx_ldata ldata;
+	assert(knx_telegram_compact_to_ldata(&packet.payload.ldata, &ldata));
+	assert(ldata.source == example_ldata.source);
+	assert(ldata.tpdu.info.data.length == example_ldata.tpdu.info.data.length);
+	assert(memcmp(ldata.tpdu.info.data.payload + 1, example_ldata_payload + 1, 4) == 0);
+
+	// Tunnel response
+	knx_tunnel_response res = {100, 7, 1};
+
+	uint8_t res_buffer[KNX_HEADER_SIZE + KNX_TUNNEL_RESPONSE_SIZE];
+	assert(knx_generate(res_buffer, KNX_TUNNEL_RESPONSE, &res));
+	assert(knx_parse_small(res_buffer, sizeof(res_buffer), &packet) == (ssize_t) sizeof(res_buffer));
+	assert(packet.service == KNX_TUNNEL_RESPONSE);
+	assert(packet.channel == 100 && packet.seq_number == 7 && packet.status == 1);
+
+	// Connection state request
+	knx_connection_state_request state = {
+		100,
+		0,
+		{KNX_PROTO_UDP, htonl(INADDR_LOOPBACK), 12345}
+	};
+
+	uint8_t state_buffer[KNX_HEADER_SIZE + KNX_CONNECTION_STATE_REQUEST_SIZE];
+	assert(knx_generate(state_buffer, KNX_CONNECTION_STATE_REQUEST, &state));
+	assert(knx_parse_small(state_buffer, sizeof(state_buffer), &packet) ==
+	       (ssize_t) sizeof(state_buffer));
+	assert(packet.service == KNX_CONNECTION_STATE_REQUEST && packet.channel == 100);
+	assert(host_info_equal(&packet.payload.host, &state.host));
+
+	// Not covered
+	knx_description_request desc = {
+		{KNX_PROTO_UDP, htonl(INADDR_LOOPBACK), 12345}
+	};
+
+	uint8_t desc_buffer[KNX_HEADER_SIZE + KNX_DESCRIPTION_REQUEST_SIZE];
+	assert(knx_generate(desc_buffer, KNX_DESCRIPTION_REQUEST, &desc));
+	assert(knx_parse_small(desc_buffer, sizeof(desc_buffer), &packet) == -KNX_UNKNOWN_SERVICE);
+})
+
 deftest(knxnetip, {
 	runsubtest(knx_connection_request);
 	runsubtest(knx_connection_response);
@@ -276,4 +451,7 @@ deftest(knxnetip, {
 	runsubtest(knx_tunnel_response);
 	// runsubtest(knx_routing_indication);
 	runsubtest(knx_description_request);
+	runsubtest(knx_description_response);
+	runsubtest(knx_parse_typed);
+	runsubtest(knx_parse_small);
 })
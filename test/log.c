@@ -0,0 +1,306 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+#include "testalloc.h"
+
+#include "../src/io/log.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static
+const uint8_t example_log_payload[3] = {0, 0x0C, 0x1A};
+
+static
+const knx_addr example_log_groups[3] = {
+	knx_group_addr(1, 2, 3),
+	knx_group_addr(1, 2, 4),
+	knx_group_addr(3, 0, 1)
+};
+
+inline static
+size_t log_example_frame(uint8_t* buffer, size_t i) {
+	knx_cemi frame = {
+		KNX_CEMI_LDATA_IND,
+		0,
+		NULL,
+		{
+			.ldata = {
+				.control1 = {KNX_LDATA_PRIO_LOW, true, true, false, false},
+				.control2 = {KNX_LDATA_ADDR_GROUP, 6},
+				.source = knx_individual_addr(1, 1, 5),
+				.destination = example_log_groups[i % 3],
+				.tpdu = {
+					.tpci = KNX_TPCI_UNNUMBERED_DATA,
+					.info = {
+						.data = {
+							.apci = KNX_APCI_GROUPVALUEWRITE,
+							.payload = example_log_payload,
+							.length = sizeof(example_log_payload)
+						}
+					}
+				}
+			}
+		}
+	};
+
+	// Every tenth frame is addressed to an individual device
+	if (i % 10 == 9) {
+		frame.payload.ldata.control2.address_type = KNX_LDATA_ADDR_INDIVIDUAL;
+		frame.payload.ldata.destination = example_log_groups[0];
+	}
+
+	knx_cemi_generate(buffer, &frame);
+	return knx_cemi_size(&frame);
+}
+
+typedef struct {
+	size_t count;
+	uint64_t last_timestamp;
+	bool ordered;
+	knx_addr only;
+	bool filtered;
+} log_visit_state;
+
+static
+bool log_visit(uint64_t timestamp, const knx_cemi* frame, void* data) {
+	log_visit_state* state = data;
+
+	if (timestamp < state->last_timestamp)
+		state->ordered = false;
+
+	if (state->only != 0 && (frame->payload.ldata.destination != state->only ||
+	                         frame->payload.ldata.control2.address_type != KNX_LDATA_ADDR_GROUP))
+		state->filtered = false;
+
+	state->last_timestamp = timestamp;
+	state->count++;
+
+	return state->count < 1000;
+}
+
+// Reference implementation for the expected number of matches
+inline static
+size_t log_expected(uint64_t from, uint64_t to, knx_addr group) {
+	size_t count = 0;
+
+	for (size_t i = 0; i < 1000; i++) {
+		uint64_t timestamp = i * 1000;
+
+		if (timestamp < from || timestamp > to)
+			continue;
+
+		if (group == 0 || (i % 10 != 9 && example_log_groups[i % 3] == group))
+			count++;
+	}
+
+	return count;
+}
+
+deftest(log_query, {
+	char directory[] = "/tmp/knxproto-log-XXXXXX";
+	assert(mkdtemp(directory) != NULL);
+
+	// Sealing reuses two slots for its temporary buffers instead of touching the heap
+	static uint8_t buffer[(1 << 19) + 64];
+	knx_arena arena;
+	knx_arena_init_buffer(&arena, buffer, sizeof(buffer));
+	knx_allocator backing = knx_arena_allocator(&arena);
+
+	knx_slab slab;
+	knx_slab_init_with(&slab, 1 << 18, 2, &backing);
+	knx_allocator allocator = knx_slab_allocator(&slab);
+
+	knx_alloc_stats stats;
+	knx_alloc_stats_reset();
+
+	knx_log log;
+	assert(knx_log_open_with(&log, directory, 4096, &allocator));
+
+	uint8_t frame[64];
+
+	for (size_t i = 0; i < 1000; i++) {
+		size_t length = log_example_frame(frame, i);
+		assert(knx_log_append(&log, i * 1000, frame, length));
+	}
+
+	// Timestamps must not go backwards
+	assert(!knx_log_append(&log, 0, frame, log_example_frame(frame, 0)));
+
+	// Multiple segments are required to hold every frame
+	assert(log.sequence > 1);
+	assert(knx_log_close(&log));
+
+	knx_alloc_stats_get(&stats);
+	assert(stats.allocations == 0);
+	assert(slab.used == 0);
+
+	knx_slab_destroy(&slab);
+
+	// Entire log
+	log_visit_state state = {0, 0, true, 0, true};
+	knx_log_query query = {0, UINT64_MAX, NULL, 0};
+
+	assert(knx_log_query_directory(directory, &query, log_visit, &state) == 1000);
+	assert(state.count == 1000 && state.ordered);
+
+	// Time range only
+	state = (log_visit_state) {0, 0, true, 0, true};
+	query = (knx_log_query) {123456, 654321, NULL, 0};
+
+	assert(knx_log_query_directory(directory, &query, log_visit, &state) ==
+	       (ssize_t) log_expected(123456, 654321, 0));
+	assert(state.ordered);
+
+	// Time range and a single group
+	state = (log_visit_state) {0, 0, true, example_log_groups[1], true};
+	query = (knx_log_query) {123456, 654321, example_log_groups + 1, 1};
+
+	assert(knx_log_query_directory(directory, &query, log_visit, &state) ==
+	       (ssize_t) log_expected(123456, 654321, example_log_groups[1]));
+	assert(state.ordered && state.filtered);
+
+	// Multiple groups, including duplicates and groups that never occur
+	const knx_addr groups[4] = {
+		example_log_groups[0], example_log_groups[2], example_log_groups[0], knx_group_addr(9, 1, 1)
+	};
+
+	state = (log_visit_state) {0, 0, true, 0, true};
+	query = (knx_log_query) {0, 500000, groups, 4};
+
+	assert(knx_log_query_directory(directory, &query, log_visit, &state) ==
+	       (ssize_t) (log_expected(0, 500000, example_log_groups[0]) +
+	                  log_expected(0, 500000, example_log_groups[2])));
+	assert(state.ordered);
+
+	// Large queries take their cursors from the given allocator instead of the heap
+	knx_addr many_groups[KNX_LOG_QUERY_GROUPS + 4];
+
+	for (size_t i = 0; i < KNX_LOG_QUERY_GROUPS + 4; i++)
+		many_groups[i] = i < 3 ? example_log_groups[i] : knx_group_addr(9, 1, i);
+
+	knx_arena_reset(&arena);
+	knx_alloc_stats_reset();
+
+	state = (log_visit_state) {0, 0, true, 0, true};
+	query = (knx_log_query) {0, 500000, many_groups, KNX_LOG_QUERY_GROUPS + 4};
+
+	assert(knx_log_query_directory_with(directory, &query, log_visit, &state, &backing) ==
+	       (ssize_t) (log_expected(0, 500000, example_log_groups[0]) +
+	                  log_expected(0, 500000, example_log_groups[1]) +
+	                  log_expected(0, 500000, example_log_groups[2])));
+	assert(state.ordered);
+
+	knx_alloc_stats_get(&stats);
+	assert(stats.allocations == 0);
+	assert(arena.used > 0);
+
+	// Removed segments leave a gap in the sequence numbers
+
+	char removed[64];
+	snprintf(removed, sizeof(removed), "%s/0000000000000001.knxlog", directory);
+	assert(unlink(removed) == 0);
+
+	state = (log_visit_state) {0, 0, true, 0, true};
+	query = (knx_log_query) {0, UINT64_MAX, NULL, 0};
+
+	ssize_t remaining = knx_log_query_directory(directory, &query, log_visit, &state);
+	assert(remaining > 0 && remaining < 1000);
+	assert(state.ordered && state.count == (size_t) remaining);
+
+	// Clean up
+	DIR* dir = opendir(directory);
+	assert(dir != NULL);
+
+	struct dirent* entry;
+	while ((entry = readdir(dir))) {
+		if (entry->d_name[0] != '.')
+			unlinkat(dirfd(dir), entry->d_name, 0);
+	}
+
+	closedir(dir);
+	rmdir(directory);
+})
+
+deftest(log_corrupt, {
+	char directory[] = "/tmp/knxproto-log-XXXXXX";
+	assert(mkdtemp(directory) != NULL);
+
+	int dir_fd = open(directory, O_RDONLY | O_DIRECTORY);
+	assert(dir_fd >= 0);
+
+	knx_log_segment segment;
+	assert(knx_log_segment_create(&segment, dir_fd, "segment", 1 << 16));
+
+	uint8_t frame[64];
+
+	for (size_t i = 0; i < 4 * KNX_LOG_TIME_INTERVAL; i++) {
+		size_t length = log_example_frame(frame, i);
+		assert(knx_log_segment_append(&segment, i * 1000, frame, length));
+	}
+
+	assert(knx_log_segment_seal_with(&segment, test_allocator()));
+
+	int fd = openat(dir_fd, "segment", O_RDWR);
+	assert(fd >= 0);
+
+	knx_log_header header;
+	assert(pread(fd, &header, sizeof(header), 0) == sizeof(header));
+	assert(header.sealed && header.time_entries == 4);
+
+	// Offset of the second time index entry's record offset
+	off_t entry = header.index_offset + 16 + 8;
+	uint64_t original, next;
+	assert(pread(fd, &original, 8, entry) == 8);
+	assert(pread(fd, &next, 8, entry + 16) == 8);
+
+	// Starts between the second and third sample, so that the second one is the lower bound
+	log_visit_state state = {0, 0, true, 0, true};
+	knx_log_query query = {KNX_LOG_TIME_INTERVAL * 1000 + 1, KNX_LOG_TIME_INTERVAL * 1000 + 1, NULL, 0};
+
+	assert(knx_log_segment_query(fd, &query, log_visit, &state) == 0);
+
+	const uint64_t corrupt[3] = {header.data_end + (1 << 20), 0, next + 8};
+
+	for (size_t i = 0; i < 3; i++) {
+		assert(pwrite(fd, corrupt + i, 8, entry) == 8);
+		assert(knx_log_segment_query(fd, &query, log_visit, &state) == -1);
+	}
+
+	assert(pwrite(fd, &original, 8, entry) == 8);
+	assert(knx_log_segment_query(fd, &query, log_visit, &state) == 0);
+
+	close(fd);
+	unlinkat(dir_fd, "segment", 0);
+	close(dir_fd);
+	rmdir(directory);
+})
+
+deftest(log, {
+	runsubtest(log_query);
+	runsubtest(log_corrupt);
+})
@@ -0,0 +1,282 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+#include "testalloc.h"
+
+#include "../src/bus/memory.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#define SECOND 1000000000ull
+
+// Simulated device answering memory requests
+typedef struct {
+	knx_addr address;
+	uint8_t memory[256];
+	uint8_t seq_number;
+	bool silent;
+	bool reorder;
+	size_t requests;
+	size_t max_tpdu;
+} memory_device;
+
+typedef struct {
+	knx_ldata ldata;
+	uint8_t payload[3 + KNX_MEMORY_MAX_CHUNK];
+} memory_frame;
+
+typedef struct {
+	memory_device devices[2];
+
+	memory_frame queue[64];
+	size_t head, tail;
+
+	size_t done;
+	bool success[4];
+	size_t transferred[4];
+} memory_bus;
+
+static
+void memory_enqueue(
+	memory_bus*          bus,
+	const memory_device* device,
+	knx_tpci             tpci,
+	uint8_t              seq_number,
+	const uint8_t*       payload,
+	size_t               length
+) {
+	memory_frame* frame = bus->queue + bus->tail++;
+
+	memset(&frame->ldata, 0, sizeof(knx_ldata));
+	frame->ldata.control2.address_type = KNX_LDATA_ADDR_INDIVIDUAL;
+	frame->ldata.source = device->address;
+	frame->ldata.tpdu.tpci = tpci;
+	frame->ldata.tpdu.seq_number = seq_number;
+
+	if (tpci == KNX_TPCI_NUMBERED_CONTROL) {
+		frame->ldata.tpdu.info.control = KNX_TPCI_CONTROL_ACK;
+	} else {
+		memcpy(frame->payload, payload, length);
+		frame->ldata.tpdu.info.data.apci = KNX_APCI_MEMORYRESPONSE;
+		frame->ldata.tpdu.info.data.payload = frame->payload;
+		frame->ldata.tpdu.info.data.length = length;
+	}
+}
+
+static
+void memory_device_receive(const knx_ldata* ldata, void* user, void* data) {
+	memory_bus* bus = data;
+	memory_device* device = NULL;
+
+	for (size_t i = 0; i < 2; i++)
+		if (bus->devices[i].address == ldata->destination)
+			device = bus->devices + i;
+
+	if (!device || device->silent)
+		return;
+
+	const knx_tpdu* tpdu = &ldata->tpdu;
+
+	if (tpdu->tpci == KNX_TPCI_UNNUMBERED_CONTROL &&
+	    tpdu->info.control == KNX_TPCI_CONTROL_CONNECTED)
+		device->seq_number = 0;
+
+	if (tpdu->tpci != KNX_TPCI_NUMBERED_DATA)
+		return;
+
+	device->requests++;
+
+	if (knx_tpdu_size(tpdu) > device->max_tpdu)
+		device->max_tpdu = knx_tpdu_size(tpdu);
+
+	const uint8_t* request = tpdu->info.data.payload;
+	uint8_t count = request[0] & 63;
+	uint16_t address = request[1] << 8 | request[2];
+
+	if (!device->reorder)
+		memory_enqueue(bus, device, KNX_TPCI_NUMBERED_CONTROL, tpdu->seq_number, NULL, 0);
+
+	if (tpdu->info.data.apci == KNX_APCI_MEMORYREAD) {
+		uint8_t response[3 + KNX_MEMORY_MAX_CHUNK] = {count, request[1], request[2]};
+		memcpy(response + 3, device->memory + address, count);
+
+		memory_enqueue(bus, device, KNX_TPCI_NUMBERED_DATA, device->seq_number, response,
+		               3 + count);
+		device->seq_number = (device->seq_number + 1) & 15;
+	} else if (tpdu->info.data.apci == KNX_APCI_MEMORYWRITE) {
+		memcpy(device->memory + address, request + 3, count);
+	}
+
+	if (device->reorder)
+		memory_enqueue(bus, device, KNX_TPCI_NUMBERED_CONTROL, tpdu->seq_number, NULL, 0);
+}
+
+static
+void memory_record_done(uint32_t job, bool success, size_t transferred, void* user, void* data) {
+	memory_bus* bus = data;
+	size_t index = (size_t) user;
+
+	bus->success[index] = success;
+	bus->transferred[index] = transferred;
+	bus->done++;
+}
+
+static
+void memory_bus_init(memory_bus* bus) {
+	memset(bus, 0, sizeof(memory_bus));
+
+	bus->devices[0].address = knx_individual_addr(1, 1, 1);
+	bus->devices[1].address = knx_individual_addr(1, 1, 2);
+
+	for (size_t i = 0; i < 256; i++) {
+		bus->devices[0].memory[i] = i;
+		bus->devices[1].memory[i] = 255 - i;
+	}
+}
+
+static
+void memory_bus_pump(memory_bus* bus, knx_memory* memory, uint64_t now) {
+	while (bus->head < bus->tail)
+		knx_memory_receive(memory, &bus->queue[bus->head++].ldata, now);
+}
+
+deftest(memory_read, {
+	static memory_bus bus;
+	memory_bus_init(&bus);
+
+	// The second device acknowledges after answering
+	bus.devices[1].reorder = true;
+
+	knx_memory memory;
+	assert(knx_memory_init_with(&memory, 4, memory_device_receive, memory_record_done, &bus,
+	                            test_allocator()));
+
+	uint8_t extended[200], standard[40];
+
+	uint32_t a = knx_memory_read(&memory, 0, bus.devices[0].address, 0x10, extended,
+	                             sizeof(extended), KNX_MEMORY_EXTENDED_APDU, (void*) 0, SECOND);
+	uint32_t b = knx_memory_read(&memory, 0, bus.devices[1].address, 0x20, standard,
+	                             sizeof(standard), KNX_MEMORY_STANDARD_APDU, (void*) 1, SECOND);
+
+	assert(a != KNX_TRANSPORT_NONE && b != KNX_TRANSPORT_NONE);
+
+	// Only one job per device
+	assert(knx_memory_read(&memory, 0, bus.devices[0].address, 0, standard, 1,
+	                       KNX_MEMORY_STANDARD_APDU, NULL, SECOND) == KNX_TRANSPORT_NONE);
+
+	// Both devices have a request in flight before any answer arrived
+	assert(bus.devices[0].requests == 1 && bus.devices[1].requests == 1);
+
+	memory_bus_pump(&bus, &memory, SECOND);
+
+	assert(bus.done == 2);
+	assert(bus.success[0] && bus.transferred[0] == sizeof(extended));
+	assert(bus.success[1] && bus.transferred[1] == sizeof(standard));
+	assert(memcmp(extended, bus.devices[0].memory + 0x10, sizeof(extended)) == 0);
+	assert(memcmp(standard, bus.devices[1].memory + 0x20, sizeof(standard)) == 0);
+
+	// Chunks of 63 bytes with extended frames, 12 bytes with standard frames
+	assert(bus.devices[0].requests == 4);
+	assert(bus.devices[1].requests == 4);
+
+	// Connections are closed afterwards
+	assert(memory.transport.active == 0);
+	assert(knx_memory_poll(&memory, SECOND) == UINT64_MAX);
+
+	knx_memory_destroy(&memory);
+})
+
+deftest(memory_write, {
+	static memory_bus bus;
+	memory_bus_init(&bus);
+
+	knx_memory memory;
+	assert(knx_memory_init_with(&memory, 4, memory_device_receive, memory_record_done, &bus,
+	                            test_allocator()));
+
+	uint8_t data[100];
+	for (size_t i = 0; i < sizeof(data); i++)
+		data[i] = 0xA0 ^ i;
+
+	assert(knx_memory_write(&memory, 0, bus.devices[0].address, 0x80, data, sizeof(data),
+	                        KNX_MEMORY_EXTENDED_APDU, (void*) 0, SECOND) != KNX_TRANSPORT_NONE);
+	assert(knx_memory_write(&memory, 0, bus.devices[1].address, 0x08, data, 30,
+	                        KNX_MEMORY_STANDARD_APDU, (void*) 1, SECOND) != KNX_TRANSPORT_NONE);
+
+	memory_bus_pump(&bus, &memory, SECOND);
+
+	assert(bus.done == 2);
+	assert(bus.success[0] && bus.transferred[0] == sizeof(data));
+	assert(bus.success[1] && bus.transferred[1] == 30);
+	assert(memcmp(bus.devices[0].memory + 0x80, data, sizeof(data)) == 0);
+	assert(memcmp(bus.devices[1].memory + 0x08, data, 30) == 0);
+
+	// Long writes need extended frames, the other device only ever sees standard frames
+	assert(bus.devices[0].requests == 2);
+	assert(bus.devices[0].max_tpdu == 4 + KNX_MEMORY_MAX_CHUNK);
+	assert(bus.devices[1].requests == 3);
+	assert(bus.devices[1].max_tpdu == KNX_LDATA_STANDARD_TPDU_SIZE);
+
+	knx_memory_destroy(&memory);
+})
+
+deftest(memory_failure, {
+	static memory_bus bus;
+	memory_bus_init(&bus);
+	bus.devices[0].silent = true;
+
+	knx_memory memory;
+	assert(knx_memory_init_with(&memory, 2, memory_device_receive, memory_record_done, &bus,
+	                            test_allocator()));
+
+	uint8_t buffer[16];
+
+	// Invalid ranges and APDU lengths
+	assert(knx_memory_read(&memory, 0, bus.devices[0].address, 0, buffer, 0,
+	                       KNX_MEMORY_STANDARD_APDU, NULL, 0) == KNX_TRANSPORT_NONE);
+	assert(knx_memory_read(&memory, 0, bus.devices[0].address, 0xFFF8, buffer, sizeof(buffer),
+	                       KNX_MEMORY_STANDARD_APDU, NULL, 0) == KNX_TRANSPORT_NONE);
+	assert(knx_memory_read(&memory, 0, bus.devices[0].address, 0, buffer, sizeof(buffer),
+	                       3, NULL, 0) == KNX_TRANSPORT_NONE);
+
+	// A device which never answers fails the job after all repetitions
+	assert(knx_memory_read(&memory, 0, bus.devices[0].address, 0, buffer, sizeof(buffer),
+	                       KNX_MEMORY_STANDARD_APDU, (void*) 0, 0) != KNX_TRANSPORT_NONE);
+
+	uint64_t now = 0;
+
+	while (now != UINT64_MAX && bus.done == 0)
+		now = knx_memory_poll(&memory, now);
+
+	assert(bus.done == 1);
+	assert(!bus.success[0] && bus.transferred[0] == 0);
+	assert(memory.transport.active == 0);
+
+	knx_memory_destroy(&memory);
+})
+
+deftest(memory, {
+	runsubtest(memory_read);
+	runsubtest(memory_write);
+	runsubtest(memory_failure);
+})
@@ -0,0 +1,199 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+#include "testalloc.h"
+
+#include "../src/io/pool.h"
+
+#include <sys/socket.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+inline static
+bool example_pool_within(const knx_pool_buffer* buffer, const void* pointer) {
+	return (const uint8_t*) pointer >= buffer->data &&
+	       (const uint8_t*) pointer < buffer->data + buffer->pool->buffer_size;
+}
+
+deftest(pool_acquire, {
+	knx_pool pool;
+	assert(knx_pool_init_with(&pool, 4, 100, test_allocator()));
+	assert(pool.buffer_size == 128);
+
+	knx_pool_buffer* buffers[4];
+	for (size_t i = 0; i < 4; i++) {
+		buffers[i] = knx_pool_acquire(&pool);
+		assert(buffers[i] != NULL);
+		assert(buffers[i]->refs == 1 && buffers[i]->length == 0);
+		assert((uintptr_t) buffers[i]->data % 64 == 0);
+	}
+
+	// Exhausted
+	assert(knx_pool_acquire(&pool) == NULL);
+
+	knx_pool_stats stats;
+	knx_pool_stats_get(&pool, &stats);
+	assert(stats.capacity == 4 && stats.in_use == 4 && stats.peak == 4);
+	assert(stats.acquired == 4 && stats.exhausted == 1);
+
+	// Buffers return once the last reference is gone
+	knx_pool_retain(buffers[1]);
+	knx_pool_release(buffers[1]);
+	assert(knx_pool_acquire(&pool) == NULL);
+
+	knx_pool_release(buffers[1]);
+	assert(knx_pool_acquire(&pool) == buffers[1]);
+
+	for (size_t i = 0; i < 4; i++)
+		knx_pool_release(buffers[i]);
+
+	knx_pool_stats_get(&pool, &stats);
+	assert(stats.in_use == 0 && stats.peak == 4);
+	assert(stats.acquired == 5 && stats.exhausted == 2);
+
+	knx_pool_destroy(&pool);
+
+	assert(!knx_pool_init_with(&pool, 0, 100, test_allocator()));
+	assert(!knx_pool_init_with(&pool, 4, 0, test_allocator()));
+})
+
+deftest(pool_packet, {
+	knx_pool pool;
+	assert(knx_pool_init_with(&pool, 2, 256, test_allocator()));
+
+	int fds[2];
+	assert(socketpair(AF_UNIX, SOCK_DGRAM, 0, fds) == 0);
+
+	const uint8_t payload[3] = {0x80, 0x0C, 0x1A};
+
+	knx_tunnel_request req;
+	memset(&req, 0, sizeof(req));
+	req.channel = 7;
+	req.seq_number = 3;
+	req.data.service = KNX_CEMI_LDATA_REQ;
+	req.data.payload.ldata.destination = 0x0A04;
+	req.data.payload.ldata.control2.address_type = KNX_LDATA_ADDR_GROUP;
+	req.data.payload.ldata.tpdu.tpci = KNX_TPCI_UNNUMBERED_DATA;
+	req.data.payload.ldata.tpdu.info.data.apci = KNX_APCI_GROUPVALUEWRITE;
+	req.data.payload.ldata.tpdu.info.data.payload = payload;
+	req.data.payload.ldata.tpdu.info.data.length = sizeof(payload);
+
+	// Generate into a pooled buffer and send it
+	knx_pool_buffer* out = knx_pool_acquire(&pool);
+	assert(out != NULL);
+	assert(knx_generate(out->data, KNX_TUNNEL_REQUEST, &req));
+	out->length = knx_size(KNX_TUNNEL_REQUEST, &req);
+
+	assert(write(fds[0], out->data, out->length) == (ssize_t) out->length);
+	knx_pool_release(out);
+
+	// Receive and parse in place
+	knx_pool_buffer* in = knx_pool_acquire(&pool);
+	assert(in != NULL);
+	assert(knx_pool_receive(in, fds[1], 0, NULL, NULL) == (ssize_t) knx_size(KNX_TUNNEL_REQUEST, &req));
+
+	knx_pool_packet packet;
+	assert(knx_pool_parse(in, &packet));
+	assert(packet.buffer == in && in->refs == 2);
+
+	// The receiver is done with the buffer, the packet keeps it alive
+	knx_pool_release(in);
+
+	const knx_tunnel_request* parsed = &packet.packet.payload.tunnel_req;
+	assert(packet.packet.service == KNX_TUNNEL_REQUEST);
+	assert(parsed->channel == 7 && parsed->seq_number == 3);
+	assert(example_pool_within(in, parsed->data.payload.ldata.tpdu.info.data.payload));
+
+	// Hand the packet to another stage
+	knx_pool_packet copy = packet;
+	knx_pool_packet_retain(&copy);
+	knx_pool_packet_release(&packet);
+
+	assert(in->refs == 1);
+	assert(copy.packet.payload.tunnel_req.data.payload.ldata.tpdu.info.data.payload[2] == 0x1A);
+
+	// CEMI frame at an offset
+	knx_pool_cemi frame;
+	assert(knx_pool_parse_cemi(in, KNX_HEADER_SIZE + 4, &frame));
+	assert(frame.frame.payload.ldata.destination == 0x0A04);
+	assert(!knx_pool_parse_cemi(in, in->length + 1, &frame));
+
+	knx_pool_packet_release(&copy);
+	assert(in->refs == 1);
+	knx_pool_cemi_release(&frame);
+
+	knx_pool_stats stats;
+	knx_pool_stats_get(&pool, &stats);
+	assert(stats.in_use == 0);
+
+	close(fds[0]);
+	close(fds[1]);
+	knx_pool_destroy(&pool);
+})
+
+deftest(pool_description_response, {
+	knx_pool pool;
+	assert(knx_pool_init_with(&pool, 1, 128, test_allocator()));
+
+	knx_pool_buffer* buffer = knx_pool_acquire(&pool);
+	assert(buffer != NULL);
+
+	uint8_t* frame = buffer->data;
+	memset(frame, 0, KNX_HEADER_SIZE + 58);
+
+	frame[0] = KNX_HEADER_SIZE;
+	frame[1] = 16;
+	frame[2] = KNX_DESCRIPTION_RESPONSE >> 8;
+	frame[3] = KNX_DESCRIPTION_RESPONSE & 0xFF;
+	frame[5] = KNX_HEADER_SIZE + 58;
+	frame[KNX_HEADER_SIZE] = 54;
+	frame[KNX_HEADER_SIZE + 1] = 1;
+	frame[KNX_HEADER_SIZE + 54] = 4;
+	frame[KNX_HEADER_SIZE + 55] = 2;
+	frame[KNX_HEADER_SIZE + 56] = 4;
+	frame[KNX_HEADER_SIZE + 57] = 1;
+	buffer->length = KNX_HEADER_SIZE + 58;
+
+	knx_pool_packet packet;
+	assert(knx_pool_parse(buffer, &packet));
+	knx_pool_release(buffer);
+
+	knx_description_response* res = &packet.packet.payload.description_res;
+	assert(res->num_services == 1 && res->services[0].family == 4);
+
+	// Services live behind the frame
+	assert(example_pool_within(buffer, res->services));
+	assert((uint8_t*) res->services >= buffer->data + buffer->length);
+
+	// Freeing them is harmless
+	knx_description_response_free_services(res);
+	knx_pool_packet_release(&packet);
+
+	knx_pool_destroy(&pool);
+})
+
+deftest(pool, {
+	runsubtest(pool_acquire);
+	runsubtest(pool_packet);
+	runsubtest(pool_description_response);
+})
@@ -0,0 +1,198 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+
+#include "../src/io/ring.h"
+
+#include <sys/mman.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+static
+const uint8_t example_ring_payload[3] = {0, 0x0C, 0x1A};
+
+static
+const knx_cemi example_ring_cemi = {
+	KNX_CEMI_LDATA_IND,
+	0,
+	NULL,
+	{
+		.ldata = {
+			.control1 = {KNX_LDATA_PRIO_LOW, true, true, false, false},
+			.control2 = {KNX_LDATA_ADDR_GROUP, 6},
+			.source = 0x1105,
+			.destination = 0x0A03,
+			.tpdu = {
+				.tpci = KNX_TPCI_UNNUMBERED_DATA,
+				.info = {
+					.data = {
+						.apci = KNX_APCI_GROUPVALUEWRITE,
+						.payload = example_ring_payload,
+						.length = sizeof(example_ring_payload)
+					}
+				}
+			}
+		}
+	}
+};
+
+deftest(ring_publish, {
+	knx_ring producer, consumer;
+	assert(knx_ring_create(&producer, "knxproto-test", 3));
+	assert(producer.header->capacity == 4);
+
+	// Consumers map the ring through their own descriptor
+	assert(knx_ring_attach(&consumer, dup(producer.fd)));
+
+	knx_ring_reader reader;
+	knx_ring_reader_init(&reader, &consumer);
+	assert(knx_ring_read(&reader) == NULL);
+
+	assert(knx_ring_publish_cemi(&producer, KNX_RING_RECEIVED, &example_ring_cemi));
+
+	const knx_ring_record* record = knx_ring_read(&reader);
+	assert(record != NULL);
+	assert(record->direction == KNX_RING_RECEIVED);
+	assert(record->length == knx_cemi_size(&example_ring_cemi));
+
+	knx_cemi frame;
+	assert(knx_ring_record_parse(record, &frame));
+	assert(knx_ring_reader_valid(&reader, record));
+	assert(frame.service == KNX_CEMI_LDATA_IND);
+	assert(frame.payload.ldata.source == example_ring_cemi.payload.ldata.source);
+	assert(frame.payload.ldata.destination == example_ring_cemi.payload.ldata.destination);
+	assert(frame.payload.ldata.tpdu.info.data.payload == record->data + 10);
+
+	assert(knx_ring_read(&reader) == NULL);
+
+	// Raw frames are published as they are
+	uint8_t raw[KNX_RING_FRAME_SIZE + 1];
+	memcpy(raw, record->data, record->length);
+	assert(knx_ring_publish(&producer, KNX_RING_SENT, raw, record->length));
+	assert(!knx_ring_publish(&producer, KNX_RING_SENT, raw, sizeof(raw)));
+
+	record = knx_ring_read(&reader);
+	assert(record != NULL);
+	assert(record->direction == KNX_RING_SENT);
+	assert(knx_ring_record_parse(record, &frame));
+
+	knx_ring_destroy(&consumer);
+	knx_ring_destroy(&producer);
+})
+
+deftest(ring_overrun, {
+	knx_ring ring;
+	assert(knx_ring_create(&ring, "knxproto-test", 4));
+
+	knx_ring_reader reader;
+	knx_ring_reader_init(&reader, &ring);
+
+	for (size_t i = 0; i < 6; i++)
+		assert(knx_ring_publish_cemi(&ring, KNX_RING_RECEIVED, &example_ring_cemi));
+
+	// The first two records have been overwritten
+	size_t n = 0;
+	const knx_ring_record* record;
+
+	while ((record = knx_ring_read(&reader))) {
+		assert(record->seq == reader.position);
+		n++;
+	}
+
+	assert(n == 4);
+	assert(reader.lost == 2);
+
+	// Overwriting a record after reading invalidates it
+	knx_ring_reader_init(&reader, &ring);
+	assert(knx_ring_publish_cemi(&ring, KNX_RING_RECEIVED, &example_ring_cemi));
+	record = knx_ring_read(&reader);
+	assert(record != NULL);
+
+	for (size_t i = 0; i < 4; i++)
+		assert(knx_ring_publish_cemi(&ring, KNX_RING_RECEIVED, &example_ring_cemi));
+
+	assert(!knx_ring_reader_valid(&reader, record));
+
+	knx_ring_destroy(&ring);
+})
+
+deftest(ring_publish_invalid, {
+	knx_ring ring;
+	assert(knx_ring_create(&ring, "knxproto-test", 4));
+
+	for (size_t i = 0; i < 4; i++)
+		assert(knx_ring_publish_cemi(&ring, KNX_RING_RECEIVED, &example_ring_cemi));
+
+	knx_ring_reader reader;
+	reader.ring = &ring;
+	reader.position = 0;
+	reader.lost = 0;
+
+	// A frame which cannot be generated leaves the oldest record intact
+	knx_cemi invalid = example_ring_cemi;
+	invalid.payload.ldata.tpdu.tpci = 7;
+	assert(knx_cemi_size(&invalid) > 0);
+	assert(!knx_ring_publish_cemi(&ring, KNX_RING_RECEIVED, &invalid));
+	assert(ring.header->head == 4);
+
+	size_t n = 0;
+	const knx_ring_record* record;
+
+	while ((record = knx_ring_read(&reader))) {
+		assert(knx_ring_reader_valid(&reader, record));
+		n++;
+	}
+
+	assert(n == 4 && reader.lost == 0);
+
+	knx_ring_destroy(&ring);
+})
+
+deftest(ring_attach_invalid, {
+	knx_ring producer, consumer;
+	assert(knx_ring_create(&producer, "knxproto-test", 4));
+
+	// Too small to hold a header
+	int fd = memfd_create("knxproto-test", MFD_CLOEXEC);
+	assert(fd >= 0);
+	assert(!knx_ring_attach(&consumer, fd));
+	assert(fcntl(fd, F_GETFD) == -1 && errno == EBADF);
+
+	// Record size mismatch
+	fd = dup(producer.fd);
+	producer.header->record_size++;
+	assert(!knx_ring_attach(&consumer, fd));
+	assert(fcntl(fd, F_GETFD) == -1 && errno == EBADF);
+
+	producer.header->record_size--;
+	knx_ring_destroy(&producer);
+})
+
+deftest(ring, {
+	runsubtest(ring_publish);
+	runsubtest(ring_overrun);
+	runsubtest(ring_publish_invalid);
+	runsubtest(ring_attach_invalid);
+})
@@ -0,0 +1,272 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+#include "testalloc.h"
+
+#include "../src/io/series.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define MILLISECOND 1000000ull
+#define SECOND      1000000000ull
+
+typedef struct {
+	size_t count;
+	uint64_t timestamps[4096];
+	double values[4096];
+} example_series_samples;
+
+static
+bool example_series_collect(uint64_t timestamp, double value, void* data) {
+	example_series_samples* samples = data;
+
+	samples->timestamps[samples->count] = timestamp;
+	samples->values[samples->count] = value;
+	samples->count++;
+
+	return true;
+}
+
+static
+bool example_series_stop(uint64_t timestamp, double value, void* data) {
+	(void) timestamp;
+	(void) value;
+	(*(size_t*) data)++;
+
+	return false;
+}
+
+// Temperature-like signal (single precision like decoded DPT 9 values) with jittered timestamps
+static
+double example_series_value(size_t i) {
+	return (float) (20.0 + (double) ((i * 7) % 23) * 0.02);
+}
+
+static
+uint64_t example_series_time(size_t i) {
+	return i * 10 * SECOND + (i % 3) * MILLISECOND;
+}
+
+deftest(series_float, {
+	static knx_series series;
+	static example_series_samples samples;
+	knx_series_init_with(&series, MILLISECOND, test_allocator());
+
+	knx_addr group = knx_group_addr(1, 2, 4);
+
+	for (size_t i = 0; i < 3000; i++)
+		assert(knx_series_append(&series, group, KNX_DPT_FLOAT16, example_series_time(i),
+		                         example_series_value(i)));
+
+	assert(series.columns[group]->count == 3000);
+
+	// Full scan returns every sample exactly
+	samples.count = 0;
+	assert(knx_series_scan(&series, group, 0, UINT64_MAX, example_series_collect, &samples) == 3000);
+	assert(samples.count == 3000);
+
+	for (size_t i = 0; i < 3000; i++) {
+		assert(samples.timestamps[i] == example_series_time(i));
+		assert(samples.values[i] == example_series_value(i));
+	}
+
+	// Range spanning a block boundary
+	samples.count = 0;
+	assert(knx_series_scan(&series, group, example_series_time(1000), example_series_time(1100),
+	                       example_series_collect, &samples) == 101);
+	assert(samples.timestamps[0] == example_series_time(1000));
+	assert(samples.values[100] == example_series_value(1100));
+
+	// Visitor stops the scan
+	size_t visited = 0;
+	assert(knx_series_scan(&series, group, 0, UINT64_MAX, example_series_stop, &visited) == 1);
+	assert(visited == 1);
+
+	// Unknown group
+	assert(knx_series_scan(&series, group + 1, 0, UINT64_MAX, example_series_collect, &samples) == 0);
+
+	// Less than a third of the uncompressed 16 bytes per sample
+	assert(knx_series_memory(&series) < 3000 * 16 / 3);
+
+	knx_series_destroy(&series);
+	assert(series.columns[group] == NULL);
+})
+
+deftest(series_bool, {
+	static knx_series series;
+	static example_series_samples samples;
+	knx_series_init_with(&series, SECOND, test_allocator());
+
+	knx_addr group = knx_group_addr(0, 0, 1);
+
+	// Runs of 1, 2, 3 ... samples
+	size_t n = 0;
+	bool value = true;
+	for (size_t run = 1; n + run <= 2000; run++) {
+		for (size_t j = 0; j < run; j++, n++)
+			assert(knx_series_append(&series, group, KNX_DPT_BOOL, n * SECOND, value));
+
+		value = !value;
+	}
+
+	samples.count = 0;
+	assert(knx_series_scan(&series, group, 0, UINT64_MAX, example_series_collect, &samples) == n);
+
+	n = 0;
+	value = true;
+	for (size_t run = 1; n < samples.count; run++) {
+		for (size_t j = 0; j < run; j++, n++) {
+			assert(samples.timestamps[n] == n * SECOND);
+			assert(samples.values[n] == value);
+		}
+
+		value = !value;
+	}
+
+	// Constant signal compresses to almost nothing
+	knx_addr constant = knx_group_addr(0, 0, 2);
+	for (size_t i = 0; i < 1000; i++)
+		assert(knx_series_append(&series, constant, KNX_DPT_BOOL, i * SECOND, 1));
+
+	samples.count = 0;
+	assert(knx_series_scan(&series, constant, 0, UINT64_MAX, example_series_collect, &samples) == 1000);
+	assert(samples.values[999] == 1);
+
+	const knx_series_block* block = series.columns[constant]->head;
+	assert(block->values.bits == 1 && block->times.bits == 9 + 998 && block->run == 1000);
+
+	knx_series_destroy(&series);
+})
+
+deftest(series_downsample, {
+	static knx_series series;
+	knx_series_init_with(&series, MILLISECOND, test_allocator());
+
+	knx_addr group = knx_group_addr(2, 0, 0);
+
+	// One sample per second, value equals the second
+	for (size_t i = 0; i < 5000; i++)
+		assert(knx_series_append(&series, group, KNX_DPT_UNSIGNED16, i * SECOND, i));
+
+	knx_series_aggregate aggregates[3];
+
+	// Intervals covering whole blocks
+	knx_series_downsample(&series, group, 0, 2048 * SECOND, aggregates, 3);
+
+	assert(aggregates[0].start == 0 && aggregates[0].count == 2048);
+	assert(aggregates[0].min == 0 && aggregates[0].max == 2047 && aggregates[0].last == 2047);
+	assert(aggregates[0].sum == 2047.0 * 2048 / 2);
+
+	assert(aggregates[1].count == 2048 && aggregates[1].min == 2048);
+	assert(aggregates[2].count == 5000 - 4096 && aggregates[2].max == 4999);
+
+	// Intervals splitting blocks
+	knx_series_downsample(&series, group, 100 * SECOND, 60 * SECOND, aggregates, 3);
+
+	assert(aggregates[1].start == 160 * SECOND);
+	assert(aggregates[1].count == 60);
+	assert(aggregates[1].min == 160 && aggregates[1].max == 219 && aggregates[1].last == 219);
+
+	// Empty interval
+	knx_series_downsample(&series, group, 10000 * SECOND, SECOND, aggregates, 1);
+	assert(aggregates[0].count == 0 && isnan(aggregates[0].min));
+
+	knx_series_destroy(&series);
+})
+
+deftest(series_append, {
+	static knx_series series;
+	knx_series_init_with(&series, MILLISECOND, test_allocator());
+
+	knx_addr group = knx_group_addr(3, 0, 0);
+
+	assert(knx_series_append(&series, group, KNX_DPT_SIGNED32, 10 * SECOND, -5));
+	assert(knx_series_append(&series, group, KNX_DPT_SIGNED32, 10 * SECOND, -6));
+
+	// Out of order
+	assert(!knx_series_append(&series, group, KNX_DPT_SIGNED32, 9 * SECOND, -7));
+
+	// Type changes
+	assert(!knx_series_append(&series, group, KNX_DPT_FLOAT32, 11 * SECOND, 1.5));
+
+	// Non-numeric type
+	assert(!knx_series_append(&series, group + 1, KNX_DPT_STRING, 0, 0));
+
+	// Large gaps in time
+	assert(knx_series_append(&series, group, KNX_DPT_SIGNED32, 1000000 * SECOND, 1 << 30));
+	assert(knx_series_append(&series, group, KNX_DPT_SIGNED32, 1000000 * SECOND + 1, -(1 << 30)));
+
+	static example_series_samples samples;
+	samples.count = 0;
+	assert(knx_series_scan(&series, group, 0, UINT64_MAX, example_series_collect, &samples) == 4);
+	assert(samples.values[0] == -5 && samples.values[1] == -6);
+	assert(samples.timestamps[2] == 1000000 * SECOND && samples.values[2] == 1 << 30);
+
+	// Truncated to the resolution
+	assert(samples.timestamps[3] == 1000000 * SECOND && samples.values[3] == -(1 << 30));
+
+	knx_series_destroy(&series);
+})
+
+deftest(series_ldata, {
+	static knx_series series;
+	knx_series_init_with(&series, MILLISECOND, test_allocator());
+
+	knx_addr group = knx_group_addr(1, 2, 4);
+
+	const uint8_t payload[3] = {0, 0x0C, 0x1A};
+
+	knx_ldata ldata;
+	memset(&ldata, 0, sizeof(knx_ldata));
+	ldata.control2.address_type = KNX_LDATA_ADDR_GROUP;
+	ldata.destination = group;
+	ldata.tpdu.tpci = KNX_TPCI_UNNUMBERED_DATA;
+	ldata.tpdu.info.data.apci = KNX_APCI_GROUPVALUEWRITE;
+	ldata.tpdu.info.data.payload = payload;
+	ldata.tpdu.info.data.length = sizeof(payload);
+
+	assert(knx_series_append_ldata(&series, SECOND, &ldata, KNX_DPT_FLOAT16));
+
+	// Payload does not match the type
+	assert(!knx_series_append_ldata(&series, 2 * SECOND, &ldata, KNX_DPT_UNSIGNED32));
+
+	// Reads carry no value
+	ldata.tpdu.info.data.apci = KNX_APCI_GROUPVALUEREAD;
+	assert(!knx_series_append_ldata(&series, 2 * SECOND, &ldata, KNX_DPT_FLOAT16));
+
+	static example_series_samples samples;
+	samples.count = 0;
+	assert(knx_series_scan(&series, group, 0, UINT64_MAX, example_series_collect, &samples) == 1);
+	assert(samples.values[0] == 21.0);
+
+	knx_series_destroy(&series);
+})
+
+deftest(series, {
+	runsubtest(series_float);
+	runsubtest(series_bool);
+	runsubtest(series_downsample);
+	runsubtest(series_append);
+	runsubtest(series_ldata);
+})
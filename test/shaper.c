@@ -0,0 +1,166 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+#include "testalloc.h"
+
+#include "../src/bus/shaper.h"
+
+#include <stdbool.h>
+
+typedef struct {
+	size_t count;
+	const knx_ldata* sent[32];
+} shaper_log;
+
+static
+void shaper_record(const knx_ldata* ldata, void* user, void* data) {
+	shaper_log* log = data;
+
+	if (log->count < 32)
+		log->sent[log->count] = ldata;
+
+	log->count++;
+}
+
+deftest(shaper_schedule, {
+	knx_ldata low = {
+		.control1 = {KNX_LDATA_PRIO_LOW, true, true, false, false},
+		.control2 = {KNX_LDATA_ADDR_GROUP, 6},
+		.destination = knx_group_addr(1, 2, 3)
+	};
+
+	knx_ldata urgent = low;
+	urgent.control1.priority = KNX_LDATA_PRIO_URGENT;
+
+	knx_ldata device = low;
+	device.control2.address_type = KNX_LDATA_ADDR_INDIVIDUAL;
+	device.destination = knx_individual_addr(1, 1, 5);
+
+	shaper_log log = {0, {NULL}};
+
+	knx_shaper shaper;
+	assert(knx_shaper_init_with(&shaper, 16, KNX_SHAPER_DEFAULT_RATE, 2, shaper_record, &log,
+	                            test_allocator()));
+
+	// Nothing queued
+	assert(knx_shaper_poll(&shaper, 1000000000) == UINT64_MAX);
+
+	for (size_t i = 0; i < 4; i++)
+		assert(knx_shaper_submit(&shaper, &low, NULL));
+
+	assert(knx_shaper_submit(&shaper, &urgent, NULL));
+	assert(knx_shaper_submit(&shaper, &device, NULL));
+
+	// The burst allows two group telegrams, the urgent one comes first
+	uint64_t now = 1000000000;
+	uint64_t deadline = knx_shaper_poll(&shaper, now);
+
+	assert(log.count == 3);
+	assert(log.sent[0] == &urgent);
+	assert(log.sent[1] == &low);
+
+	// The individually addressed telegram is on a different line and not held back
+	assert(log.sent[2] == &device);
+	assert(shaper.queued == 3);
+
+	// One token every 20ms
+	assert(deadline > now && deadline <= now + 20000001);
+	assert(knx_shaper_poll(&shaper, deadline - 1000000) == deadline);
+	assert(log.count == 3);
+
+	knx_shaper_poll(&shaper, deadline);
+	assert(log.count == 4);
+
+	// Drain the rest
+	while ((deadline = knx_shaper_poll(&shaper, deadline)) != UINT64_MAX);
+	assert(log.count == 6);
+	assert(shaper.queued == 0);
+
+	// The queue is bounded
+	for (size_t i = 0; i < 16; i++)
+		assert(knx_shaper_submit(&shaper, &low, NULL));
+
+	assert(!knx_shaper_submit(&shaper, &low, NULL));
+
+	knx_shaper_destroy(&shaper);
+})
+
+deftest(shaper_lines, {
+	knx_ldata first[3];
+	for (size_t i = 0; i < 3; i++) {
+		first[i] = (knx_ldata) {
+			.control1 = {KNX_LDATA_PRIO_NORMAL, true, true, false, false},
+			.control2 = {KNX_LDATA_ADDR_INDIVIDUAL, 6},
+			.destination = knx_individual_addr(1, 1, i + 1)
+		};
+	}
+
+	knx_ldata second = first[0];
+	second.destination = knx_individual_addr(1, 2, 1);
+
+	knx_ldata system = first[0];
+	system.control1.priority = KNX_LDATA_PRIO_SYSTEM;
+
+	shaper_log log = {0, {NULL}};
+
+	knx_shaper shaper;
+	assert(knx_shaper_init_with(&shaper, 8, KNX_SHAPER_DEFAULT_RATE, 1, shaper_record, &log,
+	                            test_allocator()));
+
+	for (size_t i = 0; i < 3; i++)
+		assert(knx_shaper_submit(&shaper, &first[i], NULL));
+
+	assert(knx_shaper_submit(&shaper, &second, NULL));
+
+	// One telegram per line, the blocked line does not hold back the other
+	uint64_t deadline = knx_shaper_poll(&shaper, 1000000000);
+	assert(log.count == 2);
+	assert(log.sent[0] == &first[0]);
+	assert(log.sent[1] == &second);
+
+	// A higher priority overtakes the queued telegrams of its line
+	assert(knx_shaper_submit(&shaper, &system, NULL));
+
+	deadline = knx_shaper_poll(&shaper, deadline);
+	assert(log.count == 3);
+	assert(log.sent[2] == &system);
+
+	// The line keeps its order
+	while ((deadline = knx_shaper_poll(&shaper, deadline)) != UINT64_MAX);
+	assert(log.count == 5);
+	assert(log.sent[3] == &first[1]);
+	assert(log.sent[4] == &first[2]);
+	assert(shaper.queued == 0);
+
+	// Drained lines accept new telegrams
+	assert(knx_shaper_submit(&shaper, &second, NULL));
+	knx_shaper_poll(&shaper, 2000000000);
+	assert(log.count == 6);
+	assert(log.sent[5] == &second);
+
+	knx_shaper_destroy(&shaper);
+})
+
+deftest(shaper, {
+	runsubtest(shaper_schedule);
+	runsubtest(shaper_lines);
+})
@@ -0,0 +1,148 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+
+#include "../src/proto/telegram.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+deftest(telegram_ldata, {
+	assert(sizeof(knx_telegram_compact) == 32);
+
+	const uint8_t payload[3] = {0x00, 0x0C, 0x1A};
+
+	knx_ldata ldata;
+	memset(&ldata, 0, sizeof(knx_ldata));
+	ldata.control1.priority = KNX_LDATA_PRIO_LOW;
+	ldata.control1.repeat = true;
+	ldata.control2.address_type = KNX_LDATA_ADDR_GROUP;
+	ldata.control2.hops = 6;
+	ldata.source = knx_individual_addr(1, 1, 20);
+	ldata.destination = knx_group_addr(1, 2, 4);
+	ldata.tpdu.tpci = KNX_TPCI_UNNUMBERED_DATA;
+	ldata.tpdu.info.data.apci = KNX_APCI_GROUPVALUEWRITE;
+	ldata.tpdu.info.data.payload = payload;
+	ldata.tpdu.info.data.length = sizeof(payload);
+
+	knx_telegram_compact telegram;
+	assert(knx_telegram_compact_from_ldata(&telegram, KNX_CEMI_LDATA_IND, &ldata));
+	assert(telegram.service == KNX_CEMI_LDATA_IND);
+	assert(knx_telegram_compact_source(&telegram) == ldata.source);
+	assert(knx_telegram_compact_destination(&telegram) == ldata.destination);
+	assert(knx_telegram_compact_is_group(&telegram));
+	assert(telegram.length == 3);
+	assert(telegram.tpdu[4] == 0);
+
+	knx_ldata out;
+	assert(knx_telegram_compact_to_ldata(&telegram, &out));
+	assert(out.control1.priority == KNX_LDATA_PRIO_LOW && out.control1.repeat);
+	assert(out.control2.address_type == KNX_LDATA_ADDR_GROUP && out.control2.hops == 6);
+	assert(out.source == ldata.source && out.destination == ldata.destination);
+	assert(out.tpdu.tpci == KNX_TPCI_UNNUMBERED_DATA);
+	assert(out.tpdu.info.data.apci == KNX_APCI_GROUPVALUEWRITE);
+	assert(out.tpdu.info.data.length == 3);
+	assert(out.tpdu.info.data.payload == telegram.tpdu + 1);
+	assert(memcmp(out.tpdu.info.data.payload + 1, payload + 1, 2) == 0);
+
+	// Control frame
+	knx_ldata ack;
+	memset(&ack, 0, sizeof(knx_ldata));
+	ack.destination = knx_individual_addr(1, 1, 5);
+	ack.tpdu.tpci = KNX_TPCI_NUMBERED_CONTROL;
+	ack.tpdu.seq_number = 9;
+	ack.tpdu.info.control = KNX_TPCI_CONTROL_ACK;
+
+	assert(knx_telegram_compact_from_ldata(&telegram, KNX_CEMI_LDATA_REQ, &ack));
+	assert(!knx_telegram_compact_is_group(&telegram));
+	assert(knx_telegram_compact_to_ldata(&telegram, &out));
+	assert(out.tpdu.tpci == KNX_TPCI_NUMBERED_CONTROL && out.tpdu.seq_number == 9);
+	assert(out.tpdu.info.control == KNX_TPCI_CONTROL_ACK);
+
+	// TPDU too large
+	uint8_t large[KNX_TELEGRAM_COMPACT_TPDU_SIZE];
+	memset(large, 0, sizeof(large));
+	ldata.tpdu.info.data.payload = large;
+	ldata.tpdu.info.data.length = sizeof(large);
+	assert(!knx_telegram_compact_from_ldata(&telegram, KNX_CEMI_LDATA_IND, &ldata));
+
+	ldata.tpdu.info.data.length = sizeof(large) - 1;
+	assert(knx_telegram_compact_from_ldata(&telegram, KNX_CEMI_LDATA_IND, &ldata));
+	assert(telegram.length == KNX_TELEGRAM_COMPACT_TPDU_SIZE - 1);
+})
+
+deftest(telegram_cemi, {
+	// L_Data.ind with two bytes of additional information
+	const uint8_t cemi[] = {
+		0x29, 0x02, 0xAA, 0xBB,
+		0xBC, 0xE0, 0x11, 0x14, 0x0A, 0x04, 0x03, 0x00, 0x80, 0x0C, 0x1A
+	};
+
+	knx_telegram_compact telegram;
+	assert(knx_telegram_compact_from_cemi(&telegram, cemi, sizeof(cemi)));
+	assert(telegram.service == KNX_CEMI_LDATA_IND);
+	assert(knx_telegram_compact_source(&telegram) == 0x1114);
+	assert(knx_telegram_compact_destination(&telegram) == 0x0A04);
+	assert(knx_telegram_compact_cemi_size(&telegram) == sizeof(cemi) - 2);
+
+	// Additional information is dropped
+	uint8_t buffer[64];
+	assert(knx_telegram_compact_to_cemi(&telegram, buffer) == sizeof(cemi) - 2);
+	assert(buffer[0] == 0x29 && buffer[1] == 0);
+	assert(memcmp(buffer + 2, cemi + 4, sizeof(cemi) - 4) == 0);
+
+	// Agrees with the regular parser
+	knx_cemi parsed;
+	assert(knx_cemi_parse(buffer, sizeof(cemi) - 2, &parsed));
+
+	knx_ldata ldata;
+	assert(knx_telegram_compact_to_ldata(&telegram, &ldata));
+	assert(ldata.destination == parsed.payload.ldata.destination);
+	assert(ldata.tpdu.info.data.apci == parsed.payload.ldata.tpdu.info.data.apci);
+
+	// Truncated
+	assert(!knx_telegram_compact_from_cemi(&telegram, cemi, sizeof(cemi) - 1));
+	assert(!knx_telegram_compact_from_cemi(&telegram, cemi, 5));
+
+	// Unknown service
+	uint8_t other[sizeof(cemi)];
+	memcpy(other, cemi, sizeof(cemi));
+	other[0] = 0xFC;
+	assert(!knx_telegram_compact_from_cemi(&telegram, other, sizeof(other)));
+
+	// Standard frame with extended frame format
+	memcpy(other, cemi, sizeof(cemi));
+	other[5] |= 1;
+	assert(!knx_telegram_compact_from_cemi(&telegram, other, sizeof(other)));
+
+	// Extended frame
+	other[4] &= 0x7F;
+	assert(knx_telegram_compact_from_cemi(&telegram, other, sizeof(other)));
+	assert(knx_telegram_compact_to_ldata(&telegram, &ldata));
+	assert(ldata.control1.extended);
+	assert(ldata.control2.extended_format == 1);
+})
+
+deftest(telegram, {
+	runsubtest(telegram_ldata);
+	runsubtest(telegram_cemi);
+})
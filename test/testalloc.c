@@ -0,0 +1,50 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testalloc.h"
+
+#ifdef KNXPROTO_NO_MALLOC
+
+#include <stdint.h>
+
+// Enough for every test case that allocates through `test_allocator`
+#define TEST_ALLOCATOR_SIZE (16 << 20)
+
+const knx_allocator* test_allocator(void) {
+	static uint8_t buffer[TEST_ALLOCATOR_SIZE];
+	static knx_arena arena;
+	static knx_allocator allocator;
+
+	if (!arena.base) {
+		knx_arena_init_buffer(&arena, buffer, sizeof(buffer));
+		allocator = knx_arena_allocator(&arena);
+	}
+
+	return &allocator;
+}
+
+#else
+
+const knx_allocator* test_allocator(void) {
+	return NULL;
+}
+
+#endif
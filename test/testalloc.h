@@ -0,0 +1,46 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef KNXPROTO_TEST_TESTALLOC_H_
+#define KNXPROTO_TEST_TESTALLOC_H_
+
+#include "../src/util/allocator.h"
+
+#include <stdbool.h>
+
+/**
+ * Does the library allocate from the heap? Test cases which depend on it check this at run time,
+ * since preprocessor directives cannot appear inside `deftest`.
+ */
+#ifdef KNXPROTO_NO_MALLOC
+#define TEST_HEAP false
+#else
+#define TEST_HEAP true
+#endif
+
+/**
+ * Allocator for test cases which do not care where their memory comes from. It selects the heap,
+ * unless the library has been built with `KNXPROTO_NO_MALLOC`. In that case memory is handed out
+ * from a static arena which is never reset.
+ */
+const knx_allocator* test_allocator(void);
+
+#endif
@@ -0,0 +1,243 @@
+/* KNX Client Library
+ * A library which provides the means to communicate with several
+ * KNX-related devices or services.
+ *
+ * Copyright (C) 2014-2015, Ole Krüger <ole@vprsm.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "testfw.h"
+#include "testalloc.h"
+
+#include "../src/bus/transport.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+typedef struct {
+	size_t sent;
+	knx_ldata frames[16];
+
+	size_t events;
+	knx_transport_event event[16];
+	uint32_t connection[16];
+} transport_log;
+
+static
+void transport_record_frame(const knx_ldata* ldata, void* user, void* data) {
+	transport_log* log = data;
+
+	if (log->sent < 16)
+		log->frames[log->sent] = *ldata;
+
+	log->sent++;
+}
+
+static
+void transport_record_event(
+	uint32_t            connection,
+	knx_transport_event event,
+	const knx_tpdu*     tpdu,
+	void*               user,
+	void*               data
+) {
+	transport_log* log = data;
+
+	if (log->events < 16) {
+		log->event[log->events] = event;
+		log->connection[log->events] = connection;
+	}
+
+	log->events++;
+}
+
+// Frame as it would arrive from the remote device
+static
+knx_ldata transport_frame(
+	knx_addr         source,
+	knx_tpci         tpci,
+	uint8_t          seq_number,
+	knx_tpci_control control
+) {
+	knx_ldata ldata;
+	memset(&ldata, 0, sizeof(knx_ldata));
+
+	ldata.control2.address_type = KNX_LDATA_ADDR_INDIVIDUAL;
+	ldata.source = source;
+	ldata.destination = knx_individual_addr(1, 1, 250);
+	ldata.tpdu.tpci = tpci;
+	ldata.tpdu.seq_number = seq_number;
+	ldata.tpdu.info.control = control;
+
+	return ldata;
+}
+
+#define SECOND 1000000000ull
+
+deftest(transport_data, {
+	const uint8_t request[3] = {0x03, 0x00, 0x60};
+	const knx_addr a = knx_individual_addr(1, 1, 1);
+	const knx_addr b = knx_individual_addr(1, 1, 2);
+
+	transport_log log;
+	memset(&log, 0, sizeof(log));
+
+	knx_transport transport;
+	assert(knx_transport_init_with(&transport, 4, transport_record_frame, transport_record_event,
+	                               &log, test_allocator()));
+
+	// Nothing open
+	assert(knx_transport_poll(&transport, SECOND) == UINT64_MAX);
+
+	uint32_t ca = knx_transport_connect(&transport, 0, a, NULL, SECOND);
+	uint32_t cb = knx_transport_connect(&transport, 0, b, NULL, SECOND);
+	assert(ca != KNX_TRANSPORT_NONE && cb != KNX_TRANSPORT_NONE && ca != cb);
+	assert(knx_transport_connect(&transport, 0, a, NULL, SECOND) == KNX_TRANSPORT_NONE);
+
+	assert(log.sent == 2);
+	assert(log.frames[0].destination == a);
+	assert(log.frames[0].control2.address_type == KNX_LDATA_ADDR_INDIVIDUAL);
+	assert(log.frames[0].tpdu.tpci == KNX_TPCI_UNNUMBERED_CONTROL);
+	assert(log.frames[0].tpdu.info.control == KNX_TPCI_CONTROL_CONNECTED);
+
+	// Both connections have a frame in flight at the same time
+	assert(knx_transport_send_data(&transport, ca, KNX_APCI_MEMORYREAD, request, 3, SECOND));
+	assert(knx_transport_send_data(&transport, cb, KNX_APCI_MEMORYREAD, request, 3, SECOND));
+	assert(!knx_transport_send_data(&transport, ca, KNX_APCI_MEMORYREAD, request, 3, SECOND));
+	assert(knx_transport_state_of(&transport, ca) == KNX_TRANSPORT_OPEN_WAIT);
+
+	assert(log.sent == 4);
+	assert(log.frames[2].tpdu.tpci == KNX_TPCI_NUMBERED_DATA);
+	assert(log.frames[2].tpdu.seq_number == 0);
+	assert(log.frames[2].tpdu.info.data.apci == KNX_APCI_MEMORYREAD);
+
+	// Acknowledgements with the wrong sequence number are ignored
+	knx_ldata ack = transport_frame(a, KNX_TPCI_NUMBERED_CONTROL, 1, KNX_TPCI_CONTROL_ACK);
+	assert(knx_transport_receive(&transport, &ack, SECOND));
+	assert(log.events == 0);
+
+	ack.tpdu.seq_number = 0;
+	assert(knx_transport_receive(&transport, &ack, SECOND));
+	assert(log.events == 1);
+	assert(log.event[0] == KNX_TRANSPORT_CONFIRMED && log.connection[0] == ca);
+	assert(knx_transport_state_of(&transport, ca) == KNX_TRANSPORT_OPEN_IDLE);
+	assert(knx_transport_state_of(&transport, cb) == KNX_TRANSPORT_OPEN_WAIT);
+
+	// The next frame uses the next sequence number
+	assert(knx_transport_send_data(&transport, ca, KNX_APCI_MEMORYREAD, request, 3, SECOND));
+	assert(log.frames[4].tpdu.seq_number == 1);
+
+	// Incoming data is acknowledged and delivered once
+	knx_ldata response = transport_frame(b, KNX_TPCI_NUMBERED_DATA, 0, 0);
+	response.tpdu.info.data.apci = KNX_APCI_MEMORYRESPONSE;
+	response.tpdu.info.data.payload = request;
+	response.tpdu.info.data.length = 3;
+
+	assert(knx_transport_receive(&transport, &response, SECOND));
+	assert(log.sent == 6);
+	assert(log.frames[5].destination == b);
+	assert(log.frames[5].tpdu.tpci == KNX_TPCI_NUMBERED_CONTROL);
+	assert(log.frames[5].tpdu.info.control == KNX_TPCI_CONTROL_ACK);
+	assert(log.frames[5].tpdu.seq_number == 0);
+	assert(log.events == 2 && log.event[1] == KNX_TRANSPORT_DATA && log.connection[1] == cb);
+
+	// A repetition is acknowledged again but not delivered
+	assert(knx_transport_receive(&transport, &response, SECOND));
+	assert(log.sent == 7 && log.frames[6].tpdu.info.control == KNX_TPCI_CONTROL_ACK);
+	assert(log.events == 2);
+
+	// Out of order frames are rejected
+	response.tpdu.seq_number = 5;
+	assert(knx_transport_receive(&transport, &response, SECOND));
+	assert(log.sent == 8 && log.frames[7].tpdu.info.control == KNX_TPCI_CONTROL_ERROR);
+	assert(log.events == 2);
+
+	// Frames from unknown devices and group telegrams are not ours
+	knx_ldata other = transport_frame(knx_individual_addr(1, 1, 3), KNX_TPCI_NUMBERED_DATA, 0, 0);
+	assert(!knx_transport_receive(&transport, &other, SECOND));
+
+	response.control2.address_type = KNX_LDATA_ADDR_GROUP;
+	assert(!knx_transport_receive(&transport, &response, SECOND));
+
+	// Remote disconnect
+	knx_ldata disconnect = transport_frame(b, KNX_TPCI_UNNUMBERED_CONTROL, 0,
+	                                       KNX_TPCI_CONTROL_DISCONNECTED);
+	assert(knx_transport_receive(&transport, &disconnect, SECOND));
+	assert(log.events == 3 && log.event[2] == KNX_TRANSPORT_DISCONNECTED && log.connection[2] == cb);
+	assert(knx_transport_state_of(&transport, cb) == KNX_TRANSPORT_CLOSED);
+
+	// Local disconnect
+	knx_transport_disconnect(&transport, ca);
+	assert(log.sent == 9);
+	assert(log.frames[8].tpdu.tpci == KNX_TPCI_UNNUMBERED_CONTROL);
+	assert(log.frames[8].tpdu.info.control == KNX_TPCI_CONTROL_DISCONNECTED);
+	assert(transport.active == 0);
+
+	knx_transport_destroy(&transport);
+})
+
+deftest(transport_timeout, {
+	const uint8_t request[3] = {0x03, 0x00, 0x60};
+	const knx_addr a = knx_individual_addr(1, 1, 1);
+
+	transport_log log;
+	memset(&log, 0, sizeof(log));
+
+	knx_transport transport;
+	assert(knx_transport_init_with(&transport, 2, transport_record_frame, transport_record_event,
+	                               &log, test_allocator()));
+
+	uint32_t ca = knx_transport_connect(&transport, 0, a, NULL, 0);
+	assert(knx_transport_poll(&transport, 0) == KNX_TRANSPORT_CONNECTION_TIMEOUT);
+
+	assert(knx_transport_send_data(&transport, ca, KNX_APCI_MEMORYREAD, request, 3, SECOND));
+	assert(knx_transport_poll(&transport, SECOND) == SECOND + KNX_TRANSPORT_ACK_TIMEOUT);
+
+	// A negative acknowledgement triggers a repetition
+	knx_ldata nak = transport_frame(a, KNX_TPCI_NUMBERED_CONTROL, 0, KNX_TPCI_CONTROL_ERROR);
+	assert(knx_transport_receive(&transport, &nak, 2 * SECOND));
+	assert(log.sent == 3);
+	assert(log.frames[2].tpdu.tpci == KNX_TPCI_NUMBERED_DATA);
+	assert(log.frames[2].tpdu.seq_number == 0);
+
+	// Missing acknowledgements trigger repetitions until they are used up
+	uint64_t now = 2 * SECOND;
+
+	for (size_t i = 1; i <= KNX_TRANSPORT_MAX_REPETITIONS; i++) {
+		now = knx_transport_poll(&transport, now);
+		assert(now == 2 * SECOND + i * KNX_TRANSPORT_ACK_TIMEOUT);
+	}
+
+	assert(knx_transport_poll(&transport, now) == UINT64_MAX);
+	assert(log.sent == 2 + KNX_TRANSPORT_MAX_REPETITIONS + 1);
+	assert(log.frames[log.sent - 2].tpdu.tpci == KNX_TPCI_NUMBERED_DATA);
+	assert(log.frames[log.sent - 1].tpdu.info.control == KNX_TPCI_CONTROL_DISCONNECTED);
+	assert(log.events == 1 && log.event[0] == KNX_TRANSPORT_FAILED);
+	assert(knx_transport_state_of(&transport, ca) == KNX_TRANSPORT_CLOSED);
+
+	// Idle connections time out
+	ca = knx_transport_connect(&transport, 0, a, NULL, now);
+	assert(knx_transport_poll(&transport, now) == now + KNX_TRANSPORT_CONNECTION_TIMEOUT);
+	assert(knx_transport_poll(&transport, now + KNX_TRANSPORT_CONNECTION_TIMEOUT) == UINT64_MAX);
+	assert(log.events == 2 && log.event[1] == KNX_TRANSPORT_FAILED);
+
+	knx_transport_destroy(&transport);
+})
+
+deftest(transport, {
+	runsubtest(transport_data);
+	runsubtest(transport_timeout);
+})